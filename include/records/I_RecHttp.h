@@ -273,6 +273,8 @@ public:
   bool m_transparent_passthrough = false;
   /// True if MPTCP is enabled on this port.
   bool m_mptcp = false;
+  /// True if accepted connections use completion based I/O with io_uring.
+  bool m_io_uring = false;
   /// Local address for inbound connections (listen address).
   IpAddr m_inbound_ip;
   /// Local address for outbound connections (to origin server).
@@ -429,6 +431,7 @@ public:
   static const char *const OPT_HOST_RES_PREFIX;         ///< Set DNS family preference.
   static const char *const OPT_PROTO_PREFIX;            ///< Transport layer protocols.
   static const char *const OPT_MPTCP;                   ///< MPTCP.
+  static const char *const OPT_IO_URING;                ///< io_uring network I/O.
 
   static std::vector<self> &m_global; ///< Global ("default") data.
 
@@ -126,6 +126,120 @@ protected:
   InkFreeList *fl;
 };
 
+/**
+  Allocator for fixed size memory blocks with per thread magazines.
+
+  Each thread keeps two magazines, arrays of free blocks, for every allocator. Allocation and free
+  work on the loaded magazine without any atomic operation, when it runs empty or full it is swapped
+  with the previous one and only when both are exhausted is a whole magazine exchanged with the
+  depot, a lock free list of full and of empty magazines. The depot is kept per NUMA node. New blocks
+  are carved from chunks that the allocating thread touches first so the pages are placed on its
+  node, on huge pages if requested.
+
+  The freelist of the base class is kept for its parameters and memory accounting, blocks are only
+  taken from it if the allocator does not get a magazine slot or freelists are replaced by malloc.
+  @c used counts the blocks that are not in the depot, blocks in thread magazines included. A
+  magazine holds at most @c MAGAZINE_BYTES so threads do not hoard large blocks.
+*/
+class MagazineAllocator : public FreelistAllocator
+{
+public:
+  static constexpr int MAGAZINE_SIZE     = 64;
+  static constexpr size_t MAGAZINE_BYTES = 256 * 1024;
+  static constexpr int MAX_ALLOCATORS    = 512;
+  static constexpr int MAX_NODES         = 8;
+
+  void *
+  alloc_void()
+  {
+    Cache &c = _caches[_id];
+    if (likely(c.loaded && c.loaded->count > 0)) {
+      return c.loaded->rounds[--c.loaded->count];
+    }
+    return alloc_slow();
+  }
+
+  void
+  free_void(void *ptr)
+  {
+    Cache &c = _caches[_id];
+    if (likely(c.loaded && c.loaded->count < _capacity)) {
+      c.loaded->rounds[c.loaded->count++] = ptr;
+      return;
+    }
+    free_slow(ptr);
+  }
+
+  void
+  free_void_bulk(void *head, void *, size_t num_item)
+  {
+    void *item = head;
+    void *next;
+
+    for (size_t i = 0; i < num_item && item; ++i, item = next) {
+      next = *static_cast<void **>(item);
+      free_void(item);
+    }
+  }
+
+  MagazineAllocator();
+  MagazineAllocator(const char *name, unsigned int element_size, unsigned int chunk_size = 128, unsigned int alignment = 8,
+                    bool use_hugepages = false);
+  ~MagazineAllocator();
+
+  /** Re-initialize the parameters of the allocator, before any block is allocated. */
+  void re_init(const char *name, unsigned int element_size, unsigned int chunk_size, unsigned int alignment, bool use_hugepages,
+               int advice);
+
+  MagazineAllocator &
+  raw()
+  {
+    return *this;
+  }
+
+  /// Return the magazines of the calling thread to the depots, done when a thread exits.
+  static void flush_thread();
+
+  /// The NUMA node the calling thread runs on, as used to pick a depot.
+  static int local_node();
+
+  /// Bytes carved for all the magazine allocators by threads on NUMA node @a node.
+  static int64_t node_allocated(int node);
+
+private:
+  struct Magazine {
+    Magazine *next = nullptr;
+    int count      = 0;
+    void *rounds[MAGAZINE_SIZE];
+  };
+
+  struct Cache {
+    Magazine *loaded;
+    Magazine *previous;
+  };
+
+  struct alignas(64) Depot {
+    InkAtomicList full;
+    InkAtomicList empty;
+  };
+
+  void init_depot(const char *name);
+  void *alloc_slow();
+  void free_slow(void *ptr);
+  void setup(Cache &c, int node);
+  void carve(Cache &c);
+  Magazine *get_full(int node);
+  Magazine *get_empty(int node);
+  void put(Magazine *m, int node);
+
+  int _id;
+  int _capacity = MAGAZINE_SIZE; ///< Blocks per magazine.
+  Depot _depot[MAX_NODES];
+
+  // The slot at MAX_ALLOCATORS is never loaded, allocators beyond the limit use the freelist.
+  static thread_local Cache _caches[MAX_ALLOCATORS + 1];
+};
+
 class MallocAllocator
 {
 public:
@@ -222,16 +336,18 @@ private:
 };
 
 #if TS_USE_MALLOC_ALLOCATOR
-using Allocator = MallocAllocator;
+using Allocator      = MallocAllocator;
+using ClassAllocBase = MallocAllocator;
 #else
-using Allocator = FreelistAllocator;
+using Allocator      = FreelistAllocator;
+using ClassAllocBase = MagazineAllocator;
 #endif
 
 /**
   Allocator for Class objects.
 
 */
-template <class C, bool Destruct_on_free_ = false, typename BaseAllocator = Allocator> class ClassAllocator : public BaseAllocator
+template <class C, bool Destruct_on_free_ = false, typename BaseAllocator = ClassAllocBase> class ClassAllocator : public BaseAllocator
 {
 public:
   using Value_type                   = C;
@@ -273,7 +389,7 @@ public:
   {
   }
 
-  Allocator &
+  BaseAllocator &
   raw()
   {
     return *this;
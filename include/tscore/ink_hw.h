@@ -28,6 +28,12 @@
 
 // Get the hardware topology
 hwloc_topology_t ink_get_topology();
+
+// The logical index of the NUMA node that contains all of @a cpus, 0 if they span more than one.
+int ink_numa_node_of(hwloc_const_cpuset_t cpus);
 #endif
 
 int ink_number_of_processors();
+
+// The number of NUMA nodes, 1 without hwloc.
+int ink_number_of_numa_nodes();
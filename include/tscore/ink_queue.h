@@ -202,6 +202,7 @@ typedef struct _InkFreeList InkFreeList;
 const InkFreeListOps *ink_freelist_malloc_ops();
 const InkFreeListOps *ink_freelist_freelist_ops();
 void ink_freelist_init_ops(int nofl_class, int nofl_proxy);
+int ink_freelist_uses_malloc();
 
 /*
  * alignment must be a power of 2
@@ -116,6 +116,9 @@ aio_stats_cb(const char * /* name ATS_UNUSED */, RecDataT data_type, RecData *da
   case AIO_STAT_IO_URING_COMPLETED:
     new_val = io_uring_completions.load();
     break;
+  case AIO_STAT_IO_URING_FIXED_SUBMITTED:
+    new_val = io_uring_fixed_submissions.load();
+    break;
 #endif
   default:
     ink_assert(0);
@@ -182,6 +185,8 @@ ink_aio_init(ts::ModuleVersion v, AIOBackend backend)
                      (int)AIO_STAT_IO_URING_SUBMITTED, aio_stats_cb);
   RecRegisterRawStat(aio_rsb, RECT_PROCESS, "proxy.process.io_uring.completed", RECD_FLOAT, RECP_PERSISTENT,
                      (int)AIO_STAT_IO_URING_COMPLETED, aio_stats_cb);
+  RecRegisterRawStat(aio_rsb, RECT_PROCESS, "proxy.process.io_uring.fixed_submitted", RECD_FLOAT, RECP_PERSISTENT,
+                     (int)AIO_STAT_IO_URING_FIXED_SUBMITTED, aio_stats_cb);
 #endif
 #if AIO_MODE == AIO_MODE_DEFAULT
   memset(&aio_reqs, 0, MAX_DISKS_POSSIBLE * sizeof(AIO_Reqs *));
@@ -573,6 +578,36 @@ AIOCallbackInternal::handle_complete(io_uring_cqe *cqe)
     }
   }
 }
+
+// Prepare a read or write, using the registered file and buffer when there are any. The sqe
+// is only submitted by the next IOUringContext::submit() of this thread, so all the I/O issued
+// during one pass of the event loop goes to the kernel in a single system call.
+static void
+io_uring_prep_aio(IOUringContext *ur, io_uring_sqe *sqe, AIOCallbackInternal *op, bool write)
+{
+  ink_aiocb &cb = op->aiocb;
+  int file      = ur->fixed_file(cb.aio_fildes);
+  int buf       = ur->fixed_buffer(cb.aio_buf, cb.aio_nbytes);
+  int fd        = file >= 0 ? file : cb.aio_fildes;
+
+  if (buf >= 0) {
+    if (write) {
+      io_uring_prep_write_fixed(sqe, fd, cb.aio_buf, cb.aio_nbytes, cb.aio_offset, buf);
+    } else {
+      io_uring_prep_read_fixed(sqe, fd, cb.aio_buf, cb.aio_nbytes, cb.aio_offset, buf);
+    }
+  } else if (write) {
+    io_uring_prep_write(sqe, fd, cb.aio_buf, cb.aio_nbytes, cb.aio_offset);
+  } else {
+    io_uring_prep_read(sqe, fd, cb.aio_buf, cb.aio_nbytes, cb.aio_offset);
+  }
+  if (file >= 0) {
+    sqe->flags |= IOSQE_FIXED_FILE;
+  }
+  if (file >= 0 || buf >= 0) {
+    io_uring_fixed_submissions++;
+  }
+}
 #endif
 
 int
@@ -585,7 +620,7 @@ ink_aio_read(AIOCallback *op_in, int fromAPI)
     while (op) {
       op->this_op       = op;
       io_uring_sqe *sqe = ur->next_sqe(op);
-      io_uring_prep_read(sqe, op->aiocb.aio_fildes, op->aiocb.aio_buf, op->aiocb.aio_nbytes, op->aiocb.aio_offset);
+      io_uring_prep_aio(ur, sqe, op, false);
       op->aiocb.aio_lio_opcode = LIO_READ;
       if (op->then) {
         sqe->flags |= IOSQE_IO_LINK;
@@ -614,7 +649,7 @@ ink_aio_write(AIOCallback *op_in, int fromAPI)
     while (op) {
       op->this_op       = op;
       io_uring_sqe *sqe = ur->next_sqe(op);
-      io_uring_prep_write(sqe, op->aiocb.aio_fildes, op->aiocb.aio_buf, op->aiocb.aio_nbytes, op->aiocb.aio_offset);
+      io_uring_prep_aio(ur, sqe, op, true);
       op->aiocb.aio_lio_opcode = LIO_WRITE;
       if (op->then) {
         sqe->flags |= IOSQE_IO_LINK;
@@ -634,6 +669,46 @@ ink_aio_write(AIOCallback *op_in, int fromAPI)
 }
 #endif
 
+void
+ink_aio_register_fd(int fd)
+{
+#if AIO_MODE == AIO_MODE_DEFAULT && TS_USE_LINUX_IO_URING
+  if (use_io_uring) {
+    IOUringContext::add_fixed_file(fd);
+  }
+#endif
+}
+
+void
+ink_aio_register_buffer(void *buf, size_t len)
+{
+#if AIO_MODE == AIO_MODE_DEFAULT && TS_USE_LINUX_IO_URING
+  if (use_io_uring) {
+    IOUringContext::add_fixed_buffer(buf, len);
+  }
+#endif
+}
+
+void
+ink_aio_unregister_fd(int fd)
+{
+#if AIO_MODE == AIO_MODE_DEFAULT && TS_USE_LINUX_IO_URING
+  if (use_io_uring) {
+    IOUringContext::remove_fixed_file(fd);
+  }
+#endif
+}
+
+void
+ink_aio_unregister_buffer(void *buf)
+{
+#if AIO_MODE == AIO_MODE_DEFAULT && TS_USE_LINUX_IO_URING
+  if (use_io_uring) {
+    IOUringContext::remove_fixed_buffer(buf);
+  }
+#endif
+}
+
 #if AIO_MODE == AIO_MODE_NATIVE
 int
 DiskHandler::startAIOEvent(int /* event ATS_UNUSED */, Event *e)
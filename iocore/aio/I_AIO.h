@@ -151,4 +151,11 @@ void ink_aio_set_callback(Continuation *error_callback);
 int ink_aio_read(AIOCallback *op,
                  int fromAPI = 0); // fromAPI is a boolean to indicate if this is from an API call such as upload proxy feature
 int ink_aio_write(AIOCallback *op, int fromAPI = 0);
+// Hint that @a fd / the buffer is used for I/O for a long time, so the io_uring backend can
+// register it with each ring. It must be unregistered before it is closed or freed. A no-op for
+// the other backends.
+void ink_aio_register_fd(int fd);
+void ink_aio_register_buffer(void *buf, size_t len);
+void ink_aio_unregister_fd(int fd);
+void ink_aio_unregister_buffer(void *buf);
 AIOCallback *new_AIOCallback();
@@ -165,6 +165,7 @@ enum aio_stat_enum {
 #if TS_USE_LINUX_IO_URING
   AIO_STAT_IO_URING_SUBMITTED,
   AIO_STAT_IO_URING_COMPLETED,
+  AIO_STAT_IO_URING_FIXED_SUBMITTED,
 #endif
   AIO_STAT_COUNT
 };
@@ -47,8 +47,9 @@ constexpr ts::VersionNumber CACHE_DB_VERSION(CACHE_DB_MAJOR_VERSION, CACHE_DB_MI
 
 static size_t DEFAULT_RAM_CACHE_MULTIPLIER = 10; // I.e. 10x 1MB per 1GB of disk.
 
-// This is the oldest version number that is still usable.
-static short int const CACHE_DB_MAJOR_VERSION_COMPATIBLE = 21;
+// Stripes of this version up to CACHE_STRIPE_MAJOR_VERSION are usable. The directory
+// layout changed with the stripe version 25, older stripes are cleared.
+static short int const CACHE_STRIPE_MAJOR_VERSION_COMPATIBLE = 25;
 
 #define DOCACHE_CLEAR_DYN_STAT(x)  \
   do {                             \
@@ -62,10 +63,16 @@ int64_t cache_config_ram_cache_size            = AUTO_SIZE_RAM_CACHE;
 int cache_config_ram_cache_algorithm           = 1;
 int cache_config_ram_cache_compress            = 0;
 int cache_config_ram_cache_compress_percent    = 90;
+int cache_config_ram_cache_compress_threads    = 0;
 int cache_config_ram_cache_use_seen_filter     = 1;
 int cache_config_http_max_alts                 = 3;
 int cache_config_log_alternate_eviction        = 0;
 int cache_config_dir_sync_frequency            = 60;
+int cache_config_dir_tag_index                 = 0;
+int cache_config_dir_load_parallel             = 0;
+int cache_config_dir_sync_incremental          = 0;
+int cache_config_tier_promote_hits             = 2;
+int cache_config_tier_promote_max_inflight     = 16;
 int cache_config_permit_pinning                = 0;
 int cache_config_select_alternate              = 1;
 int cache_config_max_doc_size                  = 0;
@@ -77,6 +84,7 @@ int cache_config_hit_evacuate_size_limit       = 0;
 int cache_config_force_sector_size             = 0;
 int cache_config_target_fragment_size          = DEFAULT_TARGET_FRAGMENT_SIZE;
 int cache_config_agg_write_backlog             = AGG_SIZE * 2;
+int cache_config_agg_write_buffers             = 1;
 int cache_config_enable_checksum               = 0;
 int cache_config_alt_rewrite_max_size          = 4096;
 int cache_config_read_while_writer             = 0;
@@ -136,6 +144,10 @@ struct VolInitInfo {
   off_t recover_pos;
   AIOCallbackInternal vol_aio[4];
   char *vol_h_f;
+  AIOCallbackInternal *dir_aio = nullptr; // directory read in parallel chunks
+  int dir_aio_count            = 0;
+  int dir_aio_pending          = 0;
+  bool dir_aio_failed          = false;
 
   VolInitInfo()
   {
@@ -150,6 +162,11 @@ struct VolInitInfo {
       i.action = nullptr;
       i.mutex.clear();
     }
+    for (int i = 0; i < dir_aio_count; i++) {
+      dir_aio[i].action = nullptr;
+      dir_aio[i].mutex.clear();
+    }
+    delete[] dir_aio;
     free(vol_h_f);
   }
 };
@@ -575,8 +592,9 @@ Vol::close_read(CacheVC *cont) const
 // Cache Processor
 
 int
-CacheProcessor::start(int, size_t)
+CacheProcessor::start(int, size_t stacksize)
 {
+  ram_cache_compress_start(stacksize);
   return start_internal(0);
 }
 
@@ -948,6 +966,9 @@ CacheProcessor::cacheInitialized()
         case RAM_CACHE_ALGORITHM_LRU:
           gvol[i]->ram_cache = new_RamCacheLRU();
           break;
+        case RAM_CACHE_ALGORITHM_S3FIFO:
+          gvol[i]->ram_cache = new_RamCacheS3FIFO();
+          break;
         }
       }
       // let us calculate the Size
@@ -1044,6 +1065,16 @@ CacheProcessor::cacheInitialized()
       case CACHE_COMPRESSION_LIBLZMA:
 #ifndef HAVE_LZMA_H
         Fatal("lzma not available for RAM cache compression");
+#endif
+        break;
+      case CACHE_COMPRESSION_LZ4:
+#ifndef HAVE_LZ4_H
+        Fatal("lz4 not available for RAM cache compression");
+#endif
+        break;
+      case CACHE_COMPRESSION_ZSTD:
+#ifndef HAVE_ZSTD_H
+        Fatal("zstd not available for RAM cache compression");
 #endif
         break;
       }
@@ -1177,6 +1208,9 @@ vol_init_dir(Vol *vol)
 {
   int b, s, l;
 
+  if (vol->dir_tags) {
+    memset(vol->dir_tags, 0, sizeof(uint16_t) * DIR_TAG_INDEX_LANES * vol->buckets * vol->segments);
+  }
   for (s = 0; s < vol->segments; s++) {
     vol->header->freelist[s] = 0;
     Dir *seg                 = vol->dir_segment(s);
@@ -1196,8 +1230,8 @@ vol_clear_init(Vol *vol)
   memset(vol->raw_dir, 0, dir_len);
   vol_init_dir(vol);
   vol->header->magic          = VOL_MAGIC;
-  vol->header->version._major = CACHE_DB_MAJOR_VERSION;
-  vol->header->version._minor = CACHE_DB_MINOR_VERSION;
+  vol->header->version._major = CACHE_STRIPE_MAJOR_VERSION;
+  vol->header->version._minor = CACHE_STRIPE_MINOR_VERSION;
   vol->scan_pos = vol->header->agg_pos = vol->header->write_pos = vol->start;
   vol->header->last_write_pos                                   = vol->header->write_pos;
   vol->header->phase                                            = 0;
@@ -1285,6 +1319,19 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   dir    = reinterpret_cast<Dir *>(raw_dir + this->headerlen());
   header = reinterpret_cast<VolHeaderFooter *>(raw_dir);
   footer = reinterpret_cast<VolHeaderFooter *>(raw_dir + this->dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
+  dir_tag_index_init(this);
+  dir_sync_segments_init(this);
+  agg_write_buffers = std::clamp(cache_config_agg_write_buffers, 1, AGG_WRITE_BUFFERS_MAX);
+  for (int i = 0; i < agg_write_buffers; i++) {
+    AggWriteBuffer &w = agg_writes[i];
+    w.vol             = this;
+    w.mutex           = mutex;
+    if (!w.buffer) {
+      w.buffer = static_cast<char *>(ats_memalign(ats_pagesize(), AGG_SIZE));
+      memset(w.buffer, 0, AGG_SIZE);
+    }
+    ink_aio_register_buffer(w.buffer, AGG_SIZE);
+  }
 
   if (clear) {
     Note("clearing cache directory '%s'", hash_text.get());
@@ -1366,13 +1413,13 @@ Vol::handle_dir_read(int event, void *data)
     }
   }
 
-  if (!(header->magic == VOL_MAGIC && footer->magic == VOL_MAGIC && CACHE_DB_MAJOR_VERSION_COMPATIBLE <= header->version._major &&
-        header->version._major <= CACHE_DB_MAJOR_VERSION)) {
+  if (!(header->magic == VOL_MAGIC && footer->magic == VOL_MAGIC &&
+        CACHE_STRIPE_MAJOR_VERSION_COMPATIBLE <= header->version._major && header->version._major <= CACHE_STRIPE_MAJOR_VERSION)) {
     Warning("bad footer in cache directory for '%s', clearing", hash_text.get());
-    Note("VOL_MAGIC %d\n header magic: %d\n footer_magic %d\n CACHE_DB_MAJOR_VERSION_COMPATIBLE %d\n major version %d\n"
-         "CACHE_DB_MAJOR_VERSION %d\n",
-         VOL_MAGIC, header->magic, footer->magic, CACHE_DB_MAJOR_VERSION_COMPATIBLE, header->version._major,
-         CACHE_DB_MAJOR_VERSION);
+    Note("VOL_MAGIC %d\n header magic: %d\n footer_magic %d\n CACHE_STRIPE_MAJOR_VERSION_COMPATIBLE %d\n major version %d\n"
+         "CACHE_STRIPE_MAJOR_VERSION %d\n",
+         VOL_MAGIC, header->magic, footer->magic, CACHE_STRIPE_MAJOR_VERSION_COMPATIBLE, header->version._major,
+         CACHE_STRIPE_MAJOR_VERSION);
     Note("clearing cache directory '%s'", hash_text.get());
     clear_dir();
     return EVENT_DONE;
@@ -1621,7 +1668,9 @@ Ldone : {
     return handle_recover_write_dir(EVENT_IMMEDIATE, nullptr);
   }
 
-  recover_pos += EVACUATION_SIZE; // safely cover the max write size
+  // safely cover the max write size, and the aggregation writes which may
+  // have reached the disk past a write which did not
+  recover_pos += EVACUATION_SIZE + (agg_write_buffers - 1) * AGG_SIZE;
   if (recover_pos < header->write_pos && (recover_pos + EVACUATION_SIZE >= header->write_pos)) {
     Dbg(dbg_ctl_cache_init, "Head Pos: %" PRIu64 ", Rec Pos: %" PRIu64 ", Wrapped:%d", header->write_pos, recover_pos,
         recover_wrapped);
@@ -1740,7 +1789,7 @@ Vol::handle_header_read(int event, void *data)
         Note("using directory A for '%s'", hash_text.get());
       }
       io.aiocb.aio_offset = skip;
-      ink_assert(ink_aio_read(&io));
+      read_dir();
     }
     // try B
     else if (hf[2]->sync_serial == hf[3]->sync_serial) {
@@ -1749,7 +1798,7 @@ Vol::handle_header_read(int event, void *data)
         Note("using directory B for '%s'", hash_text.get());
       }
       io.aiocb.aio_offset = skip + this->dirlen();
-      ink_assert(ink_aio_read(&io));
+      read_dir();
     } else {
       Note("no good directory, clearing '%s' since sync_serials on both A and B copies are invalid", hash_text.get());
       Note("Header A: %d\nFooter A: %d\n Header B: %d\n Footer B %d\n", hf[0]->sync_serial, hf[1]->sync_serial, hf[2]->sync_serial,
@@ -1765,6 +1814,57 @@ Vol::handle_header_read(int event, void *data)
   return EVENT_DONE;
 }
 
+// Read the directory described by io, in proxy.config.cache.dir.load_parallel concurrent
+// chunks if configured so that all the AIO threads of the disk (or io_uring) work on it.
+void
+Vol::read_dir()
+{
+  int n = std::min<int64_t>(cache_config_dir_load_parallel, io.aiocb.aio_nbytes / STORE_BLOCK_SIZE);
+  if (n <= 1) {
+    ink_assert(ink_aio_read(&io));
+    return;
+  }
+
+  size_t chunk = ROUND_TO_STORE_BLOCK((io.aiocb.aio_nbytes + n - 1) / n);
+  n            = (io.aiocb.aio_nbytes + chunk - 1) / chunk;
+
+  init_info->dir_aio         = new AIOCallbackInternal[n];
+  init_info->dir_aio_count   = n;
+  init_info->dir_aio_pending = n;
+  init_info->dir_aio_failed  = false;
+  SET_HANDLER(&Vol::handle_dir_read_chunk);
+  for (int i = 0; i < n; i++) {
+    AIOCallback *aio      = &init_info->dir_aio[i];
+    size_t pos            = i * chunk;
+    aio->aiocb.aio_fildes = fd;
+    aio->aiocb.aio_buf    = static_cast<char *>(io.aiocb.aio_buf) + pos;
+    aio->aiocb.aio_nbytes = std::min(chunk, io.aiocb.aio_nbytes - pos);
+    aio->aiocb.aio_offset = io.aiocb.aio_offset + pos;
+    aio->action           = this;
+    aio->thread           = AIO_CALLBACK_THREAD_ANY;
+    aio->then             = nullptr;
+    ink_assert(ink_aio_read(aio));
+  }
+}
+
+int
+Vol::handle_dir_read_chunk(int event, void *data)
+{
+  AIOCallback *op = static_cast<AIOCallback *>(data);
+
+  ink_assert(event == AIO_EVENT_DONE);
+  if (static_cast<size_t>(op->aio_result) != op->aiocb.aio_nbytes) {
+    init_info->dir_aio_failed = true;
+  }
+  if (--init_info->dir_aio_pending) {
+    return EVENT_CONT;
+  }
+
+  io.aio_result = init_info->dir_aio_failed ? -1 : static_cast<int64_t>(io.aiocb.aio_nbytes);
+  SET_HANDLER(&Vol::handle_dir_read);
+  return handle_dir_read(AIO_EVENT_DONE, &io);
+}
+
 int
 Vol::dir_init_done(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
 {
@@ -1772,6 +1872,7 @@ Vol::dir_init_done(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
     eventProcessor.schedule_in(this, HRTIME_MSECONDS(5), ET_CALL);
     return EVENT_CONT;
   } else {
+    dir_tag_index_rebuild(this);
     int vol_no = gnvol++;
     ink_assert(!gvol[vol_no]);
     gvol[vol_no] = this;
@@ -2054,6 +2155,7 @@ Cache::open_done()
   }
 
   ReplaceablePtr<CacheHostTable>::ScopedReader hosttable(&this->hosttable);
+  fast_tier = hosttable->fast_host_rec.num_cachevols > 0;
   if (hosttable->gen_host_rec.num_cachevols == 0) {
     ready = CACHE_INIT_FAILED;
   } else {
@@ -2170,6 +2272,29 @@ unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay)
   }
 }
 
+IOBufferData *
+cache_doc_copy(IOBufferData *data, bool headers_only)
+{
+  Doc *doc           = reinterpret_cast<Doc *>(data->data());
+  uint32_t len       = headers_only ? doc->prefix_len() : doc->len;
+  IOBufferData *copy = new_IOBufferData(iobuffer_size_to_index(len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  memcpy(copy->data(), doc, len);
+  return copy;
+}
+
+// The fragment in buf is shared with the ram cache, which keeps it marshalled.
+// Take a private copy to unmarshal the headers in place. A reader only copies
+// the headers and serves the body from the shared fragment.
+void
+CacheVC::unshare_doc()
+{
+  bool headers_only = vio.op == VIO::READ;
+  if (headers_only) {
+    data_buf = buf;
+  }
+  buf = cache_doc_copy(buf.get(), headers_only);
+}
+
 // [amc] I think this is where all disk reads from cache funnel through here.
 int
 CacheVC::handleReadDone(int event, Event *e)
@@ -2273,9 +2398,14 @@ CacheVC::handleReadDone(int event, Event *e)
            (doc_len && static_cast<int64_t>(doc_len) < cache_config_ram_cache_cutoff) || !cache_config_ram_cache_cutoff);
         if (cutoff_check && !f.doc_from_ram_cache) {
           uint64_t o = dir_offset(&dir);
-          vol->ram_cache->put(read_key, buf.get(), doc->len, http_copy_hdr, o);
+          vol->ram_cache->put(read_key, buf.get(), doc->len, false, o);
+          if (http_copy_hdr) {
+            unshare_doc();
+            doc = reinterpret_cast<Doc *>(buf->data());
+          }
         }
-        if (!doc_len) {
+        // a copy of the headers alone can not serve an update
+        if (!doc_len && !data_buf) {
           // keep a pointer to it. In case the state machine decides to
           // update this document, we don't have to read it back in memory
           // again
@@ -2301,6 +2431,7 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   cancel_trigger();
 
   f.doc_from_ram_cache = false;
+  data_buf             = nullptr;
 
   // check ram cache
   ink_assert(vol->mutex->thread_holding == this_ethread());
@@ -2318,11 +2449,11 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   }
   // see if its in the aggregation buffer
   if (dir_agg_buf_valid(vol, &dir)) {
-    int agg_offset = vol->vol_offset(&dir) - vol->header->write_pos;
-    buf            = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
-    ink_assert((agg_offset + io.aiocb.aio_nbytes) <= (unsigned)vol->agg_buf_pos);
+    off_t agg_offset = vol->vol_offset(&dir);
+    buf              = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+    ink_assert(static_cast<off_t>(agg_offset + io.aiocb.aio_nbytes) <= vol->agg_write_pos() + vol->agg_buf_pos);
     char *doc = buf->data();
-    char *agg = vol->agg_buffer + agg_offset;
+    char *agg = vol->agg_buffer_at(agg_offset);
     memcpy(doc, agg, io.aiocb.aio_nbytes);
     io.aio_result = io.aiocb.aio_nbytes;
     SET_HANDLER(&CacheVC::handleReadDone);
@@ -2348,6 +2479,10 @@ LramHit : {
   io.aio_result        = io.aiocb.aio_nbytes;
   Doc *doc             = reinterpret_cast<Doc *>(buf->data());
   if (cache_config_ram_cache_compress && doc->doc_type == CACHE_FRAG_TYPE_HTTP && doc->hlen) {
+    // a hit decompressed for this reader alone is a buffer of its own already
+    if (buf->refcount() > 1) {
+      unshare_doc();
+    }
     SET_HANDLER(&CacheVC::handleReadDone);
     return EVENT_RETURN;
   }
@@ -2368,6 +2503,7 @@ Cache::lookup(Continuation *cont, const CacheKey *key, CacheFragType type, const
   }
 
   Vol *vol          = key_to_vol(key, hostname, host_len);
+  Vol *tier_src     = cache_tier_read_vol(this, key, &vol);
   ProxyMutex *mutex = cont->mutex.get();
   CacheVC *c        = new_CacheVC(cont);
   SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
@@ -2378,6 +2514,7 @@ Cache::lookup(Continuation *cont, const CacheKey *key, CacheFragType type, const
   c->frag_type          = type;
   c->f.lookup           = 1;
   c->vol                = vol;
+  c->tier_src           = tier_src;
   c->last_collision     = nullptr;
 
   if (c->handleEvent(EVENT_INTERVAL, nullptr) == EVENT_CONT) {
@@ -2486,6 +2623,7 @@ Cache::remove(Continuation *cont, const CacheKey *key, CacheFragType type, const
 
   CACHE_TRY_LOCK(lock, cont->mutex, this_ethread());
   ink_assert(lock.is_locked());
+  cache_tier_invalidate(this, key);
   Vol *vol = key_to_vol(key, hostname, host_len);
   // coverity[var_decl]
   Dir result;
@@ -2566,6 +2704,7 @@ cplist_update()
       if (config_vol->number == cp->vol_number) {
         if (cp->scheme == config_vol->scheme) {
           cp->ramcache_enabled = config_vol->ramcache_enabled;
+          cp->fast_tier        = config_vol->fast_tier;
           config_vol->cachep   = cp;
         } else {
           /* delete this volume from all the disks */
@@ -2633,6 +2772,7 @@ cplist_update()
             memset(new_cp->disk_vols, 0, gndisks * sizeof(DiskVol *));
             new_cp->vol_number = config_vol->number;
             new_cp->scheme     = config_vol->scheme;
+            new_cp->fast_tier  = config_vol->fast_tier;
             config_vol->cachep = new_cp;
             fillExclusiveDisks(config_vol->cachep);
             cp_list.enqueue(new_cp);
@@ -2842,6 +2982,7 @@ cplist_reconfigure()
         // we did not find a corresponding entry in cache vol...create one
 
         CacheVol *new_cp  = new CacheVol();
+        new_cp->fast_tier = config_vol->fast_tier;
         new_cp->disk_vols = static_cast<DiskVol **>(ats_malloc(gndisks * sizeof(DiskVol *)));
         memset(new_cp->disk_vols, 0, gndisks * sizeof(DiskVol *));
         if (create_volume(config_vol->number, size_in_blocks, config_vol->scheme, new_cp)) {
@@ -3016,6 +3157,9 @@ rebuild_host_table(Cache *cache)
 {
   ReplaceablePtr<CacheHostTable>::ScopedWriter hosttable(&cache->hosttable);
   build_vol_hash_table(&hosttable->gen_host_rec);
+  if (hosttable->fast_host_rec.num_vols) {
+    build_vol_hash_table(&hosttable->fast_host_rec);
+  }
   if (hosttable->m_numEntries != 0) {
     CacheHostMatcher *hm   = hosttable->getHostMatcher();
     CacheHostRecord *h_rec = hm->getDataArray();
@@ -3033,7 +3177,7 @@ Cache::key_to_vol(const CacheKey *key, const char *hostname, int host_len)
 {
   ReplaceablePtr<CacheHostTable>::ScopedReader hosttable(&this->hosttable);
 
-  uint32_t h                      = (key->slice32(2) >> DIR_TAG_WIDTH) % VOL_HASH_TABLE_SIZE;
+  uint32_t h                      = (key->slice32(2) >> DIR_TAG_KEY2_WIDTH) % VOL_HASH_TABLE_SIZE;
   unsigned short *hash_table      = hosttable->gen_host_rec.vol_hash_table;
   const CacheHostRecord *host_rec = &hosttable->gen_host_rec;
 
@@ -3064,6 +3208,23 @@ Cache::key_to_vol(const CacheKey *key, const char *hostname, int host_len)
   }
 }
 
+// the stripe of the fast tier which holds the promoted copy of key, if there is a fast tier
+Vol *
+Cache::key_to_fast_vol(const CacheKey *key)
+{
+  if (!fast_tier) {
+    return nullptr;
+  }
+  ReplaceablePtr<CacheHostTable>::ScopedReader hosttable(&this->hosttable);
+
+  const CacheHostRecord *host_rec = &hosttable->fast_host_rec;
+  if (!host_rec->vol_hash_table) {
+    return nullptr;
+  }
+  uint32_t h = (key->slice32(2) >> DIR_TAG_KEY2_WIDTH) % VOL_HASH_TABLE_SIZE;
+  return host_rec->vols[host_rec->vol_hash_table[h]];
+}
+
 static void
 reg_int(const char *str, int stat, RecRawStatBlock *rsb, const char *prefix, RecRawStatSyncCb sync_cb = RecRawStatSyncSum)
 {
@@ -3131,6 +3292,32 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("sync.count", cache_directory_sync_count_stat);
   REG_INT("sync.bytes", cache_directory_sync_bytes_stat);
   REG_INT("sync.time", cache_directory_sync_time_stat);
+  REG_INT("ram_cache.fastlz.bytes_in", cache_ram_cache_fastlz_bytes_in_stat);
+  REG_INT("ram_cache.fastlz.bytes_out", cache_ram_cache_fastlz_bytes_out_stat);
+  REG_INT("ram_cache.fastlz.compress_time", cache_ram_cache_fastlz_compress_time_stat);
+  REG_INT("ram_cache.fastlz.decompress_time", cache_ram_cache_fastlz_decompress_time_stat);
+  REG_INT("ram_cache.libz.bytes_in", cache_ram_cache_libz_bytes_in_stat);
+  REG_INT("ram_cache.libz.bytes_out", cache_ram_cache_libz_bytes_out_stat);
+  REG_INT("ram_cache.libz.compress_time", cache_ram_cache_libz_compress_time_stat);
+  REG_INT("ram_cache.libz.decompress_time", cache_ram_cache_libz_decompress_time_stat);
+  REG_INT("ram_cache.liblzma.bytes_in", cache_ram_cache_liblzma_bytes_in_stat);
+  REG_INT("ram_cache.liblzma.bytes_out", cache_ram_cache_liblzma_bytes_out_stat);
+  REG_INT("ram_cache.liblzma.compress_time", cache_ram_cache_liblzma_compress_time_stat);
+  REG_INT("ram_cache.liblzma.decompress_time", cache_ram_cache_liblzma_decompress_time_stat);
+  REG_INT("ram_cache.lz4.bytes_in", cache_ram_cache_lz4_bytes_in_stat);
+  REG_INT("ram_cache.lz4.bytes_out", cache_ram_cache_lz4_bytes_out_stat);
+  REG_INT("ram_cache.lz4.compress_time", cache_ram_cache_lz4_compress_time_stat);
+  REG_INT("ram_cache.lz4.decompress_time", cache_ram_cache_lz4_decompress_time_stat);
+  REG_INT("ram_cache.zstd.bytes_in", cache_ram_cache_zstd_bytes_in_stat);
+  REG_INT("ram_cache.zstd.bytes_out", cache_ram_cache_zstd_bytes_out_stat);
+  REG_INT("ram_cache.zstd.compress_time", cache_ram_cache_zstd_compress_time_stat);
+  REG_INT("ram_cache.zstd.decompress_time", cache_ram_cache_zstd_decompress_time_stat);
+  REG_INT("tier.fast.hits", cache_tier_fast_hit_stat);
+  REG_INT("tier.capacity.hits", cache_tier_capacity_hit_stat);
+  REG_INT("tier.promote.active", cache_tier_promote_active_stat);
+  REG_INT("tier.promote.success", cache_tier_promote_success_stat);
+  REG_INT("tier.promote.failure", cache_tier_promote_failure_stat);
+  REG_INT("tier.demote", cache_tier_demote_stat);
   REG_INT("span.errors.read", cache_span_errors_read_stat);
   REG_INT("span.errors.write", cache_span_errors_write_stat);
   REG_INT("span.failing", cache_span_failing_stat);
@@ -3164,6 +3351,8 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_algorithm, "proxy.config.cache.ram_cache.algorithm");
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress, "proxy.config.cache.ram_cache.compress");
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress_percent, "proxy.config.cache.ram_cache.compress_percent");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress_threads, "proxy.config.cache.ram_cache.compress_threads");
+  Dbg(dbg_ctl_cache_init, "proxy.config.cache.ram_cache.compress_threads = %d", cache_config_ram_cache_compress_threads);
   REC_ReadConfigInt32(cache_config_ram_cache_use_seen_filter, "proxy.config.cache.ram_cache.use_seen_filter");
 
   REC_EstablishStaticConfigInt32(cache_config_http_max_alts, "proxy.config.cache.limits.http.max_alts");
@@ -3182,6 +3371,21 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_dir_sync_frequency, "proxy.config.cache.dir.sync_frequency");
   Dbg(dbg_ctl_cache_init, "proxy.config.cache.dir.sync_frequency = %d", cache_config_dir_sync_frequency);
 
+  REC_EstablishStaticConfigInt32(cache_config_dir_tag_index, "proxy.config.cache.dir.tag_index");
+  Dbg(dbg_ctl_cache_init, "proxy.config.cache.dir.tag_index = %d", cache_config_dir_tag_index);
+
+  REC_EstablishStaticConfigInt32(cache_config_dir_load_parallel, "proxy.config.cache.dir.load_parallel");
+  Dbg(dbg_ctl_cache_init, "proxy.config.cache.dir.load_parallel = %d", cache_config_dir_load_parallel);
+
+  REC_EstablishStaticConfigInt32(cache_config_dir_sync_incremental, "proxy.config.cache.dir.sync_incremental");
+  Dbg(dbg_ctl_cache_init, "proxy.config.cache.dir.sync_incremental = %d", cache_config_dir_sync_incremental);
+
+  REC_EstablishStaticConfigInt32(cache_config_tier_promote_hits, "proxy.config.cache.tier.promote_hits");
+  Dbg(dbg_ctl_cache_init, "proxy.config.cache.tier.promote_hits = %d", cache_config_tier_promote_hits);
+
+  REC_EstablishStaticConfigInt32(cache_config_tier_promote_max_inflight, "proxy.config.cache.tier.promote_max_inflight");
+  Dbg(dbg_ctl_cache_init, "proxy.config.cache.tier.promote_max_inflight = %d", cache_config_tier_promote_max_inflight);
+
   REC_EstablishStaticConfigInt32(cache_config_select_alternate, "proxy.config.cache.select_alternate");
   Dbg(dbg_ctl_cache_init, "proxy.config.cache.select_alternate = %d", cache_config_select_alternate);
 
@@ -3220,6 +3424,9 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_agg_write_backlog, "proxy.config.cache.agg_write_backlog");
   Dbg(dbg_ctl_cache_init, "proxy.config.cache.agg_write_backlog = %d", cache_config_agg_write_backlog);
 
+  REC_EstablishStaticConfigInt32(cache_config_agg_write_buffers, "proxy.config.cache.agg_write_buffers");
+  Dbg(dbg_ctl_cache_init, "proxy.config.cache.agg_write_buffers = %d", cache_config_agg_write_buffers);
+
   REC_EstablishStaticConfigInt32(cache_config_enable_checksum, "proxy.config.cache.enable_checksum");
   Dbg(dbg_ctl_cache_init, "proxy.config.cache.enable_checksum = %d", cache_config_enable_checksum);
 
@@ -78,9 +78,40 @@ ClassAllocator<OpenDirEntry> openDirEntryAllocator("openDirEntry");
 
 // OpenDir
 
-OpenDir::OpenDir()
+namespace
+{
+inline int
+open_dir_bucket(const CryptoHash *key)
 {
-  SET_HANDLER(&OpenDir::signal_readers);
+  return key->slice32(0) % OPEN_DIR_BUCKETS;
+}
+
+} // end anonymous namespace
+
+// Wake the readers of key waiting in bucket b. A reader whose mutex is taken
+// is running and stays on the list, its retry timer brings it back anyway.
+// Nothing of a reader is touched before its mutex is taken.
+void
+OpenDir::wake_readers(int b, const CryptoHash &key)
+{
+  EThread *t = this_ethread();
+  CacheVC *c, *next;
+  std::lock_guard<std::mutex> guard(stripe[b % OPEN_DIR_STRIPES]);
+  for (c = waiting[b].head; c; c = next) {
+    next = c->opendir_link.next;
+    if (!(c->first_key == key)) {
+      continue;
+    }
+    CACHE_TRY_LOCK(lock, c->mutex, t);
+    if (!lock.is_locked()) {
+      continue;
+    }
+    waiting[b].remove(c);
+    c->f.waiting_for_writer = 0;
+    c->cancel_trigger();
+    EThread *ct = c->getThreadAffinity();
+    c->trigger  = (ct ? ct : t)->schedule_imm(c, EVENT_INTERVAL);
+  }
 }
 
 /*
@@ -94,8 +125,7 @@ int
 OpenDir::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
 {
   ink_assert(cont->vol->mutex->thread_holding == this_ethread());
-  unsigned int h = cont->first_key.slice32(0);
-  int b          = h % OPEN_DIR_BUCKETS;
+  int b = open_dir_bucket(&cont->first_key);
   for (OpenDirEntry *d = bucket[b].head; d; d = d->link.next) {
     if (!(d->writers.head->first_key == cont->first_key)) {
       continue;
@@ -110,7 +140,6 @@ OpenDir::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
     return 0;
   }
   OpenDirEntry *od = THREAD_ALLOC(openDirEntryAllocator, cont->mutex->thread_holding);
-  od->readers.head = nullptr;
   od->writers.push(cont);
   od->num_writers           = 1;
   od->max_writers           = max_writers;
@@ -126,46 +155,20 @@ OpenDir::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
   return 1;
 }
 
-int
-OpenDir::signal_readers(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
-{
-  Queue<CacheVC, Link_CacheVC_opendir_link> newly_delayed_readers;
-  EThread *t = mutex->thread_holding;
-  CacheVC *c = nullptr;
-  while ((c = delayed_readers.dequeue())) {
-    CACHE_TRY_LOCK(lock, c->mutex, t);
-    if (lock.is_locked()) {
-      c->f.open_read_timeout = 0;
-      c->handleEvent(EVENT_IMMEDIATE, nullptr);
-      continue;
-    }
-    newly_delayed_readers.push(c);
-  }
-  if (newly_delayed_readers.head) {
-    delayed_readers = newly_delayed_readers;
-    EThread *t1     = newly_delayed_readers.head->mutex->thread_holding;
-    if (!t1) {
-      t1 = mutex->thread_holding;
-    }
-    t1->schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
-  }
-  return 0;
-}
-
 int
 OpenDir::close_write(CacheVC *cont)
 {
   ink_assert(cont->vol->mutex->thread_holding == this_ethread());
-  cont->od->writers.remove(cont);
-  cont->od->num_writers--;
-  if (!cont->od->writers.head) {
-    unsigned int h = cont->first_key.slice32(0);
-    int b          = h % OPEN_DIR_BUCKETS;
-    bucket[b].remove(cont->od);
-    delayed_readers.append(cont->od->readers);
-    signal_readers(0, nullptr);
-    cont->od->vector.clear();
-    THREAD_FREE(cont->od, openDirEntryAllocator, cont->mutex->thread_holding);
+  OpenDirEntry *od = cont->od;
+  int b            = open_dir_bucket(&cont->first_key);
+  od->writers.remove(cont);
+  od->num_writers--;
+  // readers of this writer find out that it is gone
+  wake_readers(b, cont->first_key);
+  if (!od->writers.head) {
+    bucket[b].remove(od);
+    od->vector.clear();
+    THREAD_FREE(od, openDirEntryAllocator, cont->mutex->thread_holding);
   }
   cont->od = nullptr;
   return 0;
@@ -174,8 +177,7 @@ OpenDir::close_write(CacheVC *cont)
 OpenDirEntry *
 OpenDir::open_read(const CryptoHash *key) const
 {
-  unsigned int h = key->slice32(0);
-  int b          = h % OPEN_DIR_BUCKETS;
+  int b = open_dir_bucket(key);
   for (OpenDirEntry *d = bucket[b].head; d; d = d->link.next) {
     if (d->writers.head->first_key == *key) {
       return d;
@@ -185,16 +187,40 @@ OpenDir::open_read(const CryptoHash *key) const
 }
 
 int
-OpenDirEntry::wait(CacheVC *cont, int msec)
+OpenDir::wait(CacheVC *cont, ink_hrtime delay)
 {
-  ink_assert(cont->vol->mutex->thread_holding == this_ethread());
-  cont->f.open_read_timeout = 1;
-  ink_assert(!cont->trigger);
-  cont->trigger = cont->vol->mutex->thread_holding->schedule_in_local(cont, HRTIME_MSECONDS(msec));
-  readers.push(cont);
+  ink_assert(cont->mutex->thread_holding == this_ethread());
+  ink_assert(!cont->trigger && !cont->f.waiting_for_writer);
+  int b = open_dir_bucket(&cont->first_key);
+  std::lock_guard<std::mutex> guard(stripe[b % OPEN_DIR_STRIPES]);
+  cont->trigger = cont->mutex->thread_holding->schedule_in_local(cont, delay);
+  waiting[b].push(cont);
+  cont->f.waiting_for_writer = 1;
   return EVENT_CONT;
 }
 
+// Called with the mutex of the reader only, from cancel_trigger() and
+// free_CacheVC(). The stripe lock is never held across anything that blocks,
+// wake_readers() only tries the mutex of a reader while holding it.
+void
+OpenDir::cancel_wait(CacheVC *cont)
+{
+  ink_assert(cont->mutex->thread_holding == this_ethread());
+  int b = open_dir_bucket(&cont->first_key);
+  std::lock_guard<std::mutex> guard(stripe[b % OPEN_DIR_STRIPES]);
+  if (cont->f.waiting_for_writer) {
+    waiting[b].remove(cont);
+    cont->f.waiting_for_writer = 0;
+  }
+}
+
+void
+OpenDir::signal_readers(CacheVC *writer)
+{
+  ink_assert(writer->vol->mutex->thread_holding == this_ethread());
+  wake_readers(open_dir_bucket(&writer->first_key), writer->first_key);
+}
+
 //
 // Cache Directory
 //
@@ -238,7 +264,11 @@ dir_init_segment(int s, Vol *vol)
   vol->header->freelist[s] = 0;
   Dir *seg                 = vol->dir_segment(s);
   int l, b;
+  vol->dir_segment_dirty(s);
   memset(static_cast<void *>(seg), 0, SIZEOF_DIR * DIR_DEPTH * vol->buckets);
+  if (vol->dir_tags) {
+    memset(vol->dir_tag_index(s, 0), 0, sizeof(uint16_t) * DIR_TAG_INDEX_LANES * vol->buckets);
+  }
   for (l = 1; l < DIR_DEPTH; l++) {
     for (b = 0; b < vol->buckets; b++) {
       Dir *bucket = dir_bucket(b, seg);
@@ -341,6 +371,7 @@ dir_delete_entry(Dir *e, Dir *p, int s, Vol *vol)
   Dir *seg           = vol->dir_segment(s);
   int no             = dir_next(e);
   vol->header->dirty = 1;
+  vol->dir_segment_dirty(s);
   if (p) {
     unsigned int fo = vol->header->freelist[s];
     unsigned int eo = dir_to_offset(e, seg);
@@ -388,6 +419,10 @@ dir_clean_bucket(Dir *b, int s, Vol *vol)
       }
       if (dir_offset(e)) {
         CACHE_DEC_DIR_USED(vol->mutex);
+        // the fast tier copy of an object was overwritten
+        if (dir_head(e) && vol->cache_vol->fast_tier) {
+          CACHE_SUM_DYN_STAT_THREAD(cache_tier_demote_stat, 1);
+        }
       }
       e = dir_delete_entry(e, p, s, vol);
       continue;
@@ -404,6 +439,9 @@ dir_clean_segment(int s, Vol *vol)
   for (int64_t i = 0; i < vol->buckets; i++) {
     dir_clean_bucket(dir_bucket(i, seg), s, vol);
     ink_assert(!dir_next(dir_bucket(i, seg)) || dir_offset(dir_bucket(i, seg)));
+    if (vol->dir_tags) {
+      dir_tag_index_rebuild_bucket(dir_bucket(i, seg), seg, vol->dir_tag_index(s, i));
+    }
   }
 }
 
@@ -540,6 +578,143 @@ dir_segment_accounted(int s, Vol *vol, int offby, int *f, int *u, int *et, int *
   return vol->buckets * DIR_DEPTH - (free + used + empty) <= offby;
 }
 
+// Tag index
+//
+// An optional, memory only summary of the directory which keeps the tags of each
+// bucket chain in DIR_TAG_INDEX_LANES 16 bit lanes so that dir_probe can reject a
+// miss with one vector compare instead of chasing the chain. Every entry in a chain
+// has its tag in a lane unless the bucket has overflowed. dir_insert and dir_overwrite
+// add the tag of the entry they fill, whoever unlinks an entry recomputes the lanes of
+// its bucket from the chain, which it has just walked anyway. The on disk directory
+// format is unchanged, the index is rebuilt from the directory whenever it is loaded
+// or cleaned.
+
+void
+dir_tag_index_init(Vol *vol)
+{
+  ats_free(vol->dir_tags);
+  vol->dir_tags = nullptr;
+  if (!cache_config_dir_tag_index) {
+    return;
+  }
+  size_t len    = sizeof(uint16_t) * DIR_TAG_INDEX_LANES * vol->buckets * vol->segments;
+  vol->dir_tags = static_cast<uint16_t *>(ats_memalign(ats_pagesize(), len));
+  memset(vol->dir_tags, 0, len);
+}
+
+void
+dir_tag_index_rebuild_bucket(Dir *b, Dir *seg, uint16_t *lanes)
+{
+  memset(lanes, 0, sizeof(uint16_t) * DIR_TAG_INDEX_LANES);
+  Dir *e = b;
+  for (int i = 0; e; i++) {
+    if (i >= MAX_ENTRIES_PER_SEGMENT) { // looped chain, never filter it
+      lanes[DIR_TAG_INDEX_LANES - 1] = DIR_TAG_INDEX_OVERFLOW;
+      return;
+    }
+    if (dir_offset(e)) {
+      dir_tag_index_add(lanes, dir_tag(e));
+    }
+    e = next_dir(e, seg);
+  }
+}
+
+void
+dir_tag_index_rebuild(Vol *vol)
+{
+  if (!vol->dir_tags) {
+    return;
+  }
+  for (int s = 0; s < vol->segments; s++) {
+    Dir *seg = vol->dir_segment(s);
+    for (int64_t b = 0; b < vol->buckets; b++) {
+      dir_tag_index_rebuild_bucket(dir_bucket(b, seg), seg, vol->dir_tag_index(s, b));
+    }
+  }
+}
+
+// Incremental directory sync. The two copies of the directory on disk are written in
+// turn, so each segment carries a dirty bit per copy, set by every change to the
+// segment and cleared when the sync of that copy takes its snapshot. The segments in
+// the snapshot are marked DIR_SYNC_WRITING, only the store blocks overlapping them are
+// written. The header, freelist and footer are always written.
+
+void
+dir_sync_segments_init(Vol *vol)
+{
+  ats_free(vol->dir_sync_segs);
+  vol->dir_sync_segs = nullptr;
+  if (!cache_config_dir_sync_incremental) {
+    return;
+  }
+  // the copy which was not loaded can be arbitrarily old
+  vol->dir_sync_segs = static_cast<uint8_t *>(ats_malloc(vol->segments));
+  memset(vol->dir_sync_segs, DIR_SYNC_DIRTY(0) | DIR_SYNC_DIRTY(1), vol->segments);
+}
+
+void
+dir_sync_segments_start(Vol *vol, int copy)
+{
+  for (int s = 0; s < vol->segments; s++) {
+    if (vol->dir_sync_segs[s] & DIR_SYNC_DIRTY(copy)) {
+      vol->dir_sync_segs[s] = (vol->dir_sync_segs[s] & ~DIR_SYNC_DIRTY(copy)) | DIR_SYNC_WRITING;
+    }
+  }
+}
+
+void
+dir_sync_segments_done(Vol *vol, bool written)
+{
+  for (int s = 0; s < vol->segments; s++) {
+    if (vol->dir_sync_segs[s] & DIR_SYNC_WRITING) {
+      vol->dir_sync_segs[s] &= ~DIR_SYNC_WRITING;
+      if (!written) {
+        vol->dir_sync_segs[s] |= DIR_SYNC_DIRTY(0) | DIR_SYNC_DIRTY(1);
+      }
+    }
+  }
+}
+
+// does the store block at pos (relative to the start of the directory) have to be written
+static bool
+dir_sync_block_dirty(Vol *vol, off_t pos)
+{
+  off_t dir_start = vol->headerlen();
+  if (pos < dir_start) {
+    return true;
+  }
+  off_t seglen = vol->buckets * DIR_DEPTH * SIZEOF_DIR;
+  off_t first  = (pos - dir_start) / seglen;
+  off_t last   = std::min<off_t>((pos + STORE_BLOCK_SIZE - 1 - dir_start) / seglen, vol->segments - 1);
+  for (off_t s = first; s <= last; s++) {
+    if (vol->dir_sync_segs[s] & DIR_SYNC_WRITING) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// first position at or after pos which has to be written, end if there is none
+off_t
+dir_sync_next_dirty(Vol *vol, off_t pos, off_t end)
+{
+  while (pos < end && !dir_sync_block_dirty(vol, pos)) {
+    pos += STORE_BLOCK_SIZE;
+  }
+  return std::min(pos, end);
+}
+
+// length of the run of blocks to write starting at pos, at most len
+int
+dir_sync_dirty_len(Vol *vol, off_t pos, int len)
+{
+  int l = 0;
+  while (l < len && dir_sync_block_dirty(vol, pos + l)) {
+    l += STORE_BLOCK_SIZE;
+  }
+  return std::min(l, len);
+}
+
 void
 dir_free_entry(Dir *e, int s, Vol *vol)
 {
@@ -551,6 +726,7 @@ dir_free_entry(Dir *e, int s, Vol *vol)
     dir_set_prev(dir_from_offset(fo, seg), eo);
   }
   vol->header->freelist[s] = eo;
+  vol->dir_segment_dirty(s);
 }
 
 int
@@ -566,6 +742,12 @@ dir_probe(const CacheKey *key, Vol *vol, Dir *result, Dir **last_collision)
   if (dir_bucket_loop_fix(dir_bucket(b, seg), s, vol))
     return 0;
 #endif
+  // A resumed probe has to walk the chain to find its last collision.
+  if (vol->dir_tags && !collision && !dir_tag_index_match(vol->dir_tag_index(s, b), dir_key_tag(key))) {
+    DDbg(dbg_ctl_dir_probe_miss, "tag index missed %X %X on vol %d bucket %d at %p", key->slice32(0), key->slice32(1), vol->fd, b,
+         seg);
+    return 0;
+  }
 Lagain:
   e = dir_bucket(b, seg);
   if (dir_offset(e)) {
@@ -598,10 +780,13 @@ Lagain:
         } else { // delete the invalid entry
           CACHE_DEC_DIR_USED(vol->mutex);
           e = dir_delete_entry(e, p, s, vol);
+          if (vol->dir_tags) {
+            dir_tag_index_rebuild_bucket(dir_bucket(b, seg), seg, vol->dir_tag_index(s, b));
+          }
           continue;
         }
       } else {
-        DDbg(dbg_ctl_dir_probe_tag, "tag mismatch %p %X vs expected %X", e, dir_tag(e), key->slice32(3));
+        DDbg(dbg_ctl_dir_probe_tag, "tag mismatch %p %X vs expected %X", e, dir_tag(e), dir_key_tag(key));
       }
     Lcont:
       p = e;
@@ -630,7 +815,7 @@ dir_insert(const CacheKey *key, Vol *vol, Dir *to_part)
   Dir *e   = nullptr;
   Dir *b   = dir_bucket(bi, seg);
 #if defined(DEBUG) && defined(DO_CHECK_DIR_FAST)
-  unsigned int t = DIR_MASK_TAG(key->slice32(2));
+  unsigned int t = dir_key_tag(key);
   Dir *col       = b;
   while (col) {
     ink_assert((dir_tag(col) != t) || (dir_offset(col) != dir_offset(to_part)));
@@ -675,12 +860,16 @@ Llink:
   dir_set_next(prev, dir_to_offset(e, seg));
 Lfill:
   dir_assign_data(e, to_part);
-  dir_set_tag(e, key->slice32(2));
+  dir_set_tag(e, dir_key_tag(key));
+  if (vol->dir_tags) {
+    dir_tag_index_add(vol->dir_tag_index(s, bi), dir_tag(e));
+  }
   ink_assert(vol->vol_offset(e) < (vol->skip + vol->len));
   DDbg(dbg_ctl_dir_insert, "insert %p %X into vol %d bucket %d at %p tag %X %X boffset %" PRId64 "", e, key->slice32(0), vol->fd,
        bi, e, key->slice32(1), dir_tag(e), dir_offset(e));
   CHECK_DIR(d);
   vol->header->dirty = 1;
+  vol->dir_segment_dirty(s);
   CACHE_INC_DIR_USED(vol->mutex);
   return 1;
 }
@@ -694,7 +883,7 @@ dir_overwrite(const CacheKey *key, Vol *vol, Dir *dir, Dir *overwrite, bool must
   Dir *seg       = vol->dir_segment(s);
   Dir *e         = nullptr;
   Dir *b         = dir_bucket(bi, seg);
-  unsigned int t = DIR_MASK_TAG(key->slice32(2));
+  unsigned int t = dir_key_tag(key);
   int res        = 1;
 #ifdef LOOP_CHECK_MODE
   int loop_count     = 0;
@@ -762,11 +951,15 @@ Llink:
 Lfill:
   dir_assign_data(e, dir);
   dir_set_tag(e, t);
+  if (vol->dir_tags) {
+    dir_tag_index_add(vol->dir_tag_index(s, bi), t);
+  }
   ink_assert(vol->vol_offset(e) < vol->skip + vol->len);
   DDbg(dbg_ctl_dir_overwrite, "overwrite %p %X into vol %d bucket %d at %p tag %X %X boffset %" PRId64 "", e, key->slice32(0),
        vol->fd, bi, e, t, dir_tag(e), dir_offset(e));
   CHECK_DIR(d);
   vol->header->dirty = 1;
+  vol->dir_segment_dirty(s);
   return res;
 }
 
@@ -796,6 +989,9 @@ dir_delete(const CacheKey *key, Vol *vol, Dir *del)
       if (dir_compare_tag(e, key) && dir_offset(e) == dir_offset(del)) {
         CACHE_DEC_DIR_USED(vol->mutex);
         dir_delete_entry(e, p, s, vol);
+        if (vol->dir_tags) {
+          dir_tag_index_rebuild_bucket(dir_bucket(b, seg), seg, vol->dir_tag_index(s, b));
+        }
         CHECK_DIR(d);
         return 1;
       }
@@ -1005,22 +1201,37 @@ sync_cache_dir_on_shutdown()
     // check if we have data in the agg buffer
     // dont worry about the cachevc s in the agg queue
     // directories have not been inserted for these writes
-    if (vol->agg_buf_pos) {
+    if (vol->agg_in_flight || vol->agg_buf_pos) {
       Dbg(dbg_ctl_cache_dir_sync, "Dir %s: flushing agg buffer first", vol->hash_text.get());
 
       // set write limit
-      vol->header->agg_pos = vol->header->write_pos + vol->agg_buf_pos;
-
-      int r = pwrite(vol->fd, vol->agg_buffer, vol->agg_buf_pos, vol->header->write_pos);
-      if (r != vol->agg_buf_pos) {
+      vol->header->agg_pos = vol->agg_write_pos() + vol->agg_buf_pos;
+
+      // the writes in flight in the order they were issued, then the buffer being filled
+      int i = 0;
+      for (; i <= vol->agg_in_flight; i++) {
+        AggWriteBuffer *w = &vol->agg_writes[(vol->agg_write_head + i) % vol->agg_write_buffers];
+        char *b           = i < vol->agg_in_flight ? w->buffer : vol->agg_buffer;
+        int n             = i < vol->agg_in_flight ? static_cast<int>(w->io.aiocb.aio_nbytes) : vol->agg_buf_pos;
+        if (!n) {
+          continue;
+        }
+        int r = pwrite(vol->fd, b, n, vol->header->write_pos);
+        if (r != n) {
+          break;
+        }
+        vol->header->last_write_pos  = vol->header->write_pos;
+        vol->header->write_pos      += n;
+        vol->header->write_serial++;
+      }
+      if (i <= vol->agg_in_flight) {
         ink_assert(!"flushing agg buffer failed");
         continue;
       }
-      vol->header->last_write_pos  = vol->header->write_pos;
-      vol->header->write_pos      += vol->agg_buf_pos;
       ink_assert(vol->header->write_pos == vol->header->agg_pos);
-      vol->agg_buf_pos = 0;
-      vol->header->write_serial++;
+      vol->agg_in_flight = 0;
+      vol->agg_pending   = 0;
+      vol->agg_buf_pos   = 0;
     }
 
     if (buflen < dirlen) {
@@ -1105,6 +1316,9 @@ Lrestart:
     // AIO Thread
     if (io.aio_result != static_cast<int64_t>(io.aiocb.aio_nbytes)) {
       Warning("vol write error during directory sync '%s'", gvol[vol_idx]->hash_text.get());
+      if (vol->dir_sync_segs) {
+        dir_sync_segments_done(vol, false);
+      }
       event = EVENT_NONE;
       goto Ldone;
     }
@@ -1145,10 +1359,10 @@ Lrestart:
         Dbg(dbg_ctl_cache_dir_sync, "Dir %s not dirty", vol->hash_text.get());
         goto Ldone;
       }
-      if (vol->is_io_in_progress() || vol->agg_buf_pos) {
+      if (vol->is_io_in_progress() || vol->agg_in_flight || vol->agg_buf_pos) {
         Dbg(dbg_ctl_cache_dir_sync, "Dir %s: waiting for agg buffer", vol->hash_text.get());
         vol->dir_sync_waiting = true;
-        if (!vol->is_io_in_progress()) {
+        if (!vol->is_io_in_progress() && !vol->agg_in_flight) {
           vol->aggWrite(EVENT_IMMEDIATE, nullptr);
         }
         return EVENT_CONT;
@@ -1176,32 +1390,47 @@ Lrestart:
       }
       vol->header->sync_serial++;
       vol->footer->sync_serial = vol->header->sync_serial;
+      if (vol->dir_sync_segs) {
+        dir_sync_segments_start(vol, vol->header->sync_serial & 1);
+      }
       CHECK_DIR(d);
       memcpy(buf, vol->raw_dir, dirlen);
       vol->dir_sync_in_progress = true;
     }
-    size_t B    = vol->header->sync_serial & 1;
-    off_t start = vol->skip + (B ? dirlen : 0);
+    size_t B       = vol->header->sync_serial & 1;
+    off_t start    = vol->skip + (B ? dirlen : 0);
+    off_t body_end = static_cast<off_t>(dirlen) - headerlen;
+
+    if (vol->dir_sync_segs && writepos && writepos < body_end) {
+      // skip the segments which have not changed since this copy was last written
+      writepos = dir_sync_next_dirty(vol, writepos, body_end);
+    }
 
     if (!writepos) {
       // write header
       aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
       writepos += headerlen;
-    } else if (writepos < static_cast<off_t>(dirlen) - headerlen) {
+    } else if (writepos < body_end) {
       // write part of body
       int l = SYNC_MAX_WRITE;
-      if (writepos + l > static_cast<off_t>(dirlen) - headerlen) {
-        l = dirlen - headerlen - writepos;
+      if (writepos + l > body_end) {
+        l = body_end - writepos;
+      }
+      if (vol->dir_sync_segs) {
+        l = dir_sync_dirty_len(vol, writepos, l);
       }
       aio_write(vol->fd, buf + writepos, l, start + writepos);
       writepos += l;
     } else if (writepos < static_cast<off_t>(dirlen)) {
-      ink_assert(writepos == (off_t)dirlen - headerlen);
+      ink_assert(writepos == body_end);
       // write footer
       aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
       writepos += headerlen;
     } else {
       vol->dir_sync_in_progress = false;
+      if (vol->dir_sync_segs) {
+        dir_sync_segments_done(vol, true);
+      }
       CACHE_INCREMENT_DYN_STAT(cache_directory_sync_count_stat);
       CACHE_SUM_DYN_STAT(cache_directory_sync_time_stat, Thread::get_hrtime() - start_time);
       start_time = 0;
@@ -1219,9 +1448,11 @@ Ldone:
 namespace
 {
 int
-compare_ushort(void const *a, void const *b)
+compare_tag(void const *a, void const *b)
 {
-  return *static_cast<unsigned short const *>(a) - *static_cast<unsigned short const *>(b);
+  uint32_t x = *static_cast<uint32_t const *>(a);
+  uint32_t y = *static_cast<uint32_t const *>(b);
+  return (x > y) - (x < y);
 }
 } // namespace
 
@@ -1234,7 +1465,7 @@ Vol::dir_check(bool /* fix ATS_UNUSED */) // TODO: we should eliminate this para
 {
   static int const SEGMENT_HISTOGRAM_WIDTH = 16;
   int hist[SEGMENT_HISTOGRAM_WIDTH + 1]    = {0};
-  unsigned short chain_tag[MAX_ENTRIES_PER_SEGMENT];
+  uint32_t chain_tag[MAX_ENTRIES_PER_SEGMENT];
   int32_t chain_mark[MAX_ENTRIES_PER_SEGMENT];
   uint64_t total_buckets = buckets * segments;
   uint64_t total_entries = total_buckets * DIR_DEPTH;
@@ -1311,8 +1542,8 @@ Vol::dir_check(bool /* fix ATS_UNUSED */) // TODO: we should eliminate this para
 
       // Check for duplicates (identical tags in the same bucket).
       if (h > 1) {
-        unsigned short last;
-        qsort(chain_tag, h, sizeof(chain_tag[0]), &compare_ushort);
+        uint32_t last;
+        qsort(chain_tag, h, sizeof(chain_tag[0]), &compare_tag);
         last = chain_tag[0];
         for (int k = 1; k < h; ++k) {
           if (last == chain_tag[k]) {
@@ -1543,6 +1774,88 @@ EXCLUSIVE_REGRESSION_TEST(Cache_dir)(RegressionTest *t, int /* atype ATS_UNUSED
     rprintf(t, "probe rate = %d / second\n", static_cast<int>((newfree * static_cast<uint64_t>(1000000)) / us));
   }
 
+  // compare probes walking the bucket chains against probes filtered by the tag index
+  int saved_tag_index = cache_config_dir_tag_index;
+  for (int tag_index = 0; tag_index < 2; tag_index++) {
+    cache_config_dir_tag_index = tag_index;
+    dir_tag_index_init(vol);
+    dir_tag_index_rebuild(vol);
+    const char *mode = tag_index ? "tag index" : "chain walk";
+
+    regress_rand_init(13);
+    ttime = Thread::get_hrtime_updated();
+    for (i = 0; i < newfree; i++) {
+      Dir *last_collision = nullptr;
+      regress_rand_CacheKey(&key);
+      if (!dir_probe(&key, vol, &dir, &last_collision)) {
+        ret = REGRESSION_TEST_FAILED;
+      }
+    }
+    us = (Thread::get_hrtime_updated() - ttime) / HRTIME_USECOND;
+    if (us) {
+      rprintf(t, "%s hit probe rate = %d / second\n", mode, static_cast<int>((newfree * static_cast<uint64_t>(1000000)) / us));
+    }
+
+    regress_rand_init(17);
+    ttime = Thread::get_hrtime_updated();
+    for (i = 0; i < newfree; i++) {
+      Dir *last_collision = nullptr;
+      regress_rand_CacheKey(&key);
+      dir_probe(&key, vol, &dir, &last_collision);
+    }
+    us = (Thread::get_hrtime_updated() - ttime) / HRTIME_USECOND;
+    if (us) {
+      rprintf(t, "%s miss probe rate = %d / second\n", mode, static_cast<int>((newfree * static_cast<uint64_t>(1000000)) / us));
+    }
+  }
+  // the lanes stay exact through deletes, without a rebuild by the probes
+  regress_rand_init(13);
+  for (i = 0; i < 100; i++) {
+    Dir *last_collision = nullptr;
+    regress_rand_CacheKey(&key);
+    int ks = key.slice32(0) % vol->segments;
+    int kb = key.slice32(1) % vol->buckets;
+    uint16_t lanes[DIR_TAG_INDEX_LANES];
+    if (dir_probe(&key, vol, &dir, &last_collision)) {
+      dir_delete(&key, vol, &dir);
+    }
+    dir_tag_index_rebuild_bucket(dir_bucket(kb, vol->dir_segment(ks)), vol->dir_segment(ks), lanes);
+    if (memcmp(lanes, vol->dir_tag_index(ks, kb), sizeof(lanes)) != 0) {
+      rprintf(t, "tag index of bucket %d is stale after a delete\n", kb);
+      ret = REGRESSION_TEST_FAILED;
+      break;
+    }
+  }
+  cache_config_dir_tag_index = saved_tag_index;
+  dir_tag_index_init(vol);
+  dir_tag_index_rebuild(vol);
+
+  // an incremental sync must cover a dirtied segment and skip the clean ones
+  {
+    int saved_sync_incremental        = cache_config_dir_sync_incremental;
+    cache_config_dir_sync_incremental = 1;
+    dir_sync_segments_init(vol);
+    dir_sync_segments_start(vol, 0);
+    dir_sync_segments_done(vol, true);
+    int ds = vol->segments - 1;
+    vol->dir_segment_dirty(ds);
+    dir_sync_segments_start(vol, 0);
+    off_t seg_pos  = vol->headerlen() + static_cast<off_t>(ds) * vol->buckets * DIR_DEPTH * SIZEOF_DIR;
+    off_t body_end = vol->dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+    off_t next     = dir_sync_next_dirty(vol, vol->headerlen(), body_end);
+    if (next > seg_pos || next + dir_sync_dirty_len(vol, next, SYNC_MAX_WRITE) < body_end) {
+      rprintf(t, "incremental sync missed dirty segment %d\n", ds);
+      ret = REGRESSION_TEST_FAILED;
+    }
+    if (ds > 0 && dir_sync_next_dirty(vol, vol->headerlen(), body_end) < seg_pos - STORE_BLOCK_SIZE) {
+      rprintf(t, "incremental sync wrote clean segments\n");
+      ret = REGRESSION_TEST_FAILED;
+    }
+    dir_sync_segments_done(vol, true);
+    cache_config_dir_sync_incremental = saved_sync_incremental;
+    dir_sync_segments_init(vol);
+  }
+
   for (int c = 0; c < vol->direntries() * 0.75; c++) {
     regress_rand_CacheKey(&key);
     dir_insert(&key, vol, &dir);
@@ -1630,3 +1943,58 @@ EXCLUSIVE_REGRESSION_TEST(Cache_dir)(RegressionTest *t, int /* atype ATS_UNUSED
   vol_dir_clear(vol);
   *status = ret;
 }
+
+REGRESSION_TEST(Cache_dir_layout)(RegressionTest *t, int /* atype ATS_UNUSED */, int *status)
+{
+  int ret = REGRESSION_TEST_PASSED;
+  Dir dir;
+
+  // every field at its maximum, then each one cleared, must not disturb the others
+  dir_set_offset(&dir, DIR_OFFSET_MAX);
+  dir_set_big(&dir, DIR_BLOCK_SIZES - 1);
+  dir_set_size(&dir, (1 << DIR_SIZE_WIDTH) - 1);
+  dir_set_tag(&dir, 0xFFFFFFFF);
+  dir_set_phase(&dir, 1);
+  dir_set_head(&dir, 1);
+  dir_set_pinned(&dir, 1);
+  dir_set_next(&dir, 0xFFFF);
+  dir_set_prev(&dir, 0xFFFF);
+  if (dir_offset(&dir) != DIR_OFFSET_MAX || dir_big(&dir) != DIR_BLOCK_SIZES - 1 || dir_size(&dir) != (1 << DIR_SIZE_WIDTH) - 1 ||
+      dir_tag(&dir) != 0xFFFFFFFF || !dir_phase(&dir) || !dir_head(&dir) || !dir_pinned(&dir) || dir_next(&dir) != 0xFFFF ||
+      dir_prev(&dir) != 0xFFFF) {
+    rprintf(t, "directory entry fields overlap\n");
+    ret = REGRESSION_TEST_FAILED;
+  }
+  dir_set_offset(&dir, 0);
+  dir_set_tag(&dir, 0);
+  dir_set_next(&dir, 0);
+  if (dir_big(&dir) != DIR_BLOCK_SIZES - 1 || dir_size(&dir) != (1 << DIR_SIZE_WIDTH) - 1 || !dir_phase(&dir) || !dir_head(&dir) ||
+      !dir_pinned(&dir) || dir_prev(&dir) != 0xFFFF) {
+    rprintf(t, "clearing a directory entry field changed another one\n");
+    ret = REGRESSION_TEST_FAILED;
+  }
+
+  // offsets past 40 bits, which the old layout could not hold
+  int64_t o = (static_cast<int64_t>(1) << 44) + 12345;
+  dir_set_offset(&dir, o);
+  if (dir_offset(&dir) != o) {
+    rprintf(t, "offset %" PRId64 " read back as %" PRId64 "\n", o, dir_offset(&dir));
+    ret = REGRESSION_TEST_FAILED;
+  }
+
+  // the tag must use the bits of the key which do not select the stripe, segment or bucket
+  CacheKey key;
+  key.u32[3]   = 0xABCDE;
+  uint32_t tag = dir_key_tag(&key);
+  key.u32[2]   = 0xFFFFF000; // stripe hash bits only
+  if (dir_key_tag(&key) != tag || tag != (0xABCDEu << DIR_TAG_KEY2_WIDTH)) {
+    rprintf(t, "tag %X depends on the stripe hash bits\n", tag);
+    ret = REGRESSION_TEST_FAILED;
+  }
+  dir_set_tag(&dir, tag);
+  if (!dir_compare_tag(&dir, &key)) {
+    ret = REGRESSION_TEST_FAILED;
+  }
+
+  *status = ret;
+}
@@ -64,6 +64,7 @@ CacheDisk::open(char *s, off_t blocks, off_t askip, int ahw_sector_size, int fil
   len                 = blocks;
   io.aiocb.aio_fildes = fd;
   io.action           = this;
+  ink_aio_register_fd(fd);
   // determine header size and hence start point by successive approximation
   uint64_t l;
   for (int i = 0; i < 3; i++) {
@@ -109,6 +110,9 @@ CacheDisk::open(char *s, off_t blocks, off_t askip, int ahw_sector_size, int fil
 
 CacheDisk::~CacheDisk()
 {
+  if (fd >= 0) {
+    ink_aio_unregister_fd(fd);
+  }
   if (path) {
     ats_free(path);
     for (int i = 0; i < static_cast<int>(header->num_volumes); i++) {
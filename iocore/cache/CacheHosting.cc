@@ -201,6 +201,8 @@ CacheHostTable::CacheHostTable(Cache *c, CacheType typ)
   ink_release_assert(config_path);
 
   m_numEntries = this->BuildTable(config_path);
+  // the fast tier is only reached through promotion, never by host
+  fast_host_rec.Init(type, true);
 }
 
 CacheHostTable::~CacheHostTable()
@@ -420,7 +422,7 @@ CacheHostTable::BuildTable(const char *config_file_path)
 }
 
 int
-CacheHostRecord::Init(CacheType typ)
+CacheHostRecord::Init(CacheType typ, bool fast_tier)
 {
   int i, j;
   extern Queue<CacheVol> cp_list;
@@ -433,7 +435,7 @@ CacheHostRecord::Init(CacheType typ)
   num_cachevols    = 0;
   CacheVol *cachep = cp_list.head;
   for (; cachep; cachep = cachep->link.next) {
-    if (cachep->scheme == type) {
+    if (cachep->scheme == type && cachep->fast_tier == fast_tier) {
       Dbg(dbg_ctl_cache_hosting, "Host Record: %p, Volume: %d, size: %" PRId64, this, cachep->vol_number, (int64_t)cachep->size);
       cp[num_cachevols] = cachep;
       num_cachevols++;
@@ -441,7 +443,9 @@ CacheHostRecord::Init(CacheType typ)
     }
   }
   if (!num_cachevols) {
-    Warning("error: No volumes found for Cache Type %d", type);
+    if (!fast_tier) {
+      Warning("error: No volumes found for Cache Type %d", type);
+    }
     return -1;
   }
   vols        = static_cast<Vol **>(ats_malloc(num_vols * sizeof(Vol *)));
@@ -524,6 +528,12 @@ CacheHostRecord::Init(matcher_line *line_info, CacheType typ)
           for (; cachep; cachep = cachep->link.next) {
             if (cachep->vol_number == volume_number) {
               is_vol_present = 1;
+              if (cachep->fast_tier) {
+                Warning("%s discarding %s entry at line %d : volume %d is a fast tier volume", "[CacheHosting]", config_file,
+                        line_info->line_num, volume_number);
+                ats_free(val);
+                return -1;
+              }
               if (cachep->scheme == type) {
                 Dbg(dbg_ctl_cache_hosting, "Host Record: %p, Volume: %d, size: %ld", this, volume_number,
                     (long)(cachep->size * STORE_BLOCK_SIZE));
@@ -657,6 +667,7 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
     int size              = 0;
     int in_percent        = 0;
     bool ramcache_enabled = true;
+    bool fast_tier        = false;
 
     while (true) {
       // skip all blank spaces at beginning of line
@@ -756,6 +767,18 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
           err = "Unexpected end of line";
           break;
         }
+      } else if (strcasecmp(tmp, "tier") == 0) { // match tier
+        tmp += 5;
+        if (!strcasecmp(tmp, "fast")) {
+          tmp       += 4;
+          fast_tier  = true;
+        } else if (!strcasecmp(tmp, "capacity")) {
+          tmp       += 8;
+          fast_tier  = false;
+        } else {
+          err = "Unexpected end of line";
+          break;
+        }
       }
 
       // ends here
@@ -781,6 +804,7 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       configp->size             = size;
       configp->cachep           = nullptr;
       configp->ramcache_enabled = ramcache_enabled;
+      configp->fast_tier        = fast_tier;
       cp_queue.enqueue(configp);
       num_volumes++;
       if (scheme == CACHE_HTTP_TYPE) {
@@ -788,8 +812,8 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       } else {
         ink_release_assert(!"Unexpected non-HTTP cache volume");
       }
-      Dbg(dbg_ctl_cache_hosting, "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d", volume_number, scheme, size,
-          in_percent, ramcache_enabled);
+      Dbg(dbg_ctl_cache_hosting, "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d, fast tier=%d", volume_number,
+          scheme, size, in_percent, ramcache_enabled, fast_tier);
     }
 
     tmp = bufTok.iterNext(&i_state);
@@ -49,7 +49,8 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
   }
   ink_assert(caches[type] == this);
 
-  Vol *vol = key_to_vol(key, hostname, host_len);
+  Vol *vol      = key_to_vol(key, hostname, host_len);
+  Vol *tier_src = cache_tier_read_vol(this, key, &vol);
   Dir result, *last_collision = nullptr;
   ProxyMutex *mutex = cont->mutex.get();
   OpenDirEntry *od  = nullptr;
@@ -64,6 +65,7 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
       CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
       c->first_key = c->key = c->earliest_key = *key;
       c->vol                                  = vol;
+      c->tier_src                             = tier_src;
       c->frag_type                            = type;
       c->od                                   = od;
     }
@@ -115,7 +117,8 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
   }
   ink_assert(caches[type] == this);
 
-  Vol *vol = key_to_vol(key, hostname, host_len);
+  Vol *vol      = key_to_vol(key, hostname, host_len);
+  Vol *tier_src = cache_tier_read_vol(this, key, &vol);
   Dir result, *last_collision = nullptr;
   ProxyMutex *mutex = cont->mutex.get();
   OpenDirEntry *od  = nullptr;
@@ -127,6 +130,7 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
       c            = new_CacheVC(cont);
       c->first_key = c->key = c->earliest_key = *key;
       c->vol                                  = vol;
+      c->tier_src                             = tier_src;
       c->vio.op                               = VIO::READ;
       c->base_stat                            = cache_read_active_stat;
       CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
@@ -790,7 +794,7 @@ CacheVC::openReadMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   if (bytes > vio.ntodo()) {
     bytes = vio.ntodo();
   }
-  b           = new_IOBufferBlock(buf, bytes, doc_pos);
+  b           = new_IOBufferBlock(data_buf ? data_buf : buf, bytes, doc_pos);
   b->_buf_end = b->_end;
   vio.buffer.writer()->append_block(b);
   vio.ndone += bytes;
@@ -820,6 +824,20 @@ Lread : {
   // EVENT_IMMEDIATE events. So, we have to cancel that trigger and set
   // a new EVENT_INTERVAL event.
   cancel_trigger();
+  // a RAM cache which can be read without the Vol mutex serves body fragments without the lock
+  Ptr<IOBufferData> frag;
+  if (!(key == first_key) && vol->ram_cache->get_fragment(&key, &frag)) {
+    doc = reinterpret_cast<Doc *>(frag->data());
+    if (doc->magic == DOC_MAGIC && doc->key == key) {
+      f.doc_from_ram_cache = true;
+      buf                  = frag;
+      data_buf             = nullptr;
+      fragment++;
+      doc_pos = doc->prefix_len();
+      next_CacheKey(&key, &key);
+      return openReadMain(EVENT_NONE, nullptr);
+    }
+  }
   CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
     SET_HANDLER(&CacheVC::openReadMain);
@@ -942,6 +960,13 @@ CacheVC::openReadStartEarliest(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
       }
       return ret;
     }
+    // the fast tier copy is incomplete, drop it rather than rewriting
+    // its vector, the capacity tier still has the object
+    if (tier_src) {
+      dir_delete(&first_key, vol, &first_dir);
+      CACHE_INCREMENT_DYN_STAT(cache_tier_demote_stat);
+      goto Ldone;
+    }
     // read has detected that alternate does not exist in the cache.
     // rewrite the vector.
     if (!f.read_from_writer_called && frag_type == CACHE_FRAG_TYPE_HTTP) {
@@ -986,7 +1011,7 @@ CacheVC::openReadStartEarliest(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
             od->move_resident_alt = true;
             od->single_doc_key    = doc1->key;
             dir_assign(&od->single_doc_dir, &dir);
-            dir_set_tag(&od->single_doc_dir, od->single_doc_key.slice32(2));
+            dir_set_tag(&od->single_doc_dir, dir_key_tag(&od->single_doc_key));
           }
           SET_HANDLER(&CacheVC::openReadVecWrite);
           if ((ret = do_write_call()) == EVENT_RETURN) {
@@ -1002,6 +1027,9 @@ CacheVC::openReadStartEarliest(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
       vol->close_write(this);
     }
   }
+  if (tier_read_fallback()) {
+    return handleEvent(EVENT_IMMEDIATE, nullptr);
+  }
   CACHE_INCREMENT_DYN_STAT(cache_read_failure_stat);
   _action.continuation->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-ECACHE_NO_DOC);
   return free_CacheVC(this);
@@ -1125,6 +1153,11 @@ CacheVC::openReadStartHead(int event, Event *e)
     if (!(doc->first_key == key)) {
       goto Lread;
     }
+    if (vol->cache_vol->fast_tier) {
+      CACHE_INCREMENT_DYN_STAT(cache_tier_fast_hit_stat);
+    } else if (theCache->fast_tier) {
+      CACHE_INCREMENT_DYN_STAT(cache_tier_capacity_hit_stat);
+    }
     if (f.lookup) {
       goto Lookup;
     }
@@ -1265,6 +1298,10 @@ CacheVC::openReadStartHead(int event, Event *e)
     }
   }
 Ldone:
+  // the copy in the fast tier is unusable, try the capacity tier
+  if (err != ECACHE_ALT_MISS && tier_read_fallback()) {
+    return handleEvent(EVENT_IMMEDIATE, nullptr);
+  }
   if (!f.lookup) {
     CACHE_INCREMENT_DYN_STAT(cache_read_failure_stat);
     _action.continuation->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-err);
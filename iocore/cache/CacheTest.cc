@@ -669,8 +669,332 @@ REGRESSION_TEST(ram_cache)(RegressionTest *t, int level, int *pstatus)
   for (int s = 20; s <= 28; s += 4) {
     int64_t cache_size = 1LL << s;
     *pstatus           = REGRESSION_TEST_PASSED;
-    if (!test_RamCache(t, new_RamCacheLRU(), "LRU", cache_size) || !test_RamCache(t, new_RamCacheCLFUS(), "CLFUS", cache_size)) {
+    if (!test_RamCache(t, new_RamCacheLRU(), "LRU", cache_size) || !test_RamCache(t, new_RamCacheCLFUS(), "CLFUS", cache_size) ||
+        !test_RamCache(t, new_RamCacheS3FIFO(), "S3FIFO", cache_size)) {
       *pstatus = REGRESSION_TEST_FAILED;
     }
   }
 }
+
+REGRESSION_TEST(cache_tier_sketch)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  CacheTierSketch sketch(12);
+  CacheKey hot, cold, other;
+  hot.u64[0]   = 0x0000000100000002ULL;
+  hot.u64[1]   = 0x0000000300000004ULL;
+  cold.u64[0]  = 0x0000001000000020ULL;
+  cold.u64[1]  = 0x0000003000000040ULL;
+  other.u64[0] = 0x0000010000000200ULL;
+  other.u64[1] = 0x0000030000000400ULL;
+
+  *pstatus = REGRESSION_TEST_PASSED;
+  for (int i = 1; i <= CacheTierSketch::COUNTER_MAX + 2; i++) {
+    int est = sketch.add(&hot);
+    if (est != std::min(i, CacheTierSketch::COUNTER_MAX)) {
+      rprintf(t, "estimate %d after %d additions\n", est, i);
+      *pstatus = REGRESSION_TEST_FAILED;
+    }
+  }
+  if (sketch.estimate(&other) != 0) {
+    rprintf(t, "estimate %d for a key never added\n", sketch.estimate(&other));
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+  // fill the sample with another key, which halves all the counters
+  for (uint64_t i = CacheTierSketch::COUNTER_MAX + 2; i < sketch.sample_size(); i++) {
+    sketch.add(&cold);
+  }
+  if (sketch.estimate(&hot) != CacheTierSketch::COUNTER_MAX / 2) {
+    rprintf(t, "estimate %d after aging\n", sketch.estimate(&hot));
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+}
+
+namespace
+{
+// the earliest fragment of the object of the cache_tier test, as read from the fast tier
+CacheKey tier_test_earliest_key;
+
+// 1 if the fast tier holds the head of key, 0 if not, -1 if the fast stripe is busy
+int
+tier_test_has_copy(const CacheKey *key)
+{
+  Vol *fast = theCache->key_to_fast_vol(key);
+  CACHE_TRY_LOCK(lock, fast->mutex, this_ethread());
+  if (!lock.is_locked()) {
+    return -1;
+  }
+  Dir dir, *last_collision = nullptr;
+  return dir_probe(key, fast, &dir, &last_collision) ? 1 : 0;
+}
+} // end anonymous namespace
+
+// Promotion of an object read often enough into the fast tier, reads served by the
+// fast copy, the fallback to the capacity tier when the fast copy lost a fragment and
+// the invalidation of the fast copy when the object is removed.
+EXCLUSIVE_REGRESSION_TEST(cache_tier)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+  if (!theCache->fast_tier || !cache_config_tier_promote_hits) {
+    rprintf(t, "no fast tier configured\n");
+    *pstatus = REGRESSION_TEST_PASSED;
+    return;
+  }
+
+  EThread *thread    = this_ethread();
+  const int64_t size = 3000000; // a few fragments
+
+  CACHE_SM(t, tier_write_test, { cacheProcessor.open_write(this, &key, CACHE_FRAG_TYPE_NONE, 100, CACHE_WRITE_OPT_SYNC); });
+  tier_write_test.expect_initial_event = CACHE_EVENT_OPEN_WRITE;
+  tier_write_test.expect_event         = VC_EVENT_WRITE_COMPLETE;
+  tier_write_test.nbytes               = size;
+  rand_CacheKey(&tier_write_test.key, thread->mutex);
+
+  CACHE_SM(t, tier_read_test, { cacheProcessor.open_read(this, &key); });
+  tier_read_test.expect_initial_event = CACHE_EVENT_OPEN_READ;
+  tier_read_test.expect_event         = VC_EVENT_READ_COMPLETE;
+  tier_read_test.nbytes               = size;
+  tier_read_test.key                  = tier_write_test.key;
+
+  // wait for the promotion started by the reads to insert the head into the fast tier
+  CACHE_SM(
+    t, tier_promoted_test,
+    {
+      if (tier_test_has_copy(&key) > 0) {
+        handleEvent(AIO_EVENT_DONE, nullptr);
+      } else if (polls++ < 100) {
+        timeout = eventProcessor.schedule_in(this, HRTIME_MSECONDS(10));
+      } else {
+        rprintf(this->t, "the object was not promoted\n");
+        complete(EVENT_NONE);
+      }
+    } int polls = 0;);
+  tier_promoted_test.expect_event = AIO_EVENT_DONE;
+  tier_promoted_test.key          = tier_write_test.key;
+
+  CACHE_SM(
+    t, tier_fast_read_test, { cacheProcessor.open_read(this, &key); } int open_read_callout() override {
+      CacheVC *vc = static_cast<CacheVC *>(cache_vc);
+      if (!vc->tier_src) {
+        return -1;
+      }
+      tier_test_earliest_key = vc->earliest_key;
+      cvio                   = cache_vc->do_io_read(this, nbytes, buffer);
+      return 1;
+    });
+  tier_fast_read_test.expect_initial_event = CACHE_EVENT_OPEN_READ;
+  tier_fast_read_test.expect_event         = VC_EVENT_READ_COMPLETE;
+  tier_fast_read_test.nbytes               = size;
+  tier_fast_read_test.key                  = tier_write_test.key;
+
+  // the fast copy loses its earliest fragment, the read falls back to the capacity tier
+  CACHE_SM(
+    t, tier_fallback_test,
+    {
+      Vol *fast = theCache->key_to_fast_vol(&key);
+      {
+        SCOPED_MUTEX_LOCK(lock, fast->mutex, this_ethread());
+        Dir dir;
+        Dir *last_collision = nullptr;
+        while (dir_probe(&tier_test_earliest_key, fast, &dir, &last_collision)) {
+          dir_delete(&tier_test_earliest_key, fast, &dir);
+          last_collision = nullptr;
+        }
+      }
+      cacheProcessor.open_read(this, &key);
+    } int open_read_callout() override {
+      if (static_cast<CacheVC *>(cache_vc)->tier_src || tier_test_has_copy(&key) > 0) {
+        return -1;
+      }
+      cvio = cache_vc->do_io_read(this, nbytes, buffer);
+      return 1;
+    });
+  tier_fallback_test.expect_initial_event = CACHE_EVENT_OPEN_READ;
+  tier_fallback_test.expect_event         = VC_EVENT_READ_COMPLETE;
+  tier_fallback_test.nbytes               = size;
+  tier_fallback_test.key                  = tier_write_test.key;
+
+  CACHE_SM(t, tier_remove_test, { cacheProcessor.remove(this, &key); });
+  tier_remove_test.expect_event = CACHE_EVENT_REMOVE;
+  tier_remove_test.key          = tier_write_test.key;
+
+  // the fast copy must not outlive the object
+  CACHE_SM(t, tier_read_fail_test, { cacheProcessor.open_read(this, &key); });
+  tier_read_fail_test.expect_event = CACHE_EVENT_OPEN_READ_FAILED;
+  tier_read_fail_test.key          = tier_write_test.key;
+
+  // clang-format off
+  r_sequential(t,
+      tier_write_test.clone(),
+      r_sequential(t, cache_config_tier_promote_hits, tier_read_test.clone()),
+      tier_promoted_test.clone(),
+      tier_fast_read_test.clone(),
+      tier_fallback_test.clone(),
+      tier_read_test.clone(), /* the object is still hot, this promotes it again */
+      tier_promoted_test.clone(),
+      tier_remove_test.clone(),
+      tier_read_fail_test.clone(),
+      nullptr)
+  ->run(pstatus);
+  // clang-format on
+}
+
+// Three aggregation writes in flight on a stripe complete in reverse order, the middle one
+// with an error. They are retired in the order they were issued: write_pos only moves over
+// data which is on disk, the documents of a write done early are served from its buffer
+// until the writes before it are retired, and a failed write only drops its own entries.
+EXCLUSIVE_REGRESSION_TEST(cache_agg_write_order)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  constexpr int WRITES = 3;
+
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+  Vol *vol        = gvol[0];
+  EThread *thread = this_ethread();
+  MUTEX_TRY_LOCK(lock, vol->mutex, thread);
+  ink_release_assert(lock.is_locked());
+  int l = vol->round_to_approx_size(sizeof(Doc));
+  if (vol->agg_in_flight || vol->agg_buf_pos || vol->agg.head || vol->sync.head || vol->dir_sync_waiting ||
+      vol->header->write_pos + WRITES * l > vol->skip + vol->len) {
+    rprintf(t, "stripe is busy or at its end\n");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+
+  int saved_buffers      = vol->agg_write_buffers;
+  int saved_head         = vol->agg_write_head;
+  char *saved_agg_buffer = vol->agg_buffer;
+  std::vector<int> allocated;
+  vol->agg_write_buffers = WRITES;
+  vol->agg_write_head    = 0;
+  for (int i = 0; i < WRITES; i++) {
+    AggWriteBuffer &w = vol->agg_writes[i];
+    if (!w.buffer) {
+      w.buffer = static_cast<char *>(ats_memalign(ats_pagesize(), AGG_SIZE));
+      w.vol    = vol;
+      w.mutex  = vol->mutex;
+      allocated.push_back(i);
+    }
+  }
+
+  // issue the writes the way Vol::aggWrite does, without the AIO
+  off_t write_pos       = vol->header->write_pos;
+  uint32_t write_serial = vol->header->write_serial;
+  CacheKey keys[WRITES];
+  Dir dirs[WRITES];
+  for (int i = 0; i < WRITES; i++) {
+    AggWriteBuffer *w = &vol->agg_writes[i];
+    Doc *doc          = reinterpret_cast<Doc *>(w->buffer);
+    memset(static_cast<void *>(doc), 0, sizeof(Doc));
+    rand_CacheKey(&keys[i], thread->mutex);
+    doc->magic     = DOC_MAGIC;
+    doc->len       = sizeof(Doc);
+    doc->key       = keys[i];
+    doc->first_key = keys[i];
+    dir_clear(&dirs[i]);
+    dir_set_offset(&dirs[i], vol->offset_to_vol_offset(vol->agg_write_pos()));
+    dir_set_approx_size(&dirs[i], l);
+    dir_set_phase(&dirs[i], vol->header->phase);
+    dir_set_head(&dirs[i], true);
+    dir_insert(&keys[i], vol, &dirs[i]);
+    w->io.aiocb.aio_fildes = vol->fd;
+    w->io.aiocb.aio_offset = vol->agg_write_pos();
+    w->io.aiocb.aio_buf    = w->buffer;
+    w->io.aiocb.aio_nbytes = l;
+    w->io.action           = w;
+    vol->agg_pending      += l;
+    vol->agg_in_flight++;
+  }
+  vol->header->agg_pos = vol->agg_write_pos();
+
+  *pstatus = REGRESSION_TEST_PASSED;
+  auto check = [&](bool ok, const char *what) {
+    if (!ok) {
+      rprintf(t, "%s\n", what);
+      *pstatus = REGRESSION_TEST_FAILED;
+    }
+  };
+
+  vol->agg_writes[2].io.aio_result = l;
+  vol->aggWriteDone(&vol->agg_writes[2]);
+  check(vol->header->write_pos == write_pos && vol->header->write_serial == write_serial && vol->agg_in_flight == WRITES,
+        "the last write was retired before the ones issued before it");
+  check(dir_agg_buf_valid(vol, &dirs[2]), "a document written early is not read from its buffer");
+  check(vol->agg_buffer_at(vol->vol_offset(&dirs[2])) == vol->agg_writes[2].buffer,
+        "a document written early is not found in its buffer");
+
+  vol->agg_writes[1].io.aio_result = -EIO;
+  vol->aggWriteDone(&vol->agg_writes[1]);
+  check(vol->header->write_pos == write_pos && vol->agg_in_flight == WRITES, "a failed write was retired out of order");
+
+  vol->agg_writes[0].io.aio_result = l;
+  vol->aggWriteDone(&vol->agg_writes[0]);
+  check(vol->header->write_pos == write_pos + WRITES * l && vol->header->last_write_pos == write_pos + (WRITES - 1) * l,
+        "write_pos did not move over the writes in order");
+  check(vol->header->write_serial == write_serial + WRITES, "a retired write did not bump the write serial");
+  check(!vol->agg_in_flight && !vol->agg_pending && !dir_agg_buf_valid(vol, &dirs[2]), "the writes were not all retired");
+  for (int i = 0; i < WRITES; i++) {
+    Dir dir, *last_collision = nullptr;
+    bool found = dir_probe(&keys[i], vol, &dir, &last_collision) && dir_offset(&dir) == dir_offset(&dirs[i]);
+    check(found == (i != 1), i == 1 ? "the entry of the failed write was kept" : "the entry of a good write was dropped");
+    if (found) {
+      dir_delete(&keys[i], vol, &dirs[i]);
+    }
+  }
+
+  vol->agg_write_buffers = saved_buffers;
+  vol->agg_write_head    = saved_head;
+  vol->agg_buffer        = saved_agg_buffer;
+  for (int i : allocated) {
+    ats_free(vol->agg_writes[i].buffer);
+    vol->agg_writes[i].buffer = nullptr;
+  }
+}
+
+// A ram cache hit on a fragment with headers, which each reader unmarshals in
+// place. The ram caches hand out the fragment they hold rather than a copy, a
+// reader copies the headers and serves the body from the shared fragment.
+REGRESSION_TEST(ram_cache_hit_copy)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  const int size = 1 << 20;
+  const int hlen = 2048;
+
+  *pstatus = REGRESSION_TEST_PASSED;
+
+  Ptr<IOBufferData> shared = make_ptr(new_IOBufferData(iobuffer_size_to_index(size, MAX_BUFFER_SIZE_INDEX), MEMALIGNED));
+  Doc *doc                 = reinterpret_cast<Doc *>(shared->data());
+  memset(static_cast<void *>(doc), 0, sizeof(Doc));
+  doc->magic = DOC_MAGIC;
+  doc->len   = size;
+  doc->hlen  = hlen;
+  memset(doc->hdr(), 'h', hlen);
+
+  CacheKey key;
+  Vol *vol = theCache->key_to_vol(&key, "example.com", sizeof("example.com") - 1);
+  RamCache *caches[] = {new_RamCacheLRU(), new_RamCacheCLFUS(), new_RamCacheS3FIFO()};
+  for (RamCache *cache : caches) {
+    CryptoHash hash;
+    hash.u64[0] = 0x1234;
+    hash.u64[1] = 0x5678;
+    cache->init(size * 4, vol);
+    Ptr<IOBufferData> hit;
+    cache->put(&hash, shared.get(), size, false, 1); // the second put gets past the seen filter
+    if (!cache->put(&hash, shared.get(), size, false, 1) || !cache->get(&hash, &hit, 1) || hit.get() != shared.get()) {
+      rprintf(t, "ram cache hit is not the fragment it holds\n");
+      *pstatus = REGRESSION_TEST_FAILED;
+    }
+    delete cache;
+  }
+
+  Ptr<IOBufferData> copy = make_ptr(cache_doc_copy(shared.get(), true));
+  if (copy->block_size() >= size || memcmp(copy->data(), shared->data(), doc->prefix_len()) != 0) {
+    rprintf(t, "the copy of the headers is %" PRId64 " bytes\n", copy->block_size());
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+}
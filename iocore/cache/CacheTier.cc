@@ -0,0 +1,495 @@
+/** @file
+
+  Tiered storage: hot objects of the capacity tier are copied into a fast tier.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// The fast tier is made of the volumes marked tier=fast in volume.config. It only
+// ever holds copies: every object is written to and evacuated within the capacity
+// tier as usual, so losing a fast copy, to a wrap of the fast stripe, an
+// invalidation or an incomplete promotion, never loses data.
+//
+// Reads from the capacity tier are counted in a count-min sketch. Once the estimate
+// for an object reaches proxy.config.cache.tier.promote_hits, a promoter CacheVC
+// copies the raw documents of the object, fragments first and the head last, into
+// the aggregation buffer of the fast stripe, much like an evacuation. The head is
+// only inserted into the fast directory if the object was neither written nor
+// removed meanwhile, which is tracked by a small table of invalidation epochs.
+
+#include "P_Cache.h"
+
+#include <algorithm>
+
+namespace
+{
+DbgCtl dbg_ctl_cache_tier{"cache_tier"};
+
+constexpr int TIER_EPOCHS       = 1024; // invalidation epochs, shared by objects by hash
+constexpr int TIER_MAX_INFLIGHT = 1024; // upper bound of proxy.config.cache.tier.promote_max_inflight
+
+std::atomic<uint32_t> tier_epochs[TIER_EPOCHS];
+std::atomic<uint32_t> tier_pending_drops[TIER_EPOCHS];
+std::atomic<uint64_t> tier_inflight[TIER_MAX_INFLIGHT];
+
+CacheTierSketch &
+tier_sketch()
+{
+  static CacheTierSketch sketch;
+  return sketch;
+}
+
+inline std::atomic<uint32_t> &
+epoch_of(const CacheKey *key)
+{
+  return tier_epochs[key->slice32(1) % TIER_EPOCHS];
+}
+
+inline std::atomic<uint32_t> &
+pending_drops_of(const CacheKey *key)
+{
+  return tier_pending_drops[key->slice32(1) % TIER_EPOCHS];
+}
+
+inline uint64_t
+inflight_fold(const CacheKey *key)
+{
+  return key->fold() | 1; // 0 marks a free slot
+}
+
+// reserve a promotion slot for key, fails if key is already being promoted or all slots are taken
+bool
+inflight_claim(const CacheKey *key)
+{
+  uint64_t fold = inflight_fold(key);
+  int n         = std::min(cache_config_tier_promote_max_inflight, TIER_MAX_INFLIGHT);
+  int free_slot = -1;
+  for (int i = 0; i < n; i++) {
+    uint64_t v = tier_inflight[i].load(std::memory_order_relaxed);
+    if (v == fold) {
+      return false;
+    }
+    if (!v && free_slot < 0) {
+      free_slot = i;
+    }
+  }
+  uint64_t expected = 0;
+  return free_slot >= 0 && tier_inflight[free_slot].compare_exchange_strong(expected, fold);
+}
+
+void
+inflight_release(const CacheKey *key)
+{
+  uint64_t fold = inflight_fold(key);
+  for (auto &slot : tier_inflight) {
+    uint64_t expected = fold;
+    if (slot.compare_exchange_strong(expected, 0)) {
+      return;
+    }
+  }
+}
+
+// delete every directory entry of key from the fast stripe vol, the caller holds the stripe lock
+void
+tier_drop(Vol *vol, const CacheKey *key)
+{
+  ProxyMutex *mutex = vol->mutex.get();
+  Dir dir, *last_collision = nullptr;
+  bool dropped = false;
+  while (dir_probe(key, vol, &dir, &last_collision)) {
+    dir_delete(key, vol, &dir);
+    last_collision = nullptr;
+    dropped        = true;
+  }
+  if (dropped) {
+    CACHE_INCREMENT_DYN_STAT(cache_tier_demote_stat);
+  }
+}
+
+struct CacheTierInvalidateCont : public Continuation {
+  Vol *vol;
+  CacheKey key;
+
+  int
+  event_handler(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    if (!lock.is_locked()) {
+      mutex->thread_holding->schedule_in_local(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
+      return EVENT_CONT;
+    }
+    tier_drop(vol, &key);
+    pending_drops_of(&key).fetch_sub(1, std::memory_order_release);
+    delete this;
+    return EVENT_DONE;
+  }
+
+  CacheTierInvalidateCont(Vol *v, const CacheKey *k) : Continuation(new_ProxyMutex()), vol(v), key(*k)
+  {
+    SET_HANDLER(&CacheTierInvalidateCont::event_handler);
+  }
+};
+
+// end a promotion, successful if the head was inserted into the fast directory
+int
+tier_promote_done(CacheVC *c)
+{
+  inflight_release(&c->first_key);
+  // an object which was not found is not a failure
+  if (c->closed <= 0 && c->first_buf) {
+    ProxyMutex *mutex = c->mutex.get();
+    Vol *vol          = c->vol;
+    CACHE_INCREMENT_DYN_STAT(cache_tier_promote_failure_stat);
+  }
+  Dbg(dbg_ctl_cache_tier, "promotion of %X %s", c->first_key.slice32(0), c->closed > 0 ? "done" : "abandoned");
+  c->tier_src = nullptr;
+  return free_CacheVC(c);
+}
+
+// hand the document in c->buf to the aggregation buffer of the fast stripe
+int
+tier_promote_copy(CacheVC *c)
+{
+  Vol *vol   = c->vol;
+  Doc *doc   = reinterpret_cast<Doc *>(c->buf->data());
+  c->agg_len = vol->round_to_approx_size(doc->len);
+  // promotions are opportunistic, they never add to a backlog of regular writes
+  if (c->agg_len > AGG_SIZE || vol->agg_todo_size + c->agg_len > static_cast<uint32_t>(cache_config_agg_write_backlog)) {
+    return tier_promote_done(c);
+  }
+  c->overwrite_dir    = c->dir;
+  c->f.evacuator      = 1;
+  vol->agg_todo_size += c->agg_len;
+  SET_CONTINUATION_HANDLER(c, &CacheVC::tierPromoteCopyDone);
+  vol->agg.enqueue(c);
+  if (!vol->is_io_in_progress()) {
+    return vol->aggWrite(EVENT_NONE, c);
+  }
+  return EVENT_CONT;
+}
+
+// start copying key from the capacity stripe from into the fast stripe vol, the caller holds the lock of vol
+void
+tier_promote(Vol *from, Vol *vol, const CacheKey *key)
+{
+  if (!inflight_claim(key)) {
+    return;
+  }
+  CacheVC *c        = new_CacheVC(vol);
+  ProxyMutex *mutex = vol->mutex.get();
+  c->base_stat      = cache_tier_promote_active_stat;
+  CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
+  c->first_key = c->key = *key;
+  c->vol                = vol;
+  c->tier_src           = from;
+  c->tier_epoch         = epoch_of(key).load(std::memory_order_acquire);
+  c->last_collision     = nullptr;
+  SET_CONTINUATION_HANDLER(c, &CacheVC::tierPromoteEvent);
+  eventProcessor.schedule_imm(c, ET_CALL);
+}
+
+} // end anonymous namespace
+
+CacheTierSketch::CacheTierSketch(int width_bits)
+  : width(width_bits),
+    mask((1u << width_bits) - 1),
+    sample(static_cast<uint64_t>(10) << width_bits),
+    counters(new std::atomic<uint8_t>[static_cast<size_t>(ROWS) << width_bits]())
+{
+}
+
+int
+CacheTierSketch::add(const CacheKey *key)
+{
+  int est = COUNTER_MAX;
+  for (int r = 0; r < ROWS; r++) {
+    std::atomic<uint8_t> &c = counter(r, key);
+    uint8_t v               = c.load(std::memory_order_relaxed);
+    if (v < COUNTER_MAX) {
+      c.store(++v, std::memory_order_relaxed);
+    }
+    est = std::min<int>(est, v);
+  }
+  if (additions.fetch_add(1, std::memory_order_relaxed) + 1 == sample) {
+    age();
+    additions.store(0, std::memory_order_relaxed);
+  }
+  return est;
+}
+
+int
+CacheTierSketch::estimate(const CacheKey *key) const
+{
+  int est = COUNTER_MAX;
+  for (int r = 0; r < ROWS; r++) {
+    est = std::min<int>(est, counter(r, key).load(std::memory_order_relaxed));
+  }
+  return est;
+}
+
+void
+CacheTierSketch::age()
+{
+  size_t n = static_cast<size_t>(ROWS) << width;
+  for (size_t i = 0; i < n; i++) {
+    counters[i].store(counters[i].load(std::memory_order_relaxed) >> 1, std::memory_order_relaxed);
+  }
+}
+
+Vol *
+cache_tier_read_vol(Cache *cache, const CacheKey *key, Vol **vol)
+{
+  Vol *fast = cache->key_to_fast_vol(key);
+  if (!fast) {
+    return nullptr;
+  }
+  CACHE_TRY_LOCK(lock, fast->mutex, this_ethread());
+  if (!lock.is_locked()) {
+    return nullptr;
+  }
+  // the fast copy of key may be stale until a pending invalidation drops it
+  if (pending_drops_of(key).load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  Dir dir, *last_collision = nullptr;
+  if (dir_probe(key, fast, &dir, &last_collision)) {
+    Vol *capacity = *vol;
+    *vol          = fast;
+    return capacity;
+  }
+  if (cache_config_tier_promote_hits && tier_sketch().add(key) >= cache_config_tier_promote_hits) {
+    tier_promote(*vol, fast, key);
+  }
+  return nullptr;
+}
+
+void
+cache_tier_invalidate(Cache *cache, const CacheKey *key)
+{
+  Vol *fast = cache->key_to_fast_vol(key);
+  if (!fast) {
+    return;
+  }
+  // a promotion of key running now checks the epoch before it installs the head
+  epoch_of(key).fetch_add(1, std::memory_order_acq_rel);
+  EThread *t = this_ethread();
+  CACHE_TRY_LOCK(lock, fast->mutex, t);
+  if (lock.is_locked()) {
+    tier_drop(fast, key);
+  } else {
+    pending_drops_of(key).fetch_add(1, std::memory_order_acq_rel);
+    eventProcessor.schedule_imm(new CacheTierInvalidateCont(fast, key), ET_CALL);
+  }
+}
+
+// Switch a read served by the fast tier over to the capacity tier and restart it
+// from the head. Returns false if the read is not served by the fast tier.
+bool
+CacheVC::tier_read_fallback()
+{
+  if (!tier_src) {
+    return false;
+  }
+  CACHE_DECREMENT_DYN_STAT(base_stat + CACHE_STAT_ACTIVE);
+  vol      = tier_src;
+  tier_src = nullptr;
+  CACHE_INCREMENT_DYN_STAT(base_stat + CACHE_STAT_ACTIVE);
+  buf       = nullptr;
+  first_buf = nullptr;
+  vector.clear(false);
+  alternate.clear();
+  key = earliest_key = first_key;
+  last_collision     = nullptr;
+  dir_clear(&dir);
+  f.single_fragment = 0;
+  doc_len           = 0;
+  doc_pos           = 0;
+  fragment          = 0;
+  SET_HANDLER(&CacheVC::openReadStartHead);
+  return true;
+}
+
+// Find and read the next document of the object being promoted: the fragments of
+// each alternate first and the head last, so the object only becomes visible in the
+// fast tier once all of its data is there.
+int
+CacheVC::tierPromoteEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  if (f.use_first_key) { // the head has been copied
+    return tier_promote_done(this);
+  }
+  Vol *from   = tier_src;
+  bool in_agg = false;
+  {
+    CACHE_TRY_LOCK(lock, from->mutex, mutex->thread_holding);
+    if (!lock.is_locked()) {
+      VC_SCHED_LOCK_RETRY();
+    }
+    if (!first_buf) {
+      if (!dir_probe(&first_key, from, &dir, &last_collision)) {
+        return tier_promote_done(this);
+      }
+    } else {
+      Doc *head = reinterpret_cast<Doc *>(first_buf->data());
+      while (total_len >= doc_len) { // this alternate is complete, move to the next one
+        if (fragment >= vector.count()) {
+          goto Lhead;
+        }
+        CacheHTTPInfo *alt = vector.get(fragment++);
+        alt->object_key_get(&key);
+        doc_len        = alt->object_size_get();
+        total_len      = key == head->key ? doc_len : 0; // the data is in the head
+        last_collision = nullptr;
+        // do not let a single object take over the fast stripe
+        if (doc_len > static_cast<uint64_t>(vol->len / 8)) {
+          return tier_promote_done(this);
+        }
+      }
+      if (!dir_probe(&key, from, &dir, &last_collision)) {
+        return tier_promote_done(this);
+      }
+    }
+    io.aiocb.aio_nbytes = dir_approx_size(&dir);
+    if (dir_agg_buf_valid(from, &dir)) {
+      buf = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+      memcpy(buf->data(), from->agg_buffer_at(from->vol_offset(&dir)), io.aiocb.aio_nbytes);
+      io.aio_result = io.aiocb.aio_nbytes;
+      in_agg        = true;
+    } else {
+      io.aiocb.aio_fildes = from->fd;
+      io.aiocb.aio_offset = from->vol_offset(&dir);
+      if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(from->skip + from->len)) {
+        io.aiocb.aio_nbytes = from->skip + from->len - io.aiocb.aio_offset;
+      }
+      buf              = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+      io.aiocb.aio_buf = buf->data();
+      io.action        = this;
+      io.thread        = AIO_CALLBACK_THREAD_ANY;
+      SET_HANDLER(&CacheVC::tierPromoteReadDone);
+      ink_assert(ink_aio_read(&io) >= 0);
+      return EVENT_CONT;
+    }
+  }
+  ink_assert(in_agg);
+  SET_HANDLER(&CacheVC::tierPromoteReadDone);
+  return handleEvent(AIO_EVENT_DONE, nullptr);
+
+Lhead : {
+  // all data is copied, the head may follow unless the object changed meanwhile
+  CACHE_TRY_LOCK(lock, from->mutex, mutex->thread_holding);
+  if (!lock.is_locked()) {
+    VC_SCHED_LOCK_RETRY();
+  }
+  if (from->open_read(&first_key) || epoch_of(&first_key).load(std::memory_order_acquire) != tier_epoch) {
+    return tier_promote_done(this);
+  }
+  Dir head_dir, *head_collision = nullptr;
+  bool found = false;
+  while (!found && dir_probe(&first_key, from, &head_dir, &head_collision)) {
+    found = dir_offset(&head_dir) == dir_offset(&first_dir);
+  }
+  if (!found) {
+    return tier_promote_done(this);
+  }
+}
+  buf             = first_buf;
+  dir             = first_dir;
+  key             = first_key;
+  f.use_first_key = 1;
+  return tier_promote_copy(this);
+}
+
+int
+CacheVC::tierPromoteReadDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  set_io_not_in_progress();
+  {
+    CACHE_TRY_LOCK(lock, tier_src->mutex, mutex->thread_holding);
+    if (!lock.is_locked()) {
+      VC_SCHED_LOCK_RETRY();
+    }
+    // a directory entry which is no longer valid may have been overwritten
+    if (!io.ok() || !dir_valid(tier_src, &dir)) {
+      return tier_promote_done(this);
+    }
+  }
+  Doc *doc = reinterpret_cast<Doc *>(buf->data());
+  if (doc->magic != DOC_MAGIC || doc->len > io.aiocb.aio_nbytes) {
+    return tier_promote_done(this);
+  }
+  if (first_buf ? !(doc->key == key) : !(doc->first_key == first_key)) { // collision
+    SET_HANDLER(&CacheVC::tierPromoteEvent);
+    return handleEvent(EVENT_IMMEDIATE, nullptr);
+  }
+  if (first_buf) {
+    total_len += doc->data_len();
+    return tier_promote_copy(this);
+  }
+
+  // the head, written out unchanged at the end, learn the fragments to copy first
+  first_buf = buf;
+  first_dir = dir;
+  buf       = nullptr;
+  if (doc->doc_type == CACHE_FRAG_TYPE_HTTP && doc->hlen) {
+    // unmarshalling works in place, so parse a copy
+    Ptr<IOBufferData> vector_buf(new_IOBufferData(iobuffer_size_to_index(doc->len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED));
+    Doc *vector_doc = reinterpret_cast<Doc *>(vector_buf->data());
+    memcpy(static_cast<void *>(vector_doc), doc, doc->len);
+    if (vector.get_handles(vector_doc->hdr(), vector_doc->hlen, vector_buf.get()) != vector_doc->hlen) {
+      return tier_promote_done(this);
+    }
+    fragment = 0;
+    doc_len = total_len = 0;
+  } else {
+    doc_len   = doc->total_len;
+    total_len = doc->data_len();
+    next_CacheKey(&key, &doc->key);
+  }
+  last_collision = nullptr;
+  SET_HANDLER(&CacheVC::tierPromoteEvent);
+  return handleEvent(EVENT_IMMEDIATE, nullptr);
+}
+
+// The document was copied into the aggregation buffer of the fast stripe, called by
+// Vol::aggWrite with the stripe locked, possibly on an AIO thread.
+int
+CacheVC::tierPromoteCopyDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  f.evacuator = 0;
+  buf         = nullptr;
+  if (!f.use_first_key) {
+    dir_insert(&key, vol, &dir);
+    CacheKey next_key;
+    next_CacheKey(&next_key, &key);
+    key            = next_key;
+    last_collision = nullptr;
+  } else if (epoch_of(&first_key).load(std::memory_order_acquire) == tier_epoch) {
+    Dir head_dir, *head_collision = nullptr;
+    if (!dir_probe(&first_key, vol, &head_dir, &head_collision)) {
+      dir_insert(&first_key, vol, &dir);
+      closed = 1;
+    }
+  }
+  SET_HANDLER(&CacheVC::tierPromoteEvent);
+  eventProcessor.schedule_imm(this, ET_CALL);
+  return EVENT_CONT;
+}
@@ -341,8 +341,8 @@ Vol::scan_for_pinned_documents()
 {
   if (cache_config_permit_pinning) {
     // we can't evacuate anything between header->write_pos and
-    // header->write_pos + AGG_SIZE.
-    int ps                = this->offset_to_vol_offset(header->write_pos + AGG_SIZE);
+    // the end of the writes in flight + AGG_SIZE.
+    int ps                = this->offset_to_vol_offset(agg_write_pos() + AGG_SIZE);
     int pe                = this->offset_to_vol_offset(header->write_pos + 2 * EVACUATION_SIZE + (len / PIN_SCAN_EVERY));
     int vol_end_offset    = this->offset_to_vol_offset(len + skip);
     int before_end_of_vol = pe < vol_end_offset;
@@ -367,53 +367,73 @@ Vol::scan_for_pinned_documents()
   }
 }
 
+int
+AggWriteBuffer::handle_write_done(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+{
+  return vol->aggWriteDone(this);
+}
+
 /* NOTE:: This state can be called by an AIO thread, so DON'T DON'T
    DON'T schedule any events on this thread using VC_SCHED_XXX or
    mutex->thread_holding->schedule_xxx_local(). ALWAYS use
    eventProcessor.schedule_xxx().
    */
 int
-Vol::aggWriteDone(int event, Event *e)
+Vol::aggWriteDone(AggWriteBuffer *w)
 {
-  cancel_trigger();
-
   // ensure we have the cacheDirSync lock if we intend to call it later
   // retaking the current mutex recursively is a NOOP
   CACHE_TRY_LOCK(lock, dir_sync_waiting ? cacheDirSync->mutex : mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
-    eventProcessor.schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
+    eventProcessor.schedule_in(w, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
     return EVENT_CONT;
   }
-  if (io.ok()) {
-    header->last_write_pos  = header->write_pos;
-    header->write_pos      += io.aiocb.aio_nbytes;
-    ink_assert(header->write_pos >= start);
-    DDbg(dbg_ctl_cache_agg, "Dir %s, Write: %" PRIu64 ", last Write: %" PRIu64 "", hash_text.get(), header->write_pos,
-         header->last_write_pos);
-    ink_assert(header->write_pos == header->agg_pos);
-    if (header->write_pos + EVACUATION_SIZE > scan_pos) {
-      periodic_scan();
-    }
-    agg_buf_pos = 0;
-    header->write_serial++;
-  } else {
-    // delete all the directory entries that we inserted
-    // for fragments is this aggregation buffer
-    Dbg(dbg_ctl_cache_disk_error, "Write error on disk %s\n \
-            write range : [%" PRIu64 " - %" PRIu64 " bytes]  [%" PRIu64 " - %" PRIu64 " blocks] \n",
-        hash_text.get(), (uint64_t)io.aiocb.aio_offset, (uint64_t)io.aiocb.aio_offset + io.aiocb.aio_nbytes,
-        (uint64_t)io.aiocb.aio_offset / CACHE_BLOCK_SIZE, (uint64_t)(io.aiocb.aio_offset + io.aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
-    Dir del_dir;
-    dir_clear(&del_dir);
-    for (int done = 0; done < agg_buf_pos;) {
-      Doc *doc = reinterpret_cast<Doc *>(agg_buffer + done);
-      dir_set_offset(&del_dir, header->write_pos + done);
-      dir_delete(&doc->key, this, &del_dir);
-      done += round_to_approx_size(doc->len);
+  w->done = true;
+
+  // retire the writes in the order they were issued, write_pos only
+  // moves over data which is on disk
+  while (agg_in_flight && agg_writes[agg_write_head].done) {
+    AggWriteBuffer *r = &agg_writes[agg_write_head];
+    AIOCallback &io   = r->io;
+    ink_assert(io.aiocb.aio_offset == header->write_pos);
+    if (io.ok()) {
+      header->last_write_pos  = header->write_pos;
+      header->write_pos      += io.aiocb.aio_nbytes;
+      ink_assert(header->write_pos >= start);
+      DDbg(dbg_ctl_cache_agg, "Dir %s, Write: %" PRIu64 ", last Write: %" PRIu64 "", hash_text.get(), header->write_pos,
+           header->last_write_pos);
+      ink_assert(agg_in_flight > 1 || header->write_pos == header->agg_pos);
+      if (header->write_pos + EVACUATION_SIZE > scan_pos) {
+        periodic_scan();
+      }
+      header->write_serial++;
+    } else {
+      // delete all the directory entries that we inserted
+      // for fragments is this aggregation buffer
+      Dbg(dbg_ctl_cache_disk_error, "Write error on disk %s\n \
+              write range : [%" PRIu64 " - %" PRIu64 " bytes]  [%" PRIu64 " - %" PRIu64 " blocks] \n",
+          hash_text.get(), (uint64_t)io.aiocb.aio_offset, (uint64_t)io.aiocb.aio_offset + io.aiocb.aio_nbytes,
+          (uint64_t)io.aiocb.aio_offset / CACHE_BLOCK_SIZE, (uint64_t)(io.aiocb.aio_offset + io.aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
+      Dir del_dir;
+      dir_clear(&del_dir);
+      for (int done = 0; done < static_cast<int>(io.aiocb.aio_nbytes);) {
+        Doc *doc = reinterpret_cast<Doc *>(r->buffer + done);
+        dir_set_offset(&del_dir, offset_to_vol_offset(header->write_pos + done));
+        dir_delete(&doc->key, this, &del_dir);
+        done += round_to_approx_size(doc->len);
+      }
+      // the data behind it was placed after it, step over the failed range
+      if (agg_in_flight > 1 || agg_buf_pos) {
+        header->last_write_pos  = header->write_pos;
+        header->write_pos      += io.aiocb.aio_nbytes;
+        header->write_serial++;
+      }
     }
-    agg_buf_pos = 0;
+    r->done         = false;
+    agg_pending    -= io.aiocb.aio_nbytes;
+    agg_write_head  = (agg_write_head + 1) % agg_write_buffers;
+    agg_in_flight--;
   }
-  set_io_not_in_progress();
   // callback ready sync CacheVCs
   CacheVC *c = nullptr;
   while ((c = sync.dequeue())) {
@@ -424,12 +444,13 @@ Vol::aggWriteDone(int event, Event *e)
       break;
     }
   }
-  if (dir_sync_waiting) {
+  if (dir_sync_waiting && !agg_in_flight) {
     dir_sync_waiting = false;
     cacheDirSync->handleEvent(EVENT_IMMEDIATE, nullptr);
   }
-  if (agg.head || sync.head) {
-    return aggWrite(event, e);
+  // an evacuation read calls aggWrite when it is done
+  if ((agg.head || sync.head) && !is_io_in_progress()) {
+    return aggWrite(AIO_EVENT_DONE, nullptr);
   }
   return EVENT_CONT;
 }
@@ -804,7 +825,7 @@ static int
 agg_copy(char *p, CacheVC *vc)
 {
   Vol *vol = vc->vol;
-  off_t o  = vol->header->write_pos + vol->agg_buf_pos;
+  off_t o  = vol->agg_write_pos() + vol->agg_buf_pos;
 
   if (!vc->f.evacuator) {
     Doc *doc                   = reinterpret_cast<Doc *>(p);
@@ -830,7 +851,7 @@ agg_copy(char *p, CacheVC *vc)
     doc->total_len   = vc->total_len;
     doc->first_key   = vc->first_key;
     doc->sync_serial = vol->header->sync_serial;
-    vc->write_serial = doc->write_serial = vol->header->write_serial;
+    vc->write_serial = doc->write_serial = vol->agg_write_serial();
     doc->checksum                        = DOC_NO_CHECKSUM;
     if (vc->pin_in_cache) {
       dir_set_pinned(&vc->dir, 1);
@@ -847,7 +868,7 @@ agg_copy(char *p, CacheVC *vc)
         if (vc->earliest_key == zero_key) {
           do {
             rand_CacheKey(&doc->key, vc->vol->mutex);
-          } while (DIR_MASK_TAG(doc->key.slice32(2)) == DIR_MASK_TAG(vc->first_key.slice32(2)));
+          } while (dir_key_tag(&doc->key) == dir_key_tag(&vc->first_key));
         } else {
           prev_CacheKey(&doc->key, &vc->earliest_key);
         }
@@ -941,7 +962,7 @@ agg_copy(char *p, CacheVC *vc)
     }
 
     doc->sync_serial  = vc->vol->header->sync_serial;
-    doc->write_serial = vc->vol->header->write_serial;
+    doc->write_serial = vc->vol->agg_write_serial();
 
     memcpy(p, doc, doc->len);
 
@@ -1047,16 +1068,25 @@ Vol::aggWrite(int event, void * /* e ATS_UNUSED */)
 
   cancel_trigger();
 
+  // every buffer is being written, the next one to complete calls back
+  if (agg_in_flight == agg_write_buffers) {
+    return EVENT_CONT;
+  }
+  // a directory sync waits for the writes in flight to be retired
+  if (dir_sync_waiting && agg_in_flight) {
+    return EVENT_CONT;
+  }
+
 Lagain:
   // calculate length of aggregated write
   for (c = static_cast<CacheVC *>(agg.head); c;) {
     int writelen = c->agg_len;
     // [amc] this is checked multiple places, on here was it strictly less.
     ink_assert(writelen <= AGG_SIZE);
-    if (agg_buf_pos + writelen > AGG_SIZE || header->write_pos + agg_buf_pos + writelen > (skip + len)) {
+    if (agg_buf_pos + writelen > AGG_SIZE || agg_write_pos() + agg_buf_pos + writelen > (skip + len)) {
       break;
     }
-    DDbg(dbg_ctl_agg_read, "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->write_pos + agg_buf_pos,
+    DDbg(dbg_ctl_agg_read, "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, agg_write_pos() + agg_buf_pos,
          c->first_key.slice32(0));
     int wrotelen = agg_copy(agg_buffer + agg_buf_pos, c);
     ink_assert(writelen == wrotelen);
@@ -1083,7 +1113,7 @@ Lagain:
     if (!agg.head && !sync.head) { // nothing to get
       return EVENT_CONT;
     }
-    if (header->write_pos == start) {
+    if (agg_write_pos() == start) {
       // write aggregation too long, bad bad, punt on everything.
       Note("write aggregation exceeds vol size");
       ink_assert(!tocall.head);
@@ -1096,14 +1126,18 @@ Lagain:
     }
     // start back
     if (agg.head) {
+      // the writes up to the end of the stripe have to retire first
+      if (agg_in_flight) {
+        return EVENT_CONT;
+      }
       agg_wrap();
       goto Lagain;
     }
   }
 
   // evacuate space
-  off_t end = header->write_pos + agg_buf_pos + EVACUATION_SIZE;
-  if (evac_range(header->write_pos, end, !header->phase) < 0) {
+  off_t end = agg_write_pos() + agg_buf_pos + EVACUATION_SIZE;
+  if (evac_range(agg_write_pos(), end, !header->phase) < 0) {
     goto Lwait;
   }
   if (end > skip + len) {
@@ -1128,25 +1162,33 @@ Lagain:
     d->magic        = DOC_MAGIC;
     d->len          = l;
     d->sync_serial  = header->sync_serial;
-    d->write_serial = header->write_serial;
+    d->write_serial = agg_write_serial();
   }
 
   // set write limit
-  header->agg_pos = header->write_pos + agg_buf_pos;
+  header->agg_pos = agg_write_pos() + agg_buf_pos;
 
-  io.aiocb.aio_fildes = fd;
-  io.aiocb.aio_offset = header->write_pos;
-  io.aiocb.aio_buf    = agg_buffer;
-  io.aiocb.aio_nbytes = agg_buf_pos;
-  io.action           = this;
-  /*
-    Callback on AIO thread so that we can issue a new write ASAP
-    as all writes are serialized in the volume.  This is not necessary
-    for reads proceed independently.
-   */
-  io.thread = AIO_CALLBACK_THREAD_AIO;
-  SET_HANDLER(&Vol::aggWriteDone);
-  ink_aio_write(&io);
+  {
+    AggWriteBuffer *w = &agg_writes[(agg_write_head + agg_in_flight) % agg_write_buffers];
+    ink_assert(w->buffer == agg_buffer && !w->done);
+    w->io.aiocb.aio_fildes = fd;
+    w->io.aiocb.aio_offset = agg_write_pos();
+    w->io.aiocb.aio_buf    = agg_buffer;
+    w->io.aiocb.aio_nbytes = agg_buf_pos;
+    w->io.action           = w;
+    /*
+      Callback on AIO thread so that we can issue a new write ASAP
+      as the writes are retired in order in the volume.  This is not necessary
+      for reads proceed independently.
+     */
+    w->io.thread = AIO_CALLBACK_THREAD_AIO;
+    // go on filling the next buffer while this one is written
+    agg_pending += agg_buf_pos;
+    agg_in_flight++;
+    agg_buf_pos = 0;
+    agg_buffer  = agg_writes[(agg_write_head + agg_in_flight) % agg_write_buffers].buffer;
+    ink_aio_write(&w->io);
+  }
 
 Lwait:
   int ret = EVENT_CONT;
@@ -1179,14 +1221,14 @@ CacheVC::openWriteCloseDir(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED *
   if (is_dbg_ctl_enabled(dbg_ctl_cache_update)) {
     if (f.update && closed > 0) {
       if (!total_len && !f.allow_empty_doc && alternate_index != CACHE_ALT_REMOVED) {
-        Dbg(dbg_ctl_cache_update, "header only %d (%" PRIu64 ", %" PRIu64 ")", DIR_MASK_TAG(first_key.slice32(2)), update_key.b[0],
+        Dbg(dbg_ctl_cache_update, "header only %u (%" PRIu64 ", %" PRIu64 ")", dir_key_tag(&first_key), update_key.b[0],
             update_key.b[1]);
 
       } else if ((total_len || f.allow_empty_doc) && alternate_index != CACHE_ALT_REMOVED) {
-        Dbg(dbg_ctl_cache_update, "header body, %d, (%" PRIu64 ", %" PRIu64 "), (%" PRIu64 ", %" PRIu64 ")",
-            DIR_MASK_TAG(first_key.slice32(2)), update_key.b[0], update_key.b[1], earliest_key.b[0], earliest_key.b[1]);
+        Dbg(dbg_ctl_cache_update, "header body, %u, (%" PRIu64 ", %" PRIu64 "), (%" PRIu64 ", %" PRIu64 ")",
+            dir_key_tag(&first_key), update_key.b[0], update_key.b[1], earliest_key.b[0], earliest_key.b[1]);
       } else if (!total_len && alternate_index == CACHE_ALT_REMOVED) {
-        Dbg(dbg_ctl_cache_update, "alt delete, %d, (%" PRIu64 ", %" PRIu64 ")", DIR_MASK_TAG(first_key.slice32(2)), update_key.b[0],
+        Dbg(dbg_ctl_cache_update, "alt delete, %u, (%" PRIu64 ", %" PRIu64 ")", dir_key_tag(&first_key), update_key.b[0],
             update_key.b[1]);
       }
     }
@@ -1259,7 +1301,7 @@ CacheVC::openWriteCloseHeadDone(int event, Event *e)
           od->single_doc_key = earliest_key;
         }
         dir_assign(&od->single_doc_dir, &dir);
-        dir_set_tag(&od->single_doc_dir, od->single_doc_key.slice32(2));
+        dir_set_tag(&od->single_doc_dir, dir_key_tag(&od->single_doc_key));
       }
     }
   }
@@ -1421,6 +1463,10 @@ CacheVC::openWriteWriteDone(int event, Event *e)
     write_pos += write_len;
     dir_insert(&key, vol, &dir);
     DDbg(dbg_ctl_cache_insert, "WriteDone: %X, %X, %d", key.slice32(0), first_key.slice32(0), write_len);
+    // readers following this writer can go on with the new fragment
+    if (od) {
+      vol->open_dir.signal_readers(this);
+    }
     blocks = iobufferblock_skip(blocks.get(), &offset, &length, write_len);
     next_CacheKey(&key, &key);
   }
@@ -1618,7 +1664,7 @@ CacheVC::openWriteStartDone(int event, Event *e)
         od->move_resident_alt = true;
         od->single_doc_key    = doc->key;
         dir_assign(&od->single_doc_dir, &dir);
-        dir_set_tag(&od->single_doc_dir, od->single_doc_key.slice32(2));
+        dir_set_tag(&od->single_doc_dir, dir_key_tag(&od->single_doc_key));
       }
       first_buf = buf;
       goto Lsuccess;
@@ -1711,6 +1757,7 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheFragType frag_ty
   }
 
   ink_assert(caches[frag_type] == this);
+  cache_tier_invalidate(this, key);
 
   intptr_t res      = 0;
   CacheVC *c        = new_CacheVC(cont);
@@ -1732,7 +1779,7 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheFragType frag_ty
    */
   do {
     rand_CacheKey(&c->key, cont->mutex);
-  } while (DIR_MASK_TAG(c->key.slice32(2)) == DIR_MASK_TAG(c->first_key.slice32(2)));
+  } while (dir_key_tag(&c->key) == dir_key_tag(&c->first_key));
   c->earliest_key     = c->key;
   c->info             = nullptr;
   c->f.overwrite      = (options & CACHE_WRITE_OPT_OVERWRITE) != 0;
@@ -1777,6 +1824,7 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheHTTPInfo *info,
   }
 
   ink_assert(caches[type] == this);
+  cache_tier_invalidate(this, key);
   intptr_t err      = 0;
   int if_writers    = (uintptr_t)info == CACHE_ALLOW_MULTIPLE_WRITES;
   CacheVC *c        = new_CacheVC(cont);
@@ -1792,7 +1840,7 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheHTTPInfo *info,
    */
   do {
     rand_CacheKey(&c->key, cont->mutex);
-  } while (DIR_MASK_TAG(c->key.slice32(2)) == DIR_MASK_TAG(c->first_key.slice32(2)));
+  } while (dir_key_tag(&c->key) == dir_key_tag(&c->first_key));
   c->earliest_key = c->key;
   c->frag_type    = CACHE_FRAG_TYPE_HTTP;
   c->vol          = key_to_vol(key, hostname, host_len);
@@ -38,15 +38,27 @@ static constexpr ts::ModuleVersion CACHE_MODULE_VERSION(1, 0);
 
 #define SCAN_KB_PER_SECOND 8192 // 1TB/8MB = 131072 = 36 HOURS to scan a TB
 
-#define RAM_CACHE_ALGORITHM_CLFUS 0
-#define RAM_CACHE_ALGORITHM_LRU   1
+#define RAM_CACHE_ALGORITHM_CLFUS  0
+#define RAM_CACHE_ALGORITHM_LRU    1
+#define RAM_CACHE_ALGORITHM_S3FIFO 2
 
 #define CACHE_COMPRESSION_NONE    0
 #define CACHE_COMPRESSION_FASTLZ  1
 #define CACHE_COMPRESSION_LIBZ    2
 #define CACHE_COMPRESSION_LIBLZMA 3
-
-enum { RAM_HIT_COMPRESS_NONE = 1, RAM_HIT_COMPRESS_FASTLZ, RAM_HIT_COMPRESS_LIBZ, RAM_HIT_COMPRESS_LIBLZMA, RAM_HIT_LAST_ENTRY };
+#define CACHE_COMPRESSION_LZ4     4
+#define CACHE_COMPRESSION_ZSTD    5
+#define CACHE_COMPRESSION_LAST    CACHE_COMPRESSION_ZSTD
+
+enum {
+  RAM_HIT_COMPRESS_NONE = 1,
+  RAM_HIT_COMPRESS_FASTLZ,
+  RAM_HIT_COMPRESS_LIBZ,
+  RAM_HIT_COMPRESS_LIBLZMA,
+  RAM_HIT_COMPRESS_LZ4,
+  RAM_HIT_COMPRESS_ZSTD,
+  RAM_HIT_LAST_ENTRY
+};
 
 struct CacheVC;
 struct CacheDisk;
@@ -61,8 +73,8 @@ using CacheHTTPInfo = HTTPInfo;
 
 struct CacheProcessor : public Processor {
   CacheProcessor()
-    : min_stripe_version(CACHE_DB_MAJOR_VERSION, CACHE_DB_MINOR_VERSION),
-      max_stripe_version(CACHE_DB_MAJOR_VERSION, CACHE_DB_MINOR_VERSION)
+    : min_stripe_version(CACHE_STRIPE_MAJOR_VERSION, CACHE_STRIPE_MINOR_VERSION),
+      max_stripe_version(CACHE_STRIPE_MAJOR_VERSION, CACHE_STRIPE_MINOR_VERSION)
 
   {
   }
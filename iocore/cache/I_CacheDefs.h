@@ -44,6 +44,12 @@ extern const ts::VersionNumber CACHE_DB_VERSION;
 static const uint8_t CACHE_DIR_MAJOR_VERSION = 18;
 static const uint8_t CACHE_DIR_MINOR_VERSION = 0;
 
+// Version of the stripe header and directory layout, stored in the stripe header.
+// Major version 25 has 16 byte directory entries with a 32 bit tag, stripes with
+// an older directory are cleared unless converted with traffic_cache_tool.
+static const uint8_t CACHE_STRIPE_MAJOR_VERSION = 25;
+static const uint8_t CACHE_STRIPE_MINOR_VERSION = 0;
+
 #define CACHE_DB_FDS 128
 
 // opcodes
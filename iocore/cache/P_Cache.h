@@ -40,3 +40,4 @@
 #include "P_CacheInternal.h"
 #include "P_CacheHosting.h"
 #include "P_CacheHttp.h"
+#include "P_CacheTier.h"
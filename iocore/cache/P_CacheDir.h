@@ -28,6 +28,12 @@
 #include "I_EventSystem.h"
 #include "I_Continuation.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <mutex>
+
 struct Vol;
 struct InterimCacheVol;
 struct CacheVC;
@@ -38,9 +44,9 @@ struct CacheVC;
 
 // Constants
 
-#define DIR_TAG_WIDTH         12
-#define DIR_MASK_TAG(_t)      ((_t) & ((1 << DIR_TAG_WIDTH) - 1))
-#define SIZEOF_DIR            10
+#define DIR_TAG_WIDTH         32
+#define DIR_TAG_KEY2_WIDTH    12 // tag bits from key slice 2, the stripe hash uses the upper bits of that slice
+#define SIZEOF_DIR            16
 #define ESTIMATED_OBJECT_SIZE 8000
 
 #define MAX_DIR_SEGMENTS        (32 * (1 << 16))
@@ -52,9 +58,19 @@ struct CacheVC;
 #define DIR_BLOCK_SHIFT(_i)     (3 * (_i))
 #define DIR_BLOCK_SIZE(_i)      (CACHE_BLOCK_SIZE << DIR_BLOCK_SHIFT(_i))
 #define DIR_SIZE_WITH_BLOCK(_i) ((1 << DIR_SIZE_WIDTH) * DIR_BLOCK_SIZE(_i))
-#define DIR_OFFSET_BITS         40
+#define DIR_OFFSET_BITS         48
 #define DIR_OFFSET_MAX          ((((off_t)1) << DIR_OFFSET_BITS) - 1)
 
+// Tag index (see dir_probe)
+#define DIR_TAG_INDEX_LANES    8
+#define DIR_TAG_INDEX_EMPTY    0
+#define DIR_TAG_INDEX_OVERFLOW 0xFFFF
+#define DIR_TAG_INDEX_LANE(_t) ((uint16_t)(0x8000 | ((_t)&0x7FFF)))
+
+// Per segment state of the incremental directory sync (see CacheSync)
+#define DIR_SYNC_DIRTY(_b) (1 << (_b)) // changed since directory copy _b was last written
+#define DIR_SYNC_WRITING   4           // part of the sync in progress
+
 #define SYNC_MAX_WRITE     (2 * 1024 * 1024)
 #define SYNC_DELAY         HRTIME_MSECONDS(500)
 #define DO_NOT_REMOVE_THIS 0
@@ -80,6 +96,9 @@ struct CacheVC;
     (_e)->w[2] = (_x)->w[2]; \
     (_e)->w[3] = (_x)->w[3]; \
     (_e)->w[4] = (_x)->w[4]; \
+    (_e)->w[5] = (_x)->w[5]; \
+    (_e)->w[6] = (_x)->w[6]; \
+    (_e)->w[7] = (_x)->w[7]; \
   } while (0)
 #define dir_assign_data(_e, _x)         \
   do {                                  \
@@ -103,12 +122,16 @@ struct CacheVC;
     (_e)->w[2] = 0;   \
     (_e)->w[3] = 0;   \
     (_e)->w[4] = 0;   \
+    (_e)->w[5] = 0;   \
+    (_e)->w[6] = 0;   \
+    (_e)->w[7] = 0;   \
   } while (0)
 #define dir_clean(_e) dir_set_offset(_e, 0)
 
 // OpenDir
 
 #define OPEN_DIR_BUCKETS 256
+#define OPEN_DIR_STRIPES 16
 
 struct EvacuationBlock;
 
@@ -116,46 +139,47 @@ struct EvacuationBlock;
 
 // INTERNAL: do not access these members directly, use the
 // accessors below (e.g. dir_offset, dir_set_offset).
-// These structures are stored in memory 2 byte aligned.
-// The accessors prevent unaligned memory access which
-// is often either less efficient or unsupported depending
-// on the processor.
+// An entry is 16 bytes so that a bucket of DIR_DEPTH entries fills a
+// cache line and no field straddles a 16 bit word. The fields are
+// always accessed as u16 to avoid byte order issues in the on disk
+// directory.
 struct Dir {
 #if DO_NOT_REMOVE_THIS
-  // THE BIT-FIELD INTERPRETATION OF THIS STRUCT WHICH HAS TO
-  // USE MACROS TO PREVENT UNALIGNED LOADS
+  // THE BIT-FIELD INTERPRETATION OF THIS STRUCT
   // bits are numbered from lowest in u16 to highest
   // always index as u16 to avoid byte order issues
-  unsigned int offset      : 24; // (0,1:0-7) 16M * 512 = 8GB
-  unsigned int big         : 2;  // (1:8-9) 512 << (3 * big)
-  unsigned int size        : 6;  // (1:10-15) 6**2 = 64, 64*512 = 32768 .. 64*256=16MB
-  unsigned int tag         : 12; // (2:0-11) 2048 / 8 entries/bucket = .4%
-  unsigned int phase       : 1;  // (2:12)
-  unsigned int head        : 1;  // (2:13) first segment in a document
-  unsigned int pinned      : 1;  // (2:14)
-  unsigned int token       : 1;  // (2:15)
-  unsigned int next        : 16; // (3)
-  unsigned int offset_high : 16; // 8GB * 65k = 0.5PB (4)
+  uint64_t offset     : 48; // (0,1,2) 2^48 * 512 = 128PB
+  unsigned int size   : 6;  // (3:0-5) 6**2 = 64, 64*512 = 32768 .. 64*256=16MB
+  unsigned int big    : 2;  // (3:6-7) 512 << (3 * big)
+  unsigned int phase  : 1;  // (3:8)
+  unsigned int head   : 1;  // (3:9) first segment in a document
+  unsigned int pinned : 1;  // (3:10)
+  unsigned int token  : 1;  // (3:11)
+  unsigned int unused : 4;  // (3:12-15)
+  unsigned int tag    : 32; // (4,5) 2^32 / 4 entries/bucket, about 1e-9 false matches per probe
+  unsigned int next   : 16; // (6)
+  unsigned int prev   : 16; // (7) free list only
 #else
-  uint16_t w[5];
+  uint16_t w[8];
   Dir() { dir_clear(this); }
 #endif
 };
 
-#define dir_offset(_e) \
-  ((int64_t)(((uint64_t)(_e)->w[0]) | (((uint64_t)((_e)->w[1] & 0xFF)) << 16) | (((uint64_t)(_e)->w[4]) << 24)))
-#define dir_set_offset(_e, _o)                                              \
-  do {                                                                      \
-    (_e)->w[0] = (uint16_t)_o;                                              \
-    (_e)->w[1] = (uint16_t)((((_o) >> 16) & 0xFF) | ((_e)->w[1] & 0xFF00)); \
-    (_e)->w[4] = (uint16_t)((_o) >> 24);                                    \
+static_assert(sizeof(Dir) == SIZEOF_DIR, "the directory is indexed in units of SIZEOF_DIR");
+
+#define dir_offset(_e) ((int64_t)(((uint64_t)(_e)->w[0]) | (((uint64_t)(_e)->w[1]) << 16) | (((uint64_t)(_e)->w[2]) << 32)))
+#define dir_set_offset(_e, _o)                       \
+  do {                                               \
+    (_e)->w[0] = (uint16_t)(_o);                     \
+    (_e)->w[1] = (uint16_t)(((uint64_t)(_o)) >> 16); \
+    (_e)->w[2] = (uint16_t)(((uint64_t)(_o)) >> 32); \
   } while (0)
 #define dir_bit(_e, _w, _b)         ((uint32_t)(((_e)->w[_w] >> (_b)) & 1))
 #define dir_set_bit(_e, _w, _b, _v) (_e)->w[_w] = (uint16_t)(((_e)->w[_w] & ~(1 << (_b))) | (((_v) ? 1 : 0) << (_b)))
-#define dir_big(_e)                 ((uint32_t)((((_e)->w[1]) >> 8) & 0x3))
-#define dir_set_big(_e, _v)         (_e)->w[1] = (uint16_t)(((_e)->w[1] & 0xFCFF) | (((uint16_t)(_v)) & 0x3) << 8)
-#define dir_size(_e)                ((uint32_t)(((_e)->w[1]) >> 10))
-#define dir_set_size(_e, _v)        (_e)->w[1] = (uint16_t)(((_e)->w[1] & ((1 << 10) - 1)) | ((_v) << 10))
+#define dir_big(_e)                 ((uint32_t)((((_e)->w[3]) >> 6) & 0x3))
+#define dir_set_big(_e, _v)         (_e)->w[3] = (uint16_t)(((_e)->w[3] & 0xFF3F) | (((uint16_t)(_v)) & 0x3) << 6)
+#define dir_size(_e)                ((uint32_t)(((_e)->w[3]) & 0x3F))
+#define dir_set_size(_e, _v)        (_e)->w[3] = (uint16_t)(((_e)->w[3] & 0xFFC0) | ((_v)&0x3F))
 #define dir_set_approx_size(_e, _s)                   \
   do {                                                \
     if ((_s) <= DIR_SIZE_WITH_BLOCK(0)) {             \
@@ -179,20 +203,23 @@ struct Dir {
      (_s <= DIR_SIZE_WITH_BLOCK(1) ?      \
         ROUND_TO(_s, DIR_BLOCK_SIZE(1)) : \
         (_s <= DIR_SIZE_WITH_BLOCK(2) ? ROUND_TO(_s, DIR_BLOCK_SIZE(2)) : ROUND_TO(_s, DIR_BLOCK_SIZE(3)))))
-#define dir_tag(_e) ((uint32_t)((_e)->w[2] & ((1 << DIR_TAG_WIDTH) - 1)))
-#define dir_set_tag(_e, _t) \
-  (_e)->w[2] = (uint16_t)(((_e)->w[2] & ~((1 << DIR_TAG_WIDTH) - 1)) | ((_t) & ((1 << DIR_TAG_WIDTH) - 1)))
-#define dir_phase(_e)          dir_bit(_e, 2, 12)
-#define dir_set_phase(_e, _v)  dir_set_bit(_e, 2, 12, _v)
-#define dir_head(_e)           dir_bit(_e, 2, 13)
-#define dir_set_head(_e, _v)   dir_set_bit(_e, 2, 13, _v)
-#define dir_pinned(_e)         dir_bit(_e, 2, 14)
-#define dir_set_pinned(_e, _v) dir_set_bit(_e, 2, 14, _v)
-// Bit 2:15 is unused.
-#define dir_next(_e)         (_e)->w[3]
-#define dir_set_next(_e, _o) (_e)->w[3] = (uint16_t)(_o)
-#define dir_prev(_e)         (_e)->w[2]
-#define dir_set_prev(_e, _o) (_e)->w[2] = (uint16_t)(_o)
+#define dir_tag(_e) ((uint32_t)(((uint32_t)(_e)->w[4]) | (((uint32_t)(_e)->w[5]) << 16)))
+#define dir_set_tag(_e, _t)                          \
+  do {                                               \
+    (_e)->w[4] = (uint16_t)(_t);                     \
+    (_e)->w[5] = (uint16_t)(((uint32_t)(_t)) >> 16); \
+  } while (0)
+#define dir_phase(_e)          dir_bit(_e, 3, 8)
+#define dir_set_phase(_e, _v)  dir_set_bit(_e, 3, 8, _v)
+#define dir_head(_e)           dir_bit(_e, 3, 9)
+#define dir_set_head(_e, _v)   dir_set_bit(_e, 3, 9, _v)
+#define dir_pinned(_e)         dir_bit(_e, 3, 10)
+#define dir_set_pinned(_e, _v) dir_set_bit(_e, 3, 10, _v)
+// Bits 3:11-15 are unused.
+#define dir_next(_e)         (_e)->w[6]
+#define dir_set_next(_e, _o) (_e)->w[6] = (uint16_t)(_o)
+#define dir_prev(_e)         (_e)->w[7]
+#define dir_set_prev(_e, _o) (_e)->w[7] = (uint16_t)(_o)
 
 // INKqa11166 - Cache can not store 2 HTTP alternates simultaneously.
 // To allow this, move the vector from the CacheVC to the OpenDirEntry.
@@ -203,7 +230,6 @@ struct Dir {
 LINK_FORWARD_DECLARATION(CacheVC, opendir_link) // forward declaration
 struct OpenDirEntry {
   DLL<CacheVC, Link_CacheVC_opendir_link> writers; // list of all the current writers
-  DLL<CacheVC, Link_CacheVC_opendir_link> readers; // list of all the current readers - not used
   CacheHTTPInfoVector vector;                      // Vector for the http document. Each writer
                                                    // maintains a pointer to this vector and
                                                    // writes it down to disk.
@@ -220,8 +246,6 @@ struct OpenDirEntry {
 
   LINK(OpenDirEntry, link);
 
-  int wait(CacheVC *c, int msec);
-
   bool
   has_multiple_writers()
   {
@@ -229,16 +253,27 @@ struct OpenDirEntry {
   }
 };
 
-struct OpenDir : public Continuation {
-  Queue<CacheVC, Link_CacheVC_opendir_link> delayed_readers;
+// The open entries are guarded by the Vol lock. Readers waiting for a writer
+// are kept by bucket here rather than on the entry, so that the entry can go
+// away while a reader which could not be woken up is still waiting. The wait
+// lists are guarded by striped locks of their own, so that a reader can leave
+// its list without the Vol lock.
+struct OpenDir {
   DLL<OpenDirEntry> bucket[OPEN_DIR_BUCKETS];
+  DLL<CacheVC, Link_CacheVC_opendir_link> waiting[OPEN_DIR_BUCKETS];
+  std::mutex stripe[OPEN_DIR_STRIPES];
 
   int open_write(CacheVC *c, int allow_if_writers, int max_writers);
   int close_write(CacheVC *c);
   OpenDirEntry *open_read(const CryptoHash *key) const;
-  int signal_readers(int event, Event *e);
-
-  OpenDir();
+  // park a reader until a writer of its object makes progress or delay passes
+  int wait(CacheVC *c, ink_hrtime delay);
+  void cancel_wait(CacheVC *c);
+  // wake the readers of the object of writer, called after it inserted a fragment
+  void signal_readers(CacheVC *writer);
+
+private:
+  void wake_readers(int b, const CryptoHash &key);
 };
 
 struct CacheSync : public Continuation {
@@ -276,16 +311,71 @@ void dir_clear_range(off_t start, off_t end, Vol *vol);
 int dir_segment_accounted(int s, Vol *vol, int offby = 0, int *free = nullptr, int *used = nullptr, int *empty = nullptr,
                           int *valid = nullptr, int *agg_valid = nullptr, int *avg_size = nullptr);
 uint64_t dir_entries_used(Vol *vol);
+void dir_tag_index_init(Vol *vol);
+void dir_tag_index_rebuild(Vol *vol);
+void dir_tag_index_rebuild_bucket(Dir *b, Dir *seg, uint16_t *lanes);
+void dir_sync_segments_init(Vol *vol);
+void dir_sync_segments_start(Vol *vol, int copy);
+void dir_sync_segments_done(Vol *vol, bool written);
+off_t dir_sync_next_dirty(Vol *vol, off_t pos, off_t end);
+int dir_sync_dirty_len(Vol *vol, off_t pos, int len);
 void sync_cache_dir_on_shutdown();
 
 // Inline Functions
 
 #define dir_in_seg(_s, _i) ((Dir *)(((char *)(_s)) + (SIZEOF_DIR * (_i))))
 
+// The tag of key in the directory. Only the low bits of key slice 2 are used because
+// the rest of that slice selects the stripe, so those bits are the same for all the
+// keys in a stripe. Slice 3 is not used to place an entry and supplies the others.
+inline uint32_t
+dir_key_tag(const CacheKey *key)
+{
+  return (key->slice32(2) & ((1 << DIR_TAG_KEY2_WIDTH) - 1)) | (key->slice32(3) << DIR_TAG_KEY2_WIDTH);
+}
+
 inline bool
 dir_compare_tag(const Dir *e, const CacheKey *key)
 {
-  return (dir_tag(e) == DIR_MASK_TAG(key->slice32(2)));
+  return dir_tag(e) == dir_key_tag(key);
+}
+
+// Returns true if the tag may be present in the bucket chain summarized by @a lanes.
+// False positives are possible, false negatives are not.
+inline bool
+dir_tag_index_match(const uint16_t *lanes, uint32_t tag)
+{
+#if defined(__SSE2__)
+  __m128i v = _mm_load_si128(reinterpret_cast<const __m128i *>(lanes));
+  __m128i m = _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16(DIR_TAG_INDEX_LANE(tag))),
+                           _mm_cmpeq_epi16(v, _mm_set1_epi16(static_cast<short>(DIR_TAG_INDEX_OVERFLOW))));
+  return _mm_movemask_epi8(m) != 0;
+#else
+  uint16_t t = DIR_TAG_INDEX_LANE(tag);
+  for (int i = 0; i < DIR_TAG_INDEX_LANES; i++) {
+    if (lanes[i] == t || lanes[i] == DIR_TAG_INDEX_OVERFLOW) {
+      return true;
+    }
+  }
+  return false;
+#endif
+}
+
+inline void
+dir_tag_index_add(uint16_t *lanes, uint32_t tag)
+{
+  uint16_t t = DIR_TAG_INDEX_LANE(tag);
+  for (int i = 0; i < DIR_TAG_INDEX_LANES; i++) {
+    if (lanes[i] == t || lanes[i] == DIR_TAG_INDEX_OVERFLOW) {
+      return;
+    }
+    if (lanes[i] == DIR_TAG_INDEX_EMPTY) {
+      lanes[i] = t;
+      return;
+    }
+  }
+  // more distinct tags than lanes, always walk this chain until it is rebuilt
+  lanes[DIR_TAG_INDEX_LANES - 1] = DIR_TAG_INDEX_OVERFLOW;
 }
 
 inline Dir *
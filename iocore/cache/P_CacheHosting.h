@@ -37,7 +37,7 @@ struct CacheHostResult;
 struct Cache;
 
 struct CacheHostRecord {
-  int Init(CacheType typ);
+  int Init(CacheType typ, bool fast_tier = false);
   int Init(matcher_line *line_info, CacheType typ);
 
   void UpdateMatch(CacheHostResult *r);
@@ -251,6 +251,7 @@ public:
   Cache *cache     = nullptr;
   int m_numEntries = 0;
   CacheHostRecord gen_host_rec;
+  CacheHostRecord fast_host_rec; // volumes of the fast tier, empty without tiering
 
 private:
   CacheHostMatcher *hostMatch    = nullptr;
@@ -297,6 +298,7 @@ struct ConfigVol {
   off_t size;
   bool in_percent;
   bool ramcache_enabled;
+  bool fast_tier;
   int percent;
   CacheVol *cachep;
   LINK(ConfigVol, link);
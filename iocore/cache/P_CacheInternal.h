@@ -85,6 +85,7 @@ struct EvacuationBlock;
 
 #define CONT_SCHED_LOCK_RETRY(_c) _c->mutex->thread_holding->schedule_in_local(_c, HRTIME_MSECONDS(cache_config_mutex_retry_delay))
 
+// wait for the writer, which wakes the reader up when it inserts a fragment or closes
 #define VC_SCHED_WRITER_RETRY()                                           \
   do {                                                                    \
     ink_assert(!trigger);                                                 \
@@ -92,8 +93,7 @@ struct EvacuationBlock;
     ink_hrtime _t = HRTIME_MSECONDS(cache_read_while_writer_retry_delay); \
     if (writer_lock_retry > 2)                                            \
       _t = HRTIME_MSECONDS(cache_read_while_writer_retry_delay) * 2;      \
-    trigger = mutex->thread_holding->schedule_in_local(this, _t);         \
-    return EVENT_CONT;                                                    \
+    return vol->open_dir.wait(this, _t);                                  \
   } while (0)
 
 // cache stats definitions
@@ -149,6 +149,34 @@ enum {
   cache_directory_sync_count_stat,
   cache_directory_sync_time_stat,
   cache_directory_sync_bytes_stat,
+  /* RAM cache compression counters, one group per CACHE_COMPRESSION_* type */
+  cache_ram_cache_fastlz_bytes_in_stat,
+  cache_ram_cache_fastlz_bytes_out_stat,
+  cache_ram_cache_fastlz_compress_time_stat,
+  cache_ram_cache_fastlz_decompress_time_stat,
+  cache_ram_cache_libz_bytes_in_stat,
+  cache_ram_cache_libz_bytes_out_stat,
+  cache_ram_cache_libz_compress_time_stat,
+  cache_ram_cache_libz_decompress_time_stat,
+  cache_ram_cache_liblzma_bytes_in_stat,
+  cache_ram_cache_liblzma_bytes_out_stat,
+  cache_ram_cache_liblzma_compress_time_stat,
+  cache_ram_cache_liblzma_decompress_time_stat,
+  cache_ram_cache_lz4_bytes_in_stat,
+  cache_ram_cache_lz4_bytes_out_stat,
+  cache_ram_cache_lz4_compress_time_stat,
+  cache_ram_cache_lz4_decompress_time_stat,
+  cache_ram_cache_zstd_bytes_in_stat,
+  cache_ram_cache_zstd_bytes_out_stat,
+  cache_ram_cache_zstd_compress_time_stat,
+  cache_ram_cache_zstd_decompress_time_stat,
+  /* tiered cache counters */
+  cache_tier_fast_hit_stat,
+  cache_tier_capacity_hit_stat,
+  cache_tier_promote_active_stat,
+  cache_tier_promote_success_stat,
+  cache_tier_promote_failure_stat,
+  cache_tier_demote_stat,
   /* AIO read/write error counters */
   cache_span_errors_read_stat,
   cache_span_errors_write_stat,
@@ -166,6 +194,10 @@ extern RecRawStatBlock *cache_rsb;
 
 #define GLOBAL_CACHE_SET_DYN_STAT(x, y) RecSetGlobalRawStatSum(cache_rsb, (x), (y))
 
+#define CACHE_RAM_CACHE_COMPRESS_STATS 4
+#define CACHE_RAM_CACHE_COMPRESS_STAT(_ctype, _field) \
+  (cache_ram_cache_fastlz_##_field##_stat + ((_ctype)-CACHE_COMPRESSION_FASTLZ) * CACHE_RAM_CACHE_COMPRESS_STATS)
+
 #define CACHE_SET_DYN_STAT(x, y) \
   RecSetGlobalRawStatSum(cache_rsb, (x), (y)) RecSetGlobalRawStatSum(vol->cache_vol->vol_rsb, (x), (y))
 
@@ -210,6 +242,11 @@ extern RecRawStatBlock *cache_rsb;
 
 // Configuration
 extern int cache_config_dir_sync_frequency;
+extern int cache_config_dir_tag_index;
+extern int cache_config_dir_load_parallel;
+extern int cache_config_dir_sync_incremental;
+extern int cache_config_tier_promote_hits;
+extern int cache_config_tier_promote_max_inflight;
 extern int cache_config_http_max_alts;
 extern int cache_config_log_alternate_eviction;
 extern int cache_config_permit_pinning;
@@ -217,12 +254,14 @@ extern int cache_config_select_alternate;
 extern int cache_config_max_doc_size;
 extern int cache_config_min_average_object_size;
 extern int cache_config_agg_write_backlog;
+extern int cache_config_agg_write_buffers;
 extern int cache_config_enable_checksum;
 extern int cache_config_alt_rewrite_max_size;
 extern int cache_config_read_while_writer;
 extern int cache_config_agg_write_backlog;
 extern int cache_config_ram_cache_compress;
 extern int cache_config_ram_cache_compress_percent;
+extern int cache_config_ram_cache_compress_threads;
 extern int cache_config_ram_cache_use_seen_filter;
 extern int cache_config_hit_evacuate_percent;
 extern int cache_config_hit_evacuate_size_limit;
@@ -256,7 +295,7 @@ struct CacheVC : public CacheVConnection {
   get_header(void **ptr, int *len) override
   {
     if (first_buf) {
-      Doc *doc = (Doc *)first_buf->data();
+      Doc *doc = (Doc *)(data_buf && first_buf == buf ? data_buf : first_buf)->data();
       *ptr     = doc->hdr();
       *len     = doc->hlen;
       return 0;
@@ -324,6 +363,7 @@ struct CacheVC : public CacheVConnection {
   int handleReadDone(int event, Event *e);
   int handleRead(int event, Event *e);
   int do_read_call(CacheKey *akey);
+  void unshare_doc();
   int handleWrite(int event, Event *e);
   int handleWriteLock(int event, Event *e);
   int do_write_call();
@@ -367,6 +407,11 @@ struct CacheVC : public CacheVConnection {
   int scanOpenWrite(int event, Event *e);
   int scanRemoveDone(int event, Event *e);
 
+  int tierPromoteEvent(int event, Event *e);
+  int tierPromoteReadDone(int event, Event *e);
+  int tierPromoteCopyDone(int event, Event *e);
+  bool tier_read_fallback();
+
   int
   is_io_in_progress()
   {
@@ -430,6 +475,7 @@ struct CacheVC : public CacheVConnection {
   CacheHTTPInfoVector vector;
   CacheHTTPInfo alternate;
   Ptr<IOBufferData> buf;
+  Ptr<IOBufferData> data_buf; // the shared fragment the body is read from, when buf only copies its headers
   Ptr<IOBufferData> first_buf;
   Ptr<IOBufferBlock> blocks; // data available to write
   Ptr<IOBufferBlock> writer_buf;
@@ -487,6 +533,8 @@ struct CacheVC : public CacheVConnection {
   int header_to_write_len;
   void *header_to_write;
   short writer_lock_retry;
+  Vol *tier_src;       // capacity tier stripe of a read served by the fast tier, the source of a promotion
+  uint32_t tier_epoch; // invalidation epoch of the object when its promotion started
   union {
     uint32_t flags;
     struct {
@@ -511,6 +559,7 @@ struct CacheVC : public CacheVConnection {
       unsigned int hit_evacuate            : 1;
       unsigned int compressed_in_ram       : 1; // compressed state in ram cache
       unsigned int allow_empty_doc         : 1; // used for cache empty http document
+      unsigned int waiting_for_writer      : 1; // on an OpenDir waiting list, only changed by the holder of the mutex
     } f;
   };
   // BTF optimization used to skip reading stuff in cache partition that doesn't contain any
@@ -549,6 +598,7 @@ extern CacheSync *cacheDirSync;
 int cache_write(CacheVC *, CacheHTTPInfoVector *);
 int get_alternate_index(CacheHTTPInfoVector *cache_vector, CacheKey key);
 CacheVC *new_DocEvacuator(int nbytes, Vol *vol);
+IOBufferData *cache_doc_copy(IOBufferData *data, bool headers_only);
 
 // inline Functions
 
@@ -590,6 +640,9 @@ free_CacheVC(CacheVC *cont)
   if (cont->trigger) {
     cont->trigger->cancel();
   }
+  if (cont->f.waiting_for_writer) {
+    vol->open_dir.cancel_wait(cont);
+  }
   ink_assert(!cont->is_io_in_progress());
   ink_assert(!cont->od);
   cont->io.action = nullptr;
@@ -609,6 +662,7 @@ free_CacheVC(CacheVC *cont)
   cont->_action.mutex.clear();
   cont->mutex.clear();
   cont->buf.clear();
+  cont->data_buf.clear();
   cont->first_buf.clear();
   cont->blocks.clear();
   cont->writer_buf.clear();
@@ -680,6 +734,9 @@ CacheVC::cancel_trigger()
     trigger->cancel_action();
     trigger = nullptr;
   }
+  if (f.waiting_for_writer) {
+    vol->open_dir.cancel_wait(this);
+  }
 }
 
 inline int
@@ -983,6 +1040,7 @@ struct Cache {
   int64_t cache_size        = 0; // in store block size
   int total_initialized_vol = 0;
   CacheType scheme          = CACHE_NONE_TYPE;
+  bool fast_tier            = false; // some volumes are configured as a fast tier
 
   ReplaceablePtr<CacheHostTable> hosttable;
 
@@ -1010,6 +1068,7 @@ struct Cache {
   int open_done();
 
   Vol *key_to_vol(const CacheKey *key, const char *hostname, int host_len);
+  Vol *key_to_fast_vol(const CacheKey *key);
 
   Cache() {}
 };
@@ -0,0 +1,83 @@
+/** @file
+
+  Tiered storage: hot objects of the capacity tier are copied into a fast tier.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "I_Cache.h"
+
+struct Vol;
+class Cache;
+
+// Approximate read frequency of cache objects, a count-min sketch of
+// saturating 4 bit counters. All counters are halved once the number of
+// additions reaches ten times the width of a row, so the estimate follows
+// the recent popularity of an object instead of its lifetime total.
+// Updates are lock free and may lose an increment under contention,
+// which only delays a promotion.
+class CacheTierSketch
+{
+public:
+  static constexpr int ROWS          = 4;
+  static constexpr int COUNTER_MAX   = 15;
+  static constexpr int DEFAULT_WIDTH = 16; // log2 of the counters per row
+
+  explicit CacheTierSketch(int width_bits = DEFAULT_WIDTH);
+
+  // count one more read of key, returns the new estimate
+  int add(const CacheKey *key);
+  int estimate(const CacheKey *key) const;
+
+  uint64_t
+  sample_size() const
+  {
+    return sample;
+  }
+
+private:
+  std::atomic<uint8_t> &
+  counter(int row, const CacheKey *key) const
+  {
+    return counters[(static_cast<uint64_t>(row) << width) + (key->slice32(row) & mask)];
+  }
+  void age();
+
+  int width;
+  uint32_t mask;
+  uint64_t sample;
+  std::atomic<uint64_t> additions{0};
+  std::unique_ptr<std::atomic<uint8_t>[]> counters;
+};
+
+// Choose the stripe an open_read or lookup of key starts from. If the fast tier
+// holds a copy, vol is switched to the fast stripe and the capacity stripe to
+// fall back to is returned, otherwise nullptr. Reads from the capacity tier feed
+// the popularity sketch and may start a promotion of key.
+Vol *cache_tier_read_vol(Cache *cache, const CacheKey *key, Vol **vol);
+
+// Drop the fast tier copy of key, called before the object is written or removed.
+// If the fast stripe is busy the copy is dropped later, reads of key skip the fast
+// tier until then.
+void cache_tier_invalidate(Cache *cache, const CacheKey *key);
@@ -41,6 +41,7 @@
 #define AGG_SIZE                     (4 * 1024 * 1024) // 4MB
 #define AGG_HIGH_WATER               (AGG_SIZE / 2)    // 2MB
 #define EVACUATION_SIZE              (2 * AGG_SIZE)    // 8MB
+#define AGG_WRITE_BUFFERS_MAX        4                 // aggregation writes a stripe may have in flight
 #define MAX_VOL_SIZE                 ((off_t)512 * 1024 * 1024 * 1024 * 1024)
 #define MAX_VOL_BLOCKS               (MAX_VOL_SIZE / CACHE_BLOCK_SIZE)
 #define MAX_FRAG_SIZE                (AGG_SIZE - sizeof(Doc)) // true max
@@ -120,6 +121,20 @@ struct EvacuationBlock {
   LINK(EvacuationBlock, link);
 };
 
+// An aggregation buffer and the write which puts it on disk. A stripe fills one
+// buffer while the ones before it are written, the writes may complete in any
+// order but are retired in the order they were issued (see Vol::aggWriteDone).
+struct AggWriteBuffer : public Continuation {
+  Vol *vol     = nullptr;
+  char *buffer = nullptr;
+  bool done    = false; // written, waiting for the writes before it to retire
+  AIOCallbackInternal io;
+
+  int handle_write_done(int event, void *data);
+
+  AggWriteBuffer() : Continuation(nullptr) { SET_HANDLER(&AggWriteBuffer::handle_write_done); }
+};
+
 struct Vol : public Continuation {
   char *path = nullptr;
   ats_scoped_str hash_text;
@@ -130,6 +145,8 @@ struct Vol : public Continuation {
   Dir *dir                = nullptr;
   VolHeaderFooter *header = nullptr;
   VolHeaderFooter *footer = nullptr;
+  uint16_t *dir_tags      = nullptr; // optional in memory tag index, DIR_TAG_INDEX_LANES per bucket
+  uint8_t *dir_sync_segs  = nullptr; // DIR_SYNC_* state per segment, only with an incremental sync
   int segments            = 0;
   off_t buckets           = 0;
   off_t recover_pos       = 0;
@@ -145,10 +162,16 @@ struct Vol : public Continuation {
   Queue<CacheVC, Continuation::Link_link> agg;
   Queue<CacheVC, Continuation::Link_link> stat_cache_vcs;
   Queue<CacheVC, Continuation::Link_link> sync;
-  char *agg_buffer  = nullptr;
+  char *agg_buffer  = nullptr; // the buffer being filled
   int agg_todo_size = 0;
   int agg_buf_pos   = 0;
 
+  AggWriteBuffer agg_writes[AGG_WRITE_BUFFERS_MAX];
+  int agg_write_buffers = 1; // buffers in use, from proxy.config.cache.agg_write_buffers
+  int agg_write_head    = 0; // the oldest write in flight
+  int agg_in_flight     = 0; // writes issued and not retired yet
+  int agg_pending       = 0; // bytes of the writes in flight
+
   Event *trigger = nullptr;
 
   OpenDir open_dir;
@@ -195,9 +218,11 @@ struct Vol : public Continuation {
   int clear_dir();
 
   int init(char *s, off_t blocks, off_t dir_skip, bool clear);
+  void read_dir();
 
   int handle_dir_clear(int event, void *data);
   int handle_dir_read(int event, void *data);
+  int handle_dir_read_chunk(int event, void *data);
   int handle_recover_from_data(int event, void *data);
   int handle_recover_write_dir(int event, void *data);
   int handle_header_read(int event, void *data);
@@ -211,9 +236,12 @@ struct Vol : public Continuation {
   int is_io_in_progress() const;
   void set_io_not_in_progress();
 
-  int aggWriteDone(int event, Event *e);
+  int aggWriteDone(AggWriteBuffer *w);
   int aggWrite(int event, void *e);
   void agg_wrap();
+  off_t agg_write_pos() const;        // the stripe offset of agg_buffer
+  uint32_t agg_write_serial() const;  // the write_serial of the documents copied into agg_buffer
+  char *agg_buffer_at(off_t o) const; // the aggregation buffer memory of stripe offset o
 
   int evacuateWrite(CacheVC *evacuator, int event, Event *e);
   int evacuateDocReadDone(int event, Event *e);
@@ -229,10 +257,12 @@ struct Vol : public Continuation {
   uint32_t round_to_approx_size(uint32_t l) const;
 
   // inline functions
-  int headerlen() const;         // calculates the total length of the vol header and the freelist
-  int direntries() const;        // total number of dir entries
-  Dir *dir_segment(int s) const; // returns the first dir in the segment s
-  size_t dirlen() const;         // calculates the total length of header, directories and footer
+  int headerlen() const;                           // calculates the total length of the vol header and the freelist
+  int direntries() const;                          // total number of dir entries
+  Dir *dir_segment(int s) const;                   // returns the first dir in the segment s
+  uint16_t *dir_tag_index(int s, int64_t b) const; // returns the tag index lanes of bucket b in segment s
+  void dir_segment_dirty(int s);                   // notes a change of segment s for the incremental sync
+  size_t dirlen() const;                           // calculates the total length of header, directories and footer
   int vol_out_of_phase_valid(Dir *e) const;
 
   int vol_out_of_phase_agg_valid(Dir *e) const;
@@ -247,13 +277,22 @@ struct Vol : public Continuation {
 
   Vol() : Continuation(new_ProxyMutex())
   {
-    open_dir.mutex = mutex;
-    agg_buffer     = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
+    agg_buffer = agg_writes[0].buffer = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
     memset(agg_buffer, 0, AGG_SIZE);
     SET_HANDLER(&Vol::aggWrite);
   }
 
-  ~Vol() override { ats_free(agg_buffer); }
+  ~Vol() override
+  {
+    for (auto &w : agg_writes) {
+      if (w.buffer) {
+        ink_aio_unregister_buffer(w.buffer);
+      }
+      ats_free(w.buffer);
+    }
+    ats_free(dir_tags);
+    ats_free(dir_sync_segs);
+  }
 };
 
 struct AIO_Callback_handler : public Continuation {
@@ -268,6 +307,7 @@ struct CacheVol {
   off_t size            = 0;
   int num_vols          = 0;
   bool ramcache_enabled = true;
+  bool fast_tier        = false; // holds copies of hot objects promoted from the other volumes
   Vol **vols            = nullptr;
   DiskVol **disk_vols   = nullptr;
   LINK(CacheVol, link);
@@ -334,6 +374,20 @@ Vol::dir_segment(int s) const
   return (Dir *)(((char *)this->dir) + (s * this->buckets) * DIR_DEPTH * SIZEOF_DIR);
 }
 
+inline uint16_t *
+Vol::dir_tag_index(int s, int64_t b) const
+{
+  return this->dir_tags + (s * this->buckets + b) * DIR_TAG_INDEX_LANES;
+}
+
+inline void
+Vol::dir_segment_dirty(int s)
+{
+  if (this->dir_sync_segs) {
+    this->dir_sync_segs[s] |= DIR_SYNC_DIRTY(0) | DIR_SYNC_DIRTY(1);
+  }
+}
+
 inline size_t
 Vol::dirlen() const
 {
@@ -368,7 +422,7 @@ Vol::vol_out_of_phase_write_valid(Dir *e) const
 inline int
 Vol::vol_in_phase_valid(Dir *e) const
 {
-  return (dir_offset(e) - 1 < ((this->header->write_pos + this->agg_buf_pos - this->start) / CACHE_BLOCK_SIZE));
+  return (dir_offset(e) - 1 < ((this->agg_write_pos() + this->agg_buf_pos - this->start) / CACHE_BLOCK_SIZE));
 }
 
 inline off_t
@@ -392,7 +446,34 @@ Vol::vol_offset_to_offset(off_t pos) const
 inline int
 Vol::vol_in_phase_agg_buf_valid(Dir *e) const
 {
-  return (this->vol_offset(e) >= this->header->write_pos && this->vol_offset(e) < (this->header->write_pos + this->agg_buf_pos));
+  return (this->vol_offset(e) >= this->header->write_pos && this->vol_offset(e) < (this->agg_write_pos() + this->agg_buf_pos));
+}
+
+inline off_t
+Vol::agg_write_pos() const
+{
+  return this->header->write_pos + this->agg_pending;
+}
+
+inline uint32_t
+Vol::agg_write_serial() const
+{
+  // every write in flight bumps the serial when it is retired
+  return this->header->write_serial + this->agg_in_flight;
+}
+
+inline char *
+Vol::agg_buffer_at(off_t o) const
+{
+  off_t pos = this->header->write_pos;
+  for (int i = 0; i < this->agg_in_flight; i++) {
+    const AggWriteBuffer *w = &this->agg_writes[(this->agg_write_head + i) % this->agg_write_buffers];
+    if (o < pos + static_cast<off_t>(w->io.aiocb.aio_nbytes)) {
+      return w->buffer + (o - pos);
+    }
+    pos += w->io.aiocb.aio_nbytes;
+  }
+  return this->agg_buffer + (o - pos);
 }
 
 // length of the partition not including the offset of location 0.
@@ -491,8 +572,9 @@ Vol::open_read(const CryptoHash *key) const
 inline int
 Vol::within_hit_evacuate_window(Dir *xdir) const
 {
-  off_t oft       = dir_offset(xdir) - 1;
-  off_t write_off = (header->write_pos + AGG_SIZE - start) / CACHE_BLOCK_SIZE;
+  off_t oft = dir_offset(xdir) - 1;
+  // the aggregation buffers in flight and the one being filled are all ahead of write_pos
+  off_t write_off = (header->write_pos + agg_write_buffers * AGG_SIZE - start) / CACHE_BLOCK_SIZE;
   off_t delta     = oft - write_off;
   if (delta >= 0)
     return delta < hit_evacuate_window;
@@ -36,9 +36,22 @@ public:
   virtual int fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey)                         = 0;
   virtual int64_t size() const                                                                               = 0;
 
+  // Look up a document fragment by key alone, without the Vol mutex. A fragment key is never
+  // reused for other content, so the entry is valid wherever the fragment is on disk.
+  // Returns 0 if not found or if the cache can only be used under the Vol mutex.
+  virtual int
+  get_fragment(const CryptoHash * /* key ATS_UNUSED */, Ptr<IOBufferData> * /* ret_data ATS_UNUSED */)
+  {
+    return 0;
+  }
+
   virtual void init(int64_t max_bytes, Vol *vol) = 0;
   virtual ~RamCache(){};
 };
 
 RamCache *new_RamCacheLRU();
 RamCache *new_RamCacheCLFUS();
+RamCache *new_RamCacheS3FIFO();
+
+// Start the dedicated RAM cache compression threads, if configured.
+void ram_cache_compress_start(size_t stacksize);
@@ -26,6 +26,7 @@
 
 #include "P_Cache.h"
 #include "I_Tasks.h"
+#include "tscore/Regression.h"
 #include "fastlz/fastlz.h"
 #ifdef HAVE_ZLIB_H
 #include <zlib.h>
@@ -33,12 +34,21 @@
 #ifdef HAVE_LZMA_H
 #include <lzma.h>
 #endif
+#ifdef HAVE_LZ4_H
+#include <lz4.h>
+#endif
+#ifdef HAVE_ZSTD_H
+#include <mutex>
+#include <zstd.h>
+#include "swoc/swoc_file.h"
+#endif
 
 #define REQUIRED_COMPRESSION 0.9 // must get to this size or declared incompressible
 #define REQUIRED_SHRINK      0.8 // must get to this size or keep original buffer (with padding)
 #define HISTORY_HYSTERIA     10  // extra temporary history
 #define ENTRY_OVERHEAD       256 // per-entry overhead to consider when computing cache value/size
 #define LZMA_BASE_MEMLIMIT   (64 * 1024 * 1024)
+#define DECOMPRESS_SAMPLE    16 // time one decompression in this many, the stat is scaled up
 // #define CHECK_ACOUNTING 1 // very expensive double checking of all sizes
 
 #define REQUEUE_HITS(_h)              ((_h) ? ((_h)-1) : 0)
@@ -60,6 +70,90 @@ DbgCtl dbg_ctl_ram_cache_compare{"ram_cache_compare"};
 
 #endif
 
+namespace
+{
+// Threads which compress the RAM cache entries, ET_TASK unless
+// proxy.config.cache.ram_cache.compress_threads asks for a group of their own.
+EventType ET_RAM_COMPRESS   = ET_CALL;
+bool ram_compress_dedicated = false;
+
+// CPU time used by the calling thread, charged to the per algorithm stats
+ink_hrtime
+ram_cache_cpu_time()
+{
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+    return 0;
+  }
+  return ink_hrtime_from_timespec(&ts);
+}
+
+// Hits are far more frequent than compressions, so only a sample of them pays for the clock.
+bool
+ram_cache_sample_decompress()
+{
+  static thread_local unsigned n = 0;
+  return n++ % DECOMPRESS_SAMPLE == 0;
+}
+
+#ifdef HAVE_ZSTD_H
+// A dictionary trained on typical responses (zstd --train) lets zstd find
+// redundancy across objects, which matters for the many small text bodies.
+// The RAM cache is not persistent, so the dictionary may change on restart.
+ZSTD_CDict *zstd_cdict = nullptr;
+ZSTD_DDict *zstd_ddict = nullptr;
+std::once_flag zstd_dict_once;
+
+void
+zstd_load_dictionary()
+{
+  std::string path = RecConfigReadConfigPath("proxy.config.cache.ram_cache.compress_dictionary");
+  if (path.empty()) {
+    return;
+  }
+  std::error_code ec;
+  std::string dict = swoc::file::load(swoc::file::path(path), ec);
+  if (ec || dict.empty()) {
+    Warning("unable to load RAM cache zstd dictionary '%s', compressing without it", path.c_str());
+    return;
+  }
+  zstd_cdict = ZSTD_createCDict(dict.data(), dict.size(), ZSTD_CLEVEL_DEFAULT);
+  zstd_ddict = ZSTD_createDDict(dict.data(), dict.size());
+  if (!zstd_cdict || !zstd_ddict) {
+    Warning("invalid RAM cache zstd dictionary '%s', compressing without it", path.c_str());
+    ZSTD_freeCDict(zstd_cdict);
+    ZSTD_freeDDict(zstd_ddict);
+    zstd_cdict = nullptr;
+    zstd_ddict = nullptr;
+    return;
+  }
+  Note("loaded RAM cache zstd dictionary '%s' (%zu bytes)", path.c_str(), dict.size());
+}
+
+// contexts are kept per thread, the compressor and readers run on many threads
+size_t
+zstd_compress(char *dst, size_t dst_len, const char *src, size_t src_len)
+{
+  thread_local ZSTD_CCtx *cctx = ZSTD_createCCtx();
+  if (zstd_cdict) {
+    return ZSTD_compress_usingCDict(cctx, dst, dst_len, src, src_len, zstd_cdict);
+  }
+  return ZSTD_compressCCtx(cctx, dst, dst_len, src, src_len, ZSTD_CLEVEL_DEFAULT);
+}
+
+size_t
+zstd_decompress(char *dst, size_t dst_len, const char *src, size_t src_len)
+{
+  thread_local ZSTD_DCtx *dctx = ZSTD_createDCtx();
+  if (zstd_ddict) {
+    return ZSTD_decompress_usingDDict(dctx, dst, dst_len, src, src_len, zstd_ddict);
+  }
+  return ZSTD_decompressDCtx(dctx, dst, dst_len, src, src_len);
+}
+#endif
+
+} // end anonymous namespace
+
 struct RamCacheCLFUSEntry {
   CryptoHash key;
   uint64_t auxkey;
@@ -164,6 +258,16 @@ RamCacheCLFUSCompressor::mainEvent(int /* event ATS_UNUSED */, Event *e)
   case CACHE_COMPRESSION_LIBLZMA:
 #ifndef HAVE_LZMA_H
     Warning("lzma not available for RAM cache compression");
+#endif
+    break;
+  case CACHE_COMPRESSION_LZ4:
+#ifndef HAVE_LZ4_H
+    Warning("lz4 not available for RAM cache compression");
+#endif
+    break;
+  case CACHE_COMPRESSION_ZSTD:
+#ifndef HAVE_ZSTD_H
+    Warning("zstd not available for RAM cache compression");
 #endif
     break;
   }
@@ -218,7 +322,23 @@ RamCacheCLFUS::init(int64_t abytes, Vol *avol)
   }
   this->_resize_hashtable();
   if (cache_config_ram_cache_compress) {
-    eventProcessor.schedule_every(new RamCacheCLFUSCompressor(this), HRTIME_SECOND, ET_TASK);
+#ifdef HAVE_ZSTD_H
+    if (cache_config_ram_cache_compress == CACHE_COMPRESSION_ZSTD) {
+      std::call_once(zstd_dict_once, zstd_load_dictionary);
+    }
+#endif
+    eventProcessor.schedule_every(new RamCacheCLFUSCompressor(this), HRTIME_SECOND,
+                                  ram_compress_dedicated ? ET_RAM_COMPRESS : ET_TASK);
+  }
+}
+
+void
+ram_cache_compress_start(size_t stacksize)
+{
+  int n_threads = cache_config_ram_cache_compress_threads;
+  if (cache_config_ram_cache_compress && n_threads > 0) {
+    ET_RAM_COMPRESS        = eventProcessor.spawn_event_threads("ET_RAM_COMPRESS", n_threads, stacksize);
+    ram_compress_dedicated = true;
   }
 }
 
@@ -259,14 +379,17 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
     if (e->key == *key && e->auxkey == auxkey) {
       this->_move_compressed(e);
       if (!e->flag_bits.lru) { // in memory
-        if (CACHE_VALUE(e) > this->_average_value) {
+        bool hot = CACHE_VALUE(e) > this->_average_value;
+        if (hot) {
           this->_lru[e->flag_bits.lru].remove(e);
           this->_lru[e->flag_bits.lru].enqueue(e);
         }
         e->hits++;
         uint32_t ram_hit_state = RAM_HIT_COMPRESS_NONE;
         if (e->flag_bits.compressed) {
-          b = static_cast<char *>(ats_malloc(e->len));
+          b              = static_cast<char *>(ats_malloc(e->len));
+          bool sampled   = ram_cache_sample_decompress();
+          ink_hrtime cpu = sampled ? ram_cache_cpu_time() : 0;
           switch (e->flag_bits.compressed) {
           default:
             goto Lfailed;
@@ -301,14 +424,40 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
             break;
           }
 #endif
+#ifdef HAVE_LZ4_H
+          case CACHE_COMPRESSION_LZ4: {
+            int l = static_cast<int>(e->len);
+            if (l != LZ4_decompress_safe(e->data->data(), b, e->compressed_len, l)) {
+              goto Lfailed;
+            }
+            ram_hit_state = RAM_HIT_COMPRESS_LZ4;
+            break;
+          }
+#endif
+#ifdef HAVE_ZSTD_H
+          case CACHE_COMPRESSION_ZSTD: {
+            if (e->len != zstd_decompress(b, e->len, e->data->data(), e->compressed_len)) {
+              goto Lfailed;
+            }
+            ram_hit_state = RAM_HIT_COMPRESS_ZSTD;
+            break;
+          }
+#endif
+          }
+          if (sampled) {
+            CACHE_SUM_DYN_STAT_THREAD(CACHE_RAM_CACHE_COMPRESS_STAT(e->flag_bits.compressed, decompress_time),
+                                      (ram_cache_cpu_time() - cpu) * DECOMPRESS_SAMPLE);
           }
           IOBufferData *data = new_xmalloc_IOBufferData(b, e->len);
           data->_mem_type    = DEFAULT_ALLOC;
-          if (!e->flag_bits.copy) { // don't bother if we have to copy anyway
-            int64_t delta  = (static_cast<int64_t>(e->compressed_len)) - static_cast<int64_t>(e->size);
+          // A hot entry keeps the decompressed data, so that it is decompressed once rather
+          // than on every hit. It was just requeued at the tail, the compressor gets back to
+          // it once it ages. A cold entry stays compressed, its hits are rare.
+          if (hot && !e->flag_bits.copy) {
+            int64_t delta  = static_cast<int64_t>(e->len) - static_cast<int64_t>(e->size);
             this->_bytes  += delta;
             CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, delta);
-            e->size = e->compressed_len;
+            e->size = e->len;
             check_accounting(this);
             e->flag_bits.compressed = 0;
             e->data                 = data;
@@ -463,6 +612,16 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
       case CACHE_COMPRESSION_LIBLZMA:
         l = e->len;
         break;
+#endif
+#ifdef HAVE_LZ4_H
+      case CACHE_COMPRESSION_LZ4:
+        l = static_cast<uint32_t>(LZ4_compressBound(e->len));
+        break;
+#endif
+#ifdef HAVE_ZSTD_H
+      case CACHE_COMPRESSION_ZSTD:
+        l = static_cast<uint32_t>(ZSTD_compressBound(e->len));
+        break;
 #endif
       }
       // store transient data for lock release
@@ -470,14 +629,14 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
       uint32_t elen           = e->len;
       CryptoHash key          = e->key;
       MUTEX_UNTAKE_LOCK(vol->mutex, thread);
-      b           = static_cast<char *>(ats_malloc(l));
-      bool failed = false;
+      b              = static_cast<char *>(ats_malloc(l));
+      bool failed    = false;
+      ink_hrtime cpu = ram_cache_cpu_time();
       switch (ctype) {
-      default:
-        goto Lfailed;
       case CACHE_COMPRESSION_FASTLZ:
-        if (e->len < 16) {
-          goto Lfailed;
+        if (elen < 16) {
+          failed = true;
+          break;
         }
         if ((l = fastlz_compress(edata->data(), elen, b)) <= 0) {
           failed = true;
@@ -505,6 +664,31 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
         break;
       }
 #endif
+#ifdef HAVE_LZ4_H
+      case CACHE_COMPRESSION_LZ4: {
+        int ll = LZ4_compress_default(edata->data(), b, elen, l);
+        if (ll <= 0) {
+          failed = true;
+        }
+        l = ll;
+        break;
+      }
+#endif
+#ifdef HAVE_ZSTD_H
+      case CACHE_COMPRESSION_ZSTD: {
+        size_t ll = zstd_compress(b, l, edata->data(), elen);
+        if (ZSTD_isError(ll)) {
+          failed = true;
+        }
+        l = static_cast<uint32_t>(ll);
+        break;
+      }
+#endif
+      }
+      CACHE_SUM_DYN_STAT_THREAD(CACHE_RAM_CACHE_COMPRESS_STAT(ctype, compress_time), ram_cache_cpu_time() - cpu);
+      if (!failed) {
+        CACHE_SUM_DYN_STAT_THREAD(CACHE_RAM_CACHE_COMPRESS_STAT(ctype, bytes_in), elen);
+        CACHE_SUM_DYN_STAT_THREAD(CACHE_RAM_CACHE_COMPRESS_STAT(ctype, bytes_out), l);
       }
       MUTEX_TAKE_LOCK(vol->mutex, thread);
       // see if the entry is till around
@@ -533,7 +717,7 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
         goto Lfailed;
       }
       if (l < e->len) {
-        e->flag_bits.compressed = cache_config_ram_cache_compress;
+        e->flag_bits.compressed = ctype;
         bb                      = static_cast<char *>(ats_malloc(l));
         memcpy(bb, b, l);
         ats_free(b);
@@ -785,3 +969,60 @@ new_RamCacheCLFUS()
   RamCacheCLFUS *r = new RamCacheCLFUS;
   return r;
 }
+
+// Compress an entry with each algorithm built in and check that a hit returns the original bytes.
+REGRESSION_TEST(ram_cache_compress)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  static const struct {
+    int type;
+    uint32_t hit;
+    const char *name;
+  } algorithms[] = {
+    {CACHE_COMPRESSION_FASTLZ, RAM_HIT_COMPRESS_FASTLZ, "fastlz"},
+#ifdef HAVE_LZ4_H
+    {CACHE_COMPRESSION_LZ4,    RAM_HIT_COMPRESS_LZ4,    "lz4"   },
+#endif
+#ifdef HAVE_ZSTD_H
+    {CACHE_COMPRESSION_ZSTD,   RAM_HIT_COMPRESS_ZSTD,   "zstd"  },
+#endif
+  };
+  const uint32_t len = 1 << 15;
+
+  *pstatus = REGRESSION_TEST_PASSED;
+
+  Ptr<IOBufferData> data = make_ptr(new_IOBufferData(iobuffer_size_to_index(len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED));
+  static const char line[] = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n";
+  for (uint32_t i = 0; i < len; i++) {
+    data->data()[i] = line[i % (sizeof(line) - 1)] + i / 4096;
+  }
+
+  CacheKey key;
+  Vol *vol         = theCache->key_to_vol(&key, "example.com", sizeof("example.com") - 1);
+  int save_type    = cache_config_ram_cache_compress;
+  int save_percent = cache_config_ram_cache_compress_percent;
+  for (const auto &a : algorithms) {
+    // init() before selecting the algorithm, so no compressor is scheduled for this cache
+    cache_config_ram_cache_compress = CACHE_COMPRESSION_NONE;
+    RamCacheCLFUS cache;
+    cache.init(len * 4, vol);
+    cache_config_ram_cache_compress         = a.type;
+    cache_config_ram_cache_compress_percent = 100;
+
+    CryptoHash hash;
+    hash.u64[0] = 0x1234;
+    hash.u64[1] = 0x5678;
+    cache.put(&hash, data.get(), len, true, 1); // the second put gets past the seen filter
+    cache.put(&hash, data.get(), len, true, 1);
+    cache.compress_entries(this_ethread());
+    for (int i = 0; i < 2; i++) {
+      Ptr<IOBufferData> hit;
+      if (cache.get(&hash, &hit, 1) != static_cast<int>(a.hit) || memcmp(hit->data(), data->data(), len) != 0) {
+        rprintf(t, "%s round trip %d failed\n", a.name, i);
+        *pstatus = REGRESSION_TEST_FAILED;
+        break;
+      }
+    }
+  }
+  cache_config_ram_cache_compress         = save_type;
+  cache_config_ram_cache_compress_percent = save_percent;
+}
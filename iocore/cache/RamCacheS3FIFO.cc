@@ -0,0 +1,512 @@
+/** @file
+
+  A sharded RAM cache with an S3-FIFO replacement policy
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// S3-FIFO: a small probationary FIFO, a main FIFO and a ghost filter of keys recently
+// evicted from the small FIFO (Yang et al., "FIFO queues are all you need for cache
+// eviction", SOSP '23). A hit only bumps a saturating frequency counter, so the hit path
+// never reorders a queue. Combined with a set associative table of atomic slots and
+// reference counted entries this lets get() run without taking any lock. put(), fixup()
+// and eviction are serialized per shard. CacheVC reads the body fragments of a document
+// through get_fragment() before it takes the Vol mutex, so those hits do not contend on it.
+//
+// Entries are never returned to the allocator while the cache exists, a reader which
+// races with an eviction can at worst take a reference on a recycled entry, which it
+// detects by revalidating the key and the slot after the reference is taken.
+
+#include "P_Cache.h"
+
+#include <mutex>
+
+#define S3FIFO_SHARDS          16        // power of 2
+#define S3FIFO_MIN_SHARD_BYTES (4 << 20) // fewer shards for small caches so each still holds many objects
+#define S3FIFO_WAYS            8         // slots per hash set
+#define S3FIFO_SMALL_PERCENT   10        // share of the bytes for the small FIFO
+#define S3FIFO_MAX_FREQ        3
+#define ENTRY_OVERHEAD         128       // per-entry overhead to consider when computing sizes
+
+#ifdef DEBUG
+
+namespace
+{
+
+DbgCtl dbg_ctl_ram_cache{"ram_cache"};
+
+} // end anonymous namespace
+
+#endif
+
+struct RamCacheS3FIFOEntry {
+  std::atomic<uint32_t> refcount{0}; // 0: free, 1: owned by the table, +1 for every reader
+  std::atomic<uint8_t> freq{0};
+  std::atomic<uint64_t> auxkey{0};
+  CryptoHash key;
+  uint32_t size = 0; // memory used including padding in buffer
+  uint32_t len  = 0; // actual data length
+  int slot      = -1;
+  bool main     = false;
+  bool copy     = false; // copy-in-copy-out
+  Ptr<IOBufferData> data;
+  LINK(RamCacheS3FIFOEntry, fifo_link);
+  SLINK(RamCacheS3FIFOEntry, free_link);
+};
+
+struct RamCacheS3FIFOShard {
+  std::mutex lock;
+  int nsets                                 = 0;
+  std::atomic<RamCacheS3FIFOEntry *> *slots = nullptr;
+  std::atomic<uint32_t> *tags               = nullptr; // fingerprint per slot, 0 when empty
+  uint32_t *ghost                           = nullptr; // fingerprints evicted from the small FIFO, per way
+  uint32_t *seen                            = nullptr; // per set
+  int64_t max_bytes                         = 0;
+  int64_t small_bytes                       = 0;
+  std::atomic<int64_t> bytes{0};
+  Que(RamCacheS3FIFOEntry, fifo_link) small;
+  Que(RamCacheS3FIFOEntry, fifo_link) main;
+  SList(RamCacheS3FIFOEntry, free_link) retired; // evicted but still referenced by a reader
+  SList(RamCacheS3FIFOEntry, free_link) free;
+};
+
+struct RamCacheS3FIFO : public RamCache {
+  // returns 1 on found/stored, 0 on not found/stored, if provided auxkey must match
+  int get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey = 0) override;
+  int get_fragment(const CryptoHash *key, Ptr<IOBufferData> *ret_data) override;
+  int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) override;
+  int fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey) override;
+  int64_t size() const override;
+
+  void init(int64_t max_bytes, Vol *vol) override;
+
+  ~RamCacheS3FIFO() override;
+
+  Vol *vol = nullptr; // for stats
+
+private:
+  int64_t _max_bytes = 0;
+  int _nshards       = 1;
+  RamCacheS3FIFOShard _shards[S3FIFO_SHARDS];
+
+  static uint32_t
+  _fingerprint(const CryptoHash *key)
+  {
+    return key->slice32(2) | 1;
+  }
+
+  RamCacheS3FIFOShard &
+  _shard(const CryptoHash *key)
+  {
+    return _shards[key->slice32(3) & (_nshards - 1)];
+  }
+
+  int
+  _set(const RamCacheS3FIFOShard &s, const CryptoHash *key) const
+  {
+    return ((key->slice32(3) / _nshards) & (s.nsets - 1)) * S3FIFO_WAYS;
+  }
+
+  static uint32_t &
+  _ghost(RamCacheS3FIFOShard &s, int set, uint32_t fp)
+  {
+    return s.ghost[set + (fp >> 1) % S3FIFO_WAYS];
+  }
+
+  RamCacheS3FIFOEntry *_find(const CryptoHash *key);
+  void _hit(RamCacheS3FIFOEntry *e, Ptr<IOBufferData> *ret_data);
+  static bool _acquire(RamCacheS3FIFOEntry *e);
+  static void _release(RamCacheS3FIFOEntry *e);
+  void _remove(RamCacheS3FIFOShard &s, RamCacheS3FIFOEntry *e);
+  void _reclaim(RamCacheS3FIFOShard &s);
+  void _evict(RamCacheS3FIFOShard &s, int64_t needed);
+};
+
+int64_t
+RamCacheS3FIFO::size() const
+{
+  int64_t s = 0;
+  for (const auto &shard : _shards) {
+    s += shard.bytes.load(std::memory_order_relaxed);
+  }
+  return s;
+}
+
+void
+RamCacheS3FIFO::init(int64_t abytes, Vol *avol)
+{
+  ink_assert(avol != nullptr);
+  vol        = avol;
+  _max_bytes = abytes;
+  DDbg(dbg_ctl_ram_cache, "initializing ram_cache %" PRId64 " bytes", abytes);
+  if (!_max_bytes) {
+    return;
+  }
+  while (_nshards < S3FIFO_SHARDS && _max_bytes / (_nshards * 2) >= S3FIFO_MIN_SHARD_BYTES) {
+    _nshards <<= 1;
+  }
+  // size the tables for objects of the minimum average object size
+  int64_t objects = _max_bytes / _nshards / std::max(cache_config_min_average_object_size, 1) + 1;
+  int nsets       = 1;
+  while (static_cast<int64_t>(nsets) * S3FIFO_WAYS < objects) {
+    nsets <<= 1;
+  }
+  for (int i = 0; i < _nshards; i++) {
+    RamCacheS3FIFOShard &s = _shards[i];
+    int nslots             = nsets * S3FIFO_WAYS;
+    s.nsets                = nsets;
+    s.max_bytes            = _max_bytes / _nshards;
+    s.slots                = new std::atomic<RamCacheS3FIFOEntry *>[nslots];
+    s.tags                 = new std::atomic<uint32_t>[nslots];
+    for (int j = 0; j < nslots; j++) {
+      s.slots[j].store(nullptr, std::memory_order_relaxed);
+      s.tags[j].store(0, std::memory_order_relaxed);
+    }
+    s.ghost = static_cast<uint32_t *>(ats_calloc(nslots, sizeof(uint32_t)));
+    if (cache_config_ram_cache_use_seen_filter) {
+      s.seen = static_cast<uint32_t *>(ats_calloc(nsets, sizeof(uint32_t)));
+    }
+  }
+}
+
+RamCacheS3FIFO::~RamCacheS3FIFO()
+{
+  for (auto &s : _shards) {
+    RamCacheS3FIFOEntry *e;
+    while ((e = s.small.dequeue())) {
+      delete e;
+    }
+    while ((e = s.main.dequeue())) {
+      delete e;
+    }
+    while ((e = s.retired.pop())) {
+      delete e;
+    }
+    while ((e = s.free.pop())) {
+      delete e;
+    }
+    delete[] s.slots;
+    delete[] s.tags;
+    ats_free(s.ghost);
+    ats_free(s.seen);
+  }
+}
+
+// Take a reader reference, fails if the entry has been released by the table.
+bool
+RamCacheS3FIFO::_acquire(RamCacheS3FIFOEntry *e)
+{
+  uint32_t n = e->refcount.load(std::memory_order_relaxed);
+  while (n) {
+    if (e->refcount.compare_exchange_weak(n, n + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Drop a reader reference without the shard lock, the entry is reclaimed by the next writer.
+void
+RamCacheS3FIFO::_release(RamCacheS3FIFOEntry *e)
+{
+  e->refcount.fetch_sub(1, std::memory_order_release);
+}
+
+// Find the entry for @a key and take a reader reference on it, or return nullptr.
+RamCacheS3FIFOEntry *
+RamCacheS3FIFO::_find(const CryptoHash *key)
+{
+  RamCacheS3FIFOShard &s = _shard(key);
+  uint32_t fp            = _fingerprint(key);
+  int set                = _set(s, key);
+  for (int i = set; i < set + S3FIFO_WAYS; i++) {
+    if (s.tags[i].load(std::memory_order_acquire) != fp) {
+      continue;
+    }
+    RamCacheS3FIFOEntry *e = s.slots[i].load(std::memory_order_acquire);
+    if (!e || !_acquire(e)) {
+      continue;
+    }
+    if (e->key == *key && s.slots[i].load(std::memory_order_acquire) == e) {
+      return e;
+    }
+    _release(e);
+  }
+  return nullptr;
+}
+
+// Return the data of a referenced entry and drop the reference.
+void
+RamCacheS3FIFO::_hit(RamCacheS3FIFOEntry *e, Ptr<IOBufferData> *ret_data)
+{
+  IOBufferData *data = e->data.get();
+  if (e->copy) {
+    data = new_IOBufferData(iobuffer_size_to_index(e->len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+    ::memcpy(data->data(), e->data->data(), e->len);
+  }
+  (*ret_data) = data;
+  uint8_t f   = e->freq.load(std::memory_order_relaxed);
+  if (f < S3FIFO_MAX_FREQ) {
+    e->freq.store(f + 1, std::memory_order_relaxed);
+  }
+  _release(e);
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_hits_stat, 1);
+}
+
+int
+RamCacheS3FIFO::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey)
+{
+  if (!_max_bytes) {
+    return 0;
+  }
+  RamCacheS3FIFOEntry *e = _find(key);
+  if (e && e->auxkey.load(std::memory_order_relaxed) == auxkey) {
+    DDbg(dbg_ctl_ram_cache, "get %X %" PRIu64 " HIT", key->slice32(3), auxkey);
+    _hit(e, ret_data);
+    return RAM_HIT_COMPRESS_NONE;
+  }
+  if (e) {
+    _release(e);
+  }
+  DDbg(dbg_ctl_ram_cache, "get %X %" PRIu64 " MISS", key->slice32(3), auxkey);
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_misses_stat, 1);
+  return 0;
+}
+
+// Misses are not counted, the caller looks the fragment up again with get() under the Vol mutex.
+int
+RamCacheS3FIFO::get_fragment(const CryptoHash *key, Ptr<IOBufferData> *ret_data)
+{
+  if (!_max_bytes) {
+    return 0;
+  }
+  RamCacheS3FIFOEntry *e = _find(key);
+  if (!e) {
+    return 0;
+  }
+  DDbg(dbg_ctl_ram_cache, "get %X FRAGMENT HIT", key->slice32(3));
+  _hit(e, ret_data);
+  return RAM_HIT_COMPRESS_NONE;
+}
+
+// Unlink an entry from its slot and queue and drop the table reference.
+// Called with the shard lock held.
+void
+RamCacheS3FIFO::_remove(RamCacheS3FIFOShard &s, RamCacheS3FIFOEntry *e)
+{
+  s.tags[e->slot].store(0, std::memory_order_relaxed);
+  s.slots[e->slot].store(nullptr, std::memory_order_release);
+  if (e->main) {
+    s.main.remove(e);
+  } else {
+    s.small.remove(e);
+    s.small_bytes -= e->size + ENTRY_OVERHEAD;
+  }
+  s.bytes.fetch_sub(e->size + ENTRY_OVERHEAD, std::memory_order_relaxed);
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, -static_cast<int64_t>(e->size + ENTRY_OVERHEAD));
+  DDbg(dbg_ctl_ram_cache, "put %X %" PRIu64 " FREED", e->key.slice32(3), e->auxkey.load(std::memory_order_relaxed));
+  e->slot = -1;
+  if (e->refcount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    e->data = nullptr;
+    s.free.push(e);
+  } else {
+    s.retired.push(e);
+  }
+}
+
+// Recycle the retired entries which no reader references anymore.
+// Called with the shard lock held.
+void
+RamCacheS3FIFO::_reclaim(RamCacheS3FIFOShard &s)
+{
+  RamCacheS3FIFOEntry *e, *busy = nullptr;
+  while ((e = s.retired.pop())) {
+    if (e->refcount.load(std::memory_order_acquire) == 0) {
+      e->data = nullptr;
+      s.free.push(e);
+    } else {
+      e->free_link.next = busy;
+      busy              = e;
+    }
+  }
+  while ((e = busy)) {
+    busy = e->free_link.next;
+    s.retired.push(e);
+  }
+}
+
+// Evict until @a needed more bytes fit in the shard.
+// Called with the shard lock held.
+void
+RamCacheS3FIFO::_evict(RamCacheS3FIFOShard &s, int64_t needed)
+{
+  int64_t small_target = s.max_bytes * S3FIFO_SMALL_PERCENT / 100;
+  while (s.bytes.load(std::memory_order_relaxed) + needed > s.max_bytes) {
+    RamCacheS3FIFOEntry *e;
+    if (s.small.head && (s.small_bytes > small_target || !s.main.head)) {
+      e = s.small.dequeue();
+      if (e->freq.load(std::memory_order_relaxed)) { // seen again while on probation
+        s.small_bytes -= e->size + ENTRY_OVERHEAD;
+        e->freq.store(0, std::memory_order_relaxed);
+        e->main = true;
+        s.main.enqueue(e);
+      } else {
+        _ghost(s, e->slot - e->slot % S3FIFO_WAYS, _fingerprint(&e->key)) = _fingerprint(&e->key);
+        s.small.enqueue(e); // _remove expects the entry on its queue
+        _remove(s, e);
+      }
+    } else if ((e = s.main.dequeue())) {
+      uint8_t f = e->freq.load(std::memory_order_relaxed);
+      s.main.enqueue(e);
+      if (f) {
+        e->freq.store(f - 1, std::memory_order_relaxed);
+      } else {
+        _remove(s, e);
+      }
+    } else {
+      break;
+    }
+  }
+}
+
+int
+RamCacheS3FIFO::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy, uint64_t auxkey)
+{
+  if (!_max_bytes) {
+    return 0;
+  }
+  RamCacheS3FIFOShard &s = _shard(key);
+  uint32_t fp            = _fingerprint(key);
+  int set                = _set(s, key);
+  uint32_t size          = copy ? len : data->block_size();
+  if (size + ENTRY_OVERHEAD > s.max_bytes) {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(s.lock);
+  _reclaim(s);
+  if (s.seen) {
+    uint32_t kk               = s.seen[set / S3FIFO_WAYS];
+    s.seen[set / S3FIFO_WAYS] = fp;
+    // a key in the ghost filter was admitted before, so it has been seen
+    bool present = kk == fp || _ghost(s, set, fp) == fp;
+    for (int i = set; i < set + S3FIFO_WAYS && !present; i++) {
+      present = s.tags[i].load(std::memory_order_relaxed) == fp;
+    }
+    if (!present) {
+      DDbg(dbg_ctl_ram_cache, "put %X %" PRIu64 " len %d UNSEEN", key->slice32(3), auxkey, len);
+      return 0;
+    }
+  }
+
+  for (int i = set; i < set + S3FIFO_WAYS; i++) {
+    RamCacheS3FIFOEntry *e = s.slots[i].load(std::memory_order_relaxed);
+    if (e && e->key == *key) {
+      if (e->auxkey.load(std::memory_order_relaxed) == auxkey) {
+        return 1;
+      }
+      _remove(s, e); // discard when aux keys conflict
+    }
+  }
+
+  _evict(s, size + ENTRY_OVERHEAD);
+
+  // pick a free way, or the coldest one of a full set
+  int slot  = -1;
+  int coldf = S3FIFO_MAX_FREQ + 1;
+  for (int i = set; i < set + S3FIFO_WAYS; i++) {
+    RamCacheS3FIFOEntry *e = s.slots[i].load(std::memory_order_relaxed);
+    if (!e) {
+      slot = i;
+      break;
+    }
+    int f = e->freq.load(std::memory_order_relaxed);
+    if (f < coldf) {
+      slot  = i;
+      coldf = f;
+    }
+  }
+  if (RamCacheS3FIFOEntry *victim = s.slots[slot].load(std::memory_order_relaxed)) {
+    _remove(s, victim);
+  }
+
+  RamCacheS3FIFOEntry *e = s.free.pop();
+  if (!e) {
+    e = new RamCacheS3FIFOEntry;
+  }
+  e->key = *key;
+  e->auxkey.store(auxkey, std::memory_order_relaxed);
+  e->freq.store(0, std::memory_order_relaxed);
+  e->size = size;
+  e->len  = len;
+  e->slot = slot;
+  e->copy = copy;
+  if (!copy) {
+    e->data = data;
+  } else {
+    char *b = static_cast<char *>(ats_malloc(len));
+    memcpy(b, data->data(), len);
+    e->data            = new_xmalloc_IOBufferData(b, len);
+    e->data->_mem_type = DEFAULT_ALLOC;
+  }
+  // keys evicted from probation recently go straight to the main FIFO
+  uint32_t &ghost = _ghost(s, set, fp);
+  e->main         = ghost == fp;
+  if (e->main) {
+    ghost = 0;
+    s.main.enqueue(e);
+  } else {
+    s.small.enqueue(e);
+    s.small_bytes += size + ENTRY_OVERHEAD;
+  }
+  s.bytes.fetch_add(size + ENTRY_OVERHEAD, std::memory_order_relaxed);
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, size + ENTRY_OVERHEAD);
+
+  // publish, readers synchronize on the reference count
+  e->refcount.store(1, std::memory_order_release);
+  s.slots[slot].store(e, std::memory_order_release);
+  s.tags[slot].store(fp, std::memory_order_release);
+  DDbg(dbg_ctl_ram_cache, "put %X %" PRIu64 " INSERTED", key->slice32(3), auxkey);
+  return 1;
+}
+
+int
+RamCacheS3FIFO::fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey)
+{
+  if (!_max_bytes) {
+    return 0;
+  }
+  RamCacheS3FIFOShard &s = _shard(key);
+  int set                = _set(s, key);
+  std::lock_guard<std::mutex> lock(s.lock);
+  for (int i = set; i < set + S3FIFO_WAYS; i++) {
+    RamCacheS3FIFOEntry *e = s.slots[i].load(std::memory_order_relaxed);
+    if (e && e->key == *key && e->auxkey.load(std::memory_order_relaxed) == old_auxkey) {
+      e->auxkey.store(new_auxkey, std::memory_order_relaxed);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+RamCache *
+new_RamCacheS3FIFO()
+{
+  return new RamCacheS3FIFO;
+}
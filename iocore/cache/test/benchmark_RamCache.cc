@@ -0,0 +1,238 @@
+/** @file
+
+  Benchmarks for the RAM caches: hit rate and lookups/s of CLFUS and S3-FIFO on a
+  replayed trace, and the CPU time of a hit with and without copying the fragment
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "tscore/I_Layout.h"
+#include "records/I_RecordsConfig.h"
+#include "records/I_RecProcess.h"
+
+#include "P_Cache.h"
+
+namespace
+{
+constexpr int64_t CACHE_BYTES   = 64 << 20;
+constexpr int OBJECT_SIZE_INDEX = BUFFER_SIZE_INDEX_8K;
+constexpr int OBJECTS           = 64 * 1024; // eight times what fits in the cache
+constexpr double ZIPF_ALPHA     = 0.9;
+constexpr int TRACE_LENGTH      = 1 << 20;
+
+using Clock = std::chrono::steady_clock;
+
+// Object ids drawn from a Zipf distribution, the same trace for every run.
+std::vector<int>
+make_trace()
+{
+  std::vector<double> cdf(OBJECTS);
+  double sum = 0;
+  for (int i = 0; i < OBJECTS; i++) {
+    sum    += 1.0 / std::pow(i + 1, ZIPF_ALPHA);
+    cdf[i]  = sum;
+  }
+  std::mt19937 rng(13);
+  std::uniform_real_distribution<double> u(0, sum);
+  std::vector<int> trace(TRACE_LENGTH);
+  for (auto &id : trace) {
+    id = std::lower_bound(cdf.begin(), cdf.end(), u(rng)) - cdf.begin();
+  }
+  return trace;
+}
+
+struct ReplayResult {
+  double hit_rate;
+  double lookups_per_sec;
+};
+
+// Each thread replays its share of the trace the way CacheVC uses the RAM cache: a lookup, and
+// on a miss an insert as if the fragment had been read from disk. The Vol mutex is held around
+// every call, except around get_fragment() which S3-FIFO serves without it.
+ReplayResult
+replay(RamCache *cache, Vol *vol, const std::vector<int> &trace, int nthreads, bool lock_free_hits)
+{
+  Ptr<IOBufferData> data = make_ptr(new_IOBufferData(OBJECT_SIZE_INDEX, MEMALIGNED));
+  uint32_t len           = data->block_size();
+  std::atomic<int64_t> hits{0};
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+
+  cache->init(CACHE_BYTES, vol);
+  for (int t = 0; t < nthreads; t++) {
+    threads.emplace_back([&, t]() {
+      EThread *thread = new EThread;
+      thread->set_specific();
+      int64_t n = 0;
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (size_t i = t; i < trace.size(); i += nthreads) {
+        CryptoHash key;
+        key.u64[0] = (static_cast<uint64_t>(trace[i]) << 32) + trace[i];
+        key.u64[1] = key.u64[0] * 0x9E3779B97F4A7C15ULL;
+        Ptr<IOBufferData> got;
+        if (lock_free_hits && cache->get_fragment(&key, &got)) {
+          n++;
+          continue;
+        }
+        SCOPED_MUTEX_LOCK(lock, vol->mutex, thread);
+        if (!lock_free_hits && cache->get(&key, &got, 1)) {
+          n++;
+          continue;
+        }
+        cache->put(&key, data.get(), len, false, 1);
+      }
+      hits += n;
+    });
+  }
+
+  auto start = Clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto &t : threads) {
+    t.join();
+  }
+  double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  return {static_cast<double>(hits) / trace.size(), trace.size() / elapsed};
+}
+
+// CPU time used by the calling thread
+double
+thread_cpu_seconds()
+{
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// CPU time of hits on a fragment with headers. A copy-in-copy-out entry hands each hit a
+// copy of the whole fragment, otherwise the hit is the fragment itself and the reader only
+// copies the headers it unmarshals in place, as CacheVC::unshare_doc() does.
+double
+hit_cpu_seconds(Vol *vol, Ptr<IOBufferData> &fragment, bool copy)
+{
+  constexpr int HITS = 2000;
+  RamCache *cache    = new_RamCacheCLFUS();
+  Doc *doc           = reinterpret_cast<Doc *>(fragment->data());
+  CryptoHash key;
+  key.u64[0] = 0x1234;
+  key.u64[1] = 0x5678;
+  cache->init(CACHE_BYTES, vol);
+  SCOPED_MUTEX_LOCK(lock, vol->mutex, this_ethread());
+  cache->put(&key, fragment.get(), doc->len, copy, 1); // the second put gets past the seen filter
+  REQUIRE(cache->put(&key, fragment.get(), doc->len, copy, 1));
+
+  double start = thread_cpu_seconds();
+  for (int i = 0; i < HITS; i++) {
+    Ptr<IOBufferData> hit;
+    REQUIRE(cache->get(&key, &hit, 1));
+    if (!copy) {
+      Ptr<IOBufferData> headers = make_ptr(cache_doc_copy(hit.get(), true));
+    }
+  }
+  double cpu = thread_cpu_seconds() - start;
+  delete cache;
+  return cpu;
+}
+
+} // namespace
+
+TEST_CASE("RamCache hit copy", "[cache]")
+{
+  CacheVol cache_vol;
+  Vol *vol          = new Vol;
+  cache_vol.vol_rsb = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+  cache_rsb         = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+  vol->cache_vol    = &cache_vol;
+
+  for (int size : {32 << 10, 256 << 10, 1 << 20}) {
+    Ptr<IOBufferData> fragment = make_ptr(new_IOBufferData(iobuffer_size_to_index(size, MAX_BUFFER_SIZE_INDEX), MEMALIGNED));
+    Doc *doc                   = reinterpret_cast<Doc *>(fragment->data());
+    memset(fragment->data(), 'b', size);
+    memset(static_cast<void *>(doc), 0, sizeof(Doc));
+    doc->magic = DOC_MAGIC;
+    doc->len   = size;
+    doc->hlen  = 2048;
+
+    double copied = hit_cpu_seconds(vol, fragment, true);
+    double shared = hit_cpu_seconds(vol, fragment, false);
+    std::printf("%7d byte fragment  copied hits %.3f ms CPU  shared hits %.3f ms CPU\n", size, copied * 1000, shared * 1000);
+    // only the headers are copied, the more body the larger the saving
+    CHECK(shared < copied);
+  }
+}
+
+TEST_CASE("RamCache replay", "[cache]")
+{
+  std::vector<int> trace = make_trace();
+  CacheVol cache_vol;
+  Vol *vol          = new Vol;
+  cache_vol.vol_rsb = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+  cache_rsb         = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+  vol->cache_vol    = &cache_vol;
+
+  for (int nthreads : {1, 2, 4, 8}) {
+    RamCache *clfus  = new_RamCacheCLFUS();
+    RamCache *s3fifo = new_RamCacheS3FIFO();
+    ReplayResult c   = replay(clfus, vol, trace, nthreads, false);
+    ReplayResult s   = replay(s3fifo, vol, trace, nthreads, true);
+    std::printf("%d threads  CLFUS hit rate %.3f %10.0f lookups/s  S3FIFO hit rate %.3f %10.0f lookups/s\n", nthreads, c.hit_rate,
+                c.lookups_per_sec, s.hit_rate, s.lookups_per_sec);
+    delete clfus;
+    delete s3fifo;
+
+    // the seen filter and the ghost filter cost a few points of hit rate at most
+    CHECK(s.hit_rate > c.hit_rate - 0.05);
+  }
+}
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    BaseLogFile *base_log_file = new BaseLogFile("stderr");
+    DiagsPtr::set(new Diags(testRunInfo.name, "" /* tags */, "" /* actions */, base_log_file));
+    Layout::create();
+    RecProcessInit();
+    LibRecordsConfigInit();
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+    eventProcessor.start(1);
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+    init_buffer_allocators(0);
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
@@ -382,6 +382,103 @@ private:
   bool _is_read_start = false;
 };
 
+// Many readers following one writer. The readers join once the first fragment is
+// written and then wait in the cache for each fragment, so the time to drain them
+// measures how fast waiting readers are woken up as the writer makes progress.
+// Readers polling the writer would trail it by up to a retry delay for every
+// fragment, woken up readers must finish well inside that baseline.
+class CacheRWWStressTest : public CacheTestHandler
+{
+public:
+  CacheRWWStressTest(int readers, const char *url) : CacheTestHandler(), _readers(readers)
+  {
+    this->_wt        = new CacheWriteTest(LARGE_FILE, this, url);
+    this->_wt->mutex = this->mutex;
+    for (int i = 0; i < readers; i++) {
+      this->_rts.push_back(new CacheReadTest(LARGE_FILE, this, url));
+    }
+
+    SET_HANDLER(&CacheRWWStressTest::start_test);
+  }
+
+  int
+  start_test(int event, void *e)
+  {
+    REQUIRE(event == EVENT_IMMEDIATE);
+    this->_start = Thread::get_hrtime();
+    this_ethread()->schedule_imm(this->_wt);
+    return 0;
+  }
+
+  void
+  handle_cache_event(int event, CacheTestBase *base) override
+  {
+    REQUIRE(base != nullptr);
+
+    if (base == this->_wt) {
+      switch (event) {
+      case CACHE_EVENT_OPEN_WRITE:
+        base->do_io_write();
+        break;
+      case VC_EVENT_WRITE_READY:
+        if (!this->_readers_started && this->_wt->vc->fragment) {
+          for (auto rt : this->_rts) {
+            this_ethread()->schedule_imm(rt);
+          }
+          this->_readers_started = true;
+        }
+        base->reenable();
+        break;
+      case VC_EVENT_WRITE_COMPLETE:
+        this->_wt->close();
+        this->_wt         = nullptr;
+        this->_write_done = Thread::get_hrtime();
+        break;
+      default:
+        REQUIRE(false);
+        break;
+      }
+    } else {
+      switch (event) {
+      case CACHE_EVENT_OPEN_READ:
+        base->do_io_read();
+        break;
+      case VC_EVENT_READ_READY:
+        base->reenable();
+        break;
+      case VC_EVENT_READ_COMPLETE:
+        base->close();
+        this->_done++;
+        break;
+      default:
+        CHECK(event == VC_EVENT_READ_COMPLETE);
+        base->close();
+        this->_done++;
+        break;
+      }
+    }
+
+    if (this->_wt == nullptr && this->_done == this->_readers) {
+      ink_hrtime now      = Thread::get_hrtime();
+      int fragments       = LARGE_FILE / cache_config_target_fragment_size;
+      ink_hrtime baseline = fragments * HRTIME_MSECONDS(cache_read_while_writer_retry_delay);
+      printf("cache rww stress: %d readers of a %d byte object in %.3f ms, %.3f ms after the writer, polling baseline %.3f ms\n",
+             this->_readers, LARGE_FILE, static_cast<double>(now - this->_start) / HRTIME_MSECOND,
+             static_cast<double>(now - this->_write_done) / HRTIME_MSECOND, static_cast<double>(baseline) / HRTIME_MSECOND);
+      CHECK(now - this->_write_done < baseline);
+      delete this;
+    }
+  }
+
+private:
+  int _readers           = 0;
+  int _done              = 0;
+  bool _readers_started  = false;
+  ink_hrtime _start      = 0;
+  ink_hrtime _write_done = 0;
+  std::vector<CacheReadTest *> _rts;
+};
+
 class CacheRWWCacheInit : public CacheInit
 {
 public:
@@ -389,13 +486,15 @@ public:
   int
   cache_init_success_callback(int event, void *e) override
   {
-    CacheRWWTest *crww        = new CacheRWWTest(LARGE_FILE);
-    CacheRWWErrorTest *crww_l = new CacheRWWErrorTest(LARGE_FILE, "http://www.scw22.com/");
-    CacheRWWEOSTest *crww_eos = new CacheRWWEOSTest(LARGE_FILE, "ttp://www.scw44.com/");
-    TerminalTest *tt          = new TerminalTest();
+    CacheRWWTest *crww              = new CacheRWWTest(LARGE_FILE);
+    CacheRWWErrorTest *crww_l       = new CacheRWWErrorTest(LARGE_FILE, "http://www.scw22.com/");
+    CacheRWWEOSTest *crww_eos       = new CacheRWWEOSTest(LARGE_FILE, "ttp://www.scw44.com/");
+    CacheRWWStressTest *crww_stress = new CacheRWWStressTest(32, "http://www.scw66.com/");
+    TerminalTest *tt                = new TerminalTest();
 
     crww->add(crww_l);
     crww->add(crww_eos);
+    crww->add(crww_stress);
     crww->add(tt);
     this_ethread()->schedule_imm(crww);
     delete this;
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <typeinfo>
+
 #include "tscore/ink_platform.h"
 #include "tscore/ink_rand.h"
 #include "tscore/I_Version.h"
@@ -322,6 +324,7 @@ public:
 
   static constexpr int NO_ETHREAD_ID = -1;
   int id                             = NO_ETHREAD_ID;
+  int numa_node                      = 0; ///< NUMA node the thread is bound to, 0 if it is not bound to a single one.
   unsigned int event_types           = 0;
   bool is_event_type(EventType et);
   void set_event_type(EventType et);
@@ -332,8 +335,14 @@ public:
   void execute_regular();
   void process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_count);
   void process_event(Event *e, int calling_code);
+  /// Call the handler of @a c, timed if it is sampled for the slow handler trace.
+  int call_handler(Continuation *c, int event, void *data);
   void free_event(Event *e);
+  bool steal_events();
   LoopTailHandler *tail_cb = &DEFAULT_TAIL_HANDLER;
+  int steal_victim         = 0; ///< Where the next scan for events to steal starts.
+  /// Set while the thread sleeps with nothing to do, cleared by the first thread that wakes it up.
+  std::atomic<bool> idle = false;
 
 #if HAVE_EVENTFD
   int evfd = ts::NO_FD;
@@ -533,6 +542,63 @@ public:
     /// Total number of metric based statistics.
     static constexpr unsigned N_STATS = N_SLICE_STATS + 2 * Graph::N_BUCKETS;
 
+    /// Phases of a loop.
+    enum class Phase {
+      DISPATCH, ///< Running the events that are due.
+      WAIT,     ///< Waiting in the poll of the tail handler.
+      IO,       ///< The rest of the tail handler, e.g. the NetHandler servicing the connections that are ready.
+    };
+    static constexpr unsigned N_PHASES = unsigned(Phase::IO) + 1;
+    /// Phase names, for reporting.
+    static char const *const PHASE_NAME[N_PHASES];
+
+    /// Histogram type for phases, in microseconds. 14,2 goes up to 131 ms.
+    using PhaseGraph = ts::Histogram<14, 2>;
+    std::array<PhaseGraph, N_PHASES> _phase_timing; ///< Time spent in each phase, every loop.
+
+    /// Time the tail handler waited in the current loop, negative if it did not report it.
+    ink_hrtime _wait_time = -1;
+
+    /** Record the time the tail handler spent waiting for activity.
+     *
+     * Tail handlers that do not call this are taken to wait for their whole run.
+     *
+     * @param delta Duration of the wait.
+     * @return @a this
+     */
+    self_type &record_wait_time(ink_hrtime delta);
+
+    /** Record the phases of a loop.
+     *
+     * @param dispatch Time spent running events.
+     * @param tail Time spent in the tail handler.
+     * @return @a this
+     */
+    self_type &record_phases(ink_hrtime dispatch, ink_hrtime tail);
+
+    /// A handler call that took longer than @c thread_slow_handler_threshold.
+    struct SlowHandler {
+      ink_hrtime _at              = 0;       ///< When the handler was called.
+      ink_hrtime _duration        = 0;       ///< How long it ran.
+      uintptr_t _handler          = 0;       ///< Address of the handler, the vtable offset + 1 if it is virtual.
+      std::type_info const *_type = nullptr; ///< Type of the continuation.
+      int _event                  = 0;       ///< Event passed to the handler.
+    };
+    /// Number of slow handler calls kept per thread.
+    static constexpr unsigned N_SLOW_HANDLERS = 32;
+    /// The latest slow handler calls, a circular buffer.
+    std::array<SlowHandler, N_SLOW_HANDLERS> _slow_handler;
+    /// Number of slow handler calls recorded, the latest is at <tt>(count - 1) % N_SLOW_HANDLERS</tt>.
+    std::atomic<uint64_t> _slow_handler_count = 0;
+    /// Handler calls until the next one is timed.
+    int _handler_countdown = 0;
+
+    /// Whether to time the next handler call.
+    bool sample_handler();
+
+    /// Record a timed handler call, kept if it was slow.
+    self_type &record_handler_time(ink_hrtime start, ink_hrtime delta, uintptr_t handler, std::type_info const &type, int event);
+
     /// Summarize this instance into a global instance.
     void summarize(self_type &global);
   };
@@ -540,6 +606,11 @@ public:
   Metrics metrics;
 };
 
+/// Handler calls that run at least this long are recorded, 0 to not time handlers.
+extern ink_hrtime thread_slow_handler_threshold;
+/// One handler call in this many is timed.
+extern int thread_slow_handler_sample;
+
 // --- Inline implementation
 
 inline auto
@@ -603,12 +674,57 @@ EThread::Metrics::record_api_time(ink_hrtime delta) -> self_type &
   return *this;
 }
 
+inline auto
+EThread::Metrics::record_wait_time(ink_hrtime delta) -> self_type &
+{
+  _wait_time = std::max<ink_hrtime>(_wait_time, 0) + delta;
+  return *this;
+}
+
+inline auto
+EThread::Metrics::record_phases(ink_hrtime dispatch, ink_hrtime tail) -> self_type &
+{
+  ink_hrtime wait = _wait_time < 0 ? tail : std::min(_wait_time, tail);
+
+  _phase_timing[unsigned(Phase::DISPATCH)](dispatch / HRTIME_USECOND);
+  _phase_timing[unsigned(Phase::WAIT)](wait / HRTIME_USECOND);
+  _phase_timing[unsigned(Phase::IO)]((tail - wait) / HRTIME_USECOND);
+  _wait_time = -1;
+  return *this;
+}
+
+inline bool
+EThread::Metrics::sample_handler()
+{
+  if (thread_slow_handler_threshold <= 0 || --_handler_countdown > 0) {
+    return false;
+  }
+  _handler_countdown = thread_slow_handler_sample;
+  return true;
+}
+
+inline auto
+EThread::Metrics::record_handler_time(ink_hrtime start, ink_hrtime delta, uintptr_t handler, std::type_info const &type, int event)
+  -> self_type &
+{
+  if (delta >= thread_slow_handler_threshold) {
+    uint64_t n = _slow_handler_count.load(std::memory_order_relaxed);
+    // Readers on other threads may see a slot that is being written, good enough for a trace.
+    _slow_handler[n % N_SLOW_HANDLERS] = {start, delta, handler, &type, event};
+    _slow_handler_count.store(n + 1, std::memory_order_release);
+  }
+  return *this;
+}
+
 inline auto
 EThread::Metrics::decay() -> self_type &
 {
   while (_decay_count) {
     _loop_timing.decay();
     _api_timing.decay();
+    for (auto &g : _phase_timing) {
+      g.decay();
+    }
     --_decay_count;
   }
   return *this;
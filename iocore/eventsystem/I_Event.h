@@ -213,7 +213,8 @@ public:
   unsigned int in_the_priority_queue : 1;
   unsigned int immediate             : 1;
   unsigned int globally_allocated    : 1;
-  unsigned int in_heap               : 4;
+  unsigned int in_heap               : 9;
+  unsigned int stealable             : 1; ///< An idle thread of the group may run it instead of @a ethread.
   int callback_event = 0;
 
   ink_hrtime timeout_at = 0;
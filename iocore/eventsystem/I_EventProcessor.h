@@ -295,6 +295,7 @@ public:
     Que(Event, link) _spawnQueue;                    ///< Events to dispatch when thread is spawned.
     EThread *_thread[MAX_THREADS_IN_EACH_TYPE] = {}; ///< The actual threads in this group.
     std::function<void()> _afterStartCallback  = nullptr;
+    bool _work_stealing                        = false; ///< Idle threads take immediate events from busy ones.
   };
 
   /// Storage for per group data.
@@ -25,64 +25,44 @@
 
 #include "tscore/ink_platform.h"
 #include "I_Event.h"
-
-// <5ms, 10, 20, 40, 80, 160, 320, 640, 1280, 2560, 5120
-#define N_PQ_LIST          10
-#define PQ_BUCKET_TIME(_i) (HRTIME_MSECONDS(5) << (_i))
+#include "I_TimingWheel.h"
 
 class EThread;
 
+/**
+  The timed events of an EThread, in a timing wheel with a tick of @c TICK.
+
+  An event is ready once its @a timeout_at has passed, the wheel position is kept in @a in_heap.
+ */
 struct PriorityEventQueue {
-  Que(Event, link) after[N_PQ_LIST];
+  static constexpr ink_hrtime TICK = HRTIME_MSECOND;
+
+  struct WheelTraits {
+    static ink_hrtime
+    expiry(Event *e)
+    {
+      return e->timeout_at;
+    }
+    static int
+    slot(Event *e)
+    {
+      return e->in_heap;
+    }
+    static void
+    set_slot(Event *e, int slot)
+    {
+      e->in_heap = slot;
+    }
+  };
+
+  TimingWheel<Event, Event::Link_link, WheelTraits> wheel;
   ink_hrtime last_check_time;
-  uint32_t last_check_buckets;
 
   void
-  enqueue(Event *e, ink_hrtime now)
+  enqueue(Event *e, ink_hrtime /* now ATS_UNUSED */)
   {
-    ink_hrtime t = e->timeout_at - now;
-    int i        = 0;
-    // equivalent but faster
-    if (t <= PQ_BUCKET_TIME(3)) {
-      if (t <= PQ_BUCKET_TIME(1)) {
-        if (t <= PQ_BUCKET_TIME(0)) {
-          i = 0;
-        } else {
-          i = 1;
-        }
-      } else {
-        if (t <= PQ_BUCKET_TIME(2)) {
-          i = 2;
-        } else {
-          i = 3;
-        }
-      }
-    } else {
-      if (t <= PQ_BUCKET_TIME(7)) {
-        if (t <= PQ_BUCKET_TIME(5)) {
-          if (t <= PQ_BUCKET_TIME(4)) {
-            i = 4;
-          } else {
-            i = 5;
-          }
-        } else {
-          if (t <= PQ_BUCKET_TIME(6)) {
-            i = 6;
-          } else {
-            i = 7;
-          }
-        }
-      } else {
-        if (t <= PQ_BUCKET_TIME(8)) {
-          i = 8;
-        } else {
-          i = 9;
-        }
-      }
-    }
     e->in_the_priority_queue = 1;
-    e->in_heap               = i;
-    after[i].enqueue(e);
+    wheel.insert(e);
   }
 
   void
@@ -90,14 +70,14 @@ struct PriorityEventQueue {
   {
     ink_assert(e->in_the_priority_queue);
     e->in_the_priority_queue = 0;
-    after[e->in_heap].remove(e);
+    wheel.remove(e);
   }
 
   Event *
   dequeue_ready(ink_hrtime t)
   {
     (void)t;
-    Event *e = after[0].dequeue();
+    Event *e = wheel.pop_ready();
     if (e) {
       ink_assert(e->in_the_priority_queue);
       e->in_the_priority_queue = 0;
@@ -110,12 +90,8 @@ struct PriorityEventQueue {
   ink_hrtime
   earliest_timeout()
   {
-    for (int i = 0; i < N_PQ_LIST; i++) {
-      if (after[i].head) {
-        return last_check_time + (PQ_BUCKET_TIME(i) / 2);
-      }
-    }
-    return last_check_time + HRTIME_FOREVER;
+    ink_hrtime at = wheel.earliest();
+    return at == HRTIME_FOREVER ? last_check_time + HRTIME_FOREVER : at;
   }
 
   PriorityEventQueue();
@@ -25,7 +25,8 @@
 
   Protected Queue, a FIFO queue with the following functionality:
   (1). Multiple threads could be simultaneously trying to enqueue
-       and dequeue. Hence the queue needs to be protected with mutex.
+       and dequeue. Enqueue is lock free, the consumer side is guarded
+       by a spin flag so that idle threads can steal from it.
   (2). In case the queue is empty, dequeue() sleeps for a specified
        amount of time, or until a new element is inserted, whichever
        is earlier
@@ -34,10 +35,12 @@
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
+
 #include "tscore/ink_platform.h"
 #include "I_Event.h"
 struct ProtectedQueue {
-  void enqueue(Event *e);
+  bool enqueue(Event *e); // Returns true if the queue was empty
   void signal();
   int try_signal();             // Use non blocking lock and if acquired, signal
   void enqueue_local(Event *e); // Safe when called from the same thread
@@ -45,10 +48,28 @@ struct ProtectedQueue {
   void dequeue_external();       // Dequeue any external events.
   void wait(ink_hrtime timeout); // Wait for @a timeout nanoseconds on a condition variable if there are no events.
 
-  InkAtomicList al;
+  // Move up to @a max stealable events from the head of the external queue to @a stolen, stops at
+  // the first event that is not stealable. Returns the number of events moved, 0 if the queue is
+  // busy.
+  int steal(Que(Event, link) & stolen, int max);
+  bool external_empty() const;
+
+  // Events from other threads, an intrusive MPSC queue linked through Event::link.next. Producers
+  // swap themselves in at @a tail and then link the previous tail to themselves, @a stub keeps the
+  // queue non-empty so neither end is ever null.
+  std::atomic<Event *> tail;
+  std::atomic<Event *> head;
+  std::atomic_flag consumer_busy = ATOMIC_FLAG_INIT;
+  Event stub;
+
   ink_mutex lock;
   ink_cond might_have_data;
   Que(Event, link) localQueue;
 
   ProtectedQueue();
+
+private:
+  Event *push_external(Event *e);
+  Event *pop_external();
+  void lock_consumer();
 };
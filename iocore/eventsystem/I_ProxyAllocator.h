@@ -34,6 +34,7 @@
 #include <utility>
 
 #include "tscore/ink_platform.h"
+#include "tscore/ink_assert.h"
 
 class EThread;
 
@@ -64,7 +65,29 @@ thread_alloc(CAlloc &a, ProxyAllocator &l, Args &&...args)
 
 void *thread_alloc(Allocator &a, ProxyAllocator &l);
 
-void thread_freeup(Allocator &a, ProxyAllocator &l);
+// Give the blocks above the low watermark back to @a a.
+template <class RawAlloc>
+void
+thread_freeup(RawAlloc &a, ProxyAllocator &l)
+{
+  void *head   = l.freelist;
+  void *tail   = l.freelist;
+  size_t count = 0;
+  while (l.freelist && l.allocated > thread_freelist_low_watermark) {
+    tail       = l.freelist;
+    l.freelist = *static_cast<void **>(l.freelist);
+    --(l.allocated);
+    ++count;
+  }
+
+  if (unlikely(count == 1)) {
+    a.free_void(tail);
+  } else if (count > 0) {
+    a.free_void_bulk(head, tail, count);
+  }
+
+  ink_assert(l.allocated >= thread_freelist_low_watermark);
+}
 
 #if 1
 
@@ -0,0 +1,236 @@
+/** @file
+
+  Hierarchical timing wheel
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+#include "tscore/ink_assert.h"
+#include "tscore/ink_hrtime.h"
+#include "tscore/List.h"
+
+/**
+  Timers of one thread in a hierarchical timing wheel.
+
+  Time is counted in ticks of @a tick nanoseconds. Level @c L of the wheel has @c SLOTS slots of
+  @c SLOTS^L ticks each, an element is put on the lowest level where its expiry tick and the current
+  tick differ, in the slot given by the expiry tick. When the current tick enters a slot of a
+  higher level the elements there are put back in, on a lower level, and from the slots of level 0
+  they go to the ready queue. Insert and remove are O(1) and advancing only touches the slots that
+  have elements, the cost does not grow with the number of timers that are not due.
+
+  Expiry ticks are rounded up, an element is never ready before its expiry time. Timers beyond the
+  top level are kept in an overflow queue that is put back in when the top level wraps around.
+
+  @a Traits provides, for an element @c c:
+  - @c expiry(c) - the time it expires at.
+  - @c slot(c) and @c set_slot(c, slot) - storage for the position in the wheel.
+ */
+template <class C, class L, class Traits> class TimingWheel
+{
+public:
+  static constexpr int LEVEL_BITS  = 6;
+  static constexpr int SLOTS       = 1 << LEVEL_BITS;
+  static constexpr int LEVELS      = 4;
+  static constexpr int IN_READY    = LEVELS * SLOTS; ///< Position of elements in the ready queue.
+  static constexpr int IN_OVERFLOW = IN_READY + 1;   ///< Position of elements beyond the top level.
+
+  TimingWheel(ink_hrtime tick, ink_hrtime now) : _tick(tick), _now(now / tick) {}
+
+  /// Add @a c to expire at @c Traits::expiry(c).
+  void
+  insert(C *c)
+  {
+    ink_hrtime at = Traits::expiry(c);
+    uint64_t t    = at <= 0 ? 0 : (at + _tick - 1) / _tick;
+
+    if (t <= _now) {
+      Traits::set_slot(c, IN_READY);
+      _ready.enqueue(c);
+      return;
+    }
+
+    int level = (63 - __builtin_clzll(t ^ _now)) / LEVEL_BITS;
+    if (level >= LEVELS) {
+      Traits::set_slot(c, IN_OVERFLOW);
+      _overflow.enqueue(c);
+      return;
+    }
+
+    int idx = (t >> (level * LEVEL_BITS)) & (SLOTS - 1);
+    Traits::set_slot(c, level * SLOTS + idx);
+    _slot[level][idx].enqueue(c);
+    _occupied[level] |= uint64_t(1) << idx;
+  }
+
+  /// Take @a c out of the wheel.
+  void
+  remove(C *c)
+  {
+    int s = Traits::slot(c);
+
+    if (s == IN_READY) {
+      _ready.remove(c);
+    } else if (s == IN_OVERFLOW) {
+      _overflow.remove(c);
+    } else {
+      int level = s / SLOTS;
+      int idx   = s % SLOTS;
+      _slot[level][idx].remove(c);
+      if (_slot[level][idx].empty()) {
+        _occupied[level] &= ~(uint64_t(1) << idx);
+      }
+    }
+  }
+
+  /// Next element that is due, nullptr if none.
+  C *
+  pop_ready()
+  {
+    return _ready.dequeue();
+  }
+
+  bool
+  has_ready() const
+  {
+    return _ready.head != nullptr;
+  }
+
+  /**
+    Move the clock forward to @a now, elements that are due go to the ready queue.
+
+    @a drop is called for the elements moved down from a higher level, if it returns @c true the
+    element is left out of the wheel and the caller owns it.
+   */
+  template <typename Drop>
+  void
+  advance(ink_hrtime now, Drop &&drop)
+  {
+    uint64_t target = now / _tick;
+
+    while (_now < target) {
+      uint64_t next = next_tick();
+      if (next > target) {
+        _now = target;
+        break;
+      }
+      _now = next;
+      cascade(drop);
+      expire_slot();
+    }
+  }
+
+  /// The earliest time an element can become ready, @c HRTIME_FOREVER if the wheel is empty.
+  ink_hrtime
+  earliest() const
+  {
+    if (_ready.head) {
+      return static_cast<ink_hrtime>(_now * _tick);
+    }
+    uint64_t next = next_tick();
+    return next == NEVER ? HRTIME_FOREVER : static_cast<ink_hrtime>(next * _tick);
+  }
+
+private:
+  static constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+  // The first tick after the current one at which a slot of level 0 expires or a slot of a higher
+  // level has to be moved down. Only slots after the current one of each level can have elements.
+  uint64_t
+  next_tick() const
+  {
+    for (int level = 0; level < LEVELS; ++level) {
+      int shift    = level * LEVEL_BITS;
+      int idx      = (_now >> shift) & (SLOTS - 1);
+      uint64_t set = idx == SLOTS - 1 ? 0 : _occupied[level] & (~uint64_t(0) << (idx + 1));
+      if (set) {
+        uint64_t base = (_now >> (shift + LEVEL_BITS)) << (shift + LEVEL_BITS);
+        return base | (static_cast<uint64_t>(__builtin_ctzll(set)) << shift);
+      }
+    }
+    if (_overflow.head) {
+      return ((_now >> (LEVELS * LEVEL_BITS)) + 1) << (LEVELS * LEVEL_BITS);
+    }
+    return NEVER;
+  }
+
+  // Put back the elements of the higher level slots that start at the current tick, from the top
+  // down so that they go through every level below.
+  template <typename Drop>
+  void
+  cascade(Drop &drop)
+  {
+    if ((_now & ((uint64_t(1) << (LEVELS * LEVEL_BITS)) - 1)) == 0) {
+      reinsert(_overflow, drop);
+    }
+    for (int level = LEVELS - 1; level > 0; --level) {
+      int shift = level * LEVEL_BITS;
+      if ((_now & ((uint64_t(1) << shift) - 1)) != 0) {
+        continue;
+      }
+      int idx = (_now >> shift) & (SLOTS - 1);
+      if (_occupied[level] & (uint64_t(1) << idx)) {
+        _occupied[level] &= ~(uint64_t(1) << idx);
+        reinsert(_slot[level][idx], drop);
+      }
+    }
+  }
+
+  template <typename Drop>
+  void
+  reinsert(Queue<C, L> &q, Drop &drop)
+  {
+    Queue<C, L> moving = q;
+    C *c;
+
+    q.clear();
+    while ((c = moving.dequeue())) {
+      if (!drop(c)) {
+        insert(c);
+      }
+    }
+  }
+
+  void
+  expire_slot()
+  {
+    int idx = _now & (SLOTS - 1);
+    C *c;
+
+    if (_occupied[0] & (uint64_t(1) << idx)) {
+      _occupied[0] &= ~(uint64_t(1) << idx);
+      while ((c = _slot[0][idx].dequeue())) {
+        Traits::set_slot(c, IN_READY);
+        _ready.enqueue(c);
+      }
+    }
+  }
+
+  ink_hrtime _tick;
+  uint64_t _now; ///< Current tick.
+  uint64_t _occupied[LEVELS] = {};
+  Queue<C, L> _slot[LEVELS][SLOTS];
+  Queue<C, L> _ready;
+  Queue<C, L> _overflow;
+};
@@ -32,14 +32,18 @@
 #include "I_EventSystem.h"
 
 TS_INLINE
-ProtectedQueue::ProtectedQueue()
+ProtectedQueue::ProtectedQueue() : tail(&stub), head(&stub)
 {
-  Event e;
   ink_mutex_init(&lock);
-  ink_atomiclist_init(&al, "ProtectedQueue", (char *)&e.link.next - (char *)&e);
   ink_cond_init(&might_have_data);
 }
 
+TS_INLINE bool
+ProtectedQueue::external_empty() const
+{
+  return head.load(std::memory_order_acquire) == &stub && tail.load(std::memory_order_acquire) == &stub;
+}
+
 TS_INLINE void
 ProtectedQueue::signal()
 {
@@ -100,7 +100,8 @@ EThread::schedule_every(Continuation *cont, ink_hrtime t, int callback_event, vo
 TS_INLINE Event *
 EThread::schedule(Event *e)
 {
-  e->ethread = this;
+  e->ethread   = this;
+  e->stealable = false;
   if (tt != REGULAR) {
     ink_assert(tt == DEDICATED);
     return eventProcessor.schedule(e, ET_CALL);
@@ -259,3 +260,22 @@ EThread::set_tail_handler(LoopTailHandler *handler)
 {
   ink_atomic_swap(&tail_cb, handler);
 }
+
+TS_INLINE int
+EThread::call_handler(Continuation *c, int event, void *data)
+{
+  if (!metrics.sample_handler()) {
+    return c->handleEvent(event, data);
+  }
+
+  // The continuation can be gone when the handler returns, take what is reported first.
+  uintptr_t handler;
+  static_assert(sizeof(c->handler) >= sizeof(handler));
+  memcpy(&handler, &c->handler, sizeof(handler));
+  std::type_info const &type = typeid(*c);
+
+  ink_hrtime start = ink_get_hrtime_internal();
+  int ret          = c->handleEvent(event, data);
+  metrics.record_handler_time(start, ink_get_hrtime_internal() - start, handler, type, event);
+  return ret;
+}
@@ -117,10 +117,26 @@ EventProcessor::schedule(Event *e, EventType etype)
     e->mutex = e->continuation->mutex;
   }
 
+  // An immediate event of a continuation that was not bound to a thread and has a lock of its own can
+  // run on any thread of the group.
+  ThreadGroupDescriptor &tg = thread_group[etype];
+  e->stealable = tg._work_stealing && affinity_thread == nullptr && e->timeout_at == 0 && e->period == 0 && e->mutex &&
+                 e->mutex != e->ethread->mutex;
+
   if (curr_thread != nullptr && e->ethread == curr_thread) {
     e->ethread->EventQueueExternal.enqueue_local(e);
-  } else {
-    e->ethread->EventQueueExternal.enqueue(e);
+  } else if (!e->ethread->EventQueueExternal.enqueue(e) && e->stealable && tg._count > 1) {
+    // The thread has not drained its queue yet, it may be busy with a long event. Wake up an idle
+    // thread so it can take the event over. Whoever wakes a thread clears its idle flag, so a burst
+    // of events costs one wake-up per idle thread rather than one per event.
+    uint64_t start = ++tg._next_round_robin;
+    for (int i = 0; i < tg._count; ++i) {
+      EThread *peer = tg._thread[(start + i) % tg._count];
+      if (peer != e->ethread && peer->idle.load(std::memory_order_relaxed) && peer->idle.exchange(false)) {
+        peer->tail_cb->signalActivity();
+        break;
+      }
+    }
   }
 
   return e;
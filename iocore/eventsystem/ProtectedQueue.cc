@@ -43,13 +43,83 @@
 
 extern ClassAllocator<Event> eventAllocator;
 
+namespace
+{
+// Event::link.next is written by a producer and read by the consumer of the external queue.
+inline Event *
+load_next(Event *e)
+{
+  return __atomic_load_n(&e->link.next, __ATOMIC_ACQUIRE);
+}
+
+inline void
+store_next(Event *e, Event *next)
+{
+  __atomic_store_n(&e->link.next, next, __ATOMIC_RELEASE);
+}
+} // namespace
+
+Event *
+ProtectedQueue::push_external(Event *e)
+{
+  store_next(e, nullptr);
+  Event *prev = tail.exchange(e, std::memory_order_acq_rel);
+  // Until this store the event is not reachable from the head, pop_external sees a queue that is
+  // not empty but returns nothing.
+  store_next(prev, e);
+  return prev;
+}
+
+// Remove the event at the head, nullptr if the queue is empty or a producer is in the middle of
+// linking the event after the head. Must hold the consumer side.
+Event *
+ProtectedQueue::pop_external()
+{
+  Event *h    = head.load(std::memory_order_relaxed);
+  Event *next = load_next(h);
+
+  if (h == &stub) {
+    if (next == nullptr) {
+      return nullptr;
+    }
+    head.store(next, std::memory_order_relaxed);
+    h    = next;
+    next = load_next(next);
+  }
+  if (next != nullptr) {
+    head.store(next, std::memory_order_relaxed);
+    return h;
+  }
+  if (h != tail.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  // h is the last event, put the stub back behind it so the queue does not run empty.
+  push_external(&stub);
+  next = load_next(h);
+  if (next != nullptr) {
+    head.store(next, std::memory_order_relaxed);
+    return h;
+  }
+  return nullptr;
+}
+
+// The owner holds the consumer side only while it drains the queue and a thief only while it takes a
+// few events, so spin.
 void
+ProtectedQueue::lock_consumer()
+{
+  while (consumer_busy.test_and_set(std::memory_order_acquire)) {
+    ink_thr_yield();
+  }
+}
+
+bool
 ProtectedQueue::enqueue(Event *e)
 {
   ink_assert(!e->in_the_prot_queue && !e->in_the_priority_queue);
   EThread *e_ethread   = e->ethread;
   e->in_the_prot_queue = 1;
-  bool was_empty       = (ink_atomiclist_push(&al, e) == nullptr);
+  bool was_empty       = (push_external(e) == &stub);
 
   if (was_empty) {
     EThread *inserting_thread = this_ethread();
@@ -59,20 +129,17 @@ ProtectedQueue::enqueue(Event *e)
       e_ethread->tail_cb->signalActivity();
     }
   }
+  return was_empty;
 }
 
 void
 ProtectedQueue::dequeue_external()
 {
-  Event *e = static_cast<Event *>(ink_atomiclist_popall(&al));
-  // invert the list, to preserve order
-  SLL<Event, Event::Link_link> l, t;
-  t.head = e;
-  while ((e = t.pop())) {
-    l.push(e);
-  }
-  // insert into localQueue
-  while ((e = l.pop())) {
+  Event *e;
+
+  lock_consumer();
+  // insert into localQueue, the external queue is already in order
+  while ((e = pop_external())) {
     if (!e->cancelled) {
       localQueue.enqueue(e);
     } else {
@@ -80,6 +147,30 @@ ProtectedQueue::dequeue_external()
       eventAllocator.free(e);
     }
   }
+  consumer_busy.clear(std::memory_order_release);
+}
+
+int
+ProtectedQueue::steal(Que(Event, link) & stolen, int max)
+{
+  int count = 0;
+
+  if (consumer_busy.test_and_set(std::memory_order_acquire)) {
+    return 0;
+  }
+  while (count < max) {
+    Event *e = head.load(std::memory_order_relaxed);
+    if (e == &stub) {
+      e = load_next(e);
+    }
+    if (e == nullptr || !e->stealable || e->cancelled || pop_external() != e) {
+      break;
+    }
+    stolen.enqueue(e);
+    ++count;
+  }
+  consumer_busy.clear(std::memory_order_release);
+  return count;
 }
 
 void
@@ -91,7 +182,7 @@ ProtectedQueue::wait(ink_hrtime timeout)
    *   - And then the Event Thread goes to sleep and waits for the wakeup signal of `EThread::might_have_data`,
    *   - The `EThread::lock` will be locked again when the Event Thread wakes up.
    */
-  if (INK_ATOMICLIST_EMPTY(al) && localQueue.empty()) {
+  if (external_empty() && localQueue.empty()) {
     timespec ts = ink_hrtime_to_timespec(timeout);
     ink_cond_timedwait(&might_have_data, &lock, &ts);
   }
@@ -37,25 +37,3 @@ thread_alloc(Allocator &a, ProxyAllocator &l)
   }
   return a.alloc_void();
 }
-
-void
-thread_freeup(Allocator &a, ProxyAllocator &l)
-{
-  void *head   = l.freelist;
-  void *tail   = l.freelist;
-  size_t count = 0;
-  while (l.freelist && l.allocated > thread_freelist_low_watermark) {
-    tail       = l.freelist;
-    l.freelist = *static_cast<void **>(l.freelist);
-    --(l.allocated);
-    ++count;
-  }
-
-  if (unlikely(count == 1)) {
-    a.free_void(tail);
-  } else if (count > 0) {
-    a.free_void_bulk(head, tail, count);
-  }
-
-  ink_assert(l.allocated >= thread_freelist_low_watermark);
-}
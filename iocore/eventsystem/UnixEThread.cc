@@ -48,7 +48,11 @@ char const *const EThread::Metrics::Slice::STAT_NAME[] = {
   "proxy.process.eventloop.events.max", "proxy.process.eventloop.wait",   "proxy.process.eventloop.time.min",
   "proxy.process.eventloop.time.max"};
 
+char const *const EThread::Metrics::PHASE_NAME[] = {"dispatch", "wait", "io"};
+
 int thread_max_heartbeat_mseconds = THREAD_MAX_HEARTBEAT_MSECONDS;
+ink_hrtime thread_slow_handler_threshold = 0;
+int thread_slow_handler_sample           = 1;
 
 // To define a class inherits from Thread:
 //   1) Define an independent thread_local static member
@@ -146,7 +150,7 @@ EThread::process_event(Event *e, int calling_code)
     // Restore the client IP debugging flags
     set_cont_flags(e->continuation->control_flags);
 
-    e->continuation->handleEvent(calling_code, e);
+    call_handler(e->continuation, calling_code, e);
     ink_assert(!e->in_the_priority_queue);
     ink_assert(c_temp == e->continuation);
     MUTEX_RELEASE(lock);
@@ -282,7 +286,18 @@ EThread::execute_regular()
       sleep_time = 0;
     }
 
+    // Nothing to do, help out a busy thread before going to sleep. Idle is raised before looking, so
+    // a thread that queues a stealable event after the look wakes this one up.
+    if (sleep_time > 0 && EventQueueExternal.localQueue.empty() && EventQueueExternal.external_empty()) {
+      idle.store(true);
+      if (steal_events()) {
+        sleep_time = 0;
+      }
+    }
+
+    ink_hrtime tail_start_time = Thread::get_hrtime_updated();
     tail_cb->waitForActivity(sleep_time);
+    idle.store(false, std::memory_order_relaxed);
 
     // loop cleanup
     loop_finish_time = Thread::get_hrtime_updated();
@@ -293,10 +308,45 @@ EThread::execute_regular()
 
     metrics.decay();
     metrics.record_loop_time(delta);
+    metrics.record_phases(std::max<ink_hrtime>(0, tail_start_time - loop_start_time),
+                          std::max<ink_hrtime>(0, loop_finish_time - tail_start_time));
     metrics.current_slice->record_event_count(ev_count);
   }
 }
 
+// Called by an idle thread, take stealable events from another thread of a work stealing group it
+// belongs to. Returns true if any were taken, they are in the local queue.
+bool
+EThread::steal_events()
+{
+  static constexpr int STEAL_BATCH = 4;
+
+  for (int i = 0; i < eventProcessor.n_thread_groups; ++i) {
+    auto &tg = eventProcessor.thread_group[i];
+    int n    = tg._started;
+    if (!tg._work_stealing || n < 2 || !is_event_type(i)) {
+      continue;
+    }
+    for (int k = 0; k < n; ++k) {
+      EThread *victim = tg._thread[(steal_victim + k) % n];
+      if (victim == this || victim == nullptr) {
+        continue;
+      }
+      Que(Event, link) stolen;
+      if (victim->EventQueueExternal.steal(stolen, STEAL_BATCH) > 0) {
+        Event *e;
+        steal_victim = (steal_victim + k + 1) % n;
+        while ((e = stolen.dequeue())) {
+          e->ethread = this;
+          EventQueueExternal.localQueue.enqueue(e);
+        }
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 //
 // void  EThread::execute()
 //
@@ -275,6 +275,7 @@ ThreadAffinityInitializer::set_affinity(int, Event *)
     Dbg(dbg_ctl_iocore_thread, "EThread: %d %s: %d", _name, obj->logical_index);
 #endif // HWLOC_API_VERSION
     hwloc_set_thread_cpubind(ink_get_topology(), t->tid, obj->cpuset, HWLOC_CPUBIND_STRICT);
+    t->numa_node = ink_numa_node_of(obj->cpuset);
   } else {
     Warning("hwloc returned an unexpected number of objects -- CPU affinity disabled");
   }
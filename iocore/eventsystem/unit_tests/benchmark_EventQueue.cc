@@ -0,0 +1,227 @@
+/** @file
+
+  Benchmark of the external event queue of an EThread, cross thread schedule throughput and dispatch
+  latency of ProtectedQueue compared to the atomic list it used before.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "I_EventSystem.h"
+#include "tscore/ink_queue.h"
+
+namespace
+{
+constexpr int PRODUCERS           = 4;
+constexpr int EVENTS_PER_PRODUCER = 50000;
+
+using Clock = std::chrono::steady_clock;
+
+int64_t
+now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// The external queue as it was, a lock free stack that the consumer empties at once and reverses.
+struct OldQueue {
+  InkAtomicList al;
+  Que(Event, link) localQueue;
+
+  OldQueue()
+  {
+    Event e;
+    ink_atomiclist_init(&al, "OldQueue", (char *)&e.link.next - (char *)&e);
+  }
+
+  void
+  enqueue(Event *e)
+  {
+    e->in_the_prot_queue = 1;
+    ink_atomiclist_push(&al, e);
+  }
+
+  void
+  dequeue_external()
+  {
+    Event *e = static_cast<Event *>(ink_atomiclist_popall(&al));
+    SLL<Event, Event::Link_link> l, t;
+    t.head = e;
+    while ((e = t.pop())) {
+      l.push(e);
+    }
+    while ((e = l.pop())) {
+      localQueue.enqueue(e);
+    }
+  }
+
+  Event *
+  dequeue_local()
+  {
+    Event *e = localQueue.dequeue();
+    if (e) {
+      e->in_the_prot_queue = 0;
+    }
+    return e;
+  }
+};
+
+struct Result {
+  double events_per_sec;
+  int64_t p50_ns;
+  int64_t p99_ns;
+};
+
+// @a PRODUCERS threads schedule events on one consumer, each event carries the time it was enqueued
+// in its cookie and the consumer records how long it took to get to it. The producers wait @a pace_ns
+// between events, without a pause they outrun the consumer and the latency is that of a full queue.
+template <typename Q>
+Result
+run(Q &q, int64_t pace_ns = 0)
+{
+  int total = PRODUCERS * EVENTS_PER_PRODUCER;
+  std::unique_ptr<Event[]> events(new Event[total]);
+  std::vector<int64_t> latency;
+  std::atomic<bool> go{false};
+  std::vector<std::thread> producers;
+
+  latency.reserve(total);
+  for (int p = 0; p < PRODUCERS; ++p) {
+    producers.emplace_back([&, p]() {
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (int i = 0; i < EVENTS_PER_PRODUCER; ++i) {
+        Event *e  = &events[p * EVENTS_PER_PRODUCER + i];
+        int64_t t = now_ns();
+        e->cookie = reinterpret_cast<void *>(t);
+        q.enqueue(e);
+        while (pace_ns && now_ns() - t < pace_ns) {
+          ;
+        }
+      }
+    });
+  }
+
+  int64_t start = now_ns();
+  go.store(true, std::memory_order_release);
+  while (static_cast<int>(latency.size()) < total) {
+    Event *e;
+    q.dequeue_external();
+    while ((e = q.dequeue_local())) {
+      latency.push_back(now_ns() - reinterpret_cast<int64_t>(e->cookie));
+    }
+  }
+  int64_t elapsed = now_ns() - start;
+  for (auto &t : producers) {
+    t.join();
+  }
+
+  std::sort(latency.begin(), latency.end());
+  return {total * 1e9 / elapsed, latency[total / 2], latency[total * 99 / 100]};
+}
+
+template <typename Q>
+void
+report(const char *name)
+{
+  Q q1, q2;
+  Result flood = run(q1);
+  Result paced = run(q2, 2000);
+  std::printf("%-16s %12.0f events/sec  dispatch latency at %8.0f events/sec p50 %6" PRId64 " ns p99 %6" PRId64 " ns\n", name,
+              flood.events_per_sec, paced.events_per_sec, paced.p50_ns, paced.p99_ns);
+}
+
+} // namespace
+
+TEST_CASE("EventQueue", "[iocore]")
+{
+  // The events have no thread, enqueue does not try to wake one up.
+  report<OldQueue>("atomic list");
+  report<ProtectedQueue>("ProtectedQueue");
+
+  BENCHMARK("atomic list")
+  {
+    OldQueue q;
+    return run(q).events_per_sec;
+  };
+
+  BENCHMARK("ProtectedQueue")
+  {
+    ProtectedQueue q;
+    return run(q).events_per_sec;
+  };
+}
+
+TEST_CASE("EventQueue order", "[iocore]")
+{
+  ProtectedQueue q;
+  Event events[4];
+  Event *e;
+  int n = 0;
+
+  CHECK(q.external_empty());
+  for (auto &ev : events) {
+    q.enqueue(&ev);
+  }
+  CHECK(!q.external_empty());
+  q.dequeue_external();
+  while ((e = q.dequeue_local())) {
+    CHECK(e == &events[n++]);
+  }
+  CHECK(n == 4);
+  CHECK(q.external_empty());
+}
+
+TEST_CASE("EventQueue steal", "[iocore]")
+{
+  ProtectedQueue q;
+  Event events[8];
+  Que(Event, link) stolen;
+
+  for (int i = 0; i < 8; ++i) {
+    events[i].stealable = i != 5;
+    q.enqueue(&events[i]);
+  }
+  // Events are taken in order and stealing stops at the first one that has to stay.
+  CHECK(q.steal(stolen, 4) == 4);
+  CHECK(stolen.head == &events[0]);
+  CHECK(q.steal(stolen, 4) == 1);
+  CHECK(stolen.tail == &events[4]);
+  CHECK(q.steal(stolen, 4) == 0);
+
+  Event *e;
+  int n = 5;
+  q.dequeue_external();
+  while ((e = q.dequeue_local())) {
+    CHECK(e == &events[n++]);
+  }
+  CHECK(n == 8);
+  CHECK(q.external_empty());
+}
@@ -25,6 +25,13 @@ limitations under the License.
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+
 #include "I_EventSystem.h"
 #include "I_Thread.h"
 #include "tscore/Allocator.h"
@@ -50,8 +57,74 @@ struct BItem {
   char buffer[128];
 };
 
+constexpr int BATCH  = 256;
+constexpr int ROUNDS = 200;
+
+// @a n threads each allocate @a BATCH items and free them again, @a ROUNDS times. Half of the batch
+// is freed by the next thread so that blocks also move between threads. Returns allocations per
+// second over all threads.
+template <typename A>
+double
+scale(A &a, int n)
+{
+  std::vector<std::thread> threads;
+  std::vector<std::vector<BItem *>> handoff(n);
+  std::atomic<int> ready{0};
+  std::atomic<bool> go{false};
+
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < n; ++t) {
+    threads.emplace_back([&, t]() {
+      std::vector<BItem *> items;
+      items.reserve(BATCH);
+      ++ready;
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (int r = 0; r < ROUNDS; ++r) {
+        for (int i = 0; i < BATCH; ++i) {
+          items.push_back(a.alloc());
+        }
+        for (auto item : items) {
+          a.free(item);
+        }
+        items.clear();
+      }
+      // Allocated here, freed by the next thread after the join.
+      for (int i = 0; i < BATCH / 2; ++i) {
+        handoff[(t + 1) % n].push_back(a.alloc());
+      }
+    });
+  }
+  while (ready.load() < n) {
+    std::this_thread::yield();
+  }
+  start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto &t : threads) {
+    t.join();
+  }
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  threads.clear();
+  for (int t = 0; t < n; ++t) {
+    threads.emplace_back([&, t]() {
+      for (auto item : handoff[t]) {
+        a.free(item);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  return n * (ROUNDS * BATCH + BATCH / 2) / elapsed;
+}
+
 } // namespace
 
+ClassAllocator<BItem, false, FreelistAllocator> freelistAllocator("freelist");
+ClassAllocator<BItem, false, MagazineAllocator> magazineAllocator("magazine");
+
 // THREAD_ALLOC/FREE requires allocators be global variables and are named after one of the defined ProxyAllocator members
 ClassAllocator<BItem> ioAllocator("io");
 
@@ -110,3 +183,41 @@ TEST_CASE("ProxyAllocator", "[iocore]")
 
   delete bench_thread;
 }
+
+TEST_CASE("ProxyAllocator scaling", "[iocore]")
+{
+  std::printf("%8s %16s %16s\n", "threads", "freelist/sec", "magazine/sec");
+  for (int n = 1; n <= 128; n *= 2) {
+    double fl  = scale(freelistAllocator, n);
+    double mag = scale(magazineAllocator, n);
+    std::printf("%8d %16.0f %16.0f\n", n, fl, mag);
+  }
+}
+
+TEST_CASE("MagazineAllocator", "[iocore]")
+{
+  ClassAllocator<BItem, false, MagazineAllocator> a("check");
+  std::vector<BItem *> items;
+  std::set<BItem *> seen;
+
+  // Enough to go through several chunks and magazines.
+  for (int i = 0; i < 10 * BATCH; ++i) {
+    items.push_back(a.alloc());
+    seen.insert(items.back());
+  }
+  CHECK(seen.size() == items.size());
+
+  // Freed on another thread, the blocks come back through the depot.
+  std::thread([&]() {
+    for (auto item : items) {
+      a.free(item);
+    }
+  }).join();
+  for (auto &item : items) {
+    item = a.alloc();
+    CHECK(seen.count(item) == 1);
+  }
+  for (auto item : items) {
+    a.free(item);
+  }
+}
@@ -0,0 +1,146 @@
+/** @file
+
+  Unit tests for TimingWheel
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <random>
+#include <vector>
+
+#include "I_TimingWheel.h"
+
+namespace
+{
+struct Timer {
+  ink_hrtime at = 0;
+  int slot      = -1;
+  bool dropped  = false;
+  LINK(Timer, link);
+};
+
+struct TimerTraits {
+  static ink_hrtime
+  expiry(Timer *t)
+  {
+    return t->at;
+  }
+  static int
+  slot(Timer *t)
+  {
+    return t->slot;
+  }
+  static void
+  set_slot(Timer *t, int slot)
+  {
+    t->slot = slot;
+  }
+};
+
+using Wheel = TimingWheel<Timer, Timer::Link_link, TimerTraits>;
+
+constexpr ink_hrtime TICK = HRTIME_MSECOND;
+
+auto keep = [](Timer *) { return false; };
+
+} // namespace
+
+TEST_CASE("TimingWheel order", "[iocore][TimingWheel]")
+{
+  ink_hrtime start = HRTIME_SECONDS(1000) + 123;
+  Wheel wheel(TICK, start);
+  std::mt19937_64 rng(42);
+  std::vector<Timer> timers(2000);
+
+  // Spread over every level and the overflow queue.
+  for (auto &t : timers) {
+    t.at = start + static_cast<ink_hrtime>(rng() % (uint64_t(1) << (rng() % 27))) * TICK / 4;
+    wheel.insert(&t);
+  }
+
+  ink_hrtime now = start;
+  size_t seen    = 0;
+  while (seen < timers.size()) {
+    ink_hrtime next = wheel.earliest();
+    REQUIRE(next != HRTIME_FOREVER);
+    REQUIRE(next >= now - TICK);
+    now = std::max(now, next);
+    wheel.advance(now, keep);
+    while (Timer *t = wheel.pop_ready()) {
+      // Never early, and at most a tick late.
+      CHECK(t->at <= now);
+      CHECK(now - t->at < TICK);
+      ++seen;
+    }
+  }
+  CHECK(wheel.earliest() == HRTIME_FOREVER);
+}
+
+TEST_CASE("TimingWheel remove", "[iocore][TimingWheel]")
+{
+  Wheel wheel(TICK, 0);
+  Timer a, b, c;
+
+  a.at = HRTIME_MSECONDS(10);
+  b.at = HRTIME_SECONDS(10);
+  c.at = HRTIME_MSECONDS(10);
+  wheel.insert(&a);
+  wheel.insert(&b);
+  wheel.insert(&c);
+  CHECK(wheel.earliest() == HRTIME_MSECONDS(10));
+
+  wheel.remove(&a);
+  wheel.remove(&c);
+  // b is on a higher level, the next step is when its slot is moved down.
+  CHECK(wheel.earliest() > HRTIME_MSECONDS(10));
+  CHECK(wheel.earliest() <= HRTIME_SECONDS(10));
+
+  wheel.advance(HRTIME_SECONDS(9), keep);
+  CHECK(!wheel.has_ready());
+  wheel.advance(HRTIME_SECONDS(10), keep);
+  CHECK(wheel.pop_ready() == &b);
+  CHECK(wheel.pop_ready() == nullptr);
+}
+
+TEST_CASE("TimingWheel drop", "[iocore][TimingWheel]")
+{
+  Wheel wheel(TICK, 0);
+  Timer a, b;
+
+  a.at = HRTIME_SECONDS(5);
+  b.at = HRTIME_SECONDS(5);
+  wheel.insert(&a);
+  wheel.insert(&b);
+  a.dropped = true;
+
+  // An element past its time when it is inserted is ready at once.
+  Timer late;
+  wheel.advance(HRTIME_SECONDS(1), keep);
+  late.at = HRTIME_MSECONDS(500);
+  wheel.insert(&late);
+  CHECK(wheel.pop_ready() == &late);
+
+  wheel.advance(HRTIME_SECONDS(6), [](Timer *t) { return t->dropped; });
+  CHECK(wheel.pop_ready() == &b);
+  CHECK(wheel.pop_ready() == nullptr);
+  CHECK(wheel.earliest() == HRTIME_FOREVER);
+}
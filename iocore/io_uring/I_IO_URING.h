@@ -24,15 +24,33 @@ Linux io_uring helper library
 #pragma once
 
 #include <liburing.h>
+#include <algorithm>
+#include <deque>
+#include <map>
 #include <utility>
+#include <vector>
+#include <sys/uio.h>
 #include "tscore/ink_hrtime.h"
 
+// Completion based network I/O needs provided buffer rings and multishot receives (liburing 2.4).
+#ifdef IO_URING_CHECK_VERSION
+#if !IO_URING_CHECK_VERSION(2, 3)
+#define TS_USE_IO_URING_NET 1
+#endif
+#endif
+#ifndef TS_USE_IO_URING_NET
+#define TS_USE_IO_URING_NET 0
+#endif
+
 struct IOUringConfig {
-  int queue_entries = 32;
-  int sq_poll_ms    = 0;
-  int attach_wq     = 0;
-  int wq_bounded    = 0;
-  int wq_unbounded  = 0;
+  int queue_entries   = 32;
+  int sq_poll_ms      = 0;
+  int attach_wq       = 0;
+  int wq_bounded      = 0;
+  int wq_unbounded    = 0;
+  int fixed           = 0;     // register files and buffers added with add_fixed_file / add_fixed_buffer
+  int net_buffers     = 1024;  // receive buffers per thread for ports with the uring option, a power of 2
+  int net_buffer_size = 16384; // size of each receive buffer
 };
 
 class IOUringCompletionHandler
@@ -70,8 +88,28 @@ public:
 
   int register_eventfd();
 
+#if TS_USE_IO_URING_NET
+  // Provided buffer ring @a bgid of @a entries buffers, for receives that pick their buffer at completion.
+  // nullptr if the kernel does not support it.
+  io_uring_buf_ring *setup_buf_ring(unsigned entries, int bgid);
+#endif
+
+  // Files and buffers registered on every ring, so that the hot disk paths can use
+  // IOSQE_FIXED_FILE and the READ_FIXED / WRITE_FIXED opcodes. Each thread registers them with
+  // its own ring on its next lookup. Return false if fixed resources are disabled or the table
+  // is full. A file must be removed before it is closed, a buffer before it is freed.
+  static bool add_fixed_file(int fd);
+  static bool add_fixed_buffer(void *base, size_t len);
+  static void remove_fixed_file(int fd);
+  static void remove_fixed_buffer(void *base);
+
+  // Index of @a fd / the buffer containing [@a p, @a p + @a len) on this ring, -1 if not registered.
+  int fixed_file(int fd);
+  int fixed_buffer(const void *p, size_t len);
+
   // assigns the global iouring config
   static void set_config(const IOUringConfig &);
+  static const IOUringConfig &get_config();
   static IOUringContext *local_context();
   static void set_main_queue(IOUringContext *);
   static int get_main_queue_fd();
@@ -81,9 +119,194 @@ private:
   io_uring_probe *probe = nullptr;
   int evfd              = -1;
 
+  int fixed_generation = 0;
+  bool fixed_failed    = false;
+  std::vector<int> fixed_files;                        // fd by slot, as registered with this ring
+  std::vector<iovec> fixed_buffers;                    // by slot, as registered with this ring
+  std::vector<int> fixed_file_index;                   // slot by fd
+  std::map<const char *, unsigned> fixed_buffer_index; // slot by buffer base
+
   void handle_cqe(io_uring_cqe *);
+  void sync_fixed();
   static IOUringConfig config;
 };
 
+#if TS_USE_IO_URING_NET
+class IOUringRecv;
+
+// Receive buffers handed to the kernel through a provided buffer ring. A multishot receive picks a
+// buffer for each completion, so idle sockets hold no memory.
+class IOUringBufferRing
+{
+public:
+  // @a count buffers of @a size bytes as group @a bgid of @a ur, nullptr if the kernel does not support it.
+  static IOUringBufferRing *create(IOUringContext *ur, int bgid, unsigned count, unsigned size);
+
+  IOUringContext *
+  context() const
+  {
+    return ur;
+  }
+
+  int
+  group() const
+  {
+    return bgid;
+  }
+
+  char *
+  data(unsigned bid) const
+  {
+    return base + static_cast<size_t>(bid) * size;
+  }
+
+  // Buffers the kernel can still pick.
+  unsigned
+  available() const
+  {
+    return nfree;
+  }
+
+  // Buffers one receive may hold before it stops, so a socket that is not read cannot take them all.
+  unsigned
+  share() const
+  {
+    return std::max(count / 8, 1U);
+  }
+
+  // A completion picked a buffer.
+  void
+  take()
+  {
+    --nfree;
+  }
+
+  // Give buffer @a bid back to the kernel, restarting the starved receives once a share is free.
+  void recycle(unsigned bid);
+
+  // Restart @a recv when buffers are recycled.
+  void wait(IOUringRecv *recv);
+  void cancel_wait(IOUringRecv *recv);
+
+private:
+  IOUringContext *ur      = nullptr;
+  io_uring_buf_ring *ring = nullptr;
+  char *base              = nullptr;
+  int bgid                = 0;
+  unsigned count          = 0;
+  unsigned size           = 0;
+  unsigned nfree          = 0;
+  std::vector<IOUringRecv *> starved;
+};
+
+// A multishot receive on a socket, on the ring of @a buffers, the data it delivers is queued until
+// recv copies it out. The receive is stopped while the owner does not want data or holds its share
+// of the buffers and armed again when the data is read. When the buffers run out it waits for them
+// to be recycled rather than failing again straight away.
+class IOUringRecv : public IOUringCompletionHandler
+{
+public:
+  IOUringRecv(IOUringBufferRing *buffers, int fd) : buffers(buffers), fd(fd) {}
+
+  // Arm the receive, false if the submission queue is full.
+  bool start();
+  // Copy queued data to @a iov. Returns the number of bytes copied, 0 at end of stream, -EAGAIN if
+  // no data is queued or -errno.
+  int64_t recv(iovec *iov, int niov);
+  // The owner is done with the socket, drop the queued data and cancel the receive. False if the
+  // cancel could not be submitted.
+  bool stop();
+  // Buffers were recycled after the ring ran out.
+  void restart();
+
+  bool
+  in_flight() const
+  {
+    return armed;
+  }
+
+  size_t
+  queued() const
+  {
+    return received.size();
+  }
+
+  void handle_complete(io_uring_cqe *cqe) override;
+
+protected:
+  // Data, the end of the stream or an error is ready for recv.
+  virtual void ready() = 0;
+  // Whether the owner reads the socket now.
+  virtual bool wants_data() const = 0;
+  // The last completion after stop arrived.
+  virtual void
+  stopped()
+  {
+  }
+
+private:
+  struct Chunk {
+    unsigned bid;
+    uint32_t offset;
+    uint32_t len;
+  };
+
+  bool arm();
+  bool resume();
+  bool cancel();
+
+  IOUringBufferRing *buffers;
+  int fd;
+  std::deque<Chunk> received;
+  int status      = 1; // 1 while open, 0 at end of stream, -errno after an error
+  bool armed      = false;
+  bool cancelling = false;
+  bool starved    = false;
+  bool closed     = false;
+};
+
+// A send on a socket, at most one is in flight. The result is kept until the owner collects it.
+class IOUringSend : public IOUringCompletionHandler
+{
+public:
+  IOUringSend(IOUringContext *ur, int fd) : ur(ur), fd(fd) {}
+
+  // Send the @a niov buffers of @a iov, which must stay valid until the completion. False if a send
+  // is in flight or the submission queue is full.
+  bool start(iovec *iov, unsigned niov);
+  // The result of a completed send, bytes sent or -errno. False if there is none to collect.
+  bool result(int64_t &res);
+  // The owner is done with the socket, cancel the send. False if the cancel could not be submitted.
+  bool stop();
+
+  bool
+  in_flight() const
+  {
+    return armed;
+  }
+
+  void handle_complete(io_uring_cqe *cqe) override;
+
+protected:
+  // A send completed, its result is ready.
+  virtual void ready() = 0;
+  // The last completion after stop arrived.
+  virtual void
+  stopped()
+  {
+  }
+
+private:
+  IOUringContext *ur;
+  int fd;
+  msghdr msg   = {};
+  int64_t sent = 0;
+  bool armed   = false;
+  bool done    = false;
+  bool closed  = false;
+};
+#endif
+
 extern std::atomic<uint64_t> io_uring_submissions;
 extern std::atomic<uint64_t> io_uring_completions;
+extern std::atomic<uint64_t> io_uring_fixed_submissions;
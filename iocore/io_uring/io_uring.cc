@@ -22,27 +22,65 @@ Linux io_uring helper library
  */
 
 #include <sys/eventfd.h>
+#include <algorithm>
 #include <atomic>
 #include <cstring>
+#include <mutex>
 #include <stdexcept>
 
 #include <unistd.h>
 
 #include "I_IO_URING.h"
 #include "tscore/ink_hrtime.h"
+#include "tscore/ink_memory.h"
 
 std::atomic<int> main_wq_fd;
-std::atomic<uint64_t> io_uring_submissions = 0;
-std::atomic<uint64_t> io_uring_completions = 0;
+std::atomic<uint64_t> io_uring_submissions       = 0;
+std::atomic<uint64_t> io_uring_completions       = 0;
+std::atomic<uint64_t> io_uring_fixed_submissions = 0;
 
 IOUringConfig IOUringContext::config;
 
+namespace
+{
+constexpr unsigned MAX_FIXED_FILES   = 256;
+constexpr unsigned MAX_FIXED_BUFFERS = 1024;
+
+// The process wide tables of fixed resources, by slot, rings copy them on the next use after they
+// change. A free file slot is -1, a free buffer slot has a null base.
+std::mutex fixed_mutex;
+std::vector<int> fixed_file_table;
+std::vector<iovec> fixed_buffer_table;
+std::atomic<int> fixed_table_generation{0};
+
+template <typename T, typename Free>
+int
+free_slot(std::vector<T> &table, unsigned max, Free &&is_free)
+{
+  auto spot = std::find_if(table.begin(), table.end(), is_free);
+  if (spot != table.end()) {
+    return spot - table.begin();
+  }
+  if (table.size() >= max) {
+    return -1;
+  }
+  table.emplace_back();
+  return table.size() - 1;
+}
+} // namespace
+
 void
 IOUringContext::set_config(const IOUringConfig &cfg)
 {
   config = cfg;
 }
 
+const IOUringConfig &
+IOUringContext::get_config()
+{
+  return config;
+}
+
 static io_uring_probe probe_unsupported     = {};
 constexpr int MAX_SUPPORTED_OP_BEFORE_PROBE = 20;
 
@@ -188,6 +226,316 @@ IOUringContext::register_eventfd()
   return evfd;
 }
 
+#if TS_USE_IO_URING_NET
+io_uring_buf_ring *
+IOUringContext::setup_buf_ring(unsigned entries, int bgid)
+{
+  int ret = 0;
+  return io_uring_setup_buf_ring(&ring, entries, bgid, 0, &ret);
+}
+
+namespace
+{
+// Completion of the cancel requests, the cancelled operation completes on its own.
+struct IOUringCancelOp : public IOUringCompletionHandler {
+  void
+  handle_complete(io_uring_cqe *) override
+  {
+  }
+} cancel_op;
+
+io_uring_sqe *
+get_sqe(IOUringContext *ur, IOUringCompletionHandler *op)
+{
+  io_uring_sqe *sqe = ur->next_sqe(op);
+
+  if (sqe == nullptr) {
+    // The submission queue is full, push it to the kernel and try again.
+    ur->submit();
+    sqe = ur->next_sqe(op);
+  }
+  return sqe;
+}
+
+bool
+submit_cancel(IOUringContext *ur, IOUringCompletionHandler *op)
+{
+  io_uring_sqe *sqe = get_sqe(ur, &cancel_op);
+
+  if (sqe == nullptr) {
+    return false;
+  }
+  io_uring_prep_cancel(sqe, op, 0);
+  return true;
+}
+} // namespace
+
+//
+// IOUringBufferRing
+//
+IOUringBufferRing *
+IOUringBufferRing::create(IOUringContext *ur, int bgid, unsigned count, unsigned size)
+{
+  io_uring_buf_ring *ring = ur->setup_buf_ring(count, bgid);
+
+  if (ring == nullptr) {
+    return nullptr;
+  }
+
+  IOUringBufferRing *buffers = new IOUringBufferRing;
+  buffers->ur                = ur;
+  buffers->ring              = ring;
+  buffers->bgid              = bgid;
+  buffers->count             = count;
+  buffers->size              = size;
+  buffers->nfree             = count;
+  buffers->base              = static_cast<char *>(ats_malloc(static_cast<size_t>(count) * size));
+  for (unsigned bid = 0; bid < count; ++bid) {
+    io_uring_buf_ring_add(ring, buffers->data(bid), size, bid, io_uring_buf_ring_mask(count), bid);
+  }
+  io_uring_buf_ring_advance(ring, count);
+  return buffers;
+}
+
+void
+IOUringBufferRing::recycle(unsigned bid)
+{
+  io_uring_buf_ring_add(ring, data(bid), size, bid, io_uring_buf_ring_mask(count), 0);
+  io_uring_buf_ring_advance(ring, 1);
+  ++nfree;
+
+  // Waking the starved receives on every buffer would have them run dry again at once.
+  if (!starved.empty() && nfree >= share()) {
+    std::vector<IOUringRecv *> waiting;
+    waiting.swap(starved);
+    for (IOUringRecv *recv : waiting) {
+      recv->restart();
+    }
+  }
+}
+
+void
+IOUringBufferRing::wait(IOUringRecv *recv)
+{
+  starved.push_back(recv);
+}
+
+void
+IOUringBufferRing::cancel_wait(IOUringRecv *recv)
+{
+  starved.erase(std::remove(starved.begin(), starved.end(), recv), starved.end());
+}
+
+//
+// IOUringRecv
+//
+bool
+IOUringRecv::start()
+{
+  return arm();
+}
+
+bool
+IOUringRecv::arm()
+{
+  io_uring_sqe *sqe = get_sqe(buffers->context(), this);
+
+  if (sqe == nullptr) {
+    return false;
+  }
+  io_uring_prep_recv_multishot(sqe, fd, nullptr, 0, 0);
+  sqe->flags     |= IOSQE_BUFFER_SELECT;
+  sqe->buf_group  = buffers->group();
+  armed           = true;
+  return true;
+}
+
+// Arm the receive again if it stopped and the owner wants more data, false if that failed.
+bool
+IOUringRecv::resume()
+{
+  if (armed || starved || closed || status <= 0 || received.size() >= buffers->share() || !wants_data()) {
+    return true;
+  }
+  return arm();
+}
+
+bool
+IOUringRecv::cancel()
+{
+  if (!cancelling) {
+    cancelling = submit_cancel(buffers->context(), this);
+  }
+  return cancelling;
+}
+
+void
+IOUringRecv::restart()
+{
+  starved = false;
+  // Not gated on wants_data, nothing else would arm a receive that has no data queued. If the owner
+  // does not read, the first completion stops it again.
+  if (!armed && !closed && status > 0 && received.size() < buffers->share()) {
+    arm();
+  }
+}
+
+int64_t
+IOUringRecv::recv(iovec *iov, int niov)
+{
+  int64_t total = 0;
+  size_t filled = 0;
+
+  for (int i = 0; i < niov && !received.empty();) {
+    Chunk &chunk = received.front();
+    size_t len   = std::min<size_t>(chunk.len, iov[i].iov_len - filled);
+
+    memcpy(static_cast<char *>(iov[i].iov_base) + filled, buffers->data(chunk.bid) + chunk.offset, len);
+    total        += len;
+    filled       += len;
+    chunk.offset += len;
+    chunk.len    -= len;
+    if (chunk.len == 0) {
+      buffers->recycle(chunk.bid);
+      received.pop_front();
+    }
+    if (filled == iov[i].iov_len) {
+      ++i;
+      filled = 0;
+    }
+  }
+
+  bool armed_ok = resume();
+  if (total > 0) {
+    return total;
+  }
+  if (status <= 0) {
+    return status;
+  }
+  return armed_ok ? -EAGAIN : -ENOBUFS;
+}
+
+void
+IOUringRecv::handle_complete(io_uring_cqe *cqe)
+{
+  bool more = cqe->flags & IORING_CQE_F_MORE;
+  int res   = cqe->res;
+
+  if (!more) {
+    armed      = false;
+    cancelling = false;
+  }
+  if (cqe->flags & IORING_CQE_F_BUFFER) {
+    unsigned bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    buffers->take();
+    if (res > 0 && !closed) {
+      received.push_back({bid, 0, static_cast<uint32_t>(res)});
+    } else {
+      buffers->recycle(bid);
+    }
+  }
+
+  if (closed) {
+    if (!armed) {
+      stopped();
+    }
+    return;
+  }
+
+  if (res == -ENOBUFS) {
+    // The queued data, if any, was reported by the completions that brought it.
+    starved = true;
+    buffers->wait(this);
+    return;
+  }
+  if (res == -ECANCELED) {
+    // Stopped while not reading, the data may have been read since.
+    resume();
+    return;
+  }
+
+  if (res == 0) {
+    status = 0;
+  } else if (res < 0) {
+    status = res;
+  } else if (more && (received.size() >= buffers->share() || !wants_data())) {
+    // Leave the data in the socket, its window holds the peer back.
+    cancel();
+  } else if (!more) {
+    resume();
+  }
+  ready();
+}
+
+bool
+IOUringRecv::stop()
+{
+  closed = true;
+  for (auto &chunk : received) {
+    buffers->recycle(chunk.bid);
+  }
+  received.clear();
+  if (starved) {
+    buffers->cancel_wait(this);
+    starved = false;
+  }
+  return !armed || cancel();
+}
+
+//
+// IOUringSend
+//
+bool
+IOUringSend::start(iovec *iov, unsigned niov)
+{
+  io_uring_sqe *sqe = armed || niov == 0 ? nullptr : get_sqe(ur, this);
+
+  if (sqe == nullptr) {
+    return false;
+  }
+  msg            = {};
+  msg.msg_iov    = iov;
+  msg.msg_iovlen = niov;
+  io_uring_prep_sendmsg(sqe, fd, &msg, MSG_NOSIGNAL);
+  armed = true;
+  done  = false;
+  return true;
+}
+
+bool
+IOUringSend::result(int64_t &res)
+{
+  if (!done) {
+    return false;
+  }
+  done = false;
+  res  = sent;
+  return true;
+}
+
+bool
+IOUringSend::stop()
+{
+  closed = true;
+  return !armed || submit_cancel(ur, this);
+}
+
+void
+IOUringSend::handle_complete(io_uring_cqe *cqe)
+{
+  armed = false;
+  if (closed) {
+    stopped();
+    return;
+  }
+
+  // A send of more than 0 bytes that sends nothing is a broken connection.
+  sent = cqe->res != 0 ? cqe->res : -EPIPE;
+  done = true;
+  ready();
+}
+#endif
+
 IOUringContext *
 IOUringContext::local_context()
 {
@@ -196,6 +544,164 @@ IOUringContext::local_context()
   return &threadContext;
 }
 
+bool
+IOUringContext::add_fixed_file(int fd)
+{
+  std::lock_guard<std::mutex> lock(fixed_mutex);
+  if (!config.fixed || fd < 0) {
+    return false;
+  }
+  if (std::find(fixed_file_table.begin(), fixed_file_table.end(), fd) != fixed_file_table.end()) {
+    return true;
+  }
+  int slot = free_slot(fixed_file_table, MAX_FIXED_FILES, [](int f) { return f < 0; });
+  if (slot < 0) {
+    return false;
+  }
+  fixed_file_table[slot] = fd;
+  fixed_table_generation++;
+  return true;
+}
+
+bool
+IOUringContext::add_fixed_buffer(void *base, size_t len)
+{
+  std::lock_guard<std::mutex> lock(fixed_mutex);
+  if (!config.fixed || base == nullptr) {
+    return false;
+  }
+  for (auto &iov : fixed_buffer_table) {
+    if (iov.iov_base == base && iov.iov_len == len) {
+      return true;
+    }
+  }
+  int slot = free_slot(fixed_buffer_table, MAX_FIXED_BUFFERS, [](const iovec &iov) { return iov.iov_base == nullptr; });
+  if (slot < 0) {
+    return false;
+  }
+  fixed_buffer_table[slot] = {base, len};
+  fixed_table_generation++;
+  return true;
+}
+
+void
+IOUringContext::remove_fixed_file(int fd)
+{
+  std::lock_guard<std::mutex> lock(fixed_mutex);
+  for (auto &f : fixed_file_table) {
+    if (f == fd) {
+      f = -1;
+      fixed_table_generation++;
+    }
+  }
+}
+
+void
+IOUringContext::remove_fixed_buffer(void *base)
+{
+  std::lock_guard<std::mutex> lock(fixed_mutex);
+  for (auto &iov : fixed_buffer_table) {
+    if (iov.iov_base == base) {
+      iov = {nullptr, 0};
+      fixed_table_generation++;
+    }
+  }
+}
+
+// Bring the registrations of this ring in line with the process wide tables, slot by slot on
+// sparse tables, so the indices of the resources which did not change stay valid. Every lookup
+// syncs first, so a removed buffer is never used once remove_fixed_buffer() returns. On failure
+// (old kernel, RLIMIT_MEMLOCK) this ring stops using fixed resources altogether.
+void
+IOUringContext::sync_fixed()
+{
+  if (fixed_table_generation.load(std::memory_order_acquire) == fixed_generation || fixed_failed) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(fixed_mutex);
+  if (fixed_generation == 0) {
+    if (io_uring_register_files_sparse(&ring, MAX_FIXED_FILES) < 0 ||
+        io_uring_register_buffers_sparse(&ring, MAX_FIXED_BUFFERS) < 0) {
+      fixed_failed = true;
+      return;
+    }
+  }
+  fixed_files.resize(fixed_file_table.size(), -1);
+  for (unsigned i = 0; i < fixed_file_table.size(); i++) {
+    int fd = fixed_file_table[i];
+    if (fixed_files[i] == fd) {
+      continue;
+    }
+    if (fixed_files[i] >= 0) {
+      fixed_file_index[fixed_files[i]] = -1;
+    }
+    // -1 empties the slot
+    if (io_uring_register_files_update(&ring, i, &fd, 1) < 0) {
+      fixed_failed = true;
+      return;
+    }
+    fixed_files[i] = fd;
+    if (fd >= 0) {
+      if (static_cast<unsigned>(fd) >= fixed_file_index.size()) {
+        fixed_file_index.resize(fd + 1, -1);
+      }
+      fixed_file_index[fd] = i;
+    }
+  }
+  fixed_buffers.resize(fixed_buffer_table.size(), iovec{nullptr, 0});
+  for (unsigned i = 0; i < fixed_buffer_table.size(); i++) {
+    iovec iov = fixed_buffer_table[i];
+    if (fixed_buffers[i].iov_base == iov.iov_base && fixed_buffers[i].iov_len == iov.iov_len) {
+      continue;
+    }
+    if (fixed_buffers[i].iov_base) {
+      fixed_buffer_index.erase(static_cast<const char *>(fixed_buffers[i].iov_base));
+    }
+    // a null base and length empties the slot
+    if (io_uring_register_buffers_update_tag(&ring, i, &iov, nullptr, 1) < 0) {
+      fixed_failed = true;
+      return;
+    }
+    fixed_buffers[i] = iov;
+    if (iov.iov_base) {
+      fixed_buffer_index[static_cast<const char *>(iov.iov_base)] = i;
+    }
+  }
+  fixed_generation = fixed_table_generation.load(std::memory_order_relaxed);
+}
+
+int
+IOUringContext::fixed_file(int fd)
+{
+  sync_fixed();
+  if (fixed_failed || fd < 0 || static_cast<unsigned>(fd) >= fixed_file_index.size()) {
+    return -1;
+  }
+  return fixed_file_index[fd];
+}
+
+int
+IOUringContext::fixed_buffer(const void *p, size_t len)
+{
+  sync_fixed();
+  if (fixed_failed || fixed_buffer_index.empty()) {
+    return -1;
+  }
+  // the registered buffer with the highest base at or below p is the only one which can hold it
+  const char *start = static_cast<const char *>(p);
+  auto spot         = fixed_buffer_index.upper_bound(start);
+  if (spot == fixed_buffer_index.begin()) {
+    return -1;
+  }
+  --spot;
+  const iovec &iov = fixed_buffers[spot->second];
+  if (start + len > static_cast<const char *>(iov.iov_base) + iov.iov_len) {
+    return -1;
+  }
+  return spot->second;
+}
+
 bool
 IOUringContext::supports_op(int op) const
 {
@@ -20,6 +20,7 @@
   See the License for the specific language governing permissions and
   limitations under the License.
  */
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #define CATCH_CONFIG_MAIN
 #include <atomic>
 #include "catch.hpp"
@@ -28,8 +29,15 @@
 
 #include "I_IO_URING.h"
 
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
 #include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -161,6 +169,201 @@ TEST_CASE("disk_io", "[io_uring]")
   ctx.submit_and_wait(100 * HRTIME_MSECOND);
 }
 
+// Disk read throughput of io_uring with and without fixed files and buffers, against a pool of
+// threads doing pread, which is what the thread AIO backend does. The reads bypass the page cache
+// with O_DIRECT, as the cache opens its disks.
+namespace
+{
+constexpr int IO_SIZE       = 4096;
+constexpr int IO_COUNT      = 256; // per benchmark iteration
+constexpr int IO_DEPTH      = 32;  // in flight per submit
+constexpr int FILE_BLOCKS   = 1024;
+constexpr int POOL_THREADS  = 4;
+constexpr size_t IO_BUFFERS = static_cast<size_t>(IO_DEPTH) * IO_SIZE;
+
+class CountingHandler : public IOUringCompletionHandler
+{
+public:
+  void
+  handle_complete(io_uring_cqe *c) override
+  {
+    completed++;
+    if (c->res != IO_SIZE) {
+      errors++;
+    }
+  }
+
+  int completed = 0;
+  int errors    = 0;
+};
+
+off_t
+block_offset(int i)
+{
+  return static_cast<off_t>((i * 7919) % FILE_BLOCKS) * IO_SIZE;
+}
+
+int
+uring_read_batch(IOUringContext &ctx, int fd, char *buffers, bool fixed)
+{
+  CountingHandler h;
+  int file = fixed ? ctx.fixed_file(fd) : -1;
+  int buf  = fixed ? ctx.fixed_buffer(buffers, IO_BUFFERS) : -1;
+
+  for (int i = 0; i < IO_COUNT; i += IO_DEPTH) {
+    for (int j = 0; j < IO_DEPTH; j++) {
+      io_uring_sqe *sqe = ctx.next_sqe(&h);
+      char *dst         = buffers + j * IO_SIZE;
+      if (buf >= 0) {
+        io_uring_prep_read_fixed(sqe, file >= 0 ? file : fd, dst, IO_SIZE, block_offset(i + j), buf);
+      } else {
+        io_uring_prep_read(sqe, file >= 0 ? file : fd, dst, IO_SIZE, block_offset(i + j));
+      }
+      if (file >= 0) {
+        sqe->flags |= IOSQE_FIXED_FILE;
+      }
+    }
+    while (h.completed < i + IO_DEPTH) {
+      ctx.submit_and_wait(1 * HRTIME_SECOND);
+    }
+  }
+  return h.errors;
+}
+
+class PreadPool
+{
+public:
+  PreadPool()
+  {
+    for (int i = 0; i < POOL_THREADS; i++) {
+      threads.emplace_back([this] { run(); });
+    }
+  }
+
+  ~PreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      shutdown = true;
+    }
+    work.notify_all();
+    for (auto &t : threads) {
+      t.join();
+    }
+  }
+
+  int
+  read_batch(int afd, char *abuffers)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    fd            = afd;
+    buffers       = abuffers;
+    next          = 0;
+    completed     = 0;
+    errors        = 0;
+    work.notify_all();
+    done.wait(lock, [this] { return completed == IO_COUNT; });
+    return errors;
+  }
+
+private:
+  void
+  run()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      work.wait(lock, [this] { return shutdown || next < IO_COUNT; });
+      if (shutdown) {
+        return;
+      }
+      int i = next++;
+      lock.unlock();
+      ssize_t r = ::pread(fd, buffers + (i % IO_DEPTH) * IO_SIZE, IO_SIZE, block_offset(i));
+      lock.lock();
+      if (r != IO_SIZE) {
+        errors++;
+      }
+      if (++completed == IO_COUNT) {
+        done.notify_one();
+      }
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable work;
+  std::condition_variable done;
+  std::vector<std::thread> threads;
+  bool shutdown = false;
+  int fd        = -1;
+  char *buffers = nullptr;
+  int next      = IO_COUNT;
+  int completed = 0;
+  int errors    = 0;
+};
+} // namespace
+
+TEST_CASE("disk_io_throughput", "[io_uring][benchmark]")
+{
+  IOUringConfig cfg = {
+    .queue_entries = IO_DEPTH,
+    .fixed         = 1,
+  };
+  IOUringContext::set_config(cfg);
+  IOUringContext ctx;
+
+  auto path    = temp_prefix("disk_io_throughput") / "data";
+  int write_fd = open_path(path);
+  REQUIRE(write_fd != -1);
+
+  std::vector<char> block(IO_SIZE, 'x');
+  for (int i = 0; i < FILE_BLOCKS; i++) {
+    REQUIRE(::pwrite(write_fd, block.data(), IO_SIZE, static_cast<off_t>(i) * IO_SIZE) == IO_SIZE);
+  }
+  REQUIRE(::fsync(write_fd) == 0);
+  close(write_fd);
+
+  int fd = open_path(path, O_RDONLY | O_DIRECT);
+  if (fd == -1 && errno == EINVAL) {
+    WARN("the temporary directory does not support O_DIRECT, the reads go through the page cache");
+    fd = open_path(path, O_RDONLY);
+  }
+  REQUIRE(fd != -1);
+
+  char *buffers = static_cast<char *>(aligned_alloc(IO_SIZE, IO_BUFFERS));
+  REQUIRE(IOUringContext::add_fixed_file(fd));
+  REQUIRE(IOUringContext::add_fixed_buffer(buffers, IO_BUFFERS));
+  if (ctx.fixed_file(fd) < 0 || ctx.fixed_buffer(buffers, IO_BUFFERS) < 0) {
+    WARN("fixed files or buffers are not supported, the fixed benchmark uses regular reads");
+  }
+
+  REQUIRE(uring_read_batch(ctx, fd, buffers, false) == 0);
+  REQUIRE(uring_read_batch(ctx, fd, buffers, true) == 0);
+  PreadPool pool;
+  REQUIRE(pool.read_batch(fd, buffers) == 0);
+
+  BENCHMARK("io_uring read 256 x 4KB")
+  {
+    return uring_read_batch(ctx, fd, buffers, false);
+  };
+
+  BENCHMARK("io_uring fixed read 256 x 4KB")
+  {
+    return uring_read_batch(ctx, fd, buffers, true);
+  };
+
+  BENCHMARK("thread pool pread 256 x 4KB")
+  {
+    return pool.read_batch(fd, buffers);
+  };
+
+  IOUringContext::remove_fixed_buffer(buffers);
+  IOUringContext::remove_fixed_file(fd);
+  REQUIRE(ctx.fixed_buffer(buffers, IO_BUFFERS) == -1);
+  REQUIRE(ctx.fixed_file(fd) == -1);
+  free(buffers);
+  close(fd);
+}
+
 void
 set_reuseport(int s)
 {
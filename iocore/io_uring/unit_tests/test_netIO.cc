@@ -0,0 +1,254 @@
+/** @file
+
+  Catch based unit tests for the io_uring socket receive and send
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "I_IO_URING.h"
+
+#if TS_USE_IO_URING_NET
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+constexpr unsigned BUFFER_SIZE = 16;
+
+class TestRecv : public IOUringRecv
+{
+public:
+  TestRecv(IOUringBufferRing *buffers, int fd) : IOUringRecv(buffers, fd) {}
+
+  void
+  handle_complete(io_uring_cqe *cqe) override
+  {
+    ++completions;
+    IOUringRecv::handle_complete(cqe);
+  }
+
+  // Everything queued, -errno or 0 at end of stream if nothing is.
+  std::string
+  read(int64_t &r)
+  {
+    std::string data;
+    char buf[64];
+    iovec iov = {buf, sizeof(buf)};
+
+    while ((r = recv(&iov, 1)) > 0) {
+      data.append(buf, r);
+    }
+    return data;
+  }
+
+  bool reading    = true;
+  int completions = 0;
+  int readies     = 0;
+
+protected:
+  void
+  ready() override
+  {
+    ++readies;
+  }
+
+  bool
+  wants_data() const override
+  {
+    return reading;
+  }
+};
+
+class TestSend : public IOUringSend
+{
+public:
+  TestSend(IOUringContext *ur, int fd) : IOUringSend(ur, fd) {}
+
+  int readies = 0;
+
+protected:
+  void
+  ready() override
+  {
+    ++readies;
+  }
+};
+
+void
+run(IOUringContext &ctx, int rounds = 5)
+{
+  for (int i = 0; i < rounds; i++) {
+    ctx.submit_and_wait(10 * HRTIME_MSECOND);
+  }
+}
+
+// A ring for one test, each gets its own group.
+IOUringBufferRing *
+make_buffers(IOUringContext &ctx, unsigned count)
+{
+  static int bgid = 1;
+  return IOUringBufferRing::create(&ctx, bgid++, count, BUFFER_SIZE);
+}
+} // namespace
+
+TEST_CASE("net_io_recv_send", "[io_uring]")
+{
+  IOUringContext ctx;
+  IOUringBufferRing *buffers = make_buffers(ctx, 64);
+  if (buffers == nullptr) {
+    WARN("provided buffer rings are not supported by this kernel");
+    return;
+  }
+  int fds[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  TestRecv recv(buffers, fds[0]);
+  REQUIRE(recv.start());
+  REQUIRE(::write(fds[1], "hello", 5) == 5);
+  run(ctx);
+  REQUIRE(recv.readies > 0);
+  int64_t r = 0;
+  REQUIRE(recv.read(r) == "hello");
+  REQUIRE(r == -EAGAIN);
+  REQUIRE(buffers->available() == 64);
+
+  TestSend send(&ctx, fds[0]);
+  char pong[] = "pong";
+  iovec iov   = {pong, 4};
+  REQUIRE(send.start(&iov, 1));
+  REQUIRE_FALSE(send.start(&iov, 1));
+  run(ctx, 1);
+  int64_t sent = 0;
+  REQUIRE(send.readies == 1);
+  REQUIRE(send.result(sent));
+  REQUIRE(sent == 4);
+  REQUIRE_FALSE(send.result(sent));
+  char buf[8];
+  REQUIRE(::read(fds[1], buf, sizeof(buf)) == 4);
+  REQUIRE(memcmp(buf, "pong", 4) == 0);
+
+  ::close(fds[1]);
+  run(ctx, 1);
+  REQUIRE(recv.read(r).empty());
+  REQUIRE(r == 0);
+  REQUIRE_FALSE(recv.in_flight());
+  ::close(fds[0]);
+}
+
+TEST_CASE("net_io_recv_stops_while_not_reading", "[io_uring]")
+{
+  IOUringContext ctx;
+  IOUringBufferRing *buffers = make_buffers(ctx, 64);
+  if (buffers == nullptr) {
+    WARN("provided buffer rings are not supported by this kernel");
+    return;
+  }
+  int fds[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  TestRecv recv(buffers, fds[0]);
+  recv.reading = false;
+  REQUIRE(recv.start());
+  REQUIRE(::write(fds[1], "abc", 3) == 3);
+  run(ctx);
+  REQUIRE(recv.queued() == 1);
+  // The first completion cancels the receive, later data stays in the socket.
+  REQUIRE_FALSE(recv.in_flight());
+  REQUIRE(::write(fds[1], "def", 3) == 3);
+  run(ctx);
+  REQUIRE(recv.queued() == 1);
+
+  recv.reading = true;
+  int64_t r    = 0;
+  REQUIRE(recv.read(r) == "abc");
+  REQUIRE(recv.in_flight());
+  run(ctx);
+  REQUIRE(recv.read(r) == "def");
+
+  REQUIRE(recv.stop());
+  run(ctx);
+  REQUIRE_FALSE(recv.in_flight());
+  REQUIRE(buffers->available() == 64);
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+TEST_CASE("net_io_recv_waits_for_buffers", "[io_uring]")
+{
+  const unsigned count = 4;
+  IOUringContext ctx;
+  IOUringBufferRing *buffers = make_buffers(ctx, count);
+  if (buffers == nullptr) {
+    WARN("provided buffer rings are not supported by this kernel");
+    return;
+  }
+  int a[2], b[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, a) == 0);
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, b) == 0);
+
+  // A reader that does not keep up, it holds its share and maybe more before the receive stops.
+  std::string sent;
+  for (unsigned i = 0; i < 32 * BUFFER_SIZE; i++) {
+    sent.push_back('a' + i % 26);
+  }
+  TestRecv slow(buffers, a[0]);
+  REQUIRE(slow.start());
+  REQUIRE(::write(a[1], sent.data(), sent.size()) == static_cast<ssize_t>(sent.size()));
+  run(ctx);
+  REQUIRE(slow.queued() >= buffers->share());
+
+  TestRecv other(buffers, b[0]);
+  REQUIRE(other.start());
+  REQUIRE(::write(b[1], "ping", 4) == 4);
+  run(ctx);
+  if (buffers->available() == 0 && other.queued() == 0) {
+    // Out of buffers, the receive waits instead of being armed again and failing at once.
+    REQUIRE_FALSE(other.in_flight());
+    REQUIRE(other.completions == 1);
+    REQUIRE(other.readies == 0);
+    run(ctx);
+    REQUIRE(other.completions == 1);
+  }
+
+  // Reading gives the buffers back, which restarts both receives.
+  std::string received;
+  int64_t r = 0;
+  for (int i = 0; i < 1000 && received.size() < sent.size(); i++) {
+    received += slow.read(r);
+    REQUIRE(r == -EAGAIN);
+    run(ctx, 1);
+  }
+  REQUIRE(received == sent);
+  REQUIRE(other.read(r) == "ping");
+  REQUIRE(buffers->available() == count);
+
+  ::close(a[0]);
+  ::close(a[1]);
+  ::close(b[0]);
+  ::close(b[1]);
+}
+
+#endif
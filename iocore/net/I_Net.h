@@ -61,6 +61,9 @@ extern int net_accept_period;
 extern int net_retry_delay;
 extern int net_throttle_delay;
 
+/// Writes of at least this many bytes are sent zero copy on connections with @c SOCK_OPT_ZEROCOPY.
+extern int net_zerocopy_min_bytes;
+
 extern std::string_view net_ccp_in;
 extern std::string_view net_ccp_out;
 
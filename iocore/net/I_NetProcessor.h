@@ -103,6 +103,9 @@ public:
     */
     bool f_mptcp;
 
+    /// Use io_uring for accepts and for the I/O of accepted connections.
+    bool f_io_uring;
+
     /// Proxy Protocol enabled
     bool f_proxy_protocol;
 
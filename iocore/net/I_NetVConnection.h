@@ -153,6 +153,9 @@ struct NetVCOptions {
   // Use TCP Fast Open on this socket. The connect(2) call will be omitted.
   bool f_tcp_fastopen = false;
 
+  /// Do the socket I/O of the connection with io_uring instead of readiness polling.
+  bool f_io_uring = false;
+
   bool tls_upstream = false;
 
   /// Control use of SOCKS.
@@ -184,6 +187,8 @@ struct NetVCOptions {
   static uint32_t const SOCK_OPT_PACKET_TOS = 32;
   /// Value for TCP_NOTSENT_LOWAT @c sockopt_flags
   static uint32_t const SOCK_OPT_TCP_NOTSENT_LOWAT = 64;
+  /// Value for SO_ZEROCOPY @c sockopt_flags, only used for inbound connections.
+  static uint32_t const SOCK_OPT_ZEROCOPY = 128;
 
   uint32_t packet_mark;
   uint32_t packet_tos;
@@ -368,6 +373,7 @@ NetVCOptions::reset()
   addr_binding       = ANY_ADDR;
   f_blocking         = false;
   f_blocking_connect = false;
+  f_io_uring         = false;
   socks_support      = NORMAL_SOCKS;
   socks_version      = SOCKS_DEFAULT_VERSION;
   socket_recv_bufsize =
@@ -29,9 +29,12 @@
 ************************************************************************/
 
 #include "P_Net.h"
+#include "records/P_RecUtils.h"
+#include "tscore/ink_hw.h"
 #include <utility>
 
-RecRawStatBlock *net_rsb = nullptr;
+RecRawStatBlock *net_rsb      = nullptr;
+RecRawStatBlock *net_node_rsb = nullptr;
 
 // All in milli-seconds
 int net_config_poll_timeout = -1; // This will get set via either command line or records.yaml.
@@ -40,6 +43,8 @@ int net_accept_period       = 10;
 int net_retry_delay         = 10;
 int net_throttle_delay      = 50; /* milliseconds */
 
+int net_zerocopy_min_bytes = 16384;
+
 // For the in/out congestion control: ToDo: this probably would be better as ports: specifications
 std::string_view net_ccp_in;
 std::string_view net_ccp_out;
@@ -56,6 +61,7 @@ configure_net()
   // These are not reloadable
   REC_ReadConfigInteger(net_event_period, "proxy.config.net.event_period");
   REC_ReadConfigInteger(net_accept_period, "proxy.config.net.accept_period");
+  REC_ReadConfigInteger(net_zerocopy_min_bytes, "proxy.config.net.zerocopy_min_bytes");
 
   // This is kinda fugly, but better than it was before (on every connection in and out)
   // Note that these would need to be ats_free()'d if we ever want to clean that up, but
@@ -93,6 +99,12 @@ register_net_stats()
     {"proxy.process.net.write_bytes",                         net_write_bytes_stat                    },
     {"proxy.process.net.fastopen_out.attempts",               net_fastopen_attempts_stat              },
     {"proxy.process.net.fastopen_out.successes",              net_fastopen_successes_stat             },
+    {"proxy.process.net.io_uring.accepts",                    net_io_uring_accepts_stat               },
+    {"proxy.process.net.io_uring.recvs",                      net_io_uring_recvs_stat                 },
+    {"proxy.process.net.io_uring.sends",                      net_io_uring_sends_stat                 },
+    {"proxy.process.net.zerocopy.sends",                      net_zerocopy_sends_stat                 },
+    {"proxy.process.net.zerocopy.bytes",                      net_zerocopy_bytes_stat                 },
+    {"proxy.process.net.zerocopy.copied",                     net_zerocopy_copied_stat                },
     {"proxy.process.socks.connections_successful",            socks_connections_successful_stat       },
     {"proxy.process.socks.connections_unsuccessful",          socks_connections_unsuccessful_stat     },
   };
@@ -142,6 +154,33 @@ register_net_stats()
                      (int)net_requests_max_throttled_in_stat, RecRawStatSyncSum);
 }
 
+// Bytes the magazine allocators carved on the node, they keep the count.
+static int
+net_node_allocated_sync(const char *, RecDataT data_type, RecData *data, RecRawStatBlock *, int id)
+{
+  RecDataSetFromInt64(data_type, data, MagazineAllocator::node_allocated(id / Net_Node_Stat_Count));
+  return REC_ERR_OKAY;
+}
+
+static void
+register_net_node_stats()
+{
+  static const char *const names[] = {"read_bytes", "write_bytes", "allocated_bytes"};
+  static_assert(sizeof(names) / sizeof(names[0]) == Net_Node_Stat_Count);
+  int nodes = ink_number_of_numa_nodes();
+  char name[64];
+
+  net_node_rsb = RecAllocateRawStatBlock(nodes * Net_Node_Stat_Count);
+  for (int node = 0; node < nodes; ++node) {
+    for (int i = 0; i < Net_Node_Stat_Count; ++i) {
+      int id = node * Net_Node_Stat_Count + i;
+      snprintf(name, sizeof(name), "proxy.process.numa.node_%d.%s", node, names[i]);
+      RecRegisterRawStat(net_node_rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, id,
+                         i == net_node_allocated_bytes_stat ? net_node_allocated_sync : RecRawStatSyncSum);
+    }
+  }
+}
+
 void
 ink_net_init(ts::ModuleVersion version)
 {
@@ -155,6 +194,7 @@ ink_net_init(ts::ModuleVersion version)
     net_rsb = RecAllocateRawStatBlock(static_cast<int>(Net_Stat_Count));
     configure_net();
     register_net_stats();
+    register_net_node_stats();
   }
 
   init_called = 1;
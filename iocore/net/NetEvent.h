@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 
 #include "I_EventSystem.h"
@@ -102,8 +103,18 @@ public:
   /** Whether the current timeout is a default inactivity timeout. */
   bool use_default_inactivity_timeout = false;
 
+  /** When the InactivityCop looks at the timeouts next, not later than the earliest of them. */
+  ink_hrtime timeout_check_at = 0;
+  /** Position in NetHandler::timeout_wheel, -1 if not in it. */
+  int timeout_slot           = -1;
+  int in_timeout_update_list = 0;
+
+  /** The earliest of the inactivity and active timeouts, 0 if neither is set. */
+  ink_hrtime next_timeout_at() const;
+
   LINK(NetEvent, open_link);
-  LINK(NetEvent, cop_link);
+  LINK(NetEvent, timeout_link);
+  SLINK(NetEvent, timeout_update_link);
   LINKM(NetEvent, read, ready_link)
   SLINKM(NetEvent, read, enable_link)
   LINKM(NetEvent, write, ready_link)
@@ -130,6 +141,15 @@ NetEvent::has_error() const
   return error != 0;
 }
 
+inline ink_hrtime
+NetEvent::next_timeout_at() const
+{
+  if (next_inactivity_timeout_at && next_activity_timeout_at) {
+    return std::min(next_inactivity_timeout_at, next_activity_timeout_at);
+  }
+  return next_inactivity_timeout_at ? next_inactivity_timeout_at : next_activity_timeout_at;
+}
+
 inline void
 NetEvent::set_error_from_socket()
 {
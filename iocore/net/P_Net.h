@@ -57,11 +57,26 @@ enum Net_Stats {
   net_connections_throttled_in_stat,
   net_connections_throttled_out_stat,
   net_requests_max_throttled_in_stat,
+  net_io_uring_accepts_stat,
+  net_io_uring_recvs_stat,
+  net_io_uring_sends_stat,
+  net_zerocopy_sends_stat,
+  net_zerocopy_bytes_stat,
+  net_zerocopy_copied_stat,
   Net_Stat_Count
 };
 
+// Per NUMA node statistics, the block has Net_Node_Stat_Count entries for each node.
+enum Net_Node_Stats {
+  net_node_read_bytes_stat,
+  net_node_write_bytes_stat,
+  net_node_allocated_bytes_stat,
+  Net_Node_Stat_Count
+};
+
 struct RecRawStatBlock;
 extern RecRawStatBlock *net_rsb;
+extern RecRawStatBlock *net_node_rsb;
 #define SSL_HANDSHAKE_WANT_READ    6
 #define SSL_HANDSHAKE_WANT_WRITE   7
 #define SSL_HANDSHAKE_WANT_ACCEPT  8
@@ -73,6 +88,10 @@ extern RecRawStatBlock *net_rsb;
 
 #define NET_SUM_DYN_STAT(_x, _r) RecIncrRawStatSum(net_rsb, mutex->thread_holding, (int)_x, _r)
 
+#define NET_SUM_NODE_DYN_STAT(_x, _r)                                                                                       \
+  RecIncrRawStatSum(net_node_rsb, mutex->thread_holding, mutex->thread_holding->numa_node * Net_Node_Stat_Count + (int)_x, \
+                    _r)
+
 #define NET_READ_DYN_SUM(_x, _sum) RecGetRawStatSum(net_rsb, (int)_x, &_sum)
 
 #define NET_READ_DYN_STAT(_x, _count, _sum)        \
@@ -86,6 +86,7 @@ struct NetAccept : public Continuation {
   AcceptFunctionPtr accept_fn = nullptr;
   int ifd                     = NO_FD;
   int id                      = -1;
+  int thread_index            = -1; ///< Index of the ET_NET thread of a per thread accept, -1 otherwise.
   Ptr<NetAcceptAction> action_;
   SSLNextProtocolAccept *snpa = nullptr;
   EventIO ep;
@@ -108,6 +109,7 @@ struct NetAccept : public Continuation {
   virtual int acceptEvent(int event, void *e);
   virtual int acceptFastEvent(int event, void *e);
   virtual int accept_per_thread(int event, void *e);
+  void accept_connection(Connection &con, EThread *t);
   int acceptLoopEvent(int event, Event *e);
   void cancel();
 
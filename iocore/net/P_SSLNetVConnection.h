@@ -454,6 +454,7 @@ private:
   } sslHandshakeHookState = HANDSHAKE_HOOKS_PRE;
 
   int64_t redoWriteSize = 0;
+  bool ktlsSend         = false; ///< The kernel encrypts what is written to the socket, see @c _check_ktls.
 
   X509_STORE_CTX *verify_cert = nullptr;
 
@@ -480,6 +481,7 @@ private:
   ssl_error_t _ssl_write_buffer(const void *buf, int64_t nbytes, int64_t &nwritten);
   ssl_error_t _ssl_connect();
   ssl_error_t _ssl_accept();
+  void _check_ktls();
 };
 
 typedef int (SSLNetVConnection::*SSLNetVConnHandler)(int, void *);
@@ -57,6 +57,10 @@ ssl_curve_id SSLGetCurveNID(SSL *ssl);
 
 SSL_SESSION *SSLSessionDup(SSL_SESSION *sess);
 
+// Whether OpenSSL has handshake messages to send, such as the response to a KeyUpdate or deferred
+// session tickets. It only sends them from SSL_write, so data must not bypass it.
+bool SSLHasPendingPostHandshake(SSL *ssl);
+
 enum class SSLCertContextType;
 
 struct SSLLoadingContext {
@@ -326,6 +326,15 @@ public:
   ink_hrtime nextCheck;
   ink_hrtime lastCheck;
 
+  // Receive buffers of this thread, one per datagram of a recvmmsg() call. The packets read into a
+  // buffer point into it, it is reused once they are all freed.
+  static constexpr int RECV_BATCH = 32;
+  Ptr<IOBufferData> recv_buffers[RECV_BATCH];
+  // Datagrams shorter than this are copied to @a recv_shared, which the packets of many share.
+  static constexpr int64_t RECV_COPY_LIMIT = 16 * 1024;
+  Ptr<IOBufferData> recv_shared;
+  int64_t recv_shared_used = 0;
+
   int startNetEvent(int event, Event *data);
   int mainNetEvent(int event, Event *data);
 
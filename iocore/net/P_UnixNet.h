@@ -260,7 +260,6 @@ public:
   QueM(NetEvent, NetState, read, ready_link) read_ready_list;
   QueM(NetEvent, NetState, write, ready_link) write_ready_list;
   Que(NetEvent, open_link) open_list;
-  DList(NetEvent, cop_link) cop_list;
   ASLLM(NetEvent, NetState, read, enable_link) read_enable_list;
   ASLLM(NetEvent, NetState, write, enable_link) write_enable_list;
   Que(NetEvent, keep_alive_queue_link) keep_alive_queue;
@@ -268,6 +267,30 @@ public:
   Que(NetEvent, active_queue_link) active_queue;
   uint32_t active_queue_size = 0;
 
+  struct TimeoutTraits {
+    static ink_hrtime
+    expiry(NetEvent *ne)
+    {
+      return ne->timeout_check_at;
+    }
+    static int
+    slot(NetEvent *ne)
+    {
+      return ne->timeout_slot;
+    }
+    static void
+    set_slot(NetEvent *ne, int slot)
+    {
+      ne->timeout_slot = slot;
+    }
+  };
+  /// The open NetEvents by the time the InactivityCop looks at their timeouts next.
+  TimingWheel<NetEvent, NetEvent::Link_timeout_link, TimeoutTraits> timeout_wheel{HRTIME_SECOND, Thread::get_hrtime_updated()};
+  /// NetEvents whose timeouts were moved earlier on another thread.
+  ASLL(NetEvent, timeout_update_link) timeout_update_list;
+  /// How often the InactivityCop runs, NetEvents without a timeout are looked at this often.
+  ink_hrtime timeout_check_interval = HRTIME_SECOND;
+
 #ifdef TS_USE_LINUX_IO_URING
   EventIO uring_evio;
 #endif
@@ -319,6 +342,7 @@ public:
   int mainNetEvent(int event, Event *data);
   int waitForActivity(ink_hrtime timeout) override;
   void process_enabled_list();
+  void process_timeout_updates();
   void process_ready_list();
   void manage_keep_alive_queue();
   bool manage_active_queue(NetEvent *ne, bool ignore_queue_size);
@@ -354,7 +378,8 @@ public:
 
   /**
     Start to handle active timeout and inactivity timeout on a NetEvent.
-    Put the ne into open_list. All NetEvents in the open_list is checked for timeout by InactivityCop.
+    Put the ne into open_list and timeout_wheel. The InactivityCop checks the timeouts of a NetEvent
+    when it comes out of the timeout_wheel.
     Only be called when holding the mutex of this NetHandler and must call startIO(ne) first.
 
     @param ne NetEvent to be managed by InactivityCop
@@ -362,7 +387,7 @@ public:
   void startCop(NetEvent *ne);
   /**
     Stop to handle active timeout and inactivity on a NetEvent.
-    Remove the ne from open_list and cop_list.
+    Remove the ne from open_list and timeout_wheel.
     Also remove the ne from keep_alive_queue and active_queue if its context is IN.
     Only be called when holding the mutex of this NetHandler.
 
@@ -370,6 +395,17 @@ public:
    */
   void stopCop(NetEvent *ne);
 
+  /**
+    Have the InactivityCop look at the timeouts of @a ne at @a at. Only be called on the thread of
+    this NetHandler.
+   */
+  void schedule_timeout_check(NetEvent *ne, ink_hrtime at);
+  /**
+    The timeouts of @a ne were changed. The check is moved up if a timeout is now earlier than it,
+    a later timeout is found when the check comes. Can be called from any thread.
+   */
+  void timeout_changed(NetEvent *ne);
+
   // Signal the epoll_wait to terminate.
   void signalActivity() override;
 
@@ -825,6 +861,33 @@ NetHandler::startCop(NetEvent *ne)
   ink_assert(!open_list.in(ne));
 
   open_list.enqueue(ne);
+  ink_hrtime at = ne->next_timeout_at();
+  schedule_timeout_check(ne, at ? at : Thread::get_hrtime() + timeout_check_interval);
+}
+
+TS_INLINE void
+NetHandler::schedule_timeout_check(NetEvent *ne, ink_hrtime at)
+{
+  if (ne->timeout_slot >= 0) {
+    timeout_wheel.remove(ne);
+  }
+  ne->timeout_check_at = at;
+  timeout_wheel.insert(ne);
+}
+
+TS_INLINE void
+NetHandler::timeout_changed(NetEvent *ne)
+{
+  ink_hrtime at = ne->next_timeout_at();
+
+  if (at == 0 || ne->timeout_slot < 0 || at >= ne->timeout_check_at) {
+    return;
+  }
+  if (this_ethread() == thread) {
+    schedule_timeout_check(ne, at);
+  } else if (!ink_atomic_swap(&ne->in_timeout_update_list, 1)) {
+    timeout_update_list.push(ne);
+  }
 }
 
 TS_INLINE void
@@ -833,7 +896,14 @@ NetHandler::stopCop(NetEvent *ne)
   ink_release_assert(ne->nh == this);
 
   open_list.remove(ne);
-  cop_list.remove(ne);
+  if (ne->timeout_slot >= 0) {
+    timeout_wheel.remove(ne);
+    ne->timeout_slot = -1;
+  }
+  if (ne->in_timeout_update_list) {
+    timeout_update_list.remove(ne);
+    ne->in_timeout_update_list = 0;
+  }
   remove_from_keep_alive_queue(ne);
   remove_from_active_queue(ne);
 }
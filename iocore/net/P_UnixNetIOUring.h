@@ -0,0 +1,122 @@
+/** @file
+
+  Completion based network I/O with io_uring.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Ports with the @c uring option accept with a multishot accept and do the I/O of the accepted
+  connections with io_uring on the ring of the net thread. The connection is not added to the poll
+  set, the completions, serviced by NetHandler::waitForActivity, set the triggered flags and put the
+  connection on the ready lists instead, so read_from_net and write_to_net_io run unchanged.
+ */
+
+#pragma once
+
+#include "tscore/ink_config.h"
+
+#if TS_USE_LINUX_IO_URING
+#include "I_IO_URING.h"
+#else
+#define TS_USE_IO_URING_NET 0
+#endif
+
+#if TS_USE_IO_URING_NET
+
+#include "I_IOBuffer.h"
+#include "I_Net.h"
+
+class UnixNetVConnection;
+struct NetAccept;
+
+// The io_uring operations of one connection. The receive is a multishot recv with the buffers of the
+// net thread, it stops while the connection does not read. A send is submitted by write_to_net_io
+// and goes out with the next submission of the ring, at most one is in flight and its result is
+// reported by the next write_to_net_io.
+//
+// If an operation is still in flight when the connection is freed, the object lives on detached
+// from it and deletes itself when the last completion arrives.
+class IOUringNetIO
+{
+public:
+  // Start completion based I/O for @a vc on the current thread, nullptr if not available.
+  static IOUringNetIO *start(UnixNetVConnection *vc);
+  // The receive buffers of the current thread, nullptr if the kernel lacks multishot receives.
+  static IOUringBufferRing *buffers();
+
+  // Copy received data to @a iov. Returns the number of bytes copied, 0 at end of stream, -EAGAIN
+  // if no data is queued or -errno.
+  int64_t
+  recv(IOVec *iov, int niov)
+  {
+    return recv_op.recv(iov, niov);
+  }
+  // Send up to @a towrite bytes of @a buf, see UnixNetVConnection::load_buffer_and_write.
+  int64_t send(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs);
+  // The connection is being freed, cancel the operations in flight.
+  void detach();
+
+  IOUringNetIO(UnixNetVConnection *vc, IOUringBufferRing *buffers);
+
+private:
+  struct RecvOp : public IOUringRecv {
+    IOUringNetIO *io;
+
+    RecvOp(IOUringNetIO *io, IOUringBufferRing *buffers, int fd) : IOUringRecv(buffers, fd), io(io) {}
+    void ready() override;
+    bool wants_data() const override;
+    void stopped() override;
+  };
+  struct SendOp : public IOUringSend {
+    IOUringNetIO *io;
+
+    SendOp(IOUringNetIO *io, IOUringContext *ur, int fd) : IOUringSend(ur, fd), io(io) {}
+    void ready() override;
+    void stopped() override;
+  };
+
+  void free_if_done();
+
+  UnixNetVConnection *vc;
+  int fd;
+
+  RecvOp recv_op;
+
+  SendOp send_op;
+  IOVec send_iov[NET_MAX_IOV];
+  Ptr<IOBufferBlock> send_blocks;        // keeps the data being sent alive
+  IOBufferReader *send_reader = nullptr; // the reader the data was taken from
+};
+
+// A multishot accept on the listen socket of a per thread NetAccept.
+class IOUringNetAccept final : public IOUringCompletionHandler
+{
+public:
+  // Start accepting for @a na on the current thread, false if not available.
+  static bool start(NetAccept *na);
+
+  void handle_complete(io_uring_cqe *cqe) override;
+
+private:
+  explicit IOUringNetAccept(NetAccept *na) : na(na) {}
+  bool arm();
+
+  NetAccept *na;
+};
+
+#endif
@@ -40,6 +40,8 @@
 
 class UnixNetVConnection;
 class NetHandler;
+class IOUringNetIO;
+class NetZeroCopy;
 struct PollDescriptor;
 
 enum tcp_congestion_control_t { CLIENT_SIDE, SERVER_SIDE };
@@ -200,6 +202,8 @@ public:
   int recursion            = 0;
   bool from_accept_thread  = false;
   NetAccept *accept_object = nullptr;
+  IOUringNetIO *uring      = nullptr; ///< Completion based I/O, for connections accepted on a @c uring port.
+  NetZeroCopy *zerocopy    = nullptr; ///< Zero copy sends, for connections with @c SOCK_OPT_ZEROCOPY.
 
   int startEvent(int event, Event *e);
   int acceptEvent(int event, Event *e);
@@ -287,14 +291,6 @@ UnixNetVConnection::get_inactivity_timeout()
   return inactivity_timeout_in;
 }
 
-inline void
-UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
-{
-  Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
-  active_timeout_in        = timeout_in;
-  next_activity_timeout_at = (active_timeout_in > 0) ? Thread::get_hrtime() + timeout_in : 0;
-}
-
 inline void
 UnixNetVConnection::cancel_inactivity_timeout()
 {
@@ -0,0 +1,97 @@
+/** @file
+
+  Zero copy sends with MSG_ZEROCOPY.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  With SO_ZEROCOPY set on a socket a send with MSG_ZEROCOPY pins the pages of the data instead of
+  copying them, the kernel reports on the error queue of the socket when it is done with them. The
+  data of every such send is held here until then, the IOBufferData must not be reused before.
+ */
+
+#pragma once
+
+#include <sys/socket.h>
+
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#define TS_USE_NET_ZEROCOPY 1
+#else
+#define TS_USE_NET_ZEROCOPY 0
+#endif
+
+#if TS_USE_NET_ZEROCOPY
+
+#include <deque>
+
+#include "I_IOBuffer.h"
+#include "tscore/List.h"
+
+struct Connection;
+
+class NetZeroCopy
+{
+public:
+  /// Turn on zero copy sends for @a fd, nullptr if the kernel does not support them.
+  static NetZeroCopy *start(int fd);
+
+  /// Whether a send of @a len bytes should be zero copy.
+  bool use(int64_t len);
+  /// A zero copy send of @a sent bytes from @a iov was made, hold the @a data of the blocks it covers.
+  void sent(const IOVec *iov, IOBufferData *const *data, unsigned niov, int64_t sent);
+  /// Release the data of the sends the kernel is done with.
+  void reap();
+  /// Make no more zero copy sends on the connection, its socket is left alone. Returns true if the
+  /// kernel is done with the data of all the sends and this can be deleted at once, otherwise the
+  /// owner keeps calling use(), which goes on reaping, and deletes this once finished().
+  bool stop();
+  /// Zero copy sends were stopped and the kernel is done with all of their data.
+  bool
+  finished() const
+  {
+    return stopped && sends.empty();
+  }
+  /// The connection is being freed. If the kernel still uses some of the data the socket is shut
+  /// down, left open to get the notifications and closed when they are in, otherwise this is
+  /// deleted at once. Takes the socket from @a con.
+  void detach(Connection &con);
+
+  /// Close the sockets of freed connections that are done, called by the NetHandler of the thread.
+  static void service_detached();
+
+  LINK(NetZeroCopy, link);
+
+private:
+  explicit NetZeroCopy(int fd) : fd(fd) {}
+
+  struct Send {
+    uint32_t id;
+    uint32_t blocks; ///< Number of entries in @c held.
+    bool done;
+  };
+
+  int fd;
+  uint32_t next_id = 0;     ///< The kernel numbers zero copy sends from 0.
+  bool copied      = false; ///< The kernel copied the data of a send anyway.
+  bool stopped     = false; ///< No more zero copy sends, see stop().
+  std::deque<Send> sends;   ///< Sends in flight, by id.
+  std::deque<Ptr<IOBufferData>> held;
+  ink_hrtime release_at = 0; ///< After a detach, when to give up waiting for the kernel.
+};
+
+#endif
@@ -87,7 +87,7 @@ QUICPollCont::_process_long_header_packet(QUICPollEvent *e, NetHandler *nh)
   UDPPacket *p = e->packet;
   // FIXME: VC is nullptr ?
   QUICNetVConnection *vc = static_cast<QUICNetVConnection *>(e->con);
-  uint8_t *buf           = reinterpret_cast<uint8_t *>(p->getIOBlockChain()->buf());
+  uint8_t *buf           = reinterpret_cast<uint8_t *>(p->getIOBlockChain()->start());
 
   QUICPacketType ptype;
   QUICLongHeaderPacketR::type(ptype, buf, 1);
@@ -172,7 +172,7 @@ QUICPollCont::pollEvent(int, Event *)
     this->_process_packet(e, nh);
 #else
     uint8_t *buf;
-    buf = reinterpret_cast<uint8_t *>(e->packet->getIOBlockChain()->buf());
+    buf = reinterpret_cast<uint8_t *>(e->packet->getIOBlockChain()->start());
     if (QUICInvariants::is_long_header(buf)) {
       // Long Header Packet with Connection ID, has a valid type value.
       this->_process_long_header_packet(e, nh);
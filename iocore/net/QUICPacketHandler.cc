@@ -231,7 +231,7 @@ QUICPacketHandlerIn::_recv_packet(int event, UDPPacket *udp_packet)
 {
   // Assumption: udp_packet has only one IOBufferBlock
   IOBufferBlock *block = udp_packet->getIOBlockChain();
-  const uint8_t *buf   = reinterpret_cast<uint8_t *>(block->buf());
+  const uint8_t *buf   = reinterpret_cast<uint8_t *>(block->start());
   uint64_t buf_len     = block->size();
   QUICVersion version;
 
@@ -573,7 +573,7 @@ void
 QUICPacketHandlerOut::_recv_packet(int event, UDPPacket *udp_packet)
 {
   IOBufferBlock *block = udp_packet->getIOBlockChain();
-  const uint8_t *buf   = reinterpret_cast<uint8_t *>(block->buf());
+  const uint8_t *buf   = reinterpret_cast<uint8_t *>(block->start());
   uint64_t buf_len     = block->size();
 
   if (is_debug_tag_set(debug_tag)) {
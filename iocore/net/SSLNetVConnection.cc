@@ -38,6 +38,7 @@
 #include "P_SSLConfig.h"
 #include "P_SSLClientUtils.h"
 #include "P_SSLNetVConnection.h"
+#include "P_UnixNetZeroCopy.h"
 #include "BIO_fastopen.h"
 #include "SSLStats.h"
 #include "P_ALPNSupport.h"
@@ -390,6 +391,7 @@ SSLNetVConnection::read_raw_data()
     }
   }
   NET_SUM_DYN_STAT(net_read_bytes_stat, r);
+  NET_SUM_NODE_DYN_STAT(net_node_read_bytes_stat, r);
 
   swoc::IPRangeSet *pp_ipmap;
   pp_ipmap = SSLConfigParams::proxy_protocol_ip_addrs;
@@ -747,6 +749,23 @@ SSLNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf
     return this->super::load_buffer_and_write(towrite, buf, total_written, needs);
   }
 
+  // With kTLS the kernel splits the data in records and encrypts them, it is written to the socket
+  // as is, without the copy through the record layer of OpenSSL. A fixed record size and the small
+  // records at the start of dynamic record sizing still go through SSL_write, as does a write that
+  // OpenSSL has to finish or one that has to carry a KeyUpdate response or session tickets.
+  if (ktlsSend && redoWriteSize == 0 && !SSLHasPendingPostHandshake(ssl) &&
+      (SSLConfigParams::ssl_maxrecord == 0 ||
+       (SSLConfigParams::ssl_maxrecord == -1 && sslTotalBytesSent >= SSL_DEF_TLS_RECORD_BYTE_THRESHOLD))) {
+    int64_t before = total_written;
+    int64_t r      = this->super::load_buffer_and_write(towrite, buf, total_written, needs);
+    if (total_written > before) {
+      sslLastWriteTime   = now;
+      sslTotalBytesSent += total_written - before;
+      SSL_INCREMENT_DYN_STAT_EX(ssl_ktls_plain_write_bytes_stat, total_written - before);
+    }
+    return r;
+  }
+
   Debug("ssl", "towrite=%" PRId64, towrite);
 
   do {
@@ -860,6 +879,37 @@ SSLNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf
 
 SSLNetVConnection::SSLNetVConnection() {}
 
+// OpenSSL hands the keys to the kernel as the handshake sets them if the kernel and the cipher
+// allow it, otherwise it quietly keeps doing the crypto itself. Note which way it went. Only
+// inbound connections can be offloaded, the BIO of outbound ones does not support kTLS.
+void
+SSLNetVConnection::_check_ktls()
+{
+#ifdef SSL_OP_ENABLE_KTLS
+  if (!(SSL_get_options(ssl) & SSL_OP_ENABLE_KTLS)) {
+    return;
+  }
+
+  ktlsSend  = BIO_get_ktls_send(SSL_get_wbio(ssl));
+  bool recv = BIO_get_ktls_recv(SSL_get_rbio(ssl));
+  SSL_INCREMENT_DYN_STAT(ktlsSend ? ssl_ktls_send_offloaded_stat : ssl_ktls_not_offloaded_stat);
+  if (recv) {
+    SSL_INCREMENT_DYN_STAT(ssl_ktls_recv_offloaded_stat);
+  }
+  Debug("ssl.ktls", "kTLS send %s, receive %s for %s", ktlsSend ? "on" : "off", recv ? "on" : "off",
+        SSL_CIPHER_get_name(SSL_get_current_cipher(ssl)));
+
+#if TS_USE_NET_ZEROCOPY
+  // The kernel TLS layer does not take MSG_ZEROCOPY sends. The socket stays as it is, the
+  // tracker is kept until the kernel is done with the data of earlier sends, if there are any.
+  if (ktlsSend && zerocopy && zerocopy->stop()) {
+    delete zerocopy;
+    zerocopy = nullptr;
+  }
+#endif
+#endif
+}
+
 void
 SSLNetVConnection::do_io_close(int lerrno)
 {
@@ -943,6 +993,7 @@ SSLNetVConnection::clear()
   sslLastWriteTime            = 0;
   sslTotalBytesSent           = 0;
   sslClientRenegotiationAbort = false;
+  ktlsSend                    = false;
 
   curHook         = nullptr;
   hookOpRequested = SSL_HOOK_OP_DEFAULT;
@@ -1325,6 +1376,7 @@ SSLNetVConnection::sslServerHandShakeEvent(int &err)
     }
 
     sslHandshakeStatus = SSL_HANDSHAKE_DONE;
+    this->_check_ktls();
 
     if (this->get_tls_handshake_begin_time()) {
       this->_record_tls_handshake_end_time();
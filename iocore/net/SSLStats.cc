@@ -240,6 +240,16 @@ SSLInitializeStatistics()
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ssl_total_tlsv13", RECD_COUNTER, RECP_PERSISTENT,
                      (int)ssl_total_tlsv13, RecRawStatSyncCount);
 
+  // Kernel TLS
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ktls.send_offloaded", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_ktls_send_offloaded_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ktls.recv_offloaded", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_ktls_recv_offloaded_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ktls.not_offloaded", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_ktls_not_offloaded_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ktls.plain_write_bytes", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_ktls_plain_write_bytes_stat, RecRawStatSyncSum);
+
   // TLSv1.3 0-RTT stats
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.early_data_received", RECD_INT, RECP_PERSISTENT,
                      (int)ssl_early_data_received_count, RecRawStatSyncCount);
@@ -110,6 +110,12 @@ enum SSL_Stats {
   ssl_total_tlsv12,
   ssl_total_tlsv13,
 
+  /* kernel TLS */
+  ssl_ktls_send_offloaded_stat,
+  ssl_ktls_recv_offloaded_stat,
+  ssl_ktls_not_offloaded_stat,
+  ssl_ktls_plain_write_bytes_stat,
+
   ssl_cipher_stats_start = 100,
   ssl_cipher_stats_end   = 300,
 
@@ -2611,3 +2611,16 @@ SSLSessionDup(SSL_SESSION *sess)
   return duplicated;
 #endif
 }
+
+bool
+SSLHasPendingPostHandshake(SSL *ssl)
+{
+  if (SSL_in_init(ssl)) {
+    return true;
+  }
+#ifdef SSL_KEY_UPDATE_NONE
+  return SSL_get_key_update_type(ssl) != SSL_KEY_UPDATE_NONE;
+#else
+  return false;
+#endif
+}
@@ -22,6 +22,7 @@
  */
 
 #include "P_Net.h"
+#include "P_UnixNetZeroCopy.h"
 #include "I_AIO.h"
 #include "tscore/ink_hrtime.h"
 
@@ -47,7 +48,7 @@ extern "C" void fd_reify(struct ev_loop *);
 
 // INKqa10496
 // One Inactivity cop runs on each thread once every second and
-// loops through the list of NetEvents and calls the timeouts
+// calls the timeouts of the NetEvents that come out of the timeout wheel
 class InactivityCop : public Continuation
 {
 public:
@@ -60,13 +61,21 @@ public:
     NetHandler &nh = *get_NetHandler(this_ethread());
 
     Debug("inactivity_cop_check", "Checking inactivity on Thread-ID #%d", this_ethread()->id);
-    // The rest NetEvents in cop_list which are not triggered between InactivityCop runs.
-    // Use pop() to catch any closes caused by callbacks.
-    while (NetEvent *ne = nh.cop_list.pop()) {
+    // Only the NetEvents whose check is due come out of the wheel, a NetEvent with activity since it
+    // was put in is just put back at its new timeout.
+    nh.timeout_wheel.advance(now, [](NetEvent *) { return false; });
+    // Use pop_ready() to catch any closes caused by callbacks.
+    while (NetEvent *ne = nh.timeout_wheel.pop_ready()) {
+      ne->timeout_slot = -1;
+      if (ne->get_thread() != this_ethread()) {
+        nh.schedule_timeout_check(ne, now + nh.timeout_check_interval);
+        continue;
+      }
       // If we cannot get the lock don't stop just keep cleaning
       MUTEX_TRY_LOCK(lock, ne->get_mutex(), this_ethread());
       if (!lock.is_locked()) {
         NET_INCREMENT_DYN_STAT(inactivity_cop_lock_acquire_failure_stat);
+        nh.schedule_timeout_check(ne, now + nh.timeout_check_interval);
         continue;
       }
 
@@ -109,25 +118,22 @@ public:
         }
         Debug("inactivity_cop_verbose", "ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
               ink_hrtime_to_sec(now), ne->next_inactivity_timeout_at, ne->inactivity_timeout_in);
+        // Put it back before the callback, which may free it. It is timed out again on the next run
+        // if it is still open.
+        nh.schedule_timeout_check(ne, now + nh.timeout_check_interval);
         ne->callback(VC_EVENT_INACTIVITY_TIMEOUT, e);
       } else if (ne->next_activity_timeout_at && ne->next_activity_timeout_at < now) {
         Debug("inactivity_cop_verbose", "active ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
               ink_hrtime_to_sec(now), ne->next_activity_timeout_at, ne->active_timeout_in);
+        nh.schedule_timeout_check(ne, now + nh.timeout_check_interval);
         ne->callback(VC_EVENT_ACTIVE_TIMEOUT, e);
+      } else {
+        // Not timed out yet, look again at the earliest timeout. Without one, look again on the next run
+        // in case a default inactivity timeout has to be applied.
+        ink_hrtime at = ne->next_timeout_at();
+        nh.schedule_timeout_check(ne, at ? std::max(at, now + 1) : now + nh.timeout_check_interval);
       }
     }
-    // The cop_list is empty now.
-    // Let's reload the cop_list from open_list again.
-    forl_LL(NetEvent, ne, nh.open_list)
-    {
-      if (ne->get_thread() == this_ethread()) {
-        nh.cop_list.push(ne);
-      }
-    }
-    // NetHandler will remove NetEvent from cop_list if it is triggered.
-    // As the NetHandler runs, the number of NetEvents in the cop_list is decreasing.
-    // NetHandler runs 100 times maximum between InactivityCop runs.
-    // Therefore we don't have to check all the NetEvents as much as open_list.
 
     // Cleanup the active and keep-alive queues periodically
     nh.manage_active_queue(nullptr, true); // close any connections over the active timeout
@@ -187,6 +193,7 @@ PollCont::do_poll(ink_hrtime timeout)
       poll_timeout = net_config_poll_timeout;
     }
   }
+  ink_hrtime wait_start = Thread::get_hrtime_updated();
 // wait for fd's to trigger, or don't wait if timeout is 0
 #if TS_USE_EPOLL
   pollDescriptor->result =
@@ -202,6 +209,10 @@ PollCont::do_poll(ink_hrtime timeout)
   NetDebug("v_iocore_net_poll", "[PollCont::pollEvent] kqueue_fd: %d, timeout: %d, results: %d", pollDescriptor->kqueue_fd,
            poll_timeout, pollDescriptor->result);
 #endif
+  // Reported so the loop of the thread tells the wait apart from the I/O that follows it.
+  if (EThread *t = this_ethread(); t != nullptr) {
+    t->metrics.record_wait_time(std::max<ink_hrtime>(0, Thread::get_hrtime_updated() - wait_start));
+  }
 }
 
 static void
@@ -233,6 +244,7 @@ initialize_thread_for_net(EThread *thread)
   int cop_freq                 = 1;
 
   REC_ReadConfigInteger(cop_freq, "proxy.config.net.inactivity_check_frequency");
+  nh->timeout_check_interval = HRTIME_SECONDS(cop_freq);
   memcpy(&nh->config, &NetHandler::global_config, sizeof(NetHandler::global_config));
   nh->configure_per_thread_values();
   thread->schedule_every(inactivityCop, HRTIME_SECONDS(cop_freq));
@@ -384,6 +396,23 @@ NetHandler::process_enabled_list()
       write_ready_list.in_or_enqueue(ne);
     }
   }
+
+  process_timeout_updates();
+}
+
+//
+// Move up the timeout checks of NetEvents whose timeouts were changed on a different thread
+//
+void
+NetHandler::process_timeout_updates()
+{
+  NetEvent *ne = nullptr;
+
+  SList(NetEvent, timeout_update_link) tq(timeout_update_list.popall());
+  while ((ne = tq.pop())) {
+    ne->in_timeout_update_list = 0;
+    timeout_changed(ne);
+  }
 }
 
 //
@@ -476,6 +505,12 @@ NetHandler::waitForActivity(ink_hrtime timeout)
   ur->submit();
 #endif
 
+  // A producer that has swapped itself in at the tail of the external queue but not linked the event
+  // yet does not signal, the event must not wait for the poll timeout.
+  if (!this->thread->EventQueueExternal.external_empty()) {
+    timeout = 0;
+  }
+
   // Polling event by PollCont
   PollCont *p = get_PollCont(this->thread);
   p->do_poll(timeout);
@@ -487,10 +522,6 @@ NetHandler::waitForActivity(ink_hrtime timeout)
     epd = static_cast<EventIO *> get_ev_data(pd, x);
     if (epd->type == EVENTIO_READWRITE_VC) {
       ne = epd->data.ne;
-      // Remove triggered NetEvent from cop_list because it won't be timeout before next InactivityCop runs.
-      if (cop_list.in(ne)) {
-        cop_list.remove(ne);
-      }
       int flags = get_ev_events(pd, x);
       if (flags & (EVENTIO_ERROR)) {
         ne->set_error_from_socket();
@@ -537,14 +568,19 @@ NetHandler::waitForActivity(ink_hrtime timeout)
 
   pd->result = 0;
 
-  process_ready_list();
-
 #if TS_USE_LINUX_IO_URING
+  // Completions of connections on io_uring ports put them on the ready lists.
   if (servicedh) {
     ur->service();
   }
 #endif
 
+  process_ready_list();
+
+#if TS_USE_NET_ZEROCOPY
+  NetZeroCopy::service_detached();
+#endif
+
   return EVENT_CONT;
 }
 
@@ -682,6 +718,7 @@ NetHandler::_close_ne(NetEvent *ne, ink_hrtime now, int &handle_event, int &clos
     ++closed;
   } else {
     ne->next_inactivity_timeout_at = now;
+    timeout_changed(ne);
     // create a dummy event
     Event event;
     event.ethread = this_ethread();
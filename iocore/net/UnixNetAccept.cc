@@ -21,14 +21,104 @@
   limitations under the License.
  */
 
+#include <mutex>
+#include <vector>
+
 #include <tscore/TSSystemState.h>
 #include <tscore/ink_defs.h>
+#include <tscore/ink_hw.h>
 
 #include "P_Net.h"
+#include "P_UnixNetIOUring.h"
+
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+#include <linux/filter.h>
+#endif
 
 using NetAcceptHandler = int (NetAccept::*)(int, void *);
 int accept_till_done   = 1;
 
+// How connections are spread over the listen sockets of the threads with proxy.config.exec_thread.listen.
+enum ListenSteering {
+  LISTEN_STEERING_HASH         = 0, ///< Kernel hash of the 4 tuple.
+  LISTEN_STEERING_INCOMING_CPU = 1, ///< SO_INCOMING_CPU, the socket of the thread on the CPU the packet arrived on.
+  LISTEN_STEERING_BPF          = 2, ///< A reuseport BPF program mapping the CPU to the socket of the thread.
+};
+
+// Accepts by each ET_NET thread, indexed by NetAccept::thread_index.
+static RecRawStatBlock *accept_thread_rsb = nullptr;
+
+static void
+register_accept_thread_stats()
+{
+  int n = eventProcessor.thread_group[ET_NET]._count;
+  char name[64];
+
+  accept_thread_rsb = RecAllocateRawStatBlock(n);
+  for (int i = 0; i < n; ++i) {
+    snprintf(name, sizeof(name), "proxy.process.net.accepts.thread_%d", i);
+    RecRegisterRawStat(accept_thread_rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, i, RecRawStatSyncSum);
+  }
+}
+
+#if defined(SO_INCOMING_CPU) || defined(SO_ATTACH_REUSEPORT_CBPF)
+// The CPUs thread @a t is bound to. Returns false if it may run on any of them.
+static bool
+thread_cpus(EThread *t, cpu_set_t &cpus)
+{
+  CPU_ZERO(&cpus);
+  if (pthread_getaffinity_np(t->tid, sizeof(cpus), &cpus) != 0) {
+    return false;
+  }
+  return CPU_COUNT(&cpus) < ink_number_of_processors();
+}
+#endif
+
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+// Attach a program to the reuseport group of @a fd that picks, for the CPU a connection arrives on,
+// the listen socket of the thread bound to that CPU. The sockets are in the group in the order the
+// threads of @a tg listened, index @c i is thread @c i. Connections on a CPU no thread is bound to
+// get an index out of range and the kernel falls back to its hash.
+static void
+attach_steering_program(int fd, EventProcessor::ThreadGroupDescriptor const &tg)
+{
+  std::vector<sock_filter> prog;
+  std::vector<int> owner(CPU_SETSIZE, -1);
+  cpu_set_t cpus;
+
+  for (int i = 0; i < tg._count; ++i) {
+    if (!thread_cpus(tg._thread[i], cpus)) {
+      continue;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpus) && owner[cpu] < 0) {
+        owner[cpu] = i;
+      }
+    }
+  }
+
+  prog.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (owner[cpu] >= 0) {
+      prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(cpu), 0, 1));
+      prog.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<uint32_t>(owner[cpu])));
+    }
+  }
+  if (prog.size() == 1) {
+    Warning("exec_thread.listen_steering: the net threads are not bound to CPUs, using the kernel hash");
+    return;
+  }
+  prog.push_back(BPF_STMT(BPF_RET | BPF_K, 0xffffffff));
+
+  sock_fprog fprog;
+  fprog.len    = prog.size();
+  fprog.filter = prog.data();
+  if (safe_setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, reinterpret_cast<char *>(&fprog), sizeof(fprog)) < 0) {
+    Warning("exec_thread.listen_steering: unable to attach the reuseport program: %s", strerror(errno));
+  }
+}
+#endif
+
 // we need to protect naVec since it might be accessed
 // in different threads at the same time
 Ptr<ProxyMutex> naVecMutex;
@@ -92,6 +182,7 @@ net_accept(NetAccept *na, void *ep, bool blockable)
     vc->action_     = *na->action_;
     vc->set_is_transparent(na->opt.f_inbound_transparent);
     vc->set_is_proxy_protocol(na->opt.f_proxy_protocol);
+    vc->options.f_io_uring = na->opt.f_io_uring;
     vc->set_context(NET_VCONNECTION_IN);
     if (na->opt.f_mptcp) {
       vc->set_mptcp_state(); // Try to get the MPTCP state, and update accordingly
@@ -202,13 +293,28 @@ int
 NetAccept::accept_per_thread(int event, void *ep)
 {
   int listen_per_thread = 0;
+  int steering          = LISTEN_STEERING_HASH;
   REC_ReadConfigInteger(listen_per_thread, "proxy.config.exec_thread.listen");
+  REC_ReadConfigInteger(steering, "proxy.config.exec_thread.listen_steering");
 
-  if (listen_per_thread == 1) {
+  // With a steering program the sockets were opened in order by init_accept_per_thread.
+  if (listen_per_thread == 1 && steering != LISTEN_STEERING_BPF) {
     if (do_listen(NON_BLOCKING)) {
       Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
       return -1;
     }
+#ifdef SO_INCOMING_CPU
+    cpu_set_t cpus;
+    if (steering == LISTEN_STEERING_INCOMING_CPU && thread_cpus(this_ethread(), cpus)) {
+      int cpu = 0;
+      while (!CPU_ISSET(cpu, &cpus)) {
+        ++cpu;
+      }
+      if (safe_setsockopt(server.fd, SOL_SOCKET, SO_INCOMING_CPU, reinterpret_cast<char *>(&cpu), sizeof(cpu)) < 0) {
+        Warning("unable to set SO_INCOMING_CPU on port %d: %s", server.accept_addr.host_order_port(), strerror(errno));
+      }
+    }
+#endif
   }
 
   if (accept_fn == net_accept) {
@@ -216,6 +322,11 @@ NetAccept::accept_per_thread(int event, void *ep)
   } else {
     SET_HANDLER(&NetAccept::acceptEvent);
   }
+#if TS_USE_IO_URING_NET
+  if (opt.f_io_uring && IOUringNetAccept::start(this)) {
+    return 0;
+  }
+#endif
   PollDescriptor *pd = get_PollDescriptor(this_ethread());
   if (this->ep.start(pd, this, EVENTIO_READ) < 0) {
     Fatal("[NetAccept::accept_per_thread]:error starting EventIO");
@@ -229,24 +340,57 @@ NetAccept::init_accept_per_thread()
 {
   int i, n;
   int listen_per_thread = 0;
+  int steering          = LISTEN_STEERING_HASH;
+  static std::once_flag stats_once;
 
   ink_assert(opt.etype >= 0);
   REC_ReadConfigInteger(listen_per_thread, "proxy.config.exec_thread.listen");
+  REC_ReadConfigInteger(steering, "proxy.config.exec_thread.listen_steering");
+  std::call_once(stats_once, register_accept_thread_stats);
 
   if (listen_per_thread == 0) {
     if (do_listen(NON_BLOCKING)) {
       Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
       return;
     }
+    if (steering != LISTEN_STEERING_HASH) {
+      Warning("exec_thread.listen_steering has no effect without exec_thread.listen");
+    }
+  }
+#ifndef SO_INCOMING_CPU
+  if (steering == LISTEN_STEERING_INCOMING_CPU) {
+    Warning("exec_thread.listen_steering: SO_INCOMING_CPU is not supported, using the kernel hash");
   }
+#endif
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+  if (steering == LISTEN_STEERING_BPF) {
+    Warning("exec_thread.listen_steering: reuseport BPF programs are not supported, using the kernel hash");
+    steering = LISTEN_STEERING_HASH;
+  }
+#endif
 
   SET_HANDLER(&NetAccept::accept_per_thread);
-  n = eventProcessor.thread_group[opt.etype]._count;
+  EventProcessor::ThreadGroupDescriptor &tg = eventProcessor.thread_group[opt.etype];
+  n                                         = tg._count;
 
   for (i = 0; i < n; i++) {
     NetAccept *a = (i < n - 1) ? clone() : this;
-    EThread *t   = eventProcessor.thread_group[opt.etype]._thread[i];
+    EThread *t   = tg._thread[i];
     a->mutex     = get_NetHandler(t)->mutex;
+    if (opt.etype == ET_NET) {
+      a->thread_index = i;
+    }
+    if (listen_per_thread == 1 && steering == LISTEN_STEERING_BPF) {
+      if (a->do_listen(NON_BLOCKING)) {
+        Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
+        return;
+      }
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+      if (i == n - 1) {
+        attach_steering_program(a->server.fd, tg);
+      }
+#endif
+    }
     t->schedule_imm(a);
   }
 }
@@ -353,6 +497,7 @@ NetAccept::do_blocking_accept(EThread *t)
     vc->options.packet_tos           = opt.packet_tos;
     vc->options.packet_notsent_lowat = opt.packet_notsent_lowat;
     vc->options.ip_family            = opt.ip_family;
+    vc->options.f_io_uring           = opt.f_io_uring;
     vc->apply_options();
     vc->set_context(NET_VCONNECTION_IN);
     if (opt.f_mptcp) {
@@ -423,12 +568,11 @@ NetAccept::acceptFastEvent(int event, void *ep)
   Event *e = static_cast<Event *>(ep);
   (void)event;
   (void)e;
-  int bufsz, res = 0;
+  int res = 0;
   Connection con;
   con.sock_type = SOCK_STREAM;
 
-  UnixNetVConnection *vc = nullptr;
-  int loop               = accept_till_done;
+  int loop = accept_till_done;
 
   do {
     socklen_t sz = sizeof(con.addr);
@@ -436,98 +580,27 @@ NetAccept::acceptFastEvent(int event, void *ep)
     con.fd       = fd;
 
     if (likely(fd >= 0)) {
-      // check for throttle
-      if (check_net_throttle(ACCEPT)) {
-        // close the connection as we are in throttle state
-        con.close();
-        NET_SUM_DYN_STAT(net_connections_throttled_in_stat, 1);
-        continue;
-      }
-      Debug("iocore_net", "accepted a new socket: %d", fd);
-      NET_SUM_GLOBAL_DYN_STAT(net_tcp_accept_stat, 1);
-      if (opt.send_bufsize > 0) {
-        if (unlikely(SocketManager::set_sndbuf_size(fd, opt.send_bufsize))) {
-          bufsz = ROUNDUP(opt.send_bufsize, 1024);
-          while (bufsz > 0) {
-            if (!SocketManager::set_sndbuf_size(fd, bufsz)) {
-              break;
-            }
-            bufsz -= 1024;
-          }
-        }
-      }
-      if (opt.recv_bufsize > 0) {
-        if (unlikely(SocketManager::set_rcvbuf_size(fd, opt.recv_bufsize))) {
-          bufsz = ROUNDUP(opt.recv_bufsize, 1024);
-          while (bufsz > 0) {
-            if (!SocketManager::set_rcvbuf_size(fd, bufsz)) {
-              break;
-            }
-            bufsz -= 1024;
-          }
-        }
-      }
-    } else {
-      res = fd;
+      accept_connection(con, e->ethread);
+      continue;
     }
+
     // check return value from accept()
-    if (res < 0) {
-      Debug("iocore_net", "received : %s", strerror(errno));
-      res = -errno;
-      if (res == -EAGAIN || res == -ECONNABORTED
+    Debug("iocore_net", "received : %s", strerror(errno));
+    res = -errno;
+    if (res == -EAGAIN || res == -ECONNABORTED
 #if defined(__linux__)
-          || res == -EPIPE
+        || res == -EPIPE
 #endif
-      ) {
-        goto Ldone;
-      } else if (accept_error_seriousness(res) >= 0) {
-        check_transient_accept_error(res);
-        goto Ldone;
-      }
-      if (!action_->cancelled) {
-        action_->continuation->handleEvent(EVENT_ERROR, (void *)static_cast<intptr_t>(res));
-      }
-      goto Lerror;
-    }
-
-    vc = (UnixNetVConnection *)this->getNetProcessor()->allocate_vc(e->ethread);
-    ink_release_assert(vc);
-
-    NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, 1);
-    vc->id = net_next_connection_number();
-    vc->con.move(con);
-    vc->set_remote_addr(con.addr);
-    vc->submit_time = Thread::get_hrtime();
-    vc->action_     = *action_;
-    vc->set_is_transparent(opt.f_inbound_transparent);
-    vc->set_is_proxy_protocol(opt.f_proxy_protocol);
-    vc->options.sockopt_flags        = opt.sockopt_flags;
-    vc->options.packet_mark          = opt.packet_mark;
-    vc->options.packet_tos           = opt.packet_tos;
-    vc->options.packet_notsent_lowat = opt.packet_notsent_lowat;
-    vc->options.ip_family            = opt.ip_family;
-    vc->apply_options();
-    vc->set_context(NET_VCONNECTION_IN);
-    if (opt.f_mptcp) {
-      vc->set_mptcp_state(); // Try to get the MPTCP state, and update accordingly
+    ) {
+      goto Ldone;
+    } else if (accept_error_seriousness(res) >= 0) {
+      check_transient_accept_error(res);
+      goto Ldone;
     }
-
-#ifdef USE_EDGE_TRIGGER
-    // Set the vc as triggered and place it in the read ready queue later in case there is already data on the socket.
-    if (server.http_accept_filter) {
-      vc->read.triggered = 1;
+    if (!action_->cancelled) {
+      action_->continuation->handleEvent(EVENT_ERROR, (void *)static_cast<intptr_t>(res));
     }
-#endif
-    SET_CONTINUATION_HANDLER(vc, &UnixNetVConnection::acceptEvent);
-
-    EThread *t    = e->ethread;
-    NetHandler *h = get_NetHandler(t);
-    // Assign NetHandler->mutex to NetVC
-    vc->mutex = h->mutex;
-    // We must be holding the lock already to do later do_io_read's
-    SCOPED_MUTEX_LOCK(lock, vc->mutex, e->ethread);
-    vc->handleEvent(EVENT_NONE, nullptr);
-    vc = nullptr;
+    goto Lerror;
   } while (loop);
 
 Ldone:
@@ -541,6 +614,86 @@ Lerror:
   return EVENT_DONE;
 }
 
+// Set up a connection for the socket @a con accepted on this thread and hand it to the acceptor.
+void
+NetAccept::accept_connection(Connection &con, EThread *t)
+{
+  int bufsz;
+
+  // check for throttle
+  if (check_net_throttle(ACCEPT)) {
+    // close the connection as we are in throttle state
+    con.close();
+    NET_SUM_DYN_STAT(net_connections_throttled_in_stat, 1);
+    return;
+  }
+  Debug("iocore_net", "accepted a new socket: %d", con.fd);
+  NET_SUM_GLOBAL_DYN_STAT(net_tcp_accept_stat, 1);
+  if (thread_index >= 0) {
+    RecIncrRawStat(accept_thread_rsb, t, thread_index, 1);
+  }
+  if (opt.send_bufsize > 0) {
+    if (unlikely(SocketManager::set_sndbuf_size(con.fd, opt.send_bufsize))) {
+      bufsz = ROUNDUP(opt.send_bufsize, 1024);
+      while (bufsz > 0) {
+        if (!SocketManager::set_sndbuf_size(con.fd, bufsz)) {
+          break;
+        }
+        bufsz -= 1024;
+      }
+    }
+  }
+  if (opt.recv_bufsize > 0) {
+    if (unlikely(SocketManager::set_rcvbuf_size(con.fd, opt.recv_bufsize))) {
+      bufsz = ROUNDUP(opt.recv_bufsize, 1024);
+      while (bufsz > 0) {
+        if (!SocketManager::set_rcvbuf_size(con.fd, bufsz)) {
+          break;
+        }
+        bufsz -= 1024;
+      }
+    }
+  }
+
+  UnixNetVConnection *vc = (UnixNetVConnection *)this->getNetProcessor()->allocate_vc(t);
+  ink_release_assert(vc);
+
+  NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, 1);
+  vc->id = net_next_connection_number();
+  vc->con.move(con);
+  vc->set_remote_addr(con.addr);
+  vc->submit_time = Thread::get_hrtime();
+  vc->action_     = *action_;
+  vc->set_is_transparent(opt.f_inbound_transparent);
+  vc->set_is_proxy_protocol(opt.f_proxy_protocol);
+  vc->options.sockopt_flags        = opt.sockopt_flags;
+  vc->options.packet_mark          = opt.packet_mark;
+  vc->options.packet_tos           = opt.packet_tos;
+  vc->options.packet_notsent_lowat = opt.packet_notsent_lowat;
+  vc->options.ip_family            = opt.ip_family;
+  vc->options.f_io_uring           = opt.f_io_uring;
+  vc->apply_options();
+  vc->set_context(NET_VCONNECTION_IN);
+  if (opt.f_mptcp) {
+    vc->set_mptcp_state(); // Try to get the MPTCP state, and update accordingly
+  }
+
+#ifdef USE_EDGE_TRIGGER
+  // Set the vc as triggered and place it in the read ready queue later in case there is already data on the socket.
+  if (server.http_accept_filter) {
+    vc->read.triggered = 1;
+  }
+#endif
+  SET_CONTINUATION_HANDLER(vc, &UnixNetVConnection::acceptEvent);
+
+  NetHandler *h = get_NetHandler(t);
+  // Assign NetHandler->mutex to NetVC
+  vc->mutex = h->mutex;
+  // We must be holding the lock already to do later do_io_read's
+  SCOPED_MUTEX_LOCK(lock, vc->mutex, t);
+  vc->handleEvent(EVENT_NONE, nullptr);
+}
+
 int
 NetAccept::acceptLoopEvent(int event, Event *e)
 {
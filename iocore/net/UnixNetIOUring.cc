@@ -0,0 +1,324 @@
+/** @file
+
+  Completion based network I/O with io_uring.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Net.h"
+#include "P_UnixNetIOUring.h"
+
+#if TS_USE_IO_URING_NET
+
+#include <sys/utsname.h>
+
+namespace
+{
+ClassAllocator<IOUringNetIO, true> ioUringNetIOAllocator("ioUringNetIOAllocator");
+
+constexpr int NET_BUFFER_GROUP = 1;
+
+// Multishot receives with provided buffers exist since Linux 6.0, older kernels fail them with
+// EINVAL on the first completion. Checking up front keeps connections from starting on a ring
+// that cannot serve them.
+bool
+kernel_supports_net()
+{
+  utsname name;
+  int major = 0;
+
+  return uname(&name) == 0 && sscanf(name.release, "%d.", &major) == 1 && major >= 6;
+}
+
+io_uring_sqe *
+get_sqe(IOUringCompletionHandler *op)
+{
+  IOUringContext *ur = IOUringContext::local_context();
+  io_uring_sqe *sqe  = ur->next_sqe(op);
+
+  if (sqe == nullptr) {
+    // The submission queue is full, push it to the kernel and try again.
+    ur->submit();
+    sqe = ur->next_sqe(op);
+  }
+  return sqe;
+}
+} // namespace
+
+//
+// IOUringNetIO
+//
+IOUringBufferRing *
+IOUringNetIO::buffers()
+{
+  thread_local IOUringBufferRing *buffers = nullptr;
+  thread_local bool initialized           = false;
+
+  if (!initialized) {
+    const IOUringConfig &cfg = IOUringContext::get_config();
+
+    initialized = true;
+    if (kernel_supports_net()) {
+      buffers = IOUringBufferRing::create(IOUringContext::local_context(), NET_BUFFER_GROUP, cfg.net_buffers, cfg.net_buffer_size);
+    }
+    if (buffers == nullptr) {
+      Warning("io_uring network I/O is not supported by this kernel, using the regular network I/O");
+    }
+  }
+  return buffers;
+}
+
+IOUringNetIO::IOUringNetIO(UnixNetVConnection *vc, IOUringBufferRing *buffers)
+  : vc(vc), fd(vc->con.fd), recv_op(this, buffers, fd), send_op(this, buffers->context(), fd)
+{
+}
+
+IOUringNetIO *
+IOUringNetIO::start(UnixNetVConnection *vc)
+{
+  IOUringBufferRing *ring = buffers();
+
+  if (ring == nullptr) {
+    return nullptr;
+  }
+
+  IOUringNetIO *io = ioUringNetIOAllocator.alloc(vc, ring);
+  if (!io->recv_op.start()) {
+    ioUringNetIOAllocator.free(io);
+    return nullptr;
+  }
+  return io;
+}
+
+void
+IOUringNetIO::RecvOp::ready()
+{
+  UnixNetVConnection *vc = io->vc;
+  ProxyMutex *mutex      = vc->thread->mutex.get();
+  NET_INCREMENT_DYN_STAT(net_io_uring_recvs_stat);
+
+  vc->read.triggered = 1;
+  if (vc->read.enabled) {
+    vc->nh->read_ready_list.in_or_enqueue(vc);
+  }
+}
+
+bool
+IOUringNetIO::RecvOp::wants_data() const
+{
+  return io->vc->read.enabled;
+}
+
+void
+IOUringNetIO::RecvOp::stopped()
+{
+  io->free_if_done();
+}
+
+int64_t
+IOUringNetIO::send(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs)
+{
+  int64_t r      = -EAGAIN;
+  int64_t result = 0;
+
+  needs |= EVENTIO_WRITE;
+  if (send_op.in_flight()) {
+    return -EAGAIN;
+  }
+
+  if (send_op.result(result)) {
+    send_blocks = nullptr;
+    // A result for a reader the VIO no longer uses is of no interest to anybody.
+    if (send_reader == buf.reader()) {
+      if (result < 0) {
+        return result;
+      }
+      buf.reader()->consume(result);
+      total_written += result;
+      r              = result;
+    }
+  }
+
+  // Keep the socket busy while the caller handles the result of the previous send, the completion
+  // triggers the connection again.
+  if (total_written < towrite) {
+    IOBufferReader *reader     = buf.reader();
+    IOBufferReader *tmp_reader = reader->clone();
+    int64_t try_to_write       = 0;
+    unsigned niov              = 0;
+
+    while (niov < NET_MAX_IOV && try_to_write < towrite - total_written) {
+      int64_t len = std::min(tmp_reader->block_read_avail(), towrite - total_written - try_to_write);
+      if (len <= 0) {
+        break;
+      }
+      send_iov[niov].iov_len  = len;
+      send_iov[niov].iov_base = tmp_reader->start();
+      niov++;
+
+      try_to_write += len;
+      tmp_reader->consume(len);
+    }
+    tmp_reader->dealloc();
+
+    if (send_op.start(send_iov, niov)) {
+      // The blocks are linked from the first one, holding it keeps the data alive if the VIO drops
+      // the buffer while the send is in flight.
+      send_blocks         = reader->get_current_block();
+      send_reader         = reader;
+      vc->write.triggered = 0;
+
+      ProxyMutex *mutex = vc->thread->mutex.get();
+      NET_INCREMENT_DYN_STAT(net_io_uring_sends_stat);
+      NET_INCREMENT_DYN_STAT(net_calls_to_write_stat);
+      return r;
+    }
+  }
+  return r == -EAGAIN ? -ENOBUFS : r;
+}
+
+void
+IOUringNetIO::SendOp::ready()
+{
+  UnixNetVConnection *vc = io->vc;
+
+  vc->write.triggered = 1;
+  if (vc->write.enabled) {
+    vc->nh->write_ready_list.in_or_enqueue(vc);
+  }
+}
+
+void
+IOUringNetIO::SendOp::stopped()
+{
+  // The kernel is done with the data only now.
+  io->send_blocks = nullptr;
+  io->free_if_done();
+}
+
+void
+IOUringNetIO::detach()
+{
+  vc = nullptr;
+
+  // Without a cancel the operations end when the socket is shut down, the file stays open in the
+  // kernel as long as they hold it.
+  bool cancelled = recv_op.stop();
+  cancelled      = send_op.stop() && cancelled;
+  if (!cancelled) {
+    SocketManager::shutdown(fd, SHUT_RDWR);
+  }
+  if (!send_op.in_flight()) {
+    send_blocks = nullptr;
+  }
+  free_if_done();
+}
+
+void
+IOUringNetIO::free_if_done()
+{
+  if (!recv_op.in_flight() && !send_op.in_flight()) {
+    ioUringNetIOAllocator.free(this);
+  }
+}
+
+//
+// IOUringNetAccept
+//
+bool
+IOUringNetAccept::start(NetAccept *na)
+{
+  if (IOUringNetIO::buffers() == nullptr) {
+    return false;
+  }
+
+  IOUringNetAccept *accept = new IOUringNetAccept(na);
+  if (!accept->arm()) {
+    delete accept;
+    return false;
+  }
+  return true;
+}
+
+bool
+IOUringNetAccept::arm()
+{
+  io_uring_sqe *sqe = get_sqe(this);
+
+  if (sqe == nullptr) {
+    return false;
+  }
+  io_uring_prep_multishot_accept(sqe, na->server.fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+  return true;
+}
+
+void
+IOUringNetAccept::handle_complete(io_uring_cqe *cqe)
+{
+  EThread *t        = this_ethread();
+  ProxyMutex *mutex = t->mutex.get();
+  bool more         = cqe->flags & IORING_CQE_F_MORE;
+  int res           = cqe->res;
+
+  if (na->action_->cancelled) {
+    if (res >= 0) {
+      SocketManager::close(res);
+    }
+    if (!more) {
+      delete this;
+    }
+    return;
+  }
+
+  if (res >= 0) {
+    Connection con;
+    int sz = sizeof(con.addr);
+
+    con.sock_type = SOCK_STREAM;
+    con.fd        = res;
+    // The address is not part of a multishot completion.
+    if (safe_getpeername(con.fd, &con.addr.sa, &sz) != 0) {
+      con.close();
+    } else {
+      Debug("iocore_net", "accepted a new socket with io_uring: %d", con.fd);
+      NET_INCREMENT_DYN_STAT(net_io_uring_accepts_stat);
+      na->accept_connection(con, t);
+    }
+  } else if (res == -EINVAL || res == -EOPNOTSUPP) {
+    // No multishot accept in this kernel, poll the listen socket.
+    if (na->ep.start(get_PollDescriptor(t), na, EVENTIO_READ) < 0) {
+      Fatal("[IOUringNetAccept::handle_complete]:error starting EventIO");
+    }
+    delete this;
+    return;
+  } else if (accept_error_seriousness(res) >= 0) {
+    check_transient_accept_error(res);
+  } else {
+    na->action_->continuation->handleEvent(EVENT_ERROR, reinterpret_cast<void *>(static_cast<intptr_t>(res)));
+    delete this;
+    return;
+  }
+
+  if (!more && !arm()) {
+    Warning("unable to rearm the io_uring accept on port %d", ats_ip_port_host_order(&na->server.accept_addr));
+    delete this;
+  }
+}
+
+#endif
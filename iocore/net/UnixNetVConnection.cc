@@ -22,6 +22,8 @@
 */
 
 #include "P_Net.h"
+#include "P_UnixNetIOUring.h"
+#include "P_UnixNetZeroCopy.h"
 #include "tscore/ink_platform.h"
 #include "tscore/InkErrno.h"
 
@@ -79,7 +81,7 @@ read_signal_and_update(int event, UnixNetVConnection *vc)
 {
   vc->recursion++;
   if (vc->read.vio.cont && vc->read.vio.mutex == vc->read.vio.cont->mutex) {
-    vc->read.vio.cont->handleEvent(event, &vc->read.vio);
+    this_ethread()->call_handler(vc->read.vio.cont, event, &vc->read.vio);
   } else {
     if (vc->read.vio.cont) {
       Note("read_signal_and_update: mutexes are different? vc=%p, event=%d", vc, event);
@@ -113,7 +115,7 @@ write_signal_and_update(int event, UnixNetVConnection *vc)
 {
   vc->recursion++;
   if (vc->write.vio.cont && vc->write.vio.mutex == vc->write.vio.cont->mutex) {
-    vc->write.vio.cont->handleEvent(event, &vc->write.vio);
+    this_ethread()->call_handler(vc->write.vio.cont, event, &vc->write.vio);
   } else {
     if (vc->write.vio.cont) {
       Note("write_signal_and_update: mutexes are different? vc=%p, event=%d", vc, event);
@@ -261,7 +263,11 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
       msg.msg_namelen = ats_ip_size(vc->get_remote_addr());
       msg.msg_iov     = &tiovec[0];
       msg.msg_iovlen  = niov;
-      r               = SocketManager::recvmsg(vc->con.fd, &msg, 0);
+#if TS_USE_IO_URING_NET
+      r = vc->uring ? vc->uring->recv(&tiovec[0], niov) : SocketManager::recvmsg(vc->con.fd, &msg, 0);
+#else
+      r = SocketManager::recvmsg(vc->con.fd, &msg, 0);
+#endif
 
       NET_INCREMENT_DYN_STAT(net_calls_to_read_stat);
 
@@ -296,6 +302,7 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
       return;
     }
     NET_SUM_DYN_STAT(net_read_bytes_stat, r);
+    NET_SUM_NODE_DYN_STAT(net_node_read_bytes_stat, r);
 
     // Add data to buffer and signal continuation.
     buf.writer()->fill(r);
@@ -477,6 +484,7 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
 
   if (total_written > 0) {
     NET_SUM_DYN_STAT(net_write_bytes_stat, total_written);
+    NET_SUM_NODE_DYN_STAT(net_node_write_bytes_stat, total_written);
     s->vio.ndone += total_written;
     net_activity(vc, thread);
   }
@@ -845,6 +853,9 @@ UnixNetVConnection::set_enabled(VIO *vio)
   STATE_FROM_VIO(vio)->enabled = 1;
   if (!next_inactivity_timeout_at && inactivity_timeout_in) {
     next_inactivity_timeout_at = Thread::get_hrtime() + inactivity_timeout_in;
+    if (nh) {
+      nh->timeout_changed(this);
+    }
   }
 }
 
@@ -867,12 +878,19 @@ UnixNetVConnection::net_write_io(NetHandler *nh, EThread *lthread)
 int64_t
 UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs)
 {
+#if TS_USE_IO_URING_NET
+  if (uring) {
+    return uring->send(towrite, buf, total_written, needs);
+  }
+#endif
+
   int64_t r                  = 0;
   int64_t try_to_write       = 0;
   IOBufferReader *tmp_reader = buf.reader()->clone();
 
   do {
     IOVec tiovec[NET_MAX_IOV];
+    IOBufferData *tdata[NET_MAX_IOV]; // The data of each iov entry, held by zero copy sends.
     unsigned niov = 0;
     try_to_write  = 0;
 
@@ -897,6 +915,7 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
       // build an iov entry
       tiovec[niov].iov_len  = len;
       tiovec[niov].iov_base = tmp_reader->start();
+      tdata[niov]           = tmp_reader->block->data.get();
       niov++;
 
       try_to_write += len;
@@ -922,7 +941,26 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
       NET_INCREMENT_DYN_STAT(net_fastopen_attempts_stat);
       flags = MSG_FASTOPEN;
     }
+#if TS_USE_NET_ZEROCOPY
+    if (zerocopy && flags == 0 && zerocopy->use(try_to_write)) {
+      flags = MSG_ZEROCOPY;
+    } else if (zerocopy && zerocopy->finished()) {
+      // zero copy was stopped and the kernel is done with the data of the earlier sends
+      delete zerocopy;
+      zerocopy = nullptr;
+    }
+#endif
     r = SocketManager::sendmsg(con.fd, &msg, flags);
+#if TS_USE_NET_ZEROCOPY
+    if (flags & MSG_ZEROCOPY) {
+      if (r > 0) {
+        zerocopy->sent(tiovec, tdata, niov, r);
+      } else if (r == -ENOBUFS) {
+        // Out of option memory for the notifications, send this one with a copy.
+        r = SocketManager::sendmsg(con.fd, &msg, 0);
+      }
+    }
+#endif
     if (!this->con.is_connected && this->options.f_tcp_fastopen) {
       if (r < 0) {
         if (r == -EINPROGRESS || r == -EWOULDBLOCK) {
@@ -1019,6 +1057,19 @@ UnixNetVConnection::acceptEvent(int event, Event *e)
 
   thread = t;
 
+#if TS_USE_IO_URING_NET
+  // The completions of the ring drive the connection, it is not polled.
+  if (options.f_io_uring && (uring = IOUringNetIO::start(this)) != nullptr) {
+    ep.syscall      = false;
+    write.triggered = 1;
+  }
+#endif
+#if TS_USE_NET_ZEROCOPY
+  if ((options.sockopt_flags & NetVCOptions::SOCK_OPT_ZEROCOPY) && uring == nullptr) {
+    zerocopy = NetZeroCopy::start(con.fd);
+  }
+#endif
+
   // Send this NetVC to NetHandler and start to polling read & write event.
   if (h->startIO(this) < 0) {
     free(t);
@@ -1294,6 +1345,19 @@ UnixNetVConnection::free(EThread *t)
   if (con.fd != NO_FD) {
     NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, -1);
   }
+#if TS_USE_IO_URING_NET
+  if (uring) {
+    uring->detach();
+    uring      = nullptr;
+    ep.syscall = true;
+  }
+#endif
+#if TS_USE_NET_ZEROCOPY
+  if (zerocopy) {
+    zerocopy->detach(con);
+    zerocopy = nullptr;
+  }
+#endif
   con.close();
 
   clear();
@@ -1320,6 +1384,20 @@ UnixNetVConnection::set_inactivity_timeout(ink_hrtime timeout_in)
   Debug("socket", "Set inactive timeout=%" PRId64 ", for NetVC=%p", timeout_in, this);
   inactivity_timeout_in      = timeout_in;
   next_inactivity_timeout_at = (timeout_in > 0) ? Thread::get_hrtime() + inactivity_timeout_in : 0;
+  if (nh) {
+    nh->timeout_changed(this);
+  }
+}
+
+TS_INLINE void
+UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
+{
+  Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
+  active_timeout_in        = timeout_in;
+  next_activity_timeout_at = (active_timeout_in > 0) ? Thread::get_hrtime() + timeout_in : 0;
+  if (nh) {
+    nh->timeout_changed(this);
+  }
 }
 
 TS_INLINE void
@@ -1349,6 +1427,11 @@ UnixNetVConnection::migrateToCurrentThread(Continuation *cont, EThread *t)
     return this;
   }
 
+#if TS_USE_IO_URING_NET
+  // Only outbound connections migrate, io_uring is only used for inbound ones.
+  ink_release_assert(uring == nullptr);
+#endif
+
   Connection hold_con;
   hold_con.move(this->con);
 
@@ -0,0 +1,200 @@
+/** @file
+
+  Zero copy sends with MSG_ZEROCOPY.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Net.h"
+#include "P_UnixNetZeroCopy.h"
+
+#if TS_USE_NET_ZEROCOPY
+
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+
+namespace
+{
+// Sends in flight on one connection, more go out with a copy. The kernel limits them as well, with
+// the option memory of the socket.
+constexpr size_t MAX_SENDS = 256;
+// How long the socket of a freed connection is kept open for the notifications of its sends.
+constexpr ink_hrtime DETACH_TIMEOUT = HRTIME_SECONDS(60);
+// How often the sockets of freed connections are looked at.
+constexpr ink_hrtime DETACH_CHECK_INTERVAL = HRTIME_MSECONDS(10);
+
+thread_local Que(NetZeroCopy, link) detached;
+thread_local ink_hrtime detached_check_at = 0;
+
+inline void
+sum_stat(int stat, int64_t n)
+{
+  RecIncrRawStatSum(net_rsb, this_ethread(), stat, n);
+}
+} // namespace
+
+NetZeroCopy *
+NetZeroCopy::start(int fd)
+{
+  if (safe_setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, SOCKOPT_ON, sizeof(int)) < 0) {
+    Debug("socket", "setsockopt() SO_ZEROCOPY failed on fd %d: %s", fd, strerror(errno));
+    return nullptr;
+  }
+  return new NetZeroCopy(fd);
+}
+
+bool
+NetZeroCopy::use(int64_t len)
+{
+  if (stopped) {
+    if (!sends.empty()) {
+      reap();
+    }
+    return false;
+  }
+  if (copied || len < net_zerocopy_min_bytes) {
+    return false;
+  }
+  if (!sends.empty()) {
+    reap();
+  }
+  return sends.size() < MAX_SENDS;
+}
+
+void
+NetZeroCopy::sent(const IOVec *iov, IOBufferData *const *data, unsigned niov, int64_t sent)
+{
+  uint32_t blocks = 0;
+  int64_t left    = sent;
+
+  for (unsigned i = 0; i < niov && left > 0; ++i) {
+    // Consecutive iovecs usually come from different blocks but can share the data.
+    if (blocks == 0 || held.back().get() != data[i]) {
+      held.emplace_back(data[i]);
+      ++blocks;
+    }
+    left -= iov[i].iov_len;
+  }
+  sends.push_back({next_id++, blocks, false});
+  sum_stat(net_zerocopy_sends_stat, 1);
+  sum_stat(net_zerocopy_bytes_stat, sent);
+}
+
+void
+NetZeroCopy::reap()
+{
+  char control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+  msghdr msg;
+
+  while (!sends.empty()) {
+    ink_zero(msg);
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+    if (SocketManager::recvmsg(fd, &msg, MSG_ERRQUEUE) < 0) {
+      break;
+    }
+    for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+      if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+          !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+        continue;
+      }
+      auto ee = reinterpret_cast<const sock_extended_err *>(CMSG_DATA(cm));
+      if (ee->ee_errno != 0 || ee->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+      // Sends ee_info to ee_data are done, the ids wrap around.
+      uint32_t count = ee->ee_data - ee->ee_info;
+      for (auto &s : sends) {
+        if (s.id - ee->ee_info <= count) {
+          s.done = true;
+        }
+      }
+      // The kernel copied the data after all, as it does for loopback and devices without scatter
+      // gather. Zero copy only adds work then, stop using it for this connection.
+      if (ee->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+        copied = true;
+        sum_stat(net_zerocopy_copied_stat, count + 1);
+      }
+    }
+  }
+
+  while (!sends.empty() && sends.front().done) {
+    for (uint32_t i = 0; i < sends.front().blocks; ++i) {
+      held.pop_front();
+    }
+    sends.pop_front();
+  }
+}
+
+bool
+NetZeroCopy::stop()
+{
+  stopped = true;
+  if (!sends.empty()) {
+    reap();
+  }
+  return sends.empty();
+}
+
+void
+NetZeroCopy::detach(Connection &con)
+{
+  reap();
+  if (sends.empty() || con.fd == NO_FD) {
+    delete this;
+    return;
+  }
+
+  // Closing the socket would lose the notifications, shut it down instead so the peer still sees
+  // the end of the connection.
+  SocketManager::shutdown(con.fd, SHUT_RDWR);
+  fd         = con.fd;
+  con.fd     = NO_FD;
+  release_at = Thread::get_hrtime() + DETACH_TIMEOUT;
+  detached.enqueue(this);
+}
+
+void
+NetZeroCopy::service_detached()
+{
+  if (detached.head == nullptr) {
+    return;
+  }
+
+  ink_hrtime now = Thread::get_hrtime();
+  if (now < detached_check_at) {
+    return;
+  }
+  detached_check_at = now + DETACH_CHECK_INTERVAL;
+
+  NetZeroCopy *next;
+  for (NetZeroCopy *zc = detached.head; zc != nullptr; zc = next) {
+    next = zc->link.next;
+    zc->reap();
+    // A peer that has not taken the data by the timeout is not going to, the kernel drops it when
+    // the socket is closed.
+    if (zc->sends.empty() || now >= zc->release_at) {
+      detached.remove(zc);
+      SocketManager::close(zc->fd);
+      delete zc;
+    }
+  }
+}
+
+#endif
@@ -42,6 +42,9 @@
 // This is needed because old glibc may not have the constant even if Kernel supports it.
 #define UDP_SEGMENT 103
 #endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
 
 using UDPNetContHandler = int (UDPNetHandler::*)(int, void *);
 
@@ -151,7 +154,7 @@ UDPPacket::get_entire_chain_buffer(size_t *buf_len)
     // 2048 more likely we will using this block most of the time.
     if (block && block->next.get() == nullptr) {
       *buf_len = this->getPktLength();
-      return reinterpret_cast<uint8_t *>(block->buf());
+      return reinterpret_cast<uint8_t *>(block->start());
     }
 
     // Store it. Should we try to avoid allocating here?
@@ -256,135 +259,198 @@ UDPNetProcessorInternal::start(int n_upd_threads, size_t stacksize)
   return 0;
 }
 
+namespace
+{
+#ifdef HAVE_RECVMMSG
+using RecvMsg = mmsghdr;
+#else
+struct RecvMsg {
+  msghdr msg_hdr;
+  unsigned int msg_len;
+};
+#endif
+
+// Room for the destination address and the GRO segment size.
+constexpr size_t RECV_CONTROL_SIZE = 128;
+
+// Receive up to @a n datagrams into @a msgs, the number received or -1.
+int
+recv_datagrams(int fd, RecvMsg *msgs, unsigned int n)
+{
+#ifdef HAVE_RECVMMSG
+  return ::recvmmsg(fd, msgs, n, 0, nullptr);
+#else
+  unsigned int i = 0;
+  for (; i < n; ++i) {
+    int64_t r = SocketManager::recvmsg(fd, &msgs[i].msg_hdr, 0);
+    if (r < 0) {
+      break;
+    }
+    msgs[i].msg_len = r;
+  }
+  return i > 0 ? static_cast<int>(i) : -1;
+#endif
+}
+
+// Set the address in @a toaddr to the destination of the datagram of @a msg, the size of the
+// segments it holds if the kernel coalesced several with GRO, otherwise 0.
+int64_t
+read_control(msghdr &msg, sockaddr_in6 &toaddr)
+{
+  int64_t segment_size = 0;
+
+  for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    switch (cmsg->cmsg_type) {
+#ifdef IP_PKTINFO
+    case IP_PKTINFO:
+      if (cmsg->cmsg_level == IPPROTO_IP) {
+        struct in_pktinfo *pktinfo                                = reinterpret_cast<struct in_pktinfo *>(CMSG_DATA(cmsg));
+        reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = pktinfo->ipi_addr.s_addr;
+      }
+      break;
+#endif
+#ifdef IP_RECVDSTADDR
+    case IP_RECVDSTADDR:
+      if (cmsg->cmsg_level == IPPROTO_IP) {
+        struct in_addr *addr                                      = reinterpret_cast<struct in_addr *>(CMSG_DATA(cmsg));
+        reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = addr->s_addr;
+      }
+      break;
+#endif
+#if defined(IPV6_PKTINFO) || defined(IPV6_RECVPKTINFO)
+    case IPV6_PKTINFO: // IPV6_RECVPKTINFO uses IPV6_PKTINFO too
+      if (cmsg->cmsg_level == IPPROTO_IPV6) {
+        struct in6_pktinfo *pktinfo = reinterpret_cast<struct in6_pktinfo *>(CMSG_DATA(cmsg));
+        memcpy(toaddr.sin6_addr.s6_addr, &pktinfo->ipi6_addr, 16);
+      }
+      break;
+#endif
+#ifdef UDP_GRO
+    case UDP_GRO:
+      if (cmsg->cmsg_level == IPPROTO_UDP) {
+        int size;
+        memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+        segment_size = size;
+      }
+      break;
+#endif
+    }
+  }
+  return segment_size;
+}
+
+// Copy @a len bytes to the shared receive buffer of @a nh, returns the offset of the copy. The
+// buffer is reused once the packets in it are freed.
+int64_t
+copy_to_shared(UDPNetHandler *nh, const char *data, int64_t len)
+{
+  Ptr<IOBufferData> &shared = nh->recv_shared;
+
+  if (shared.get() != nullptr && shared->refcount() == 1) {
+    nh->recv_shared_used = 0;
+  }
+  if (shared.get() == nullptr || nh->recv_shared_used + len > shared->block_size()) {
+    shared               = new_IOBufferData(BUFFER_SIZE_INDEX_64K);
+    nh->recv_shared_used = 0;
+  }
+
+  int64_t offset = nh->recv_shared_used;
+  memcpy(shared->data() + offset, data, len);
+  nh->recv_shared_used += len;
+  return offset;
+}
+} // namespace
+
 void
 UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc)
 {
   UnixUDPConnection *uc = (UnixUDPConnection *)xuc;
 
-  // receive packet and queue onto UDPConnection.
+  // receive packets and queue onto UDPConnection.
   // don't call back connection at this time.
-  int64_t r;
-  int iters         = 0;
-  unsigned max_niov = 32;
-
-  struct msghdr msg;
-  Ptr<IOBufferBlock> chain, next_chain;
-  struct iovec tiovec[max_niov];
-  int64_t size_index  = BUFFER_SIZE_INDEX_2K;
-  int64_t buffer_size = BUFFER_SIZE_FOR_INDEX(size_index);
-  // The max length of receive buffer is 32 * buffer_size (2048) = 65536 bytes.
-  // Because the 'UDP Length' is type of uint16_t defined in RFC 768.
-  // And there is 8 octets in 'User Datagram Header' which means the max length of payload is no more than 65527 bytes.
+  constexpr int batch = UDPNetHandler::RECV_BATCH;
+  int r;
+  int iters = 0;
+
+  RecvMsg msgs[batch];
+  struct iovec tiovec[batch];
+  sockaddr_in6 fromaddr[batch];
+  alignas(cmsghdr) char cbuf[batch][RECV_CONTROL_SIZE];
+
+  // The port and, unless the socket is bound to a wildcard address, the address of the destination
+  // are the same for every datagram.
+  sockaddr_in6 localaddr;
+  int localaddr_len = sizeof(localaddr);
+  safe_getsockname(xuc->getFd(), reinterpret_cast<struct sockaddr *>(&localaddr), &localaddr_len);
+
+  // The max length of a datagram is 65527 bytes, because the 'UDP Length' is type of uint16_t defined in RFC 768 and there
+  // are 8 octets in 'User Datagram Header'. The kernel does not coalesce more than that with GRO either, so every datagram
+  // is received into a 64K buffer. Packets of a large datagram, usually several coalesced by GRO, are blocks in that buffer.
+  // A small one is copied to a buffer shared with the datagrams before it, a queued packet would otherwise hold on to 64K and
+  // have the next read allocate another buffer.
   do {
-    // create IOBufferBlock chain to receive data
-    unsigned int niov;
-    IOBufferBlock *b, *last;
-
-    // build struct iov
-    // reuse the block in chain if available
-    b    = chain.get();
-    last = nullptr;
-    for (niov = 0; niov < max_niov; niov++) {
-      if (b == nullptr) {
-        b = new_IOBufferBlock();
-        b->alloc(size_index);
-        if (last == nullptr) {
-          chain = b;
-        } else {
-          last->next = b;
-        }
+    for (int i = 0; i < batch; ++i) {
+      Ptr<IOBufferData> &data = nh->recv_buffers[i];
+      if (data.get() == nullptr || data->refcount() > 1) {
+        data = new_IOBufferData(BUFFER_SIZE_INDEX_64K);
       }
-
-      tiovec[niov].iov_base = b->buf();
-      tiovec[niov].iov_len  = b->block_size();
-
-      last = b;
-      b    = b->next.get();
+      tiovec[i].iov_base = data->data();
+      tiovec[i].iov_len  = data->block_size();
+
+      ink_zero(msgs[i]);
+      msghdr &msg        = msgs[i].msg_hdr;
+      msg.msg_name       = &fromaddr[i];
+      msg.msg_namelen    = sizeof(fromaddr[i]);
+      msg.msg_iov        = &tiovec[i];
+      msg.msg_iovlen     = 1;
+      msg.msg_control    = cbuf[i];
+      msg.msg_controllen = sizeof(cbuf[i]);
     }
 
-    // build struct msghdr
-    sockaddr_in6 fromaddr;
-    sockaddr_in6 toaddr;
-    int toaddr_len = sizeof(toaddr);
-    char *cbuf[1024];
-    msg.msg_name       = &fromaddr;
-    msg.msg_namelen    = sizeof(fromaddr);
-    msg.msg_iov        = tiovec;
-    msg.msg_iovlen     = niov;
-    msg.msg_control    = cbuf;
-    msg.msg_controllen = sizeof(cbuf);
-
-    // receive data by recvmsg
-    r = SocketManager::recvmsg(uc->getFd(), &msg, 0);
+    r = recv_datagrams(uc->getFd(), msgs, batch);
     if (r <= 0) {
       // error
       break;
     }
 
-    // truncated check
-    if (msg.msg_flags & MSG_TRUNC) {
-      Debug("udp-read", "The UDP packet is truncated");
-    }
+    for (int i = 0; i < r; ++i) {
+      msghdr &msg = msgs[i].msg_hdr;
+      int64_t len = msgs[i].msg_len;
 
-    // fill the IOBufferBlock chain
-    int64_t saved = r;
-    b             = chain.get();
-    while (b && saved > 0) {
-      if (saved > buffer_size) {
-        b->fill(buffer_size);
-        saved -= buffer_size;
-        b      = b->next.get();
-      } else {
-        b->fill(saved);
-        saved      = 0;
-        next_chain = b->next.get();
-        b->next    = nullptr;
+      // truncated check
+      if (msg.msg_flags & MSG_TRUNC) {
+        Debug("udp-read", "The UDP packet is truncated");
       }
-    }
 
-    safe_getsockname(xuc->getFd(), reinterpret_cast<struct sockaddr *>(&toaddr), &toaddr_len);
-    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-      switch (cmsg->cmsg_type) {
-#ifdef IP_PKTINFO
-      case IP_PKTINFO:
-        if (cmsg->cmsg_level == IPPROTO_IP) {
-          struct in_pktinfo *pktinfo                                = reinterpret_cast<struct in_pktinfo *>(CMSG_DATA(cmsg));
-          reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = pktinfo->ipi_addr.s_addr;
-        }
-        break;
-#endif
-#ifdef IP_RECVDSTADDR
-      case IP_RECVDSTADDR:
-        if (cmsg->cmsg_level == IPPROTO_IP) {
-          struct in_addr *addr                                      = reinterpret_cast<struct in_addr *>(CMSG_DATA(cmsg));
-          reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = addr->s_addr;
-        }
-        break;
-#endif
-#if defined(IPV6_PKTINFO) || defined(IPV6_RECVPKTINFO)
-      case IPV6_PKTINFO: // IPV6_RECVPKTINFO uses IPV6_PKTINFO too
-        if (cmsg->cmsg_level == IPPROTO_IPV6) {
-          struct in6_pktinfo *pktinfo = reinterpret_cast<struct in6_pktinfo *>(CMSG_DATA(cmsg));
-          memcpy(toaddr.sin6_addr.s6_addr, &pktinfo->ipi6_addr, 16);
-        }
-        break;
-#endif
+      sockaddr_in6 toaddr  = localaddr;
+      int64_t segment_size = read_control(msg, toaddr);
+      if (segment_size <= 0 || segment_size > len) {
+        segment_size = len;
       }
-    }
 
-    // create packet
-    UDPPacket *p = UDPPacket::new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr), ats_ip_sa_cast(&toaddr), chain);
-    p->setConnection(uc);
-    // queue onto the UDPConnection
-    uc->inQueue.push(p);
+      Ptr<IOBufferData> data = nh->recv_buffers[i];
+      int64_t base           = 0;
+      if (len < UDPNetHandler::RECV_COPY_LIMIT) {
+        base = copy_to_shared(nh, data->data(), len);
+        data = nh->recv_shared;
+      }
 
-    // reload the unused block
-    chain      = next_chain;
-    next_chain = nullptr;
+      // create packets, one per datagram the kernel coalesced into this one
+      int64_t offset = 0;
+      do {
+        Ptr<IOBufferBlock> chain = make_ptr(new_IOBufferBlock(data, std::min(segment_size, len - offset), base + offset));
+        UDPPacket *p             = UDPPacket::new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr[i]), ats_ip_sa_cast(&toaddr), chain);
+        p->setConnection(uc);
+        // queue onto the UDPConnection
+        uc->inQueue.push(p);
+        offset += segment_size;
+      } while (offset < len);
+    }
     iters++;
-  } while (r > 0);
+    // A short batch means the socket is drained.
+  } while (r == batch);
   if (iters >= 1) {
-    Debug("udp-read", "read %d at a time", iters);
+    Debug("udp-read", "read %d batches at a time", iters);
   }
   // if not already on to-be-called-back queue, then add it.
   if (!uc->onCallbackQueue) {
@@ -881,6 +947,7 @@ UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int s
   PollCont *pc       = nullptr;
   PollDescriptor *pd = nullptr;
   bool need_bind     = true;
+  int enable_gro     = 0;
 
   if (fd == -1) {
     if ((res = SocketManager::socket(addr->sa_family, SOCK_DGRAM, 0)) < 0) {
@@ -943,6 +1010,12 @@ UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int s
     goto Lerror;
   }
 
+  // Let the kernel coalesce datagrams of a flow, udp_read_from_net() splits them again.
+  REC_ReadConfigInteger(enable_gro, "proxy.config.udp.enable_gro");
+  if (enable_gro && safe_setsockopt(fd, IPPROTO_UDP, UDP_GRO, SOCKOPT_ON, sizeof(int)) < 0) {
+    Debug("udpnet", "setsockopt for UDP_GRO failed");
+  }
+
   if (safe_setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, SOCKOPT_ON, sizeof(int)) < 0) {
     Debug("udpnet", "setsockopt for SO_REUSEPORT failed");
     goto Lerror;
@@ -0,0 +1,286 @@
+/** @file
+
+  Loopback benchmark of the UDP receive path
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <vector>
+#include <netinet/udp.h>
+
+#include "tscore/I_Layout.h"
+#include "records/I_RecordsConfig.h"
+
+#include "P_Net.h"
+#include "P_UDPNet.h"
+
+#include "diags.i"
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+namespace
+{
+// QUIC sized datagrams, a burst fits in the default receive buffer of a socket.
+constexpr int PAYLOAD_SIZE = 1200;
+constexpr int BURST        = 64;
+constexpr int ROUNDS       = 2000;
+
+using Clock = std::chrono::steady_clock;
+
+int
+udp_socket(bool gro)
+{
+  sockaddr_in addr;
+  ink_zero(addr);
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  REQUIRE(fd >= 0);
+  REQUIRE(bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+  REQUIRE(safe_setsockopt(fd, IPPROTO_IP, IP_PKTINFO, SOCKOPT_ON, sizeof(int)) == 0);
+  REQUIRE(fcntl(fd, F_SETFL, O_NONBLOCK) == 0);
+  if (gro && safe_setsockopt(fd, IPPROTO_UDP, UDP_GRO, SOCKOPT_ON, sizeof(int)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Send a burst to @a fd, with GSO the kernel hands a receiver with GRO all of it at once.
+void
+send_burst(int sender, int fd, bool gso)
+{
+  sockaddr_in to;
+  socklen_t to_len = sizeof(to);
+  REQUIRE(getsockname(fd, reinterpret_cast<sockaddr *>(&to), &to_len) == 0);
+
+  static char payload[BURST * PAYLOAD_SIZE];
+  for (int i = 0; i < BURST; ++i) {
+    memset(payload + i * PAYLOAD_SIZE, 'a' + i % 26, PAYLOAD_SIZE);
+  }
+
+  if (gso) {
+    // The kernel does not take more than 64 segments at a time.
+    int segment_size = PAYLOAD_SIZE;
+    REQUIRE(safe_setsockopt(sender, IPPROTO_UDP, UDP_SEGMENT, reinterpret_cast<char *>(&segment_size), sizeof(segment_size)) == 0);
+    for (int i = 0; i < BURST; i += 32) {
+      REQUIRE(sendto(sender, payload + i * PAYLOAD_SIZE, 32 * PAYLOAD_SIZE, 0, reinterpret_cast<sockaddr *>(&to), to_len) ==
+              32 * PAYLOAD_SIZE);
+    }
+  } else {
+    for (int i = 0; i < BURST; ++i) {
+      REQUIRE(sendto(sender, payload + i * PAYLOAD_SIZE, PAYLOAD_SIZE, 0, reinterpret_cast<sockaddr *>(&to), to_len) ==
+              PAYLOAD_SIZE);
+    }
+  }
+}
+
+// The receive path as it was, one recvmsg() per datagram into a new block.
+void
+read_one_by_one(UDPNetHandler *nh, UnixUDPConnection *uc)
+{
+  for (;;) {
+    Ptr<IOBufferBlock> chain = make_ptr(new_IOBufferBlock());
+    chain->alloc(BUFFER_SIZE_INDEX_2K);
+
+    sockaddr_in6 fromaddr;
+    sockaddr_in6 toaddr;
+    int toaddr_len = sizeof(toaddr);
+    char cbuf[128];
+    iovec iov = {chain->buf(), static_cast<size_t>(chain->block_size())};
+    msghdr msg;
+    ink_zero(msg);
+    msg.msg_name       = &fromaddr;
+    msg.msg_namelen    = sizeof(fromaddr);
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+
+    int64_t r = SocketManager::recvmsg(uc->getFd(), &msg, 0);
+    if (r <= 0) {
+      break;
+    }
+    chain->fill(r);
+    safe_getsockname(uc->getFd(), reinterpret_cast<sockaddr *>(&toaddr), &toaddr_len);
+
+    UDPPacket *p = UDPPacket::new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr), ats_ip_sa_cast(&toaddr), chain);
+    p->setConnection(uc);
+    uc->inQueue.push(p);
+  }
+  if (!uc->onCallbackQueue) {
+    uc->AddRef();
+    nh->udp_callbacks.enqueue(uc);
+    uc->onCallbackQueue = 1;
+  }
+}
+
+void
+read_batched(UDPNetHandler *nh, UnixUDPConnection *uc)
+{
+  udpNetInternal.udp_read_from_net(nh, uc);
+}
+
+// Takes the packets as a QUIC packet handler does, and frees them. With @a hold the packets of a
+// read are freed with the next read only, as when they are queued for the thread of a connection.
+struct Receiver : public Continuation {
+  int64_t received = 0;
+  bool hold        = false;
+  std::vector<UDPPacket *> held;
+
+  Receiver() : Continuation(nullptr) { SET_HANDLER(&Receiver::handle_packets); }
+
+  int
+  handle_packets(int event, void *data)
+  {
+    REQUIRE(event == NET_EVENT_DATAGRAM_READ_READY);
+    release();
+    Queue<UDPPacket> *q = static_cast<Queue<UDPPacket> *>(data);
+    while (UDPPacket *p = q->pop()) {
+      size_t len;
+      uint8_t *buf = p->get_entire_chain_buffer(&len);
+      CHECK(len == PAYLOAD_SIZE);
+      CHECK(buf[0] == buf[len - 1]);
+      CHECK(p->to.host_order_port() != 0);
+      if (hold) {
+        held.push_back(p);
+      } else {
+        p->free();
+      }
+      ++received;
+    }
+    return EVENT_CONT;
+  }
+
+  // Bytes of buffers the held packets keep alive, per packet.
+  int64_t
+  held_bytes_per_packet() const
+  {
+    std::set<IOBufferData *> buffers;
+    int64_t bytes = 0;
+    for (UDPPacket *p : held) {
+      IOBufferData *d = p->getIOBlockChain()->data.get();
+      if (buffers.insert(d).second) {
+        bytes += d->block_size();
+      }
+    }
+    return held.empty() ? 0 : bytes / static_cast<int64_t>(held.size());
+  }
+
+  void
+  release()
+  {
+    for (UDPPacket *p : held) {
+      p->free();
+    }
+    held.clear();
+  }
+};
+
+template <typename Read>
+void
+run(const char *name, bool gro, Read &&read, bool hold = false)
+{
+  int fd = udp_socket(gro);
+  if (fd < 0) {
+    std::printf("%-24s UDP GRO is not supported\n", name);
+    return;
+  }
+  int sender = socket(AF_INET, SOCK_DGRAM, 0);
+  REQUIRE(sender >= 0);
+
+  Receiver receiver;
+  receiver.hold = hold;
+  UDPNetHandler nh(false);
+  UnixUDPConnection *uc = new UnixUDPConnection(fd);
+  uc->AddRef();
+  uc->continuation = &receiver;
+
+  Clock::duration elapsed{0};
+  for (int i = 0; i < ROUNDS; ++i) {
+    send_burst(sender, fd, gro);
+    auto start = Clock::now();
+    read(&nh, uc);
+    // Handing the packets on and freeing them is part of the cost, as udp_callback() does.
+    while (UnixUDPConnection *c = nh.udp_callbacks.dequeue()) {
+      c->onCallbackQueue = 0;
+      c->callbackHandler(0, nullptr);
+    }
+    elapsed += Clock::now() - start;
+  }
+  CHECK(receiver.received == static_cast<int64_t>(ROUNDS) * BURST);
+
+  double pps = receiver.received / std::chrono::duration<double>(elapsed).count();
+  std::printf("%-24s %12.0f packets/sec\n", name, pps);
+  if (hold) {
+    // Queued packets must not keep a datagram sized buffer each alive.
+    int64_t bytes = receiver.held_bytes_per_packet();
+    std::printf("%-24s %12" PRId64 " buffer bytes per queued packet\n", name, bytes);
+    CHECK(bytes <= 4 * PAYLOAD_SIZE);
+  }
+  receiver.release();
+
+  uc->continuation = nullptr;
+  uc->Release();
+  close(sender);
+}
+
+} // namespace
+
+TEST_CASE("UDPNet receive", "[iocore][net]")
+{
+  // Everything runs on this thread, the rate is per core.
+  run("recvmsg", false, read_one_by_one);
+  run("recvmmsg", false, read_batched);
+  run("recvmmsg + GRO", true, read_batched);
+  run("recvmmsg, held", false, read_batched, true);
+  run("recvmmsg + GRO, held", true, read_batched, true);
+}
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+    RecProcessInit();
+    LibRecordsConfigInit();
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
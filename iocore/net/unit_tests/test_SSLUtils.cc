@@ -0,0 +1,134 @@
+/** @file
+
+  Catch based unit tests for SSLUtils
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "P_SSLUtils.h"
+
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#if defined(TLS1_3_VERSION) && defined(SSL_KEY_UPDATE_NONE)
+
+namespace
+{
+// A server context with a throwaway self-signed certificate.
+SSL_CTX *
+make_server_ctx()
+{
+  SSL_CTX *ctx       = SSL_CTX_new(TLS_server_method());
+  EVP_PKEY_CTX *kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+  EVP_PKEY *key      = nullptr;
+  X509 *cert         = X509_new();
+
+  EVP_PKEY_keygen_init(kctx);
+  EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1);
+  EVP_PKEY_keygen(kctx, &key);
+  EVP_PKEY_CTX_free(kctx);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+  X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+  X509_set_pubkey(cert, key);
+  X509_NAME_add_entry_by_txt(X509_get_subject_name(cert), "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("test"),
+                             -1, -1, 0);
+  X509_set_issuer_name(cert, X509_get_subject_name(cert));
+  X509_sign(cert, key, EVP_sha256());
+  SSL_CTX_use_certificate(ctx, cert);
+  SSL_CTX_use_PrivateKey(ctx, key);
+  X509_free(cert);
+  EVP_PKEY_free(key);
+  return ctx;
+}
+
+// Move the records between the two ends until neither has anything to send.
+void
+exchange(SSL *client, SSL *server)
+{
+  char buf[256];
+  for (int i = 0; i < 16; i++) {
+    bool progress = false;
+    for (SSL *ssl : {client, server}) {
+      if (!SSL_is_init_finished(ssl)) {
+        progress = SSL_do_handshake(ssl) > 0 || progress;
+      }
+      while (SSL_read(ssl, buf, sizeof(buf)) > 0) {
+        progress = true;
+      }
+    }
+    if (!progress && SSL_is_init_finished(client) && SSL_is_init_finished(server)) {
+      break;
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("SSLHasPendingPostHandshake", "[ssl]")
+{
+  SSL_CTX *server_ctx = make_server_ctx();
+  SSL_CTX *client_ctx = SSL_CTX_new(TLS_client_method());
+  SSL_CTX_set_min_proto_version(server_ctx, TLS1_3_VERSION);
+  SSL_CTX_set_verify(client_ctx, SSL_VERIFY_NONE, nullptr);
+
+  SSL *server = SSL_new(server_ctx);
+  SSL *client = SSL_new(client_ctx);
+  BIO *server_bio, *client_bio;
+  REQUIRE(BIO_new_bio_pair(&server_bio, 0, &client_bio, 0) == 1);
+  SSL_set_bio(server, server_bio, server_bio);
+  SSL_set_bio(client, client_bio, client_bio);
+  SSL_set_accept_state(server);
+  SSL_set_connect_state(client);
+
+  CHECK(SSLHasPendingPostHandshake(server));
+  exchange(client, server);
+  REQUIRE(SSL_is_init_finished(server));
+  CHECK_FALSE(SSLHasPendingPostHandshake(server));
+
+  SECTION("KeyUpdate requested by the peer")
+  {
+    REQUIRE(SSL_key_update(client, SSL_KEY_UPDATE_REQUESTED) == 1);
+    REQUIRE(SSL_write(client, "x", 1) == 1);
+    char c;
+    REQUIRE(SSL_read(server, &c, 1) == 1);
+    // Only SSL_write sends the response.
+    CHECK(SSLHasPendingPostHandshake(server));
+    REQUIRE(SSL_write(server, "y", 1) == 1);
+    CHECK_FALSE(SSLHasPendingPostHandshake(server));
+  }
+
+  SECTION("deferred session ticket")
+  {
+    REQUIRE(SSL_new_session_ticket(server) == 1);
+    CHECK(SSLHasPendingPostHandshake(server));
+    REQUIRE(SSL_write(server, "y", 1) == 1);
+    CHECK_FALSE(SSLHasPendingPostHandshake(server));
+  }
+
+  SSL_free(client);
+  SSL_free(server);
+  SSL_CTX_free(client_ctx);
+  SSL_CTX_free(server_ctx);
+}
+
+#endif
@@ -20,6 +20,9 @@
 
 #include "Server.h"
 
+#include <cxxabi.h>
+#include <dlfcn.h>
+
 #include "P_Cache.h"
 #include <tscore/TSSystemState.h>
 #include "rpc/handlers/common/ErrorUtils.h"
@@ -112,6 +115,140 @@ server_stop_drain(std::string_view const &id, [[maybe_unused]] YAML::Node const
   return resp;
 }
 
+namespace
+{
+  // Call @a f on every event thread with the name of its group and its index in the group.
+  template <typename F>
+  void
+  for_each_event_thread(F &&f)
+  {
+    for (int i = 0; i < eventProcessor.n_thread_groups; ++i) {
+      auto const &group = eventProcessor.thread_group[i];
+      for (int j = 0; j < group._count; ++j) {
+        if (group._thread[j] != nullptr) {
+          f(group._name, j, *group._thread[j]);
+        }
+      }
+    }
+  }
+
+  constexpr std::pair<uint64_t, char const *> PERCENTILES[] = {{50, "p50_us"}, {90, "p90_us"}, {99, "p99_us"}};
+
+  std::string
+  demangle(char const *name)
+  {
+    int status = 0;
+    char *s    = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    std::string r{status == 0 && s ? s : name};
+    free(s);
+    return r;
+  }
+
+  // A pointer to a member function is the address of the function, or for a virtual one the offset in
+  // the vtable plus one.
+  std::string
+  handler_symbol(uintptr_t handler)
+  {
+    Dl_info info;
+    if (handler & 1) {
+      return "virtual";
+    }
+    if (dladdr(reinterpret_cast<void *>(handler), &info) != 0 && info.dli_sname != nullptr) {
+      return demangle(info.dli_sname);
+    }
+    std::string r;
+    return ts::bwprint(r, "{:#x}", handler);
+  }
+} // namespace
+
+ts::Rv<YAML::Node>
+server_get_loop_phases(std::string_view const &id, YAML::Node const &)
+{
+  using Metrics    = EThread::Metrics;
+  using PhaseGraph = Metrics::PhaseGraph;
+  YAML::Node threads{YAML::NodeType::Sequence};
+
+  for_each_event_thread([&](std::string const &group, int idx, EThread &t) {
+    YAML::Node thread;
+    thread["group"] = group;
+    thread["index"] = idx;
+    for (unsigned p = 0; p < Metrics::N_PHASES; ++p) {
+      // Updated by the thread as this runs, a copy keeps the counts consistent with each other.
+      PhaseGraph graph = t.metrics._phase_timing[p];
+      uint64_t count   = 0;
+      for (unsigned b = 0; b < PhaseGraph::N_BUCKETS; ++b) {
+        count += graph[b];
+      }
+
+      YAML::Node phase;
+      YAML::Node buckets{YAML::NodeType::Sequence};
+      uint64_t sum = 0;
+      for (auto const &[pct, key] : PERCENTILES) {
+        phase[key] = 0;
+      }
+      for (unsigned b = 0; b < PhaseGraph::N_BUCKETS; ++b) {
+        if (graph[b] == 0) {
+          continue;
+        }
+        // The lower bound of the bucket that takes the count past the percentile.
+        for (auto const &[pct, key] : PERCENTILES) {
+          if (sum * 100 < count * pct && (sum + graph[b]) * 100 >= count * pct) {
+            phase[key] = PhaseGraph::min_for_bucket(b);
+          }
+        }
+        sum += graph[b];
+        YAML::Node bucket;
+        bucket["min_us"] = PhaseGraph::min_for_bucket(b);
+        bucket["count"]  = graph[b];
+        buckets.push_back(bucket);
+      }
+      phase["count"]                 = count;
+      phase["buckets"]               = buckets;
+      thread[Metrics::PHASE_NAME[p]] = phase;
+    }
+    threads.push_back(thread);
+  });
+
+  YAML::Node resp;
+  resp["threads"] = threads;
+  return resp;
+}
+
+ts::Rv<YAML::Node>
+server_get_slow_handlers(std::string_view const &id, YAML::Node const &)
+{
+  using Metrics  = EThread::Metrics;
+  ink_hrtime now = ink_get_hrtime_internal();
+  YAML::Node threads{YAML::NodeType::Sequence};
+
+  for_each_event_thread([&](std::string const &group, int idx, EThread &t) {
+    YAML::Node thread;
+    YAML::Node calls{YAML::NodeType::Sequence};
+    uint64_t n = t.metrics._slow_handler_count.load(std::memory_order_acquire);
+
+    // Latest first.
+    for (uint64_t i = n; i > 0 && n - i < Metrics::N_SLOW_HANDLERS; --i) {
+      Metrics::SlowHandler h = t.metrics._slow_handler[(i - 1) % Metrics::N_SLOW_HANDLERS];
+      YAML::Node call;
+      call["age_ms"]       = std::max<ink_hrtime>(0, now - h._at) / HRTIME_MSECOND;
+      call["duration_us"]  = h._duration / HRTIME_USECOND;
+      call["event"]        = h._event;
+      call["continuation"] = h._type ? demangle(h._type->name()) : std::string{};
+      call["handler"]      = handler_symbol(h._handler);
+      calls.push_back(call);
+    }
+    thread["group"] = group;
+    thread["index"] = idx;
+    thread["total"] = n;
+    thread["calls"] = calls;
+    threads.push_back(thread);
+  });
+
+  YAML::Node resp;
+  resp["threads"] = threads;
+  return resp;
+}
+
 void
 server_shutdown(YAML::Node const &)
 {
@@ -26,5 +26,7 @@ namespace rpc::handlers::server
 {
 ts::Rv<YAML::Node> server_start_drain(std::string_view const &id, YAML::Node const &params);
 ts::Rv<YAML::Node> server_stop_drain(std::string_view const &id, YAML::Node const &);
+ts::Rv<YAML::Node> server_get_loop_phases(std::string_view const &id, YAML::Node const &);
+ts::Rv<YAML::Node> server_get_slow_handlers(std::string_view const &id, YAML::Node const &);
 void server_shutdown(YAML::Node const &);
 } // namespace rpc::handlers::server
@@ -22,10 +22,14 @@
  */
 
 #include "tscore/ink_platform.h"
-#include "tscore/HashFNV.h"
 #include "tscore/Diags.h"
 #include "tscore/ink_memory.h"
+#include <algorithm>
 #include <cstdio>
+#include <string>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "tscore/Allocator.h"
 #include "HTTP.h"
 #include "HdrToken.h"
@@ -34,20 +38,22 @@
 #include "URL.h"
 
 /*
- You SHOULD add to _hdrtoken_commonly_tokenized_strs, with the same ordering
  ** important, ordering matters **
 
  You want a regexp like 'Accept' after "greedier" choices so it doesn't match 'Accept-Ranges' earlier than
  it should. The regexp are anchored (^Accept), but I dont see a way with the current system to
  match the word ONLY without making _hdrtoken_strs a real PCRE, but then that breaks the hashing
- hdrtoken_hash("^Accept$") != hdrtoken_hash("Accept")
+ of the strings.
 
  So, the current hack is to have "Accept" follow "Accept-.*", lame, I know
 
   /ericb
 */
 
-static const char *_hdrtoken_strs[] = {
+// WARNING:  Indexes into this array are stored on disk for cached objects.  New strings must be added at the end of the array to
+// avoid changing the indexes of pre-existing entries, unless the cache format version number is increased.
+//
+static constexpr const char *_hdrtoken_strs[] = {
   // MIME Field names
   "Accept-Charset", "Accept-Encoding", "Accept-Language", "Accept-Ranges", "Accept", "Age", "Allow",
   "Approved", // NNTP
@@ -267,152 +273,260 @@ DFA *hdrtoken_strs_dfa = nullptr;
 
 /***********************************************************************
  *                                                                     *
- *                        H A S H    T A B L E                         *
+ *                     P E R F E C T    H A S H                        *
  *                                                                     *
  ***********************************************************************/
 
-#define HDRTOKEN_HASH_TABLE_SIZE 65536
+/*
+  A minimal perfect hash of the well known strings, built when compiling. A string is hashed by its
+  length and its first and last 8 bytes, or 4 if it is shorter. The strings fall in buckets by that
+  hash and each bucket gets a displacement that moves its strings to slots no other string has. A
+  lookup is a hash, a slot and one compare with the string in it.
+*/
 
-struct HdrTokenHashBucket {
-  const char *wks;
-  uint32_t hash;
+namespace
+{
+constexpr int WKS_COUNT       = SIZEOF(_hdrtoken_strs);
+constexpr int WKS_MAX_LENGTH  = 32;
+constexpr int WKS_BUCKET_BITS = 6;
+
+struct WksSlot {
+  char lower[WKS_MAX_LENGTH] = {}; ///< Lower case, padded with zeros.
+  int16_t wks_idx            = -1;
+  uint8_t length             = 0;
 };
 
-HdrTokenHashBucket hdrtoken_hash_table[HDRTOKEN_HASH_TABLE_SIZE];
+struct WksHash {
+  uint16_t displacement[1 << WKS_BUCKET_BITS] = {};
+  WksSlot slots[WKS_COUNT]                    = {};
+  bool ok                                     = false;
+};
 
-/**
-  basic FNV hash
-**/
-#define TINY_MASK(x) (((uint32_t)1 << (x)) - 1)
+// The hash loads @a n bytes little endian whatever the host is, so it is the same when compiling and
+// at run time. This one works in a constant expression.
+struct WksConstantLoad {
+  constexpr uint64_t
+  operator()(const char *s, int n) const
+  {
+    uint64_t w = 0;
+    for (int i = 0; i < n; ++i) {
+      w |= static_cast<uint64_t>(static_cast<uint8_t>(s[i])) << (8 * i);
+    }
+    return w;
+  }
+};
 
-inline uint32_t
-hash_to_slot(uint32_t hash)
+// This one is a single load.
+struct WksLoad {
+  uint64_t
+  operator()(const char *s, int n) const
+  {
+    uint64_t w = 0;
+    memcpy(&w, s, n);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap64(w) >> (64 - 8 * n);
+#endif
+    return w;
+  }
+};
+
+template <typename Load>
+constexpr uint64_t
+wks_hash(const char *s, int len, Load wks_load)
 {
-  return ((hash >> 15) ^ hash) & TINY_MASK(15);
+  uint64_t first = 0;
+  uint64_t last  = 0;
+
+  if (len >= 8) {
+    first = wks_load(s, 8);
+    last  = wks_load(s + len - 8, 8);
+  } else if (len >= 4) {
+    first = wks_load(s, 4);
+    last  = wks_load(s + len - 4, 4);
+  } else {
+    first = wks_load(s, 1);
+    last  = wks_load(s + len - 1, 1) | wks_load(s + len / 2, 1) << 8;
+  }
+  // Setting 0x20 makes letters lower case, other characters may collide but the compare sorts them out.
+  first |= 0x2020202020202020;
+  last  |= 0x2020202020202020;
+
+  uint64_t h  = (first * 0x9e3779b97f4a7c15) ^ (last * 0xc2b2ae3d27d4eb4f) ^ len;
+  h          ^= h >> 29;
+  return h * 0xbf58476d1ce4e5b9;
 }
 
-inline uint32_t
-hdrtoken_hash(const unsigned char *string, unsigned int length)
+constexpr int
+wks_bucket(uint64_t hash)
 {
-  ATSHash32FNV1a fnv;
-  fnv.update(string, length, ATSHash::nocase());
-  fnv.final();
-  return fnv.get();
+  return hash >> (64 - WKS_BUCKET_BITS);
 }
 
-/*-------------------------------------------------------------------------
-  -------------------------------------------------------------------------*/
-
-// WARNING:  Indexes into this array are stored on disk for cached objects.  New strings must be added at the end of the array to
-// avoid changing the indexes of pre-existing entries, unless the cache format version number is increased.
-//
-static const char *_hdrtoken_commonly_tokenized_strs[] = {
-  // MIME Field names
-  "Accept-Charset", "Accept-Encoding", "Accept-Language", "Accept-Ranges", "Accept", "Age", "Allow",
-  "Approved", // NNTP
-  "Authorization",
-  "Bytes", // NNTP
-  "Cache-Control", "Client-ip", "Connection", "Content-Base", "Content-Encoding", "Content-Language", "Content-Length",
-  "Content-Location", "Content-MD5", "Content-Range", "Content-Type",
-  "Control", // NNTP
-  "Cookie", "Date",
-  "Distribution", // NNTP
-  "Etag", "Expect", "Expires",
-  "Followup-To", // NNTP
-  "From", "Host", "If-Match", "If-Modified-Since", "If-None-Match", "If-Range", "If-Unmodified-Since", "Keep-Alive",
-  "Keywords", // NNTP
-  "Last-Modified",
-  "Lines", // NNTP
-  "Location", "Max-Forwards",
-  "Message-ID", // NNTP
-  "MIME-Version",
-  "Newsgroups",   // NNTP
-  "Organization", // NNTP
-  "Path",         // NNTP
-  "Pragma", "Proxy-Authenticate", "Proxy-Authorization", "Proxy-Connection", "Public", "Range",
-  "References", // NNTP
-  "Referer",
-  "Reply-To", // NNTP
-  "Retry-After",
-  "Sender", // NNTP
-  "Server", "Set-Cookie",
-  "Subject", // NNTP
-  "Summary", // NNTP
-  "Transfer-Encoding", "Upgrade", "User-Agent", "Vary", "Via", "Warning", "Www-Authenticate",
-  "Xref",          // NNTP
-  "@Ats-Internal", // Internal Hack
-
-  // Accept-Encoding
-  "compress", "deflate", "gzip", "identity",
-
-  // Cache-Control flags
-  "max-age", "max-stale", "min-fresh", "must-revalidate", "no-cache", "no-store", "no-transform", "only-if-cached", "private",
-  "proxy-revalidate", "s-maxage", "need-revalidate-once",
-
-  // HTTP miscellaneous
-  "none", "chunked", "close",
-
-  // WS
-  "websocket", "Sec-WebSocket-Key", "Sec-WebSocket-Version",
-
-  // HTTP/2 cleartext
-  MIME_UPGRADE_H2C_TOKEN, "HTTP2-Settings",
+constexpr int
+wks_slot(uint64_t hash, uint16_t displacement)
+{
+  uint64_t h = (hash ^ (displacement * 0x9e3779b97f4a7c15)) * 0xd6e8feb86659fd93;
+  return ((h >> 32) * WKS_COUNT) >> 32;
+}
 
-  // URL schemes
-  "file", "ftp", "gopher", "https", "http", "mailto", "news", "nntp", "prospero", "telnet", "tunnel", "wais", "pnm", "rtspu",
-  "rtsp", "mmsu", "mmst", "mms", "wss", "ws",
+constexpr WksHash
+wks_hash_build()
+{
+  WksHash table;
+  uint64_t hashes[WKS_COUNT]             = {};
+  int bucket_sizes[1 << WKS_BUCKET_BITS] = {};
+  int max_bucket_size                    = 0;
+  bool taken[WKS_COUNT]                  = {};
+
+  for (int i = 0; i < WKS_COUNT; ++i) {
+    int len = std::char_traits<char>::length(_hdrtoken_strs[i]);
+    if (len == 0 || len > WKS_MAX_LENGTH) {
+      return table;
+    }
+    hashes[i]       = wks_hash(_hdrtoken_strs[i], len, WksConstantLoad());
+    max_bucket_size = std::max(max_bucket_size, ++bucket_sizes[wks_bucket(hashes[i])]);
+  }
 
-  // HTTP methods
-  "CONNECT", "DELETE", "GET", "POST", "HEAD", "OPTIONS", "PURGE", "PUT", "TRACE", "PUSH",
+  // The largest buckets first, while there are many free slots.
+  for (int size = max_bucket_size; size > 0; --size) {
+    for (int b = 0; b < (1 << WKS_BUCKET_BITS); ++b) {
+      if (bucket_sizes[b] != size) {
+        continue;
+      }
+      uint16_t d = 1;
+      for (; d != 0; ++d) {
+        int slots[WKS_COUNT] = {};
+        int n                = 0;
+        for (int i = 0; i < WKS_COUNT && n >= 0; ++i) {
+          if (wks_bucket(hashes[i]) != b) {
+            continue;
+          }
+          int slot = wks_slot(hashes[i], d);
+          for (int j = 0; j < n && slot >= 0; ++j) {
+            if (slots[j] == slot) {
+              slot = -1;
+            }
+          }
+          if (slot < 0 || taken[slot]) {
+            n = -1;
+          } else {
+            slots[n++] = slot;
+          }
+        }
+        if (n == size) {
+          break;
+        }
+      }
+      if (d == 0) {
+        return table;
+      }
+      table.displacement[b] = d;
+      for (int i = 0; i < WKS_COUNT; ++i) {
+        if (wks_bucket(hashes[i]) == b) {
+          int n         = wks_slot(hashes[i], d);
+          WksSlot &slot = table.slots[n];
+          taken[n]      = true;
+          slot.wks_idx  = i;
+          slot.length   = std::char_traits<char>::length(_hdrtoken_strs[i]);
+          for (int k = 0; k < slot.length; ++k) {
+            char c        = _hdrtoken_strs[i][k];
+            slot.lower[k] = c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+          }
+        }
+      }
+    }
+  }
+  table.ok = true;
+  return table;
+}
 
-  // Header extensions
-  "X-ID", "X-Forwarded-For", "TE", "Strict-Transport-Security", "100-continue",
+constexpr WksHash wks_table = wks_hash_build();
+static_assert(wks_table.ok, "No perfect hash for the well known strings, try other bucket bits or constants");
 
-  // RFC-2739
-  "Forwarded",
+inline uint64_t
+load64(const char *s)
+{
+  uint64_t w;
+  memcpy(&w, s, sizeof(w));
+  return w;
+}
 
-  // RFC-8470
-  "Early-Data",
+inline uint32_t
+load32(const char *s)
+{
+  uint32_t w;
+  memcpy(&w, s, sizeof(w));
+  return w;
+}
 
-  // RFC-7932
-  "br"};
+// ASCII upper case letters to lower case, 8 at a time.
+inline uint64_t
+lower64(uint64_t w)
+{
+  uint64_t heptets = w & 0x7f7f7f7f7f7f7f7f;
+  uint64_t ge_a    = heptets + 0x3f3f3f3f3f3f3f3f; // high bit set from 'A'
+  uint64_t gt_z    = heptets + 0x2525252525252525; // high bit set after 'Z'
+  uint64_t upper   = ge_a & ~gt_z & ~w & 0x8080808080808080;
+  return w | (upper >> 2);
+}
 
-/*-------------------------------------------------------------------------
-  -------------------------------------------------------------------------*/
+#if defined(__SSE2__)
+inline bool
+lower_equal16(const char *s, const char *lower)
+{
+  __m128i v     = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+  __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+  v             = _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(lower)))) == 0xffff;
+}
+#endif
 
-void
-hdrtoken_hash_init()
+// Whether @a s, of the length of @a slot, is its string in any case. The loads overlap rather than
+// go past the end of @a s.
+inline bool
+wks_equal(const char *s, int len, const WksSlot &slot)
 {
-  uint32_t i;
-  int num_collisions;
-
-  memset(hdrtoken_hash_table, 0, sizeof(hdrtoken_hash_table));
-  num_collisions = 0;
-
-  for (i = 0; i < static_cast<int> SIZEOF(_hdrtoken_commonly_tokenized_strs); i++) {
-    // convert the common string to the well-known token
-    unsigned const char *wks;
-    int wks_idx =
-      hdrtoken_tokenize_dfa(_hdrtoken_commonly_tokenized_strs[i], static_cast<int>(strlen(_hdrtoken_commonly_tokenized_strs[i])),
-                            reinterpret_cast<const char **>(&wks));
-    ink_release_assert(wks_idx >= 0);
-
-    uint32_t hash = hdrtoken_hash(wks, hdrtoken_str_lengths[wks_idx]);
-    uint32_t slot = hash_to_slot(hash);
-
-    if (hdrtoken_hash_table[slot].wks) {
-      printf("ERROR: hdrtoken_hash_table[%u] collision: '%s' replacing '%s'\n", slot, reinterpret_cast<const char *>(wks),
-             hdrtoken_hash_table[slot].wks);
-      ++num_collisions;
+  const char *lower = slot.lower;
+
+#if defined(__SSE2__)
+  if (len >= 16) {
+    return lower_equal16(s, lower) && lower_equal16(s + len - 16, lower + len - 16);
+  }
+#endif
+  if (len >= 8) {
+    for (int i = 0; i < len - 8; i += 8) {
+      if (lower64(load64(s + i)) != load64(lower + i)) {
+        return false;
+      }
+    }
+    return lower64(load64(s + len - 8)) == load64(lower + len - 8);
+  }
+  if (len >= 4) {
+    return static_cast<uint32_t>(lower64(load32(s))) == load32(lower) &&
+           static_cast<uint32_t>(lower64(load32(s + len - 4))) == load32(lower + len - 4);
+  }
+  for (int i = 0; i < len; ++i) {
+    if (ParseRules::ink_tolower(s[i]) != lower[i]) {
+      return false;
     }
-    hdrtoken_hash_table[slot].wks  = reinterpret_cast<const char *>(wks);
-    hdrtoken_hash_table[slot].hash = hash;
   }
+  return true;
+}
 
-  if (num_collisions > 0) {
-    abort();
+int
+wks_lookup(const char *string, int string_len)
+{
+  if (string_len <= 0 || string_len > WKS_MAX_LENGTH) {
+    return -1;
   }
+  uint64_t hash       = wks_hash(string, string_len, WksLoad());
+  const WksSlot &slot = wks_table.slots[wks_slot(hash, wks_table.displacement[wks_bucket(hash)])];
+  if (slot.length != string_len || !wks_equal(string, string_len, slot)) {
+    return -1;
+  }
+  return slot.wks_idx;
 }
+} // namespace
 
 /***********************************************************************
  *                                                                     *
@@ -443,7 +557,7 @@ hdrtoken_init()
     inited = 1;
 
     hdrtoken_strs_dfa = new DFA;
-    hdrtoken_strs_dfa->compile(_hdrtoken_strs, SIZEOF(_hdrtoken_strs), (RE_CASE_INSENSITIVE));
+    hdrtoken_strs_dfa->compile(const_cast<const char **>(_hdrtoken_strs), SIZEOF(_hdrtoken_strs), (RE_CASE_INSENSITIVE));
 
     // all the tokenized hdrtoken strings are placed in a special heap,
     // and each string is prepended with a HdrTokenHeapPrefix ---
@@ -527,8 +641,6 @@ hdrtoken_init()
       hdrtoken_str_masks[i]       = prefix->wks_info.mask;   // parallel array for speed
       hdrtoken_str_flags[i]       = prefix->wks_info.flags;  // parallel array for speed
     }
-
-    hdrtoken_hash_init();
   }
 }
 
@@ -588,7 +700,6 @@ int
 hdrtoken_tokenize(const char *string, int string_len, const char **wks_string_out)
 {
   int wks_idx;
-  HdrTokenHashBucket *bucket;
 
   ink_assert(string != nullptr);
 
@@ -600,14 +711,10 @@ hdrtoken_tokenize(const char *string, int string_len, const char **wks_string_ou
     return wks_idx;
   }
 
-  uint32_t hash = hdrtoken_hash(reinterpret_cast<const unsigned char *>(string), static_cast<unsigned int>(string_len));
-  uint32_t slot = hash_to_slot(hash);
-
-  bucket = &(hdrtoken_hash_table[slot]);
-  if ((bucket->wks != nullptr) && (bucket->hash == hash) && (hdrtoken_wks_to_length(bucket->wks) == string_len)) {
-    wks_idx = hdrtoken_wks_to_index(bucket->wks);
+  wks_idx = wks_lookup(string, string_len);
+  if (wks_idx >= 0) {
     if (wks_string_out) {
-      *wks_string_out = bucket->wks;
+      *wks_string_out = hdrtoken_strs[wks_idx];
     }
     return wks_idx;
   }
@@ -25,6 +25,8 @@
 #include "tscore/ink_platform.h"
 #include "tscore/ink_memory.h"
 #include "tscore/ink_defs.h"
+#include "tscore/ink_assert.h"
+#include "tscore/ink_endian.h"
 
 struct huffman_entry {
   uint32_t code_as_hex;
@@ -291,189 +293,164 @@ static const huffman_entry huffman_table[] = {
   {0x3fffffff, 30}
 };
 
-using Node = struct node {
-  node *left, *right;
-  char ascii_code;
-  bool leaf_node;
+// The decoder runs a state machine over the input, a byte at a time. A state is an internal node of
+// the Huffman tree, there are 256 of them for the 257 codes. The shortest code is 5 bits so a step
+// emits at most two symbols. The table takes 256 KB.
+namespace
+{
+constexpr int HUFFMAN_DECODE_STATES = 256;
+constexpr int HUFFMAN_DECODE_BITS   = 8;
+
+enum huffman_decode_flags : uint8_t {
+  HUFFMAN_DECODE_ACCEPT       = 0x1, ///< The input may end in the next state, the pending bits are a prefix of EOS.
+  HUFFMAN_DECODE_FAIL         = 0x2, ///< EOS was decoded.
+  HUFFMAN_DECODE_SYMBOL_SHIFT = 4,   ///< The number of symbols decoded is in the high bits.
 };
 
-Node *HUFFMAN_TREE_ROOT;
+struct huffman_decode_entry {
+  uint8_t state;
+  uint8_t flags;
+  uint8_t symbol[2];
+};
 
-static Node *
-make_huffman_tree_node()
-{
-  Node *n       = static_cast<Node *>(ats_malloc(sizeof(Node)));
-  n->left       = nullptr;
-  n->right      = nullptr;
-  n->ascii_code = '\0';
-  n->leaf_node  = false;
-  return n;
-}
+huffman_decode_entry huffman_decode_table[HUFFMAN_DECODE_STATES][1 << HUFFMAN_DECODE_BITS];
 
-static Node *
-make_huffman_tree()
+// Ids of the child nodes of the internal nodes, leaves are -1 - symbol.
+struct huffman_tree_node {
+  int child[2];
+};
+
+void
+make_huffman_decode_table()
 {
-  Node *root = make_huffman_tree_node();
+  huffman_tree_node tree[HUFFMAN_DECODE_STATES];
+  int n_nodes = 1;
 
-  // insert leafs for each ascii code
+  tree[0] = {{0, 0}};
   for (unsigned i = 0; i < countof(huffman_table); i++) {
-    uint32_t bit_len = huffman_table[i].bit_len;
-    Node *current    = root;
-
-    while (bit_len > 0) {
-      if (huffman_table[i].code_as_hex & (1 << (bit_len - 1))) {
-        if (!current->right) {
-          current->right = make_huffman_tree_node();
-        }
-        current = current->right;
+    int current = 0;
+    for (uint32_t bit_len = huffman_table[i].bit_len; bit_len > 0; bit_len--) {
+      int &child = tree[current].child[(huffman_table[i].code_as_hex >> (bit_len - 1)) & 1];
+      if (bit_len == 1) {
+        child = -1 - static_cast<int>(i);
       } else {
-        if (!current->left) {
-          current->left = make_huffman_tree_node();
+        if (child == 0) {
+          ink_release_assert(n_nodes < HUFFMAN_DECODE_STATES);
+          tree[n_nodes] = {{0, 0}};
+          child         = n_nodes++;
         }
-        current = current->left;
+        current = child;
       }
-      bit_len--;
     }
-    current->ascii_code = i;
-    current->leaf_node  = true;
   }
+  ink_release_assert(n_nodes == HUFFMAN_DECODE_STATES);
 
-  return root;
-}
-
-static void
-free_huffman_tree(Node *node)
-{
-  if (node->left) {
-    free_huffman_tree(node->left);
-  }
-  if (node->right) {
-    free_huffman_tree(node->right);
+  // Padding is up to 7 bits of the EOS code, which is all ones.
+  bool accept[HUFFMAN_DECODE_STATES] = {};
+  for (int depth = 0, current = 0; depth < 8 && current >= 0; ++depth, current = tree[current].child[1]) {
+    accept[current] = true;
   }
 
-  ats_free(node);
+  for (int state = 0; state < HUFFMAN_DECODE_STATES; ++state) {
+    for (int bits = 0; bits < (1 << HUFFMAN_DECODE_BITS); ++bits) {
+      huffman_decode_entry &e = huffman_decode_table[state][bits];
+      int current             = state;
+      int n                   = 0;
+
+      e = {0, 0, {0, 0}};
+      for (int shift = HUFFMAN_DECODE_BITS - 1; shift >= 0; --shift) {
+        current = tree[current].child[(bits >> shift) & 1];
+        if (current < 0) {
+          int symbol = -1 - current;
+          if (symbol == static_cast<int>(countof(huffman_table)) - 1) {
+            e.flags = HUFFMAN_DECODE_FAIL;
+            break;
+          }
+          e.symbol[n++] = symbol;
+          current       = 0;
+        }
+      }
+      if (!(e.flags & HUFFMAN_DECODE_FAIL)) {
+        e.state = current;
+        e.flags = (n << HUFFMAN_DECODE_SYMBOL_SHIFT) | (accept[current] ? HUFFMAN_DECODE_ACCEPT : 0);
+      }
+    }
+  }
 }
 
+bool huffman_decode_table_ready = false;
+} // namespace
+
 void
 hpack_huffman_init()
 {
-  if (!HUFFMAN_TREE_ROOT) {
-    HUFFMAN_TREE_ROOT = make_huffman_tree();
+  if (!huffman_decode_table_ready) {
+    make_huffman_decode_table();
+    huffman_decode_table_ready = true;
   }
 }
 
 void
 hpack_huffman_fin()
 {
-  if (HUFFMAN_TREE_ROOT) {
-    free_huffman_tree(HUFFMAN_TREE_ROOT);
-  }
+  // The decode table is static, there is nothing to free.
 }
 
-#define MAX_HUFFMAN_CODE_LEN 30
-#define EOS                  0x3fffffff
-
 int64_t
 huffman_decode(char *dst_start, const uint8_t *src, uint32_t src_len)
 {
-  char *dst_end      = dst_start;
-  uint8_t shift      = 7;
-  Node *current      = HUFFMAN_TREE_ROOT;
-  int nbits          = 0;
-  uint32_t curr_bits = 0;
-
-  while (src_len) {
-    if (nbits > 0) {
-      curr_bits <<= 1;
-    }
-    if (*src & (1 << shift)) {
-      curr_bits |= 1;
-      current    = current->right;
-    } else {
-      current = current->left;
-    }
-    ++nbits;
+  char *dst_end = dst_start;
+  uint8_t state = 0;
+  uint8_t flags = HUFFMAN_DECODE_ACCEPT;
 
-    if (current->leaf_node == true) {
-      if (curr_bits == EOS) {
-        return -1;
-      }
-      nbits     = 0;
-      curr_bits = 0;
-      *dst_end  = current->ascii_code;
-      ++dst_end;
-      current = HUFFMAN_TREE_ROOT;
-    }
-
-    if (shift) {
-      --shift;
-    } else {
-      shift = 7;
-      ++src;
-      --src_len;
-    }
+  for (const uint8_t *end = src + src_len; src < end; ++src) {
+    const huffman_decode_entry &e = huffman_decode_table[state][*src];
 
-    if (nbits > MAX_HUFFMAN_CODE_LEN) {
+    if (e.flags & HUFFMAN_DECODE_FAIL) {
       return -1;
     }
+    // Both are copied whether or not they were decoded, it is cheaper than a branch.
+    memcpy(dst_end, e.symbol, sizeof(e.symbol));
+    dst_end += e.flags >> HUFFMAN_DECODE_SYMBOL_SHIFT;
+    state    = e.state;
+    flags    = e.flags;
   }
 
-  if (nbits > 7) {
-    return -1;
-  }
-
-  // Padding bits must be a prefix of EOS
-  uint8_t mask = (1 << nbits) - 1;
-  if ((mask & curr_bits) != mask) {
+  // More than 7 bits of padding, or padding that is not a prefix of EOS.
+  if (!(flags & HUFFMAN_DECODE_ACCEPT)) {
     return -1;
   }
 
   return dst_end - dst_start;
 }
 
-uint8_t *
-huffman_encode_append(uint8_t *dst, uint32_t src, int n = 0)
-{
-  for (int j = 3; j >= n; --j) {
-    *dst++ = ((src >> (8 * j)) & 255);
-  }
-  return dst;
-}
-
 int64_t
 huffman_encode(uint8_t *dst_start, const uint8_t *src, uint32_t src_len)
 {
   uint8_t *dst = dst_start;
-  // NOTE: The maximum length of Huffman Code is 30, thus using uint32_t as buffer.
-  uint32_t buf         = 0;
-  uint32_t remain_bits = 32;
+  // NOTE: The maximum length of Huffman Code is 30, 32 bits are written out as soon as they are
+  // complete so at most 61 bits are pending.
+  uint64_t buf = 0;
+  uint32_t len = 0;
 
   for (uint32_t i = 0; i < src_len; ++i) {
-    const uint32_t hex     = huffman_table[src[i]].code_as_hex;
-    const uint32_t bit_len = huffman_table[src[i]].bit_len;
-
-    if (remain_bits > bit_len) {
-      remain_bits  = remain_bits - bit_len;
-      buf         |= hex << remain_bits;
-    } else if (remain_bits == bit_len) {
-      buf         |= hex;
-      dst          = huffman_encode_append(dst, buf);
-      remain_bits  = 32;
-      buf          = 0;
-    } else {
-      buf         |= hex >> (bit_len - remain_bits);
-      dst          = huffman_encode_append(dst, buf);
-      remain_bits  = (32 - (bit_len - remain_bits));
-      buf          = hex << remain_bits;
+    buf  = (buf << huffman_table[src[i]].bit_len) | huffman_table[src[i]].code_as_hex;
+    len += huffman_table[src[i]].bit_len;
+    if (len >= 32) {
+      len          -= 32;
+      uint32_t word = htobe32(static_cast<uint32_t>(buf >> len));
+      memcpy(dst, &word, sizeof(word));
+      dst += sizeof(word);
     }
   }
 
-  dst = huffman_encode_append(dst, buf, remain_bits / 8);
-
   // NOTE: Add padding w/ EOS
-  uint32_t pad_len = remain_bits % 8;
-  if (pad_len) {
-    *(dst - 1) |= 0xff >> (8 - pad_len);
+  uint32_t pad_len = (8 - len % 8) % 8;
+  buf              = (buf << pad_len) | ((1 << pad_len) - 1);
+  len             += pad_len;
+  while (len > 0) {
+    len    -= 8;
+    *dst++  = buf >> len;
   }
 
   return dst - dst_start;
@@ -28,6 +28,6 @@
 
 void hpack_huffman_init();
 void hpack_huffman_fin();
+/// Decode @a src_len bytes of @a src, -1 on error. @a dst_start must have room for <tt>src_len * 8 / 5 + 1</tt> bytes.
 int64_t huffman_decode(char *dst_start, const uint8_t *src, uint32_t src_len);
-uint8_t *huffman_encode_append(uint8_t *dst, uint32_t src, int n);
 int64_t huffman_encode(uint8_t *dst_start, const uint8_t *src, uint32_t src_len);
@@ -33,6 +33,7 @@
 #include "HdrHeap.h"
 #include "HdrToken.h"
 #include "HdrUtils.h"
+#include "MIMEScan.h"
 #include "HttpCompat.h"
 
 using ts::TextView;
@@ -54,6 +55,8 @@ using ts::TextView;
 static DFA *day_names_dfa   = nullptr;
 static DFA *month_names_dfa = nullptr;
 
+thread_local MIMEFieldFindStats mime_field_find_stats;
+
 static const char *day_names[] = {
   "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat",
 };
@@ -435,6 +438,131 @@ mime_hdr_presence_unset(MIMEHdrImpl *h, int well_known_str_index)
   mime_hdr_presence_unset(h, wks);
 }
 
+/***********************************************************************
+ *                                                                     *
+ *                         N A M E    I N D E X                        *
+ *                                                                     *
+ ***********************************************************************/
+
+// The hash of the length and the first and last 8 bytes of a name, in any case.
+static inline unsigned
+mime_name_index_hash(const char *name, int length)
+{
+  uint64_t first = 0;
+  uint64_t last  = 0;
+  int n          = std::min(length, 8);
+
+  memcpy(&first, name, n);
+  memcpy(&last, name + length - n, n);
+  uint64_t h = ((first | 0x2020202020202020) * 0x9e3779b97f4a7c15) ^ ((last | 0x2020202020202020) * 0xc2b2ae3d27d4eb4f) ^ length;
+  return (h * 0xbf58476d1ce4e5b9) >> (64 - MIME_NAME_INDEX_BITS);
+}
+
+static inline bool
+mime_field_name_equal(const MIMEField *field, const char *name, int length)
+{
+  return field != nullptr && field->m_len_name == length && strncasecmp(field->m_ptr_name, name, length) == 0;
+}
+
+/// The entry of the dup head named @a name, nullptr if there is none.
+static uint8_t *
+mime_hdr_name_index_find(MIMEHdrImpl *mh, const char *name, int length, MIMEField **field_out = nullptr)
+{
+  unsigned i = mime_name_index_hash(name, length);
+
+  for (int probes = 0; probes < MIME_NAME_INDEX_SIZE; ++probes, i = (i + 1) % MIME_NAME_INDEX_SIZE) {
+    uint8_t &entry = mh->m_name_index[i];
+    if (entry == MIME_NAME_INDEX_EMPTY) {
+      break;
+    }
+    if (entry != MIME_NAME_INDEX_DELETED) {
+      MIMEField *field = _mime_hdr_field_list_search_by_slotnum(mh, entry - 1);
+      if (mime_field_name_equal(field, name, length)) {
+        if (field_out) {
+          *field_out = field;
+        }
+        return &entry;
+      }
+    }
+  }
+  return nullptr;
+}
+
+/// Add @a field, the dup head at @a slotnum of a name not in the index. False if there is no room.
+static bool
+mime_hdr_name_index_add(MIMEHdrImpl *mh, MIMEField *field, int slotnum)
+{
+  if (slotnum < 0 || slotnum >= MIME_NAME_INDEX_DELETED - 1) {
+    return false;
+  }
+
+  unsigned i = mime_name_index_hash(field->m_ptr_name, field->m_len_name);
+  while (mh->m_name_index[i] != MIME_NAME_INDEX_EMPTY && mh->m_name_index[i] != MIME_NAME_INDEX_DELETED) {
+    i = (i + 1) % MIME_NAME_INDEX_SIZE;
+  }
+  if (mh->m_name_index[i] == MIME_NAME_INDEX_EMPTY) {
+    // Probes stop at an empty entry, keep some.
+    if (mh->m_name_index_used >= MIME_NAME_INDEX_MAX_USED) {
+      return false;
+    }
+    ++mh->m_name_index_used;
+  }
+  mh->m_name_index[i] = slotnum + 1;
+  return true;
+}
+
+// Up to one block of fields a walk is as fast.
+static inline bool
+mime_hdr_name_index_use(const MIMEHdrImpl *mh)
+{
+  return mh->m_first_fblock.m_next != nullptr && mh->m_name_index_state != MIME_NAME_INDEX_STATE_OFF;
+}
+
+static void
+mime_hdr_name_index_build(MIMEHdrImpl *mh)
+{
+  int slotnum = 0;
+
+  memset(mh->m_name_index, MIME_NAME_INDEX_EMPTY, sizeof(mh->m_name_index));
+  mh->m_name_index_used  = 0;
+  mh->m_name_index_state = MIME_NAME_INDEX_STATE_BUILT;
+  for (MIMEFieldBlockImpl *fblock = &(mh->m_first_fblock); fblock != nullptr; fblock = fblock->m_next) {
+    for (uint32_t index = 0; index < fblock->m_freetop; ++index) {
+      MIMEField *field = &(fblock->m_field_slots[index]);
+      if (field->is_live() && field->is_dup_head() && field->m_wks_idx < 0 && !mime_hdr_name_index_add(mh, field, slotnum + index)) {
+        mh->m_name_index_state = MIME_NAME_INDEX_STATE_OFF;
+        return;
+      }
+    }
+    slotnum += MIME_FIELD_BLOCK_SLOTS;
+  }
+}
+
+/// @a field, not a well known string, is now the dup head of its name.
+static void
+mime_hdr_name_index_set(MIMEHdrImpl *mh, MIMEField *field)
+{
+  int slotnum = mime_hdr_field_slotnum(mh, field);
+
+  // The head of a name in the index moved, or a new name.
+  if (uint8_t *entry = mime_hdr_name_index_find(mh, field->m_ptr_name, field->m_len_name);
+      entry != nullptr && slotnum < MIME_NAME_INDEX_DELETED - 1) {
+    *entry = slotnum + 1;
+  } else if (entry != nullptr || !mime_hdr_name_index_add(mh, field, slotnum)) {
+    // Rebuilt without the deleted entries by the next find.
+    mh->m_name_index_state = MIME_NAME_INDEX_STATE_UNBUILT;
+  }
+}
+
+/// @a field, not a well known string, was the only one of its name.
+static void
+mime_hdr_name_index_unset(MIMEHdrImpl *mh, MIMEField *field)
+{
+  if (uint8_t *entry = mime_hdr_name_index_find(mh, field->m_ptr_name, field->m_len_name); entry != nullptr) {
+    *entry = MIME_NAME_INDEX_DELETED;
+  }
+}
+
 /***********************************************************************
  *                                                                     *
  *                  S L O T    A C C E L E R A T O R S                 *
@@ -485,6 +613,9 @@ mime_hdr_set_accelerators_and_presence_bits(MIMEHdrImpl *mh, MIMEField *field)
   int slot_id;
   ptrdiff_t slot_num;
   if (field->m_wks_idx < 0) {
+    if (mh->m_name_index_state == MIME_NAME_INDEX_STATE_BUILT) {
+      mime_hdr_name_index_set(mh, field);
+    }
     return;
   }
 
@@ -516,6 +647,9 @@ mime_hdr_unset_accelerators_and_presence_bits(MIMEHdrImpl *mh, MIMEField *field)
 {
   int slot_id;
   if (field->m_wks_idx < 0) {
+    if (mh->m_name_index_state == MIME_NAME_INDEX_STATE_BUILT) {
+      mime_hdr_name_index_unset(mh, field);
+    }
     return;
   }
 
@@ -534,6 +668,9 @@ inline void
 mime_hdr_reset_accelerators_and_presence_bits(MIMEHdrImpl *mh)
 {
   mime_hdr_init_accelerators_and_presence_bits(mh);
+  if (mh->m_name_index_state == MIME_NAME_INDEX_STATE_BUILT) {
+    mh->m_name_index_state = MIME_NAME_INDEX_STATE_UNBUILT;
+  }
 
   for (MIMEFieldBlockImpl *fblock = &(mh->m_first_fblock); fblock != nullptr; fblock = fblock->m_next) {
     for (MIMEField *field = fblock->m_field_slots, *limit = field + fblock->m_freetop; field < limit; ++field) {
@@ -1057,6 +1194,7 @@ void
 mime_hdr_init(MIMEHdrImpl *mh)
 {
   mime_hdr_init_accelerators_and_presence_bits(mh);
+  mh->m_name_index_state = MIME_NAME_INDEX_STATE_UNBUILT;
 
   mime_hdr_cooked_stuff_init(mh, nullptr);
 
@@ -1123,7 +1261,7 @@ mime_hdr_copy_onto(MIMEHdrImpl *s_mh, HdrHeap *s_heap, MIMEHdrImpl *d_mh, HdrHea
     mime_hdr_destroy_field_block_list(d_heap, d_mh->m_first_fblock.m_next);
   }
 
-  ink_assert(((char *)&(s_mh->m_first_fblock.m_field_slots[MIME_FIELD_BLOCK_SLOTS]) - (char *)s_mh) == sizeof(struct MIMEHdrImpl));
+  ink_assert((char *)&(s_mh->m_first_fblock.m_field_slots[MIME_FIELD_BLOCK_SLOTS]) == (char *)s_mh->m_name_index);
 
   int top             = s_mh->m_first_fblock.m_freetop;
   char *end           = reinterpret_cast<char *>(&(s_mh->m_first_fblock.m_field_slots[top]));
@@ -1132,6 +1270,13 @@ mime_hdr_copy_onto(MIMEHdrImpl *s_mh, HdrHeap *s_heap, MIMEHdrImpl *d_mh, HdrHea
   // copies useful part of enclosed first block too
   memcpy(d_mh, s_mh, bytes_below_top);
 
+  // The copy has the same slot numbers.
+  if (s_mh->m_name_index_state == MIME_NAME_INDEX_STATE_BUILT) {
+    memcpy(d_mh->m_name_index, s_mh->m_name_index, sizeof(d_mh->m_name_index));
+  } else {
+    d_mh->m_name_index_state = MIME_NAME_INDEX_STATE_UNBUILT;
+  }
+
   if (d_mh->m_first_fblock.m_next == nullptr) // common case: no other block
   {
     d_mh->m_fblock_list_tail = &(d_mh->m_first_fblock);
@@ -1316,9 +1461,19 @@ MIMEField *
 mime_hdr_field_find(MIMEHdrImpl *mh, const char *field_name_str, int field_name_len)
 {
   HdrTokenHeapPrefix *token_info;
-  const bool is_wks = hdrtoken_is_wks(field_name_str);
+  bool is_wks = hdrtoken_is_wks(field_name_str);
 
   ink_assert(field_name_len >= 0);
+  ++mime_field_find_stats.calls;
+
+  // A well known name that is not the token is found by token, the name index has the other names.
+  if (!is_wks && mime_hdr_name_index_use(mh)) {
+    const char *wks = nullptr;
+    if (hdrtoken_tokenize(field_name_str, field_name_len, &wks) >= 0) {
+      field_name_str = wks;
+      is_wks         = true;
+    }
+  }
 
   ////////////////////////////////////////////
   // do presence check and slot accelerator //
@@ -1334,6 +1489,7 @@ mime_hdr_field_find(MIMEHdrImpl *mh, const char *field_name_str, int field_name_
 #if TRACK_FIELD_FIND_CALLS
       Debug("http", "mime_hdr_field_find(hdr 0x%X, field %.*s): MISS (due to presence bits)", mh, field_name_len, field_name_str);
 #endif
+      ++mime_field_find_stats.indexed;
       return nullptr;
     }
 
@@ -1349,6 +1505,7 @@ mime_hdr_field_find(MIMEHdrImpl *mh, const char *field_name_str, int field_name_
         Debug("http", "mime_hdr_field_find(hdr 0x%X, field %.*s): %s (due to slot accelerators)", mh, field_name_len,
               field_name_str, (f ? "HIT" : "MISS"));
 #endif
+        ++mime_field_find_stats.indexed;
         return f;
       } else {
 #if TRACK_FIELD_FIND_CALLS
@@ -1369,6 +1526,21 @@ mime_hdr_field_find(MIMEHdrImpl *mh, const char *field_name_str, int field_name_
 #endif
     return f;
   } else {
+    if (mh->m_name_index_state == MIME_NAME_INDEX_STATE_UNBUILT && mime_hdr_name_index_use(mh)) {
+      mime_hdr_name_index_build(mh);
+    }
+    if (mh->m_name_index_state == MIME_NAME_INDEX_STATE_BUILT && mime_hdr_name_index_use(mh)) {
+      MIMEField *f = nullptr;
+      mime_hdr_name_index_find(mh, field_name_str, field_name_len, &f);
+      ink_assert((f == nullptr) || f->is_live());
+#if TRACK_FIELD_FIND_CALLS
+      Debug("http", "mime_hdr_field_find(hdr 0x%X, field %.*s): %s (due to name index)", mh, field_name_len, field_name_str,
+            (f ? "HIT" : "MISS"));
+#endif
+      ++mime_field_find_stats.indexed;
+      return f;
+    }
+
     MIMEField *f = _mime_hdr_field_list_search_by_string(mh, field_name_str, field_name_len);
 
     ink_assert((f == nullptr) || f->is_live());
@@ -1532,6 +1704,7 @@ mime_hdr_field_attach(MIMEHdrImpl *mh, MIMEField *field, int check_for_dups, MIM
       prev_dup     = next_dup;
       prev_slotnum = next_slotnum;
       next_dup     = prev_dup->m_next_dup;
+      next_slotnum = (next_dup ? mime_hdr_field_slotnum(mh, next_dup) : -1);
     }
 
     /////////////////////////////////////////////////////
@@ -1681,6 +1854,10 @@ mime_hdr_field_delete(HdrHeap *heap, MIMEHdrImpl *mh, MIMEField *field, bool del
             if (prev_block->m_next == nullptr) {
               mh->m_fblock_list_tail = prev_block;
             }
+            // The slot numbers of the blocks after it went down.
+            if (mh->m_name_index_state == MIME_NAME_INDEX_STATE_BUILT) {
+              mh->m_name_index_state = MIME_NAME_INDEX_STATE_UNBUILT;
+            }
           }
           break;
         }
@@ -2360,6 +2537,7 @@ ParseResult
 MIMEScanner::get(TextView &input, TextView &output, bool &output_shares_input, bool eof_p, ScanType scan_type)
 {
   ParseResult zret = PARSE_RESULT_CONT;
+  bool nul_p       = false; // Found a null character.
   // Need this for handling dangling CR.
   static const char RAW_CR{ParseRules::CHAR_CR};
 
@@ -2398,9 +2576,14 @@ MIMEScanner::get(TextView &input, TextView &output, bool &output_shares_input, b
       }
       break;
     case MIME_PARSE_INSIDE: {
-      auto lf_off = text.find(ParseRules::CHAR_LF);
-      if (lf_off != TextView::npos) {
-        text.remove_prefix(lf_off + 1); // drop up to and including LF
+      // Look for the null characters on the way to the LF, they are not allowed in the text.
+      const char *eol = mime_scan_for(text.data(), text.data_end(), ParseRules::CHAR_LF, '\0');
+      while (eol != text.data_end() && *eol == '\0') {
+        nul_p = true;
+        eol   = mime_scan_for(eol + 1, text.data_end(), ParseRules::CHAR_LF, '\0');
+      }
+      if (eol != text.data_end()) {
+        text.remove_prefix(eol - text.data() + 1); // drop up to and including LF
         if (LINE == scan_type) {
           zret    = PARSE_RESULT_OK;
           m_state = MIME_PARSE_BEFORE;
@@ -2487,7 +2670,7 @@ MIMEScanner::get(TextView &input, TextView &output, bool &output_shares_input, b
   }
 
   // Make sure there are no null characters in the input scanned so far
-  if (zret != PARSE_RESULT_ERROR && TextView::npos != parsed_text.find('\0')) {
+  if (zret != PARSE_RESULT_ERROR && nul_p) {
     zret = PARSE_RESULT_ERROR;
   }
 
@@ -2568,12 +2751,18 @@ mime_parser_parse(MIMEParser *parser, HdrHeap *heap, MIMEHdrImpl *mh, const char
       continue; // toss away garbage line
     }
 
-    // find name last
-    auto field_value = parsed; // need parsed as is later on.
-    auto field_name  = field_value.split_prefix_at(':');
-    if (field_name.empty()) {
+    // find name last, and whether it has control characters on the way.
+    const char *colon     = mime_scan_control_or(parsed.data(), parsed.data_end(), ':');
+    bool name_has_control = false;
+    while (colon != parsed.data_end() && *colon != ':') {
+      name_has_control = true;
+      colon            = mime_scan_control_or(colon + 1, parsed.data_end(), ':');
+    }
+    if (colon == parsed.data() || colon == parsed.data_end()) {
       continue; // toss away garbage line
     }
+    TextView field_name{parsed.data(), colon};
+    TextView field_value{colon + 1, parsed.data_end()};
 
     // RFC7230 section 3.2.4:
     // No whitespace is allowed between the header field-name and colon.  In
@@ -2622,19 +2811,14 @@ mime_parser_parse(MIMEParser *parser, HdrHeap *heap, MIMEHdrImpl *mh, const char
 
     int field_name_wks_idx = hdrtoken_tokenize(field_name.data(), field_name.size());
 
-    if (field_name_wks_idx < 0) {
-      for (auto i : field_name) {
-        if (ParseRules::is_control(i)) {
-          return PARSE_RESULT_ERROR;
-        }
-      }
+    // Control characters were looked for with the colon, trimming white space does not remove any.
+    if (field_name_wks_idx < 0 && name_has_control) {
+      return PARSE_RESULT_ERROR;
     }
 
     // RFC 9110 Section 5.5. Field Values
-    for (char i : field_value) {
-      if (ParseRules::is_control(i)) {
-        return PARSE_RESULT_ERROR;
-      }
+    if (mime_scan_control(field_value.data(), field_value.data_end()) != field_value.data_end()) {
+      return PARSE_RESULT_ERROR;
     }
 
     ///////////////////////////////////////////
@@ -3799,6 +3983,8 @@ MIMEHdrImpl::unmarshal(intptr_t offset)
 {
   HDR_UNMARSHAL_PTR(m_fblock_list_tail, MIMEFieldBlockImpl, offset);
   m_first_fblock.unmarshal(offset);
+  // The heap is read only and shared, and this may be as short as it was before the index.
+  m_name_index_state = MIME_NAME_INDEX_STATE_OFF;
 }
 
 void
@@ -88,6 +88,18 @@ enum MimeParseState {
 #define MIME_FIELD_SLOTNUM_MAX     (MIME_FIELD_SLOTNUM_MASK - 1)
 #define MIME_FIELD_SLOTNUM_UNKNOWN MIME_FIELD_SLOTNUM_MAX
 
+// The name index is an open addressed hash table of the dup heads of the names that are not well
+// known, an entry is the slot number of a head plus one.
+#define MIME_NAME_INDEX_BITS     6
+#define MIME_NAME_INDEX_SIZE     (1 << MIME_NAME_INDEX_BITS)
+#define MIME_NAME_INDEX_MAX_USED (MIME_NAME_INDEX_SIZE * 3 / 4)
+#define MIME_NAME_INDEX_EMPTY    0
+#define MIME_NAME_INDEX_DELETED  0xFF
+
+#define MIME_NAME_INDEX_STATE_UNBUILT 0 ///< Built by the next find of a name that is not well known.
+#define MIME_NAME_INDEX_STATE_BUILT   1
+#define MIME_NAME_INDEX_STATE_OFF     2 ///< Unmarshaled, or too many names, find walks the fields.
+
 /***********************************************************************
  *                                                                     *
  *                    MIMEField & MIMEFieldBlockImpl                   *
@@ -305,7 +317,9 @@ struct MIMEHdrImpl : public HdrHeapObjImpl {
     friend struct MIMEHdrImpl;
   };
 
-  // HdrHeapObjImpl is 4 bytes, so this will result in 4 bytes padding
+  // HdrHeapObjImpl is 4 bytes, these take what was padding before m_presence_bits.
+  uint16_t m_name_index_state;
+  uint16_t m_name_index_used; ///< Entries not empty.
   uint64_t m_presence_bits;
   uint32_t m_slot_accelerators[4];
 
@@ -313,8 +327,11 @@ struct MIMEHdrImpl : public HdrHeapObjImpl {
 
   MIMEFieldBlockImpl *m_fblock_list_tail;
   MIMEFieldBlockImpl m_first_fblock; // 1 block inline
-  // mime_hdr_copy_onto assumes that m_first_fblock is last --
-  // don't add any new fields after it.
+  // mime_hdr_copy_onto assumes that m_first_fblock is followed only by
+  // the name index -- don't add any new fields after them. Headers
+  // marshaled before the index was added end at m_first_fblock, read
+  // m_name_index only in the BUILT state.
+  uint8_t m_name_index[MIME_NAME_INDEX_SIZE];
 
   // Marshaling Functions
   int marshal(MarshalXlate *ptr_xlate, int num_ptr, MarshalXlate *str_xlate, int num_str);
@@ -844,6 +861,14 @@ MIMEField *_mime_hdr_field_list_search_by_string(MIMEHdrImpl *mh, const char *fi
 MIMEField *_mime_hdr_field_list_search_by_slotnum(MIMEHdrImpl *mh, int slotnum);
 MIMEField *mime_hdr_field_find(MIMEHdrImpl *mh, const char *field_name_str, int field_name_len);
 
+/// Counts of mime_hdr_field_find calls on a thread, and of those answered without a walk of the fields.
+struct MIMEFieldFindStats {
+  uint64_t calls;
+  uint64_t indexed;
+};
+
+extern thread_local MIMEFieldFindStats mime_field_find_stats;
+
 MIMEField *mime_hdr_field_get(MIMEHdrImpl *mh, int idx);
 MIMEField *mime_hdr_field_get_slotnum(MIMEHdrImpl *mh, int slotnum);
 int mime_hdr_fields_count(MIMEHdrImpl *mh);
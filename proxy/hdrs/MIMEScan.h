@@ -0,0 +1,154 @@
+/** @file
+
+  Vector scans of header text.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  The MIME parser looks for a few delimiters and for control characters in every line. These scans
+  look at 32 bytes at a time with AVX2, 16 with SSE2, and one at a time otherwise. The instruction
+  set is picked when compiling, SSE2 is always there on x86-64.
+ */
+
+#pragma once
+
+#include "tscore/ParseRules.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Matches either of two characters.
+struct MIMEScanChars {
+  char c1;
+  char c2;
+
+  bool
+  operator()(char c) const
+  {
+    return c == c1 || c == c2;
+  }
+#if defined(__SSE2__)
+  unsigned
+  operator()(__m128i v) const
+  {
+    return _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(c1)), _mm_cmpeq_epi8(v, _mm_set1_epi8(c2))));
+  }
+#endif
+#if defined(__AVX2__)
+  unsigned
+  operator()(__m256i v) const
+  {
+    return _mm256_movemask_epi8(
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c1)), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c2))));
+  }
+#endif
+};
+
+/// Matches a control character as ParseRules::is_control does, 0x00-0x08, 0x0a-0x1f and 0x7f, or @c c.
+struct MIMEScanControlOr {
+  char c;
+
+  bool
+  operator()(char x) const
+  {
+    return ParseRules::is_control(x) || x == c;
+  }
+#if defined(__SSE2__)
+  unsigned
+  operator()(__m128i v) const
+  {
+    __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v);
+    ctl         = _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(ParseRules::CHAR_HT)), ctl);
+    ctl         = _mm_or_si128(ctl, _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f)));
+    return _mm_movemask_epi8(_mm_or_si128(ctl, _mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+  }
+#endif
+#if defined(__AVX2__)
+  unsigned
+  operator()(__m256i v) const
+  {
+    __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1f)), v);
+    ctl         = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(ParseRules::CHAR_HT)), ctl);
+    ctl         = _mm256_or_si256(ctl, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f)));
+    return _mm256_movemask_epi8(_mm256_or_si256(ctl, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+  }
+#endif
+};
+
+/** The first character in [@a s, @a e) that @a match matches, @a e if there is none.
+
+    @a VECTOR false scans one character at a time, for testing.
+ */
+template <typename Match, bool VECTOR = true>
+inline const char *
+mime_scan(const char *s, const char *e, const Match &match)
+{
+  if constexpr (VECTOR) {
+    [[maybe_unused]] const char *start = s;
+#if defined(__AVX2__)
+    for (; e - s >= 32; s += 32) {
+      if (unsigned m = match(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s)))) {
+        return s + __builtin_ctz(m);
+      }
+    }
+#endif
+#if defined(__SSE2__)
+    for (; e - s >= 16; s += 16) {
+      if (unsigned m = match(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s)))) {
+        return s + __builtin_ctz(m);
+      }
+    }
+    // Rather than one character at a time, look at the last 16 again and skip those already seen.
+    if (s < e && e - start >= 16) {
+      unsigned m = match(_mm_loadu_si128(reinterpret_cast<const __m128i *>(e - 16))) >> (16 - (e - s));
+      return m ? s + __builtin_ctz(m) : e;
+    }
+#endif
+  }
+  for (; s < e; ++s) {
+    if (match(*s)) {
+      return s;
+    }
+  }
+  return e;
+}
+
+/// The first @a c1 or @a c2 in [@a s, @a e), @a e if there is none.
+inline const char *
+mime_scan_for(const char *s, const char *e, char c1, char c2)
+{
+  return mime_scan(s, e, MIMEScanChars{c1, c2});
+}
+
+/// The first control character or @a c in [@a s, @a e), @a e if there is none.
+inline const char *
+mime_scan_control_or(const char *s, const char *e, char c)
+{
+  return mime_scan(s, e, MIMEScanControlOr{c});
+}
+
+/// The first control character in [@a s, @a e), @a e if there is none.
+inline const char *
+mime_scan_control(const char *s, const char *e)
+{
+  // DEL is a control character already.
+  return mime_scan(s, e, MIMEScanControlOr{0x7f});
+}
@@ -25,9 +25,13 @@
 #include "HuffmanCodec.h"
 
 #include "tscore/Arena.h"
+#include "tscore/HashFNV.h"
 #include "tscore/ink_memory.h"
 #include "tscpp/util/LocalBuffer.h"
 
+#include <algorithm>
+#include <string>
+
 //
 // [RFC 7541] 5.1. Integer representation
 //
@@ -188,3 +192,346 @@ xpack_encode_string(uint8_t *buf_start, const uint8_t *buf_end, const char *valu
 
   return p - buf_start;
 }
+
+//
+// XpackDynamicTable
+//
+namespace
+{
+// Initial capacities, enough for the typical table of 4096 bytes.
+constexpr size_t XPACK_MIN_DATA_CAPACITY = 1024;
+constexpr size_t XPACK_MIN_ENTRIES       = 16;
+
+// The hash of the name, and of the name with the value.
+void
+xpack_hash(const char *name, uint32_t name_len, const char *value, uint32_t value_len, uint32_t &name_hash, uint32_t &hash)
+{
+  ATSHash32FNV1a h;
+  h.update(name, name_len, ATSHash::nocase());
+  name_hash = h.get();
+  h.update(value, value_len);
+  hash = h.get();
+}
+} // namespace
+
+XpackDynamicTable::XpackDynamicTable(uint32_t size, uint32_t entry_overhead) : _maximum_size(size), _entry_overhead(entry_overhead)
+{
+}
+
+XpackDynamicTable::~XpackDynamicTable()
+{
+  ats_free(this->_data);
+}
+
+XpackDynamicTable::Entry &
+XpackDynamicTable::_entry(uint32_t index)
+{
+  return this->_entries[index & (this->_entries.size() - 1)];
+}
+
+const XpackDynamicTable::Entry &
+XpackDynamicTable::_entry(uint32_t index) const
+{
+  return this->_entries[index & (this->_entries.size() - 1)];
+}
+
+bool
+XpackDynamicTable::_is_live(uint32_t index) const
+{
+  return index != 0 && index <= this->_inserted && this->_inserted - index < this->_count;
+}
+
+const XpackLookupResult
+XpackDynamicTable::lookup(uint32_t index, const char **name, int *name_len, const char **value, int *value_len) const
+{
+  if (!this->_is_live(index)) {
+    return {0, XpackLookupResult::MatchType::NONE};
+  }
+
+  const Entry &e = this->_entry(index);
+  *name          = this->_data + e.offset;
+  *name_len      = e.name_len;
+  *value         = this->_data + e.offset + e.name_len;
+  *value_len     = e.value_len;
+  return {index, XpackLookupResult::MatchType::EXACT};
+}
+
+const XpackLookupResult
+XpackDynamicTable::lookup(const char *name, int name_len, const char *value, int value_len) const
+{
+  if (this->_count == 0) {
+    return {0, XpackLookupResult::MatchType::NONE};
+  }
+
+  uint32_t name_hash, hash;
+  xpack_hash(name, name_len, value, value_len, name_hash, hash);
+
+  if (uint32_t index = this->_fields[this->_probe<false>(this->_fields, hash, name, name_len, value, value_len)].index; index) {
+    return {index, XpackLookupResult::MatchType::EXACT};
+  }
+  if (uint32_t index = this->_names[this->_probe<true>(this->_names, name_hash, name, name_len, value, value_len)].index; index) {
+    return {index, XpackLookupResult::MatchType::NAME};
+  }
+  return {0, XpackLookupResult::MatchType::NONE};
+}
+
+const XpackLookupResult
+XpackDynamicTable::insert_entry(const char *name, int name_len, const char *value, int value_len)
+{
+  // The name is often taken from an entry of this table, which may be evicted or moved.
+  auto in_table = [this](const char *p) { return this->_data && this->_data <= p && p < this->_data + this->_data_capacity; };
+  if (in_table(name) || in_table(value)) {
+    std::string copy{name, static_cast<size_t>(name_len)};
+    copy.append(value, value_len);
+    return this->insert_entry(copy.data(), name_len, copy.data() + name_len, value_len);
+  }
+
+  uint32_t len        = name_len + value_len;
+  uint32_t entry_size = len + this->_entry_overhead;
+  if (entry_size > this->_maximum_size || !this->_evict(this->_maximum_size - entry_size)) {
+    return {0, XpackLookupResult::MatchType::NONE};
+  }
+
+  this->_reserve(len);
+  if (this->_head + len > this->_data_capacity) {
+    this->_head = 0;
+  }
+
+  uint32_t index = ++this->_inserted;
+  Entry &e       = this->_entry(index);
+  e.offset       = this->_head;
+  e.name_len     = name_len;
+  e.value_len    = value_len;
+  e.ref_count    = 0;
+  xpack_hash(name, name_len, value, value_len, e.name_hash, e.hash);
+  memcpy(this->_data + e.offset, name, name_len);
+  memcpy(this->_data + e.offset + name_len, value, value_len);
+
+  this->_head     += len;
+  this->_size     += entry_size;
+  this->_data_len += len;
+  ++this->_count;
+  this->_index<true>(this->_names, index);
+  this->_index<false>(this->_fields, index);
+
+  return {index, value_len ? XpackLookupResult::MatchType::EXACT : XpackLookupResult::MatchType::NAME};
+}
+
+const XpackLookupResult
+XpackDynamicTable::duplicate_entry(uint32_t current_index)
+{
+  const char *name;
+  int name_len;
+  const char *value;
+  int value_len;
+
+  if (this->lookup(current_index, &name, &name_len, &value, &value_len).match_type == XpackLookupResult::MatchType::NONE) {
+    return {0, XpackLookupResult::MatchType::NONE};
+  }
+  return this->insert_entry(name, name_len, value, value_len);
+}
+
+bool
+XpackDynamicTable::should_duplicate(uint32_t index)
+{
+  // TODO: Check whether a specified entry should be duplicated
+  // Just return false for now
+  return false;
+}
+
+bool
+XpackDynamicTable::update_maximum_size(uint32_t new_size)
+{
+  if (!this->_evict(new_size)) {
+    return false;
+  }
+  this->_maximum_size = new_size;
+  return true;
+}
+
+void
+XpackDynamicTable::clear()
+{
+  while (this->_count > 0 && this->_entry(this->_inserted - this->_count + 1).ref_count == 0) {
+    this->_evict_oldest();
+  }
+}
+
+void
+XpackDynamicTable::ref_entry(uint32_t index)
+{
+  if (this->_is_live(index)) {
+    ++this->_entry(index).ref_count;
+  }
+}
+
+void
+XpackDynamicTable::unref_entry(uint32_t index)
+{
+  if (this->_is_live(index)) {
+    --this->_entry(index).ref_count;
+  }
+}
+
+uint32_t
+XpackDynamicTable::maximum_size() const
+{
+  return this->_maximum_size;
+}
+
+uint32_t
+XpackDynamicTable::size() const
+{
+  return this->_size;
+}
+
+uint32_t
+XpackDynamicTable::count() const
+{
+  return this->_count;
+}
+
+uint32_t
+XpackDynamicTable::largest_index() const
+{
+  return this->_inserted;
+}
+
+// Evict the oldest entries until the table is no larger than @a size. Nothing is evicted if that
+// would take an entry that is referenced.
+bool
+XpackDynamicTable::_evict(uint32_t size)
+{
+  uint32_t oldest = this->_inserted - this->_count + 1;
+  uint32_t n      = 0;
+
+  for (uint32_t remaining = this->_size; remaining > size; ++n) {
+    const Entry &e = this->_entry(oldest + n);
+    if (e.ref_count) {
+      return false;
+    }
+    remaining -= e.name_len + e.value_len + this->_entry_overhead;
+  }
+  while (n-- > 0) {
+    this->_evict_oldest();
+  }
+  return true;
+}
+
+void
+XpackDynamicTable::_evict_oldest()
+{
+  uint32_t index = this->_inserted - this->_count + 1;
+  Entry &e       = this->_entry(index);
+
+  this->_unindex<true>(this->_names, index);
+  this->_unindex<false>(this->_fields, index);
+  this->_size     -= e.name_len + e.value_len + this->_entry_overhead;
+  this->_data_len -= e.name_len + e.value_len;
+  if (--this->_count == 0) {
+    this->_head = 0;
+  }
+}
+
+// Make room for one more entry of @a data_len bytes.
+//
+// With the data of the live entries at most half of the ring, a new entry always fits either after
+// the newest entry or at the start of the ring without overwriting anything.
+void
+XpackDynamicTable::_reserve(uint32_t data_len)
+{
+  size_t need = 2 * (static_cast<size_t>(this->_data_len) + data_len);
+  if (need > this->_data_capacity) {
+    size_t capacity = std::max(this->_data_capacity, XPACK_MIN_DATA_CAPACITY);
+    while (capacity < need) {
+      capacity *= 2;
+    }
+    char *data    = static_cast<char *>(ats_malloc(capacity));
+    size_t offset = 0;
+    for (uint32_t index = this->_inserted - this->_count + 1; index <= this->_inserted; ++index) {
+      Entry &e = this->_entry(index);
+      memcpy(data + offset, this->_data + e.offset, e.name_len + e.value_len);
+      e.offset  = offset;
+      offset   += e.name_len + e.value_len;
+    }
+    ats_free(this->_data);
+    this->_data          = data;
+    this->_data_capacity = capacity;
+    this->_head          = offset;
+  }
+
+  if (this->_count + 1 > this->_entries.size()) {
+    std::vector<Entry> entries(std::max(this->_entries.size() * 2, XPACK_MIN_ENTRIES));
+    for (uint32_t index = this->_inserted - this->_count + 1; index <= this->_inserted; ++index) {
+      entries[index & (entries.size() - 1)] = this->_entry(index);
+    }
+    this->_entries.swap(entries);
+
+    // Oldest first, a newer entry with the same name or field takes the slot.
+    this->_names.assign(this->_entries.size() * 2, Slot{});
+    this->_fields.assign(this->_entries.size() * 2, Slot{});
+    for (uint32_t index = this->_inserted - this->_count + 1; index <= this->_inserted; ++index) {
+      this->_index<true>(this->_names, index);
+      this->_index<false>(this->_fields, index);
+    }
+  }
+}
+
+// The slot of the entry with @a name (and @a value), or the empty slot where it would go.
+template <bool NAME_ONLY>
+uint32_t
+XpackDynamicTable::_probe(const std::vector<Slot> &slots, uint32_t hash, const char *name, uint32_t name_len, const char *value,
+                          uint32_t value_len) const
+{
+  uint32_t mask = slots.size() - 1;
+  uint32_t i    = hash & mask;
+
+  for (; slots[i].index != 0; i = (i + 1) & mask) {
+    if (slots[i].hash != hash) {
+      continue;
+    }
+    const Entry &e = this->_entry(slots[i].index);
+    const char *p  = this->_data + e.offset;
+    if (e.name_len == name_len && strncasecmp(p, name, name_len) == 0 &&
+        (NAME_ONLY || (e.value_len == value_len && memcmp(p + name_len, value, value_len) == 0))) {
+      break;
+    }
+  }
+  return i;
+}
+
+template <bool NAME_ONLY>
+void
+XpackDynamicTable::_index(std::vector<Slot> &slots, uint32_t index)
+{
+  const Entry &e = this->_entry(index);
+  const char *p  = this->_data + e.offset;
+  uint32_t hash  = NAME_ONLY ? e.name_hash : e.hash;
+
+  slots[this->_probe<NAME_ONLY>(slots, hash, p, e.name_len, p + e.name_len, e.value_len)] = {hash, index};
+}
+
+template <bool NAME_ONLY>
+void
+XpackDynamicTable::_unindex(std::vector<Slot> &slots, uint32_t index)
+{
+  const Entry &e = this->_entry(index);
+  const char *p  = this->_data + e.offset;
+  uint32_t mask  = slots.size() - 1;
+  uint32_t i     = this->_probe<NAME_ONLY>(slots, NAME_ONLY ? e.name_hash : e.hash, p, e.name_len, p + e.name_len, e.value_len);
+
+  // A newer entry took the slot.
+  if (slots[i].index != index) {
+    return;
+  }
+
+  // Linear probing, move back the slots after this one that are not at their home slot already.
+  for (uint32_t j = (i + 1) & mask; slots[j].index != 0; j = (j + 1) & mask) {
+    uint32_t home = slots[j].hash & mask;
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      slots[i] = slots[j];
+      i        = j;
+    }
+  }
+  slots[i] = Slot{};
+}
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 #include "tscore/Arena.h"
 
 const static int XPACK_ERROR_COMPRESSION_ERROR   = -1;
@@ -35,3 +36,90 @@ int64_t xpack_decode_integer(uint64_t &dst, const uint8_t *buf_start, const uint
 int64_t xpack_encode_string(uint8_t *buf_start, const uint8_t *buf_end, const char *value, uint64_t value_len, uint8_t n = 7);
 int64_t xpack_decode_string(Arena &arena, char **str, uint64_t &str_length, const uint8_t *buf_start, const uint8_t *buf_end,
                             uint8_t n = 7);
+
+struct XpackLookupResult {
+  uint32_t index                                  = 0;
+  enum MatchType { NONE, NAME, EXACT } match_type = MatchType::NONE;
+};
+
+/** Dynamic table of HPACK and QPACK.
+
+    Entries are addressed by their absolute index, the first one inserted is 1. Names and values are
+    kept in a byte ring, the ring is twice as large as the live entries so every entry fits in one
+    piece without moving the others. Two hash indices map a name, and a name with its value, to the
+    newest entry that has it. Only the oldest entry is ever evicted, if an index still refers to it
+    there is no newer match.
+
+    Names match case insensitively, values exactly.
+ */
+class XpackDynamicTable
+{
+public:
+  /// @a entry_overhead is added to the size of every entry, RFC 7541 has 32.
+  XpackDynamicTable(uint32_t size, uint32_t entry_overhead);
+  ~XpackDynamicTable();
+
+  // noncopyable
+  XpackDynamicTable(XpackDynamicTable &)                  = delete;
+  XpackDynamicTable &operator=(const XpackDynamicTable &) = delete;
+
+  const XpackLookupResult lookup(uint32_t index, const char **name, int *name_len, const char **value, int *value_len) const;
+  const XpackLookupResult lookup(const char *name, int name_len, const char *value, int value_len) const;
+  const XpackLookupResult insert_entry(const char *name, int name_len, const char *value, int value_len);
+  const XpackLookupResult duplicate_entry(uint32_t current_index);
+  bool should_duplicate(uint32_t index);
+  /// Evict entries to fit @a new_size, false if it is blocked by referenced entries.
+  bool update_maximum_size(uint32_t new_size);
+  /// Evict all the entries, up to the first one that is referenced.
+  void clear();
+  void ref_entry(uint32_t index);
+  void unref_entry(uint32_t index);
+
+  uint32_t maximum_size() const;
+  uint32_t size() const;
+  uint32_t count() const;
+  uint32_t largest_index() const;
+
+private:
+  struct Entry {
+    size_t offset      = 0;
+    uint32_t name_len  = 0;
+    uint32_t value_len = 0;
+    uint32_t name_hash = 0; ///< Hash of the name.
+    uint32_t hash      = 0; ///< Hash of the name and the value.
+    uint32_t ref_count = 0;
+  };
+
+  struct Slot {
+    uint32_t hash  = 0;
+    uint32_t index = 0; ///< Absolute index of the entry, 0 if the slot is empty.
+  };
+
+  Entry &_entry(uint32_t index);
+  const Entry &_entry(uint32_t index) const;
+  bool _is_live(uint32_t index) const;
+  bool _evict(uint32_t required);
+  void _evict_oldest();
+  void _reserve(uint32_t data_len);
+
+  template <bool NAME_ONLY>
+  uint32_t _probe(const std::vector<Slot> &slots, uint32_t hash, const char *name, uint32_t name_len, const char *value,
+                  uint32_t value_len) const;
+  template <bool NAME_ONLY> void _index(std::vector<Slot> &slots, uint32_t index);
+  template <bool NAME_ONLY> void _unindex(std::vector<Slot> &slots, uint32_t index);
+
+  uint32_t _maximum_size   = 0;
+  uint32_t _entry_overhead = 0;
+  uint32_t _size           = 0; ///< Sum of the sizes of the entries, with the overhead.
+  uint32_t _data_len       = 0; ///< Sum of the lengths of the names and values.
+  uint32_t _count          = 0;
+  uint32_t _inserted       = 0; ///< Absolute index of the newest entry.
+
+  char *_data           = nullptr;
+  size_t _data_capacity = 0;
+  size_t _head          = 0; ///< Where the next entry goes in @c _data.
+
+  std::vector<Entry> _entries; ///< By absolute index, modulo the capacity, a power of 2.
+  std::vector<Slot> _names;    ///< Open addressing, twice the capacity of @c _entries.
+  std::vector<Slot> _fields;
+};
@@ -22,10 +22,14 @@
 */
 
 #include "HuffmanCodec.h"
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <cassert>
 #include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
 
 using namespace std;
 
@@ -64,6 +68,60 @@ uint32_t test_values[] = {
   0x7ffffeb,  27, 0xffffffe, 28, 0x7ffffec,  27, 0x7ffffed, 27, 0x7ffffee, 27, 0x7ffffef,  27, 0x7fffff0,  27, 0x3ffffee, 26,
   0x3fffffff, 30};
 
+// The decoder as it was, one bit at a time down the Huffman tree. A reference for the table driven
+// one and the baseline of the benchmark.
+struct TreeNode {
+  std::unique_ptr<TreeNode> child[2];
+  int symbol = -1;
+};
+
+TreeNode *
+reference_tree()
+{
+  static TreeNode *root = nullptr;
+  if (root == nullptr) {
+    root = new TreeNode;
+    for (int i = 0; i < 257; ++i) {
+      TreeNode *current = root;
+      for (uint32_t bit_len = test_values[2 * i + 1]; bit_len > 0; --bit_len) {
+        auto &child = current->child[(test_values[2 * i] >> (bit_len - 1)) & 1];
+        if (!child) {
+          child = std::make_unique<TreeNode>();
+        }
+        current = child.get();
+      }
+      current->symbol = i;
+    }
+  }
+  return root;
+}
+
+int64_t
+reference_decode(char *dst_start, const uint8_t *src, uint32_t src_len)
+{
+  TreeNode *root    = reference_tree();
+  TreeNode *current = root;
+  char *dst         = dst_start;
+  int nbits         = 0;
+  bool ones         = true;
+
+  for (uint32_t i = 0; i < src_len * 8; ++i) {
+    int bit  = (src[i / 8] >> (7 - i % 8)) & 1;
+    current  = current->child[bit].get();
+    ones    &= bit;
+    ++nbits;
+    if (current->symbol == 256) {
+      return -1;
+    } else if (current->symbol >= 0) {
+      *dst++  = current->symbol;
+      current = root;
+      nbits   = 0;
+      ones    = true;
+    }
+  }
+  return nbits > 7 || !ones ? -1 : dst - dst_start;
+}
+
 void
 random_test()
 {
@@ -85,6 +143,15 @@ random_test()
     // cout << i << " " << (int)dst_start[i] << " " << dst_start[i] << endl;
   }
 
+  // Random input almost always fails, check short strings which do not too.
+  char *expect = (char *)malloc(size * 2);
+  for (uint32_t len = 0; len < 8; ++len) {
+    int64_t n = reference_decode(expect, src, len);
+    assert(huffman_decode(dst_start, src, len) == n);
+    assert(n < 0 || memcmp(dst_start, expect, n) == 0);
+  }
+
+  free(expect);
   free(dst_start);
 }
 
@@ -178,6 +245,31 @@ encode_test()
   }
 }
 
+void
+round_trip_test()
+{
+  uint8_t src[512];
+  uint8_t encoded[sizeof(src) * 4];
+  char decoded[sizeof(encoded) * 2];
+  char expect[sizeof(encoded) * 2];
+
+  for (int round = 0; round < 1000; ++round) {
+    uint32_t len = lrand48() % sizeof(src);
+    for (uint32_t i = 0; i < len; ++i) {
+      // coverity[dont_call]
+      src[i] = round % 2 ? lrand48() : ' ' + lrand48() % 95;
+    }
+    int64_t encoded_len = huffman_encode(encoded, src, len);
+    assert(encoded_len >= 0);
+
+    int64_t decoded_len = huffman_decode(decoded, encoded, encoded_len);
+    assert(decoded_len == len);
+    assert(memcmp(decoded, src, len) == 0);
+    assert(reference_decode(expect, encoded, encoded_len) == len);
+    assert(memcmp(expect, src, len) == 0);
+  }
+}
+
 void
 decode_errors_test()
 {
@@ -201,6 +293,72 @@ decode_errors_test()
   }
 }
 
+// Header values of typical requests and responses, as a client or origin sends them.
+const char *const benchmark_corpus[] = {
+  "www.example.com",
+  "/assets/js/vendor/jquery-3.6.0.min.js?v=20231018",
+  "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/118.0.0.0 Safari/537.36",
+  "text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,image/apng,*/*;q=0.8",
+  "gzip, deflate, br",
+  "en-US,en;q=0.9",
+  "_ga=GA1.2.1234567890.1697625600; _gid=GA1.2.987654321.1697625600; session_id=5f2b9c7e8a1d4e3f9b0c6a2d",
+  "https://www.example.com/products/category/shoes?sort=price&page=2",
+  "max-age=0",
+  "Wed, 18 Oct 2023 10:20:30 GMT",
+  "\"33a64df551425fcc55e4d42a148795d9f25f89d4\"",
+  "public, max-age=31536000, immutable",
+  "application/json; charset=utf-8",
+  "Accept-Encoding, Origin",
+  "1; mode=block",
+};
+
+void
+benchmark_test()
+{
+  using Clock = std::chrono::steady_clock;
+
+  std::vector<std::vector<uint8_t>> encoded;
+  size_t total = 0;
+  for (const char *s : benchmark_corpus) {
+    std::vector<uint8_t> e(strlen(s) * 4);
+    e.resize(huffman_encode(e.data(), reinterpret_cast<const uint8_t *>(s), strlen(s)));
+    total += strlen(s);
+    encoded.push_back(std::move(e));
+  }
+
+  char dst[1024];
+  constexpr int ROUNDS = 20000;
+  auto run             = [&](const char *name, int64_t (*decode)(char *, const uint8_t *, uint32_t)) {
+    int64_t check = 0;
+    auto start    = Clock::now();
+    for (int i = 0; i < ROUNDS; ++i) {
+      for (auto const &e : encoded) {
+        check += decode(dst, e.data(), e.size());
+      }
+    }
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    assert(check == static_cast<int64_t>(total) * ROUNDS);
+    cout << name << ": " << total * ROUNDS / secs / 1e6 << " MB/s decoded" << endl;
+    return secs;
+  };
+
+  double tree  = run("bit at a time", reference_decode);
+  double table = run("table driven", huffman_decode);
+  cout << "speedup: " << tree / table << "x" << endl;
+
+  uint8_t out[1024];
+  int64_t check = 0;
+  auto start    = Clock::now();
+  for (int i = 0; i < ROUNDS; ++i) {
+    for (const char *s : benchmark_corpus) {
+      check += huffman_encode(out, reinterpret_cast<const uint8_t *>(s), strlen(s));
+    }
+  }
+  double secs = std::chrono::duration<double>(Clock::now() - start).count();
+  assert(check > 0);
+  cout << "encode: " << total * ROUNDS / secs / 1e6 << " MB/s" << endl;
+}
+
 int
 main()
 {
@@ -210,7 +368,9 @@ main()
     random_test();
   }
   values_test();
+  round_trip_test();
   decode_errors_test();
+  benchmark_test();
 
   hpack_huffman_fin();
 
@@ -19,6 +19,7 @@
    the License.
  */
 
+#include <algorithm>
 #include <string>
 #include <cstring>
 #include <cctype>
@@ -539,6 +540,8 @@ TEST_CASE("HdrTest", "[proxy][hdrtest]")
 
   SECTION("Field Char Check")
   {
+    using namespace std::literals;
+
     static struct {
       std::string_view line;
       ParseResult expected;
@@ -565,6 +568,15 @@ TEST_CASE("HdrTest", "[proxy][hdrtest]")
       {"Content-Length: 10\x0b\r\n", PARSE_RESULT_ERROR},
       {"Content-Length:\x0b 10\r\n", PARSE_RESULT_ERROR},
       {"Foo: ab\x1d/cd\r\n",         PARSE_RESULT_ERROR},
+ ////
+  // Longer than a vector
+      {"X-Forwarded-For-Some-Client: 192.0.2.1, 198.51.100.17, 203.0.113.9\r\n",        PARSE_RESULT_CONT },
+      {"X-Forwarded-For-Some-Client: 192.0.2.1, 198.51.100.17\x0b, 203.0.113.9\r\n",    PARSE_RESULT_ERROR},
+      {"X-Forwarded-For-Some-Client: 192.0.2.1, 198.51.100.17, 203.0.113.9\x7f\r\n",    PARSE_RESULT_ERROR},
+      {"X-Forwarded-For-Some-Client: 192.0.2.1,\t198.51.100.17,\x80" "203.0.113.9\r\n", PARSE_RESULT_CONT },
+      {"X-Forwarded-For-Some\x01-Client: 192.0.2.1, 198.51.100.17, 203.0.113.9\r\n",    PARSE_RESULT_ERROR},
+      {"X-Forwarded-For-Some-Client: 192.0.2.1, 198.51.100.17\0, 203.0.113.9\r\n"sv,    PARSE_RESULT_ERROR},
+      {"X-Forwarded-For-Some-Client: 192.0.2.1, 198.51.100.17, 203.0.113.9\r\n\0"sv,    PARSE_RESULT_ERROR},
     };
 
     MIMEHdr hdr;
@@ -2069,3 +2081,52 @@ TEST_CASE("HdrTest", "[proxy][hdrtest]")
     }
   }
 }
+
+TEST_CASE("HdrTokenTokenize", "[proxy][hdrtoken]")
+{
+  hdrtoken_init();
+
+  // The index of the well known string @a s is, in any case, by looking at all of them.
+  auto expected = [](const std::string &s) {
+    for (int i = 0; i < hdrtoken_num_wks; ++i) {
+      if (hdrtoken_str_lengths[i] == static_cast<int>(s.size()) && strncasecmp(hdrtoken_strs[i], s.data(), s.size()) == 0) {
+        return i;
+      }
+    }
+    return -1;
+  };
+  auto tokenize = [](const std::string &s) {
+    // Not in the heap of the well known strings, for the hash to be used.
+    std::string copy{s};
+    return hdrtoken_tokenize(copy.data(), copy.size());
+  };
+
+  for (int i = 0; i < hdrtoken_num_wks; ++i) {
+    std::string wks{hdrtoken_strs[i], static_cast<size_t>(hdrtoken_str_lengths[i])};
+    std::string upper{wks}, lower{wks};
+    std::transform(wks.begin(), wks.end(), upper.begin(), ::toupper);
+    std::transform(wks.begin(), wks.end(), lower.begin(), ::tolower);
+
+    const char *wks_out = nullptr;
+    CHECK(hdrtoken_tokenize(lower.data(), lower.size(), &wks_out) == i);
+    CHECK(wks_out == hdrtoken_strs[i]);
+    CHECK(tokenize(upper) == i);
+    CHECK(hdrtoken_tokenize(hdrtoken_strs[i], hdrtoken_str_lengths[i]) == i);
+
+    // Every character changed, and one more or less at each end.
+    for (size_t k = 0; k < wks.size(); ++k) {
+      for (char c : {'-', '@', '`', '{', 'x', 'X', '\x80', '\0'}) {
+        std::string s{wks};
+        s[k] = c;
+        CHECK(tokenize(s) == expected(s));
+      }
+    }
+    for (const std::string &s : {wks.substr(1), wks.substr(0, wks.size() - 1), wks + "s", "X" + wks}) {
+      CHECK(tokenize(s) == expected(s));
+    }
+  }
+
+  CHECK(tokenize("") == -1);
+  CHECK(tokenize(std::string(100, 'a')) == -1);
+  CHECK(tokenize("X-Unknown-Header") == -1);
+}
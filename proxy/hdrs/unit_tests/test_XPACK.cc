@@ -25,6 +25,9 @@
 
 #include "catch.hpp"
 
+#include <string>
+#include <string_view>
+
 #include "XPACK.h"
 #include "HuffmanCodec.h"
 
@@ -126,3 +129,94 @@ TEST_CASE("XPACK_String", "[xpack]")
     }
   }
 }
+
+TEST_CASE("XPACK_DynamicTable", "[xpack]")
+{
+  const char *name, *value;
+  int name_len, value_len;
+
+  SECTION("Lookup and eviction")
+  {
+    // Each entry is 3 + 3 + 32 = 38 bytes, three fit.
+    XpackDynamicTable table(120, 32);
+
+    CHECK(table.insert_entry("aaa", 3, "111", 3).match_type == XpackLookupResult::EXACT);
+    CHECK(table.insert_entry("bbb", 3, "222", 3).match_type == XpackLookupResult::EXACT);
+    CHECK(table.insert_entry("aaa", 3, "333", 3).match_type == XpackLookupResult::EXACT);
+    CHECK(table.count() == 3);
+    CHECK(table.size() == 114);
+
+    auto r = table.lookup("AAA", 3, "111", 3);
+    CHECK(r.match_type == XpackLookupResult::EXACT);
+    CHECK(r.index == 1);
+    // The newest entry with the name.
+    r = table.lookup("aaa", 3, "444", 3);
+    CHECK(r.match_type == XpackLookupResult::NAME);
+    CHECK(r.index == 3);
+    CHECK(table.lookup("ccc", 3, "111", 3).match_type == XpackLookupResult::NONE);
+
+    table.insert_entry("ccc", 3, "444", 3);
+    CHECK(table.count() == 3);
+    CHECK(table.lookup(1u, &name, &name_len, &value, &value_len).match_type == XpackLookupResult::NONE);
+    CHECK(table.lookup("aaa", 3, "111", 3).match_type == XpackLookupResult::NAME);
+
+    r = table.lookup(4u, &name, &name_len, &value, &value_len);
+    CHECK(r.match_type == XpackLookupResult::EXACT);
+    CHECK(std::string_view(name, name_len) == "ccc");
+    CHECK(std::string_view(value, value_len) == "444");
+
+    REQUIRE(table.update_maximum_size(40));
+    CHECK(table.count() == 1);
+    CHECK(table.lookup("bbb", 3, "222", 3).match_type == XpackLookupResult::NONE);
+    CHECK(table.lookup("ccc", 3, "444", 3).index == 4);
+
+    // Too large to fit at all, the table is left as it is.
+    CHECK(table.insert_entry("ddd", 3, "5555555555", 10).match_type == XpackLookupResult::NONE);
+    CHECK(table.count() == 1);
+  }
+
+  SECTION("References")
+  {
+    XpackDynamicTable table(20, 0);
+
+    table.insert_entry("aaaaa", 5, "11111", 5);
+    table.ref_entry(1);
+    CHECK(table.insert_entry("bbbbb", 5, "22222", 5).match_type == XpackLookupResult::EXACT);
+    // The oldest entry is still referenced.
+    CHECK(table.insert_entry("ccccc", 5, "33333", 5).match_type == XpackLookupResult::NONE);
+    CHECK(!table.update_maximum_size(10));
+    CHECK(table.count() == 2);
+
+    table.unref_entry(1);
+    CHECK(table.insert_entry("ccccc", 5, "33333", 5).match_type == XpackLookupResult::EXACT);
+    CHECK(table.lookup("aaaaa", 5, "11111", 5).match_type == XpackLookupResult::NONE);
+
+    // The entry to duplicate is the one evicted for it.
+    auto r = table.duplicate_entry(2);
+    CHECK(r.match_type == XpackLookupResult::EXACT);
+    CHECK(r.index == 4);
+    CHECK(table.count() == 2);
+    table.lookup(4u, &name, &name_len, &value, &value_len);
+    CHECK(std::string_view(name, name_len) == "bbbbb");
+    CHECK(std::string_view(value, value_len) == "22222");
+  }
+
+  SECTION("Wrap around")
+  {
+    XpackDynamicTable table(4096, 32);
+
+    for (int i = 0; i < 10000; ++i) {
+      std::string n = "name-" + std::to_string(i % 97);
+      std::string v(i % 200, 'a' + i % 26);
+      REQUIRE(table.insert_entry(n.data(), n.size(), v.data(), v.size()).match_type != XpackLookupResult::NONE);
+      REQUIRE(table.size() <= 4096);
+
+      auto r = table.lookup(n.data(), n.size(), v.data(), v.size());
+      REQUIRE(r.match_type == XpackLookupResult::EXACT);
+      REQUIRE(r.index == table.largest_index());
+      table.lookup(r.index, &name, &name_len, &value, &value_len);
+      REQUIRE(std::string_view(name, name_len) == n);
+      REQUIRE(std::string_view(value, value_len) == v);
+    }
+  }
+}
@@ -22,11 +22,15 @@
  */
 
 #include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "catch.hpp"
 
 #include "I_EventSystem.h"
 #include "MIME.h"
+#include "MIMEScan.h"
 
 TEST_CASE("Mime", "[proxy][mime]")
 {
@@ -249,3 +253,118 @@ TEST_CASE("MimeParsers", "[proxy][mimeparsers]")
   std::printf("Date1: %d\n", d1);
   std::printf("Date2: %d\n", d2);
 }
+
+TEST_CASE("MimeNameIndex", "[proxy][mime]")
+{
+  // Custom names, some the same but in the middle and some well known.
+  std::vector<std::string> names;
+  for (int i = 0; i < 40; ++i) {
+    char name[64];
+    snprintf(name, sizeof(name), i % 3 ? "X-Custom-%d" : "x-trace-%03d-span-id", i);
+    names.emplace_back(name);
+  }
+  names.insert(names.end(), {"Via", "cookie", "X-Forwarded-For", "X-Custom-", "x"});
+
+  std::mt19937 rng(25);
+  auto any_case = [&](std::string name) {
+    for (auto &c : name) {
+      c = rng() % 2 ? ParseRules::ink_toupper(c) : ParseRules::ink_tolower(c);
+    }
+    return name;
+  };
+
+  MIMEHdr hdr;
+  hdr.create(nullptr);
+  uint64_t indexed = mime_field_find_stats.indexed;
+
+  // Slots are not reused, the slot numbers of a header that changes a lot outgrow the index.
+  for (int round = 0; round < 50; ++round) {
+    hdr.fields_clear();
+    for (int i = 0; i < 400; ++i) {
+      std::string name = any_case(names[rng() % names.size()]);
+      MIMEField *field = hdr.field_find(name.data(), name.size());
+
+      REQUIRE(field == _mime_hdr_field_list_search_by_string(hdr.m_mime, name.data(), name.size()));
+      switch (rng() % 4) {
+      case 0:
+      case 1:
+        if (hdr.fields_count() < 100) {
+          hdr.field_attach(hdr.field_create(name.data(), name.size()));
+        }
+        break;
+      case 2:
+        if (field) {
+          hdr.field_delete(field, rng() % 2);
+        }
+        break;
+      case 3:
+        // A rename, as TSMimeHdrFieldNameSet does.
+        if (field) {
+          std::string other = names[rng() % names.size()];
+          hdr.field_detach(field, false);
+          field->name_set(hdr.m_heap, hdr.m_mime, other.data(), other.size());
+          hdr.field_attach(field);
+        }
+        break;
+      }
+    }
+  }
+  CHECK(hdr.m_mime->m_name_index_state == MIME_NAME_INDEX_STATE_BUILT);
+  CHECK(mime_field_find_stats.indexed > indexed);
+
+  // A copy has the index, a header off the cache has none.
+  MIMEHdr copy;
+  copy.create(nullptr);
+  copy.copy(&hdr);
+  CHECK(copy.m_mime->m_name_index_state == MIME_NAME_INDEX_STATE_BUILT);
+  for (uint16_t state : {MIME_NAME_INDEX_STATE_BUILT, MIME_NAME_INDEX_STATE_OFF}) {
+    copy.m_mime->m_name_index_state = state;
+    for (const auto &name : names) {
+      REQUIRE(copy.field_find(name.data(), name.size()) ==
+              _mime_hdr_field_list_search_by_string(copy.m_mime, name.data(), name.size()));
+    }
+  }
+
+
+  // More names than the index takes.
+  for (int i = 0; i < MIME_NAME_INDEX_SIZE; ++i) {
+    std::string name = "X-More-" + std::to_string(i);
+    hdr.field_attach(hdr.field_create(name.data(), name.size()));
+  }
+  CHECK(hdr.m_mime->m_name_index_state == MIME_NAME_INDEX_STATE_OFF);
+  CHECK(hdr.field_find("x-more-7", 8) != nullptr);
+  CHECK(hdr.field_find("x-more-", 7) == nullptr);
+
+  copy.destroy();
+  hdr.destroy();
+}
+
+TEST_CASE("MimeScan", "[proxy][mimescan]")
+{
+  // Every character the scans tell apart, and some they do not.
+  static const char alphabet[] = {'a', 'Z', ' ', ':', '\t', '\r', '\n', '\0', '\x01', '\x1f', '\x7f', '\x80', '\xff'};
+  std::mt19937 rng(7);
+  char buf[96];
+
+  for (int i = 0; i < 20000; ++i) {
+    // Mostly plain text, so the matches are spread over the vector and the tail.
+    for (char &c : buf) {
+      c = rng() % 8 ? 'a' + rng() % 26 : alphabet[rng() % sizeof(alphabet)];
+    }
+    const char *s = buf + rng() % 32;
+    const char *e = s + rng() % (buf + sizeof(buf) - s + 1);
+
+    MIMEScanChars lf{'\n', '\0'};
+    MIMEScanControlOr colon{':'};
+    REQUIRE(mime_scan(s, e, lf) == mime_scan<MIMEScanChars, false>(s, e, lf));
+    REQUIRE(mime_scan(s, e, colon) == mime_scan<MIMEScanControlOr, false>(s, e, colon));
+  }
+
+  for (int c = 0; c < 256; ++c) {
+    char line[40];
+    memset(line, 'a', sizeof(line));
+    line[33]   = c;
+    bool match = ParseRules::is_control(c) || c == ':';
+    CHECK(mime_scan_control_or(line, line + sizeof(line), ':') == (match ? line + 33 : line + sizeof(line)));
+  }
+}
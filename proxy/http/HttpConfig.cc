@@ -1035,6 +1035,12 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache.open_write.adjust_thread", RECD_COUNTER, RECP_NON_PERSISTENT,
                      (int)http_cache_open_write_adjust_thread_stat, RecRawStatSyncCount);
   HTTP_CLEAR_DYN_STAT(http_cache_open_write_adjust_thread_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.mime_field_find", RECD_COUNTER, RECP_NON_PERSISTENT,
+                     (int)http_mime_field_find_stat, RecRawStatSyncSum);
+  HTTP_CLEAR_DYN_STAT(http_mime_field_find_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.mime_field_find_indexed", RECD_COUNTER, RECP_NON_PERSISTENT,
+                     (int)http_mime_field_find_indexed_stat, RecRawStatSyncSum);
+  HTTP_CLEAR_DYN_STAT(http_mime_field_find_indexed_stat);
   // milestones
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.milestone.ua_begin", RECD_COUNTER, RECP_PERSISTENT,
                      (int)http_ua_begin_time_stat, RecRawStatSyncSum);
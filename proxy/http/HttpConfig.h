@@ -337,6 +337,9 @@ enum {
   http_origin_connect_adjust_thread_stat,
   http_cache_open_write_adjust_thread_stat,
 
+  http_mime_field_find_stat,
+  http_mime_field_find_indexed_stat,
+
   http_origin_shutdown_pool_lock_contention,
   http_origin_shutdown_migration_failure,
   http_origin_shutdown_tunnel_server,
@@ -7645,6 +7645,11 @@ HttpSM::update_stats()
     &t_state, total_time, ua_write_time, os_read_time, client_request_hdr_bytes, client_request_body_bytes,
     client_response_hdr_bytes, client_response_body_bytes, server_request_hdr_bytes, server_request_body_bytes,
     server_response_hdr_bytes, server_response_body_bytes, pushed_response_hdr_bytes, pushed_response_body_bytes, milestones);
+
+  // The header finds made on this thread since the last transaction finished on it.
+  HTTP_SUM_DYN_STAT(http_mime_field_find_stat, mime_field_find_stats.calls);
+  HTTP_SUM_DYN_STAT(http_mime_field_find_indexed_stat, mime_field_find_stats.indexed);
+  mime_field_find_stats = {};
   /*
       if (is_action_tag_set("http_handler_times")) {
           print_all_http_handler_times();
@@ -31,6 +31,7 @@
  ****************************************************************************/
 
 #include "HttpSessionManager.h"
+#include "tscore/ink_hw.h"
 #include "../ProxySession.h"
 #include "HttpSM.h"
 #include "HttpDebugNames.h"
@@ -139,6 +140,42 @@ ServerSessionPool::validate_cert(HttpSM *sm, NetVConnection *netvc)
   return retval;
 }
 
+namespace
+{
+// How many more matching sessions are looked at for one on the NUMA node of this thread.
+constexpr int SESSION_NODE_SEARCH = 8;
+
+// The first session from @a first on that is still in the range of the key and matches. With more
+// than one NUMA node one handled on the node of this thread is preferred, a session from another
+// node would be moved to this thread with its buffers left on the other node.
+template <typename Table, typename InRange, typename Match>
+typename Table::iterator
+find_session(Table &pool, typename Table::iterator first, InRange &&in_range, Match &&match)
+{
+  static const bool multi_node = ink_number_of_numa_nodes() > 1;
+  auto found                   = pool.end();
+  int left                     = SESSION_NODE_SEARCH;
+  int node                     = this_ethread()->numa_node;
+
+  for (; first != pool.end() && in_range(first); ++first) {
+    if (!match(first)) {
+      continue;
+    }
+    if (found == pool.end()) {
+      found = first;
+    }
+    NetVConnection *netvc = first->get_netvc();
+    if (!multi_node || (netvc && netvc->thread && netvc->thread->numa_node == node)) {
+      return first;
+    }
+    if (--left == 0) {
+      break;
+    }
+  }
+  return found;
+}
+} // namespace
+
 HSMresult_t
 ServerSessionPool::acquireSession(sockaddr const *addr, CryptoHash const &hostname_hash,
                                   TSServerSessionSharingMatchMask match_style, HttpSM *sm, PoolableSession *&to_return)
@@ -152,19 +189,18 @@ ServerSessionPool::acquireSession(sockaddr const *addr, CryptoHash const &hostna
     // to verify an upstream that matches port and SNI name is selected. Walk backwards to select oldest.
     in_port_t port = ats_ip_port_cast(addr);
     auto first     = m_fqdn_pool.find(hostname_hash);
-    while (first != m_fqdn_pool.end() && first->hostname_hash == hostname_hash) {
-      Debug("http_ss", "Compare port 0x%x against 0x%x", port, ats_ip_port_cast(first->get_remote_addr()));
-      if (port == ats_ip_port_cast(first->get_remote_addr()) &&
-          (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_SNI) || validate_sni(sm, first->get_netvc())) &&
-          (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTSNISYNC) || validate_host_sni(sm, first->get_netvc())) &&
-          (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_CERT) || validate_cert(sm, first->get_netvc()))) {
-        zret = HSM_DONE;
-        break;
-      }
-      ++first;
-    }
-    if (zret == HSM_DONE) {
-      to_return = first;
+    auto found     = find_session(
+      m_fqdn_pool, first, [&](auto it) { return it->hostname_hash == hostname_hash; },
+      [&](auto it) {
+        Debug("http_ss", "Compare port 0x%x against 0x%x", port, ats_ip_port_cast(it->get_remote_addr()));
+        return port == ats_ip_port_cast(it->get_remote_addr()) &&
+               (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_SNI) || validate_sni(sm, it->get_netvc())) &&
+               (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTSNISYNC) || validate_host_sni(sm, it->get_netvc())) &&
+               (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_CERT) || validate_cert(sm, it->get_netvc()));
+      });
+    if (found != m_fqdn_pool.end()) {
+      zret      = HSM_DONE;
+      to_return = found;
       if (!to_return->is_multiplexing()) {
         this->removeSession(to_return);
       }
@@ -172,26 +208,20 @@ ServerSessionPool::acquireSession(sockaddr const *addr, CryptoHash const &hostna
       Debug("http_ss", "Failed find entry due to name mismatch %s", sm->t_state.current.server->name);
     }
   } else if (TS_SERVER_SESSION_SHARING_MATCH_MASK_IP & match_style) { // matching is not disabled.
-    auto first = m_ip_pool.find(addr);
     // The range is all that is needed in the match IP case, otherwise need to scan for matching fqdn
     // And matches the other constraints as well
     // Note the port is matched as part of the address key so it doesn't need to be checked again.
-    if (match_style & (~TS_SERVER_SESSION_SHARING_MATCH_MASK_IP)) {
-      while (first != m_ip_pool.end() && ats_ip_addr_port_eq(first->get_remote_addr(), addr)) {
-        if ((!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTONLY) || first->hostname_hash == hostname_hash) &&
-            (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_SNI) || validate_sni(sm, first->get_netvc())) &&
-            (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTSNISYNC) || validate_host_sni(sm, first->get_netvc())) &&
-            (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_CERT) || validate_cert(sm, first->get_netvc()))) {
-          zret = HSM_DONE;
-          break;
-        }
-        ++first;
-      }
-    } else if (first != m_ip_pool.end()) {
-      zret = HSM_DONE;
-    }
-    if (zret == HSM_DONE) {
-      to_return = first;
+    auto found = find_session(
+      m_ip_pool, m_ip_pool.find(addr), [&](auto it) { return ats_ip_addr_port_eq(it->get_remote_addr(), addr); },
+      [&](auto it) {
+        return (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTONLY) || it->hostname_hash == hostname_hash) &&
+               (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_SNI) || validate_sni(sm, it->get_netvc())) &&
+               (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTSNISYNC) || validate_host_sni(sm, it->get_netvc())) &&
+               (!(match_style & TS_SERVER_SESSION_SHARING_MATCH_MASK_CERT) || validate_cert(sm, it->get_netvc()));
+      });
+    if (found != m_ip_pool.end()) {
+      zret      = HSM_DONE;
+      to_return = found;
       if (!to_return->is_multiplexing()) {
         this->removeSession(to_return);
       }
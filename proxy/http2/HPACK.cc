@@ -196,21 +196,6 @@ constexpr HpackHeaderField STATIC_TABLE[] = {
 constexpr std::string_view HPACK_HDR_FIELD_COOKIE        = STATIC_TABLE[TS_HPACK_STATIC_TABLE_COOKIE].name;
 constexpr std::string_view HPACK_HDR_FIELD_AUTHORIZATION = STATIC_TABLE[TS_HPACK_STATIC_TABLE_AUTHORIZATION].name;
 
-/**
-  Threshold for total HdrHeap size which used by HPAK Dynamic Table.
-  The HdrHeap is filled by MIMEHdrImpl and MIMEFieldBlockImpl like below.
-  This threshold allow to allocate 3 HdrHeap at maximum.
-
-                     +------------------+-----------------------------+
-   HdrHeap 1 (2048): | MIMEHdrImpl(592) | MIMEFieldBlockImpl(528) x 2 |
-                     +------------------+-----------------------------+--...--+
-   HdrHeap 2 (4096): | MIMEFieldBlockImpl(528) x 7                            |
-                     +------------------------------------------------+--...--+--...--+
-   HdrHeap 3 (8192): | MIMEFieldBlockImpl(528) x 15                                   |
-                     +------------------------------------------------+--...--+--...--+
-*/
-static constexpr uint32_t HPACK_HDR_HEAP_THRESHOLD = sizeof(MIMEHdrImpl) + sizeof(MIMEFieldBlockImpl) * (2 + 7 + 15);
-
 //
 // Local functions
 //
@@ -241,24 +226,6 @@ match(const char *s1, int s1_len, const char *s2, int s2_len)
   return true;
 }
 
-static inline bool
-match_ignore_case(const char *s1, int s1_len, const char *s2, int s2_len)
-{
-  if (s1_len != s2_len) {
-    return false;
-  }
-
-  if (s1 == s2) {
-    return true;
-  }
-
-  if (strncasecmp(s1, s2, s1_len) != 0) {
-    return false;
-  }
-
-  return true;
-}
-
 //
 // The first byte of an HPACK field unambiguously tells us what
 // kind of field it is. Field types are specified in the high 4 bits
@@ -371,14 +338,10 @@ HpackIndexingTable::get_header_field(uint32_t index, MIMEFieldWrapper &field) co
     field.value_set(STATIC_TABLE[index].value.data(), STATIC_TABLE[index].value.size());
   } else if (index < TS_HPACK_STATIC_TABLE_ENTRY_NUM + _dynamic_table.length()) {
     // dynamic table
-    const MIMEField *m_field = _dynamic_table.get_header_field(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM);
+    HpackHeaderField header = _dynamic_table.get_header_field(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM);
 
-    int name_len, value_len;
-    const char *name  = m_field->name_get(&name_len);
-    const char *value = m_field->value_get(&value_len);
-
-    field.name_set(name, name_len);
-    field.value_set(value, value_len);
+    field.name_set(header.name.data(), header.name.size());
+    field.value_set(header.value.data(), header.value.size());
   } else {
     // [RFC 7541] 2.3.3. Index Address Space
     // Indices strictly greater than the sum of the lengths of both tables
@@ -416,31 +379,21 @@ HpackIndexingTable::update_maximum_size(uint32_t new_size)
 //
 // HpackDynamicTable
 //
-HpackDynamicTable::HpackDynamicTable(uint32_t size) : _maximum_size(size)
-{
-  _mhdr = new MIMEHdr();
-  _mhdr->create();
-}
-
-HpackDynamicTable::~HpackDynamicTable()
-{
-  this->_headers.clear();
-
-  this->_mhdr->fields_clear();
-  this->_mhdr->destroy();
-  delete this->_mhdr;
+HpackDynamicTable::HpackDynamicTable(uint32_t size) : _table(size, ADDITIONAL_OCTETS) {}
 
-  if (this->_mhdr_old != nullptr) {
-    this->_mhdr_old->fields_clear();
-    this->_mhdr_old->destroy();
-    delete this->_mhdr_old;
-  }
-}
-
-const MIMEField *
+HpackHeaderField
 HpackDynamicTable::get_header_field(uint32_t index) const
 {
-  return this->_headers.at(index);
+  const char *name  = "";
+  const char *value = "";
+  int name_len      = 0;
+  int value_len     = 0;
+
+  this->_table.lookup(this->_table.largest_index() - index, &name, &name_len, &value, &value_len);
+  return {
+    {name,  static_cast<size_t>(name_len) },
+    {value, static_cast<size_t>(value_len)}
+  };
 }
 
 void
@@ -448,30 +401,14 @@ HpackDynamicTable::add_header_field(const HpackHeaderField &header)
 {
   uint32_t header_size = ADDITIONAL_OCTETS + header.name.size() + header.value.size();
 
-  if (header_size > _maximum_size) {
+  if (header_size > this->_table.maximum_size()) {
     // [RFC 7541] 4.4. Entry Eviction When Adding New Entries
     // It is not an error to attempt to add an entry that is larger than
     // the maximum size; an attempt to add an entry larger than the entire
     // table causes the table to be emptied of all existing entries.
-    this->_headers.clear();
-    this->_mhdr->fields_clear();
-
-    if (this->_mhdr_old) {
-      this->_mhdr_old->fields_clear();
-      this->_mhdr_old->destroy();
-      delete this->_mhdr_old;
-      this->_mhdr_old = nullptr;
-    }
-
-    this->_current_size = 0;
+    this->_table.clear();
   } else {
-    this->_current_size += header_size;
-    this->_evict_overflowed_entries();
-
-    MIMEField *new_field = this->_mhdr->field_create(header.name.data(), header.name.size());
-    new_field->value_set(this->_mhdr->m_heap, this->_mhdr->m_mime, header.value.data(), header.value.size());
-    this->_mhdr->field_attach(new_field);
-    this->_headers.push_front(new_field);
+    this->_table.insert_entry(header.name.data(), header.name.size(), header.value.data(), header.value.size());
   }
 }
 
@@ -479,26 +416,12 @@ HpackLookupResult
 HpackDynamicTable::lookup(const HpackHeaderField &header) const
 {
   HpackLookupResult result;
-  const unsigned int entry_num = TS_HPACK_STATIC_TABLE_ENTRY_NUM + this->length();
-
-  for (unsigned int index = TS_HPACK_STATIC_TABLE_ENTRY_NUM; index < entry_num; ++index) {
-    const MIMEField *m_field = this->_headers.at(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM);
-    std::string_view name    = m_field->name_get();
-    std::string_view value   = m_field->value_get();
-
-    // Check whether name (and value) are matched
-    if (match_ignore_case(header.name.data(), header.name.length(), name.data(), name.length())) {
-      if (match(header.value.data(), header.value.length(), value.data(), value.length())) {
-        result.index      = index;
-        result.index_type = HpackIndex::DYNAMIC;
-        result.match_type = HpackMatch::EXACT;
-        break;
-      } else if (!result.index) {
-        result.index      = index;
-        result.index_type = HpackIndex::DYNAMIC;
-        result.match_type = HpackMatch::NAME;
-      }
-    }
+  XpackLookupResult r = this->_table.lookup(header.name.data(), header.name.size(), header.value.data(), header.value.size());
+
+  if (r.match_type != XpackLookupResult::MatchType::NONE) {
+    result.index      = TS_HPACK_STATIC_TABLE_ENTRY_NUM + (this->_table.largest_index() - r.index);
+    result.index_type = HpackIndex::DYNAMIC;
+    result.match_type = r.match_type == XpackLookupResult::MatchType::EXACT ? HpackMatch::EXACT : HpackMatch::NAME;
   }
 
   return result;
@@ -507,13 +430,13 @@ HpackDynamicTable::lookup(const HpackHeaderField &header) const
 uint32_t
 HpackDynamicTable::maximum_size() const
 {
-  return _maximum_size;
+  return this->_table.maximum_size();
 }
 
 uint32_t
 HpackDynamicTable::size() const
 {
-  return _current_size;
+  return this->_table.size();
 }
 
 //
@@ -526,68 +449,13 @@ HpackDynamicTable::size() const
 void
 HpackDynamicTable::update_maximum_size(uint32_t new_size)
 {
-  this->_maximum_size = new_size;
-  this->_evict_overflowed_entries();
+  this->_table.update_maximum_size(new_size);
 }
 
 uint32_t
 HpackDynamicTable::length() const
 {
-  return this->_headers.size();
-}
-
-void
-HpackDynamicTable::_evict_overflowed_entries()
-{
-  if (this->_current_size <= this->_maximum_size) {
-    // Do nothing
-    return;
-  }
-
-  while (!this->_headers.empty()) {
-    auto h = this->_headers.back();
-    int name_len, value_len;
-    h->name_get(&name_len);
-    h->value_get(&value_len);
-
-    this->_current_size -= ADDITIONAL_OCTETS + name_len + value_len;
-
-    if (this->_mhdr_old && this->_mhdr_old->fields_count() != 0) {
-      this->_mhdr_old->field_delete(h, false);
-    } else {
-      this->_mhdr->field_delete(h, false);
-    }
-
-    this->_headers.pop_back();
-
-    if (this->_current_size <= this->_maximum_size) {
-      break;
-    }
-  }
-
-  this->_mime_hdr_gc();
-}
-
-/**
-   When HdrHeap size of current MIMEHdr exceeds the threshold, allocate new MIMEHdr and HdrHeap.
-   The old MIMEHdr and HdrHeap will be freed, when all MIMEFiled are deleted by HPACK Entry Eviction.
- */
-void
-HpackDynamicTable::_mime_hdr_gc()
-{
-  if (this->_mhdr_old == nullptr) {
-    if (this->_mhdr->m_heap->total_used_size() >= HPACK_HDR_HEAP_THRESHOLD) {
-      this->_mhdr_old = this->_mhdr;
-      this->_mhdr     = new MIMEHdr();
-      this->_mhdr->create();
-    }
-  } else {
-    if (this->_mhdr_old->fields_count() == 0) {
-      this->_mhdr_old->destroy();
-      delete this->_mhdr_old;
-      this->_mhdr_old = nullptr;
-    }
-  }
+  return this->_table.count();
 }
 
 //
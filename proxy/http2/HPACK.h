@@ -28,7 +28,6 @@
 #include "HTTP.h"
 #include "../hdrs/XPACK.h"
 
-#include <deque>
 #include <string_view>
 
 // It means that any header field can be compressed/decompressed by ATS
@@ -112,13 +111,13 @@ class HpackDynamicTable
 {
 public:
   explicit HpackDynamicTable(uint32_t size);
-  ~HpackDynamicTable();
 
   // noncopyable
   HpackDynamicTable(HpackDynamicTable &)                  = delete;
   HpackDynamicTable &operator=(const HpackDynamicTable &) = delete;
 
-  const MIMEField *get_header_field(uint32_t index) const;
+  /// The entry at @a index, 0 is the newest. The strings are valid until the next change to the table.
+  HpackHeaderField get_header_field(uint32_t index) const;
   void add_header_field(const HpackHeaderField &header);
 
   HpackLookupResult lookup(const HpackHeaderField &header) const;
@@ -129,15 +128,7 @@ public:
   uint32_t length() const;
 
 private:
-  void _evict_overflowed_entries();
-  void _mime_hdr_gc();
-
-  uint32_t _current_size = 0;
-  uint32_t _maximum_size = 0;
-
-  MIMEHdr *_mhdr     = nullptr;
-  MIMEHdr *_mhdr_old = nullptr;
-  std::deque<MIMEField *> _headers;
+  XpackDynamicTable _table;
 };
 
 // [RFC 7541] 2.3. Indexing Table
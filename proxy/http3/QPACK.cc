@@ -27,8 +27,7 @@
 #include "tscore/ink_defs.h"
 #include "tscore/ink_memory.h"
 
-#define QPACKDebug(fmt, ...)   Debug("qpack", "[%s] " fmt, this->_qc->cids().data(), ##__VA_ARGS__)
-#define QPACKDTDebug(fmt, ...) Debug("qpack", "" fmt, ##__VA_ARGS__)
+#define QPACKDebug(fmt, ...) Debug("qpack", "[%s] " fmt, this->_qc->cids().data(), ##__VA_ARGS__)
 
 // qpack-05 Appendix A.
 const QPACK::Header QPACK::StaticTable::STATIC_HEADER_FIELDS[] = {
@@ -135,7 +134,7 @@ const QPACK::Header QPACK::StaticTable::STATIC_HEADER_FIELDS[] = {
 
 QPACK::QPACK(QUICConnection *qc, uint32_t max_header_list_size, uint16_t max_table_size, uint16_t max_blocking_streams)
   : QUICApplication(qc),
-    _dynamic_table(max_table_size),
+    _dynamic_table(max_table_size, 0),
     _max_header_list_size(max_header_list_size),
     _max_table_size(max_table_size),
     _max_blocking_streams(max_blocking_streams)
@@ -1118,7 +1117,18 @@ QPACK::_on_encoder_stream_read_ready(IOBufferReader &reader)
         return EVENT_DONE;
       }
       QPACKDebug("Received Insert With Name Ref: is_static=%d, index=%d, value=%.*s", is_static, index, value_len, value);
-      this->_dynamic_table.insert_entry(is_static, index, value, value_len);
+      const char *name;
+      int name_len;
+      const char *dummy;
+      int dummy_len;
+      if (is_static) {
+        StaticTable::lookup(index, &name, &name_len, &dummy, &dummy_len);
+      } else if (this->_dynamic_table.lookup(index, &name, &name_len, &dummy, &dummy_len).match_type ==
+                 LookupResult::MatchType::NONE) {
+        this->_abort_decode();
+        return EVENT_DONE;
+      }
+      this->_dynamic_table.insert_entry(name, name_len, value, value_len);
     } else if (buf & 0x40) { // Insert Without Name Reference
       Arena arena;
       char *name;
@@ -1138,7 +1148,7 @@ QPACK::_on_encoder_stream_read_ready(IOBufferReader &reader)
         return EVENT_DONE;
       }
       QPACKDebug("Received Dynamic Table Size Update: max_size=%d", max_size);
-      this->_dynamic_table.update_size(max_size);
+      this->_dynamic_table.update_maximum_size(max_size);
     } else { // Duplicates
       uint16_t index;
       if (this->_read_duplicate(reader, index) < 0) {
@@ -1249,192 +1259,6 @@ QPACK::_attach_header(HTTPHdr &hdr, const char *name, int name_len, const char *
   hdr.field_attach(new_field);
 }
 
-//
-// DynamicTable
-//
-QPACK::DynamicTable::DynamicTable(uint16_t size) : _available(size), _max_entries(size), _storage(new DynamicTableStorage(size))
-{
-  QPACKDTDebug("Dynamic table size: %u", size);
-  this->_entries      = static_cast<struct DynamicTableEntry *>(ats_malloc(sizeof(struct DynamicTableEntry) * size));
-  this->_entries_head = size - 1;
-  this->_entries_tail = size - 1;
-}
-
-QPACK::DynamicTable::~DynamicTable()
-{
-  if (this->_storage) {
-    delete this->_storage;
-    this->_storage = nullptr;
-  }
-  if (this->_entries) {
-    delete this->_entries;
-    this->_entries = nullptr;
-  }
-}
-
-const QPACK::LookupResult
-QPACK::DynamicTable::lookup(uint16_t index, const char **name, int *name_len, const char **value, int *value_len)
-{
-  // ink_assert(index >= this->_entries[(this->_entries_tail + 1) % this->_max_entries].index);
-  // ink_assert(index <= this->_entries[this->_entries_head].index);
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
-  *name_len    = this->_entries[pos].name_len;
-  *value_len   = this->_entries[pos].value_len;
-  this->_storage->read(this->_entries[pos].offset, name, *name_len, value, *value_len);
-  return {index, QPACK::LookupResult::MatchType::EXACT};
-}
-
-const QPACK::LookupResult
-QPACK::DynamicTable::lookup(const char *name, int name_len, const char *value, int value_len)
-{
-  QPACK::LookupResult::MatchType match_type = QPACK::LookupResult::MatchType::NONE;
-  uint16_t i                                = this->_entries_tail + 1;
-  int end                                   = this->_entries_head;
-  uint16_t candidate_index                  = 0;
-  const char *tmp_name                      = nullptr;
-  const char *tmp_value                     = nullptr;
-
-  // DynamicTable is empty
-  if (this->_entries_inserted == 0) {
-    return {candidate_index, match_type};
-  }
-
-  // TODO Use a tree for better performance
-  for (; i <= end; i = (i + 1) % this->_max_entries) {
-    if (name_len != 0 && this->_entries[i].name_len == name_len) {
-      this->_storage->read(this->_entries[i].offset, &tmp_name, this->_entries[i].name_len, &tmp_value,
-                           this->_entries[i].value_len);
-      if (memcmp(name, tmp_name, name_len) == 0) {
-        candidate_index = this->_entries[i].index;
-        if (value_len == this->_entries[i].value_len && memcmp(value, tmp_value, value_len) == 0) {
-          // Exact match
-          match_type = QPACK::LookupResult::MatchType::EXACT;
-          break;
-        } else {
-          // Name match -- Keep it for no exact matches
-          match_type = QPACK::LookupResult::MatchType::NAME;
-        }
-      }
-    }
-  }
-
-  return {candidate_index, match_type};
-}
-
-const QPACK::LookupResult
-QPACK::DynamicTable::insert_entry(bool is_static, uint16_t index, const char *value, uint16_t value_len)
-{
-  const char *name;
-  int name_len;
-  const char *dummy;
-  int dummy_len;
-
-  if (is_static) {
-    StaticTable::lookup(index, &name, &name_len, &dummy, &dummy_len);
-  } else {
-    this->lookup(index, &name, &name_len, &dummy, &dummy_len);
-  }
-  return this->insert_entry(name, name_len, value, value_len);
-}
-
-const QPACK::LookupResult
-QPACK::DynamicTable::insert_entry(const char *name, uint16_t name_len, const char *value, uint16_t value_len)
-{
-  if (this->_max_entries == 0) {
-    return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
-  }
-
-  // Check if we can make enough space to insert a new entry
-  uint16_t required_len = name_len + value_len;
-  uint16_t available    = this->_available;
-  uint16_t tail         = (this->_entries_tail + 1) % this->_max_entries;
-  while (available < required_len) {
-    if (this->_entries[tail].ref_count) {
-      break;
-    }
-    available += this->_entries[tail].name_len + this->_entries[tail].value_len;
-    tail       = (tail + 1) % this->_max_entries;
-  }
-  if (available < required_len) {
-    // We can't insert a new entry because some stream(s) refer an entry that need to be evicted
-    return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
-  }
-
-  // Evict
-  if (this->_available != available) {
-    QPACKDTDebug("Evict entries: from %u to %u", this->_entries[(this->_entries_tail + 1) % this->_max_entries].index,
-                 this->_entries[tail - 1].index);
-    this->_available    = available;
-    this->_entries_tail = tail - 1;
-    QPACKDTDebug("Available size: %u", this->_available);
-  }
-
-  // Insert
-  this->_entries_head                  = (this->_entries_head + 1) % this->_max_entries;
-  this->_entries[this->_entries_head]  = {++this->_entries_inserted, this->_storage->write(name, name_len, value, value_len),
-                                          name_len, value_len, 0};
-  this->_available                    -= required_len;
-
-  QPACKDTDebug("Insert Entry: entry=%u, index=%u, size=%u", this->_entries_head, this->_entries_inserted, name_len + value_len);
-  QPACKDTDebug("Available size: %u", this->_available);
-  return {this->_entries_inserted, value_len ? LookupResult::MatchType::EXACT : LookupResult::MatchType::NAME};
-}
-
-const QPACK::LookupResult
-QPACK::DynamicTable::duplicate_entry(uint16_t current_index)
-{
-  const char *name;
-  int name_len;
-  const char *value;
-  int value_len;
-  char *duped_name;
-  char *duped_value;
-
-  this->lookup(current_index, &name, &name_len, &value, &value_len);
-  // We need to dup name and value to avoid memcpy-param-overlap
-  duped_name                = ats_strndup(name, name_len);
-  duped_value               = ats_strndup(value, value_len);
-  const LookupResult result = this->insert_entry(duped_name, name_len, duped_value, value_len);
-  ats_free(duped_name);
-  ats_free(duped_value);
-
-  return result;
-}
-
-bool
-QPACK::DynamicTable::should_duplicate(uint16_t index)
-{
-  // TODO: Check whether a specified entry should be duplicated
-  // Just return false for now
-  return false;
-}
-
-void
-QPACK::DynamicTable::update_size(uint16_t max_size)
-{
-  // TODO Implement it
-}
-
-void
-QPACK::DynamicTable::ref_entry(uint16_t index)
-{
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
-  ++this->_entries[pos].ref_count;
-}
-
-void
-QPACK::DynamicTable::unref_entry(uint16_t index)
-{
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
-  --this->_entries[pos].ref_count;
-}
-
-uint16_t
-QPACK::DynamicTable::largest_index() const
-{
-  return this->_entries_inserted;
-}
-
 int
 QPACK::_write_insert_with_name_ref(uint16_t index, bool dynamic, const char *value, uint16_t value_len)
 {
@@ -1815,48 +1639,3 @@ QPACK::_read_stream_cancellation(IOBufferReader &reader, uint64_t &stream_id)
   return 0;
 }
 
-//
-// DynamicTableStorage
-//
-
-QPACK::DynamicTableStorage::DynamicTableStorage(uint16_t size) : _head(size * 2 - 1), _tail(size * 2 - 1)
-{
-  this->_data_size           = size * 2;
-  this->_data                = reinterpret_cast<uint8_t *>(ats_malloc(this->_data_size));
-  this->_overwrite_threshold = size;
-}
-
-QPACK::DynamicTableStorage::~DynamicTableStorage()
-{
-  ats_free(this->_data);
-  this->_data = nullptr;
-}
-
-void
-QPACK::DynamicTableStorage::read(uint16_t offset, const char **name, uint16_t name_len, const char **value,
-                                 uint16_t value_len) const
-{
-  *name  = reinterpret_cast<const char *>(this->_data + offset);
-  *value = reinterpret_cast<const char *>(this->_data + offset + name_len);
-}
-
-uint16_t
-QPACK::DynamicTableStorage::write(const char *name, uint16_t name_len, const char *value, uint16_t value_len)
-{
-  uint16_t offset = (this->_head + 1) % this->_data_size;
-  memcpy(this->_data + offset, name, name_len);
-  memcpy(this->_data + offset + name_len, value, value_len);
-
-  this->_head = (this->_head + (name_len + value_len)) % this->_data_size;
-  if (this->_head > this->_overwrite_threshold) {
-    this->_head = 0;
-  }
-
-  return offset;
-}
-
-void
-QPACK::DynamicTableStorage::erase(uint16_t name_len, uint16_t value_len)
-{
-  this->_tail = (this->_tail + (name_len + value_len)) % this->_data_size;
-}
@@ -32,6 +32,7 @@
 #include "tscpp/util/IntrusiveDList.h"
 #include "MIME.h"
 #include "HTTP.h"
+#include "XPACK.h"
 #include "QUICApplication.h"
 #include "QUICStreamVCAdapter.h"
 #include "QUICConnection.h"
@@ -79,10 +80,7 @@ public:
   static size_t estimate_header_block_size(const HTTPHdr &header_set);
 
 private:
-  struct LookupResult {
-    uint16_t index                                  = 0;
-    enum MatchType { NONE, NAME, EXACT } match_type = MatchType::NONE;
-  };
+  using LookupResult = XpackLookupResult;
 
   struct Header {
     Header(const char *n, const char *v) : name(n), value(v), name_len(strlen(name)), value_len(strlen(value)) {}
@@ -102,60 +100,6 @@ private:
     static const Header STATIC_HEADER_FIELDS[];
   };
 
-  struct DynamicTableEntry {
-    uint16_t index     = 0;
-    uint16_t offset    = 0;
-    uint16_t name_len  = 0;
-    uint16_t value_len = 0;
-    uint16_t ref_count = 0;
-  };
-
-  class DynamicTableStorage
-  {
-  public:
-    DynamicTableStorage(uint16_t size);
-    ~DynamicTableStorage();
-    void read(uint16_t offset, const char **name, uint16_t name_len, const char **value, uint16_t value_len) const;
-    uint16_t write(const char *name, uint16_t name_len, const char *value, uint16_t value_len);
-    void erase(uint16_t name_len, uint16_t value_len);
-
-  private:
-    uint16_t _overwrite_threshold = 0;
-    uint8_t *_data                = nullptr;
-    uint16_t _data_size           = 0;
-    uint16_t _head                = 0;
-    uint16_t _tail                = 0;
-  };
-
-  class DynamicTable
-  {
-  public:
-    DynamicTable(uint16_t size);
-    ~DynamicTable();
-
-    const LookupResult lookup(uint16_t index, const char **name, int *name_len, const char **value, int *value_len);
-    const LookupResult lookup(const char *name, int name_len, const char *value, int value_len);
-    const LookupResult insert_entry(bool is_static, uint16_t index, const char *value, uint16_t value_len);
-    const LookupResult insert_entry(const char *name, uint16_t name_len, const char *value, uint16_t value_len);
-    const LookupResult duplicate_entry(uint16_t current_index);
-    bool should_duplicate(uint16_t index);
-    void update_size(uint16_t max_size);
-    void ref_entry(uint16_t index);
-    void unref_entry(uint16_t index);
-    uint16_t largest_index() const;
-
-  private:
-    uint16_t _available        = 0;
-    uint16_t _entries_inserted = 0;
-
-    // FIXME It may be better to split this array into small arrays to reduce memory footprint
-    struct DynamicTableEntry *_entries = nullptr;
-    uint16_t _max_entries              = 0;
-    uint16_t _entries_head             = 0;
-    uint16_t _entries_tail             = 0;
-    DynamicTableStorage *_storage      = nullptr;
-  };
-
   class DecodeRequest
   {
   public:
@@ -247,7 +191,7 @@ private:
     uint16_t largest;
   };
 
-  DynamicTable _dynamic_table;
+  XpackDynamicTable _dynamic_table;
   std::map<uint64_t, struct EntryReference> _references;
   uint32_t _max_header_list_size = 0;
   uint16_t _max_table_size       = 0;
@@ -190,6 +190,7 @@ const char *const HttpProxyPort::OPT_BLIND_TUNNEL            = "blind";
 const char *const HttpProxyPort::OPT_COMPRESSED              = "compressed";
 const char *const HttpProxyPort::OPT_MPTCP                   = "mptcp";
 const char *const HttpProxyPort::OPT_QUIC                    = "quic";
+const char *const HttpProxyPort::OPT_IO_URING                = "uring";
 
 // File local constants.
 namespace
@@ -448,6 +449,12 @@ HttpProxyPort::processOptions(const char *opts)
       } else {
         Warning("Multipath TCP requested [%s] in port descriptor '%s' but it is not supported by this host.", item, opts);
       }
+    } else if (0 == strcasecmp(OPT_IO_URING, item)) {
+#if TS_USE_LINUX_IO_URING
+      m_io_uring = true;
+#else
+      Warning("io_uring network I/O requested [%s] in port descriptor '%s' but io_uring was not configured.", item, opts);
+#endif
     } else if (nullptr != (value = this->checkPrefix(item, OPT_HOST_RES_PREFIX, OPT_HOST_RES_PREFIX_LEN))) {
       this->processFamilyPreference(value);
       host_res_set_p = true;
@@ -492,6 +499,12 @@ HttpProxyPort::processOptions(const char *opts)
     m_transparent_passthrough = false;
   }
 
+  // io_uring network I/O is only done for plain TCP connections, TLS and QUIC do their own socket I/O.
+  if (m_io_uring && (this->isSSL() || this->isQUIC())) {
+    Warning("Port descriptor '%s' has io_uring network I/O enabled on a TLS or QUIC port, this will be ignored.", opts);
+    m_io_uring = false;
+  }
+
   // Set the default session protocols.
   if (!sp_set_p) {
     if (this->isSSL()) {
@@ -643,6 +656,10 @@ HttpProxyPort::print(char *out, size_t n)
     zret += snprintf(out + zret, n - zret, ":%s", OPT_MPTCP);
   }
 
+  if (m_io_uring) {
+    zret += snprintf(out + zret, n - zret, ":%s", OPT_IO_URING);
+  }
+
   if (m_transparent_passthrough) {
     zret += snprintf(out + zret, n - zret, ":%s", OPT_TRANSPARENT_PASSTHROUGH);
   }
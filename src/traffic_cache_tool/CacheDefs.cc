@@ -238,8 +238,8 @@ Stripe::InitializeMeta()
   for (auto &i : _meta) {
     for (auto &j : i) {
       j.magic          = StripeMeta::MAGIC;
-      j.version._major = ts::CACHE_DB_MAJOR_VERSION;
-      j.version._minor = ts::CACHE_DB_MINOR_VERSION;
+      j.version._major = ts::CACHE_STRIPE_MAJOR_VERSION;
+      j.version._minor = ts::CACHE_STRIPE_MINOR_VERSION;
       j.agg_pos = j.last_write_pos = j.write_pos = this->_content;
       j.phase = j.cycle = j.sync_serial = j.write_serial = j.dirty = 0;
       j.create_time                                                = time(nullptr);
@@ -264,9 +264,12 @@ bool
 Stripe::validateMeta(StripeMeta const *meta)
 {
   // Need to be bit more robust at some point.
-  return StripeMeta::MAGIC == meta->magic && meta->version._major <= ts::CACHE_DB_MAJOR_VERSION &&
-         meta->version._minor <= 2 // This may have always been zero, actually.
-    ;
+  // Stripes written before the stripe version was split from the Doc version carry the Doc version (24.x).
+  return StripeMeta::MAGIC == meta->magic &&
+         ((meta->version._major < ts::CACHE_STRIPE_MAJOR_VERSION_COMPATIBLE &&
+           meta->version._minor <= 2) // This may have always been zero, actually.
+          || (meta->version._major >= ts::CACHE_STRIPE_MAJOR_VERSION_COMPATIBLE &&
+              meta->version._major <= ts::CACHE_STRIPE_MAJOR_VERSION));
 }
 
 bool
@@ -357,7 +360,8 @@ Stripe::updateHeaderFooter()
 size_t
 Stripe::vol_dirlen()
 {
-  return vol_headerlen() + ROUND_TO_STORE_BLOCK(((size_t)this->_buckets) * DIR_DEPTH * this->_segments * SIZEOF_DIR) +
+  size_t entry_size = _legacy_dir ? LEGACY_SIZEOF_DIR : SIZEOF_DIR;
+  return vol_headerlen() + ROUND_TO_STORE_BLOCK(((size_t)this->_buckets) * DIR_DEPTH * this->_segments * entry_size) +
          ROUND_TO_STORE_BLOCK(sizeof(StripeMeta));
 }
 
@@ -410,9 +414,14 @@ Stripe::updateLiveData(enum Copy c)
 }
 
 bool
-dir_compare_tag(const CacheDirEntry *e, const CryptoHash *key)
+Stripe::dir_compare_tag(const CacheDirEntry *e, const CryptoHash *key) const
 {
-  return (dir_tag(e) == DIR_MASK_TAG(key->slice32(2)));
+  // Entries converted from a legacy directory only have the low bits of the tag.
+  uint32_t tag = dir_key_tag(key);
+  if (_legacy_dir) {
+    tag &= (1 << LEGACY_DIR_TAG_WIDTH) - 1;
+  }
+  return dir_tag(e) == tag;
 }
 
 int
@@ -628,6 +637,143 @@ Stripe::loadDir()
   if (n < dirlen) {
     std::cout << "Failed to read Dir from stripe @" << this->hashText;
   }
+  if (_legacy_dir) {
+    // Widen the entries, each keeps its index so the bucket chains and freelists are unchanged.
+    int64_t entries          = _segments * _buckets * DIR_DEPTH;
+    auto const *legacy       = reinterpret_cast<ts::LegacyDirEntry const *>(dir);
+    CacheDirEntry *converted = static_cast<CacheDirEntry *>(ats_memalign(ats_pagesize(), entries * SIZEOF_DIR));
+    for (int64_t i = 0; i < entries; ++i) {
+      dir_from_legacy(converted + i, legacy + i);
+    }
+    dir = converted;
+    ats_free(raw_dir);
+  }
+  return zret;
+}
+
+bool
+Stripe::dir_insert(const CryptoHash *key, const CacheDirEntry *src, int64_t offset)
+{
+  int s              = key->slice32(0) % this->_segments;
+  int b              = key->slice32(1) % this->_buckets;
+  CacheDirEntry *seg = this->dir_segment(s);
+  CacheDirEntry *e   = dir_bucket(b, seg);
+  if (dir_offset(e)) {
+    // bucket head in use, link an entry from the segment freelist after it
+    CacheDirEntry *head = e;
+    e                   = dir_from_offset(this->freelist[s], seg);
+    if (!e) {
+      return false;
+    }
+    this->freelist[s] = dir_next(e);
+    if (CacheDirEntry *h = dir_from_offset(this->freelist[s], seg)) {
+      dir_set_prev(h, 0);
+    }
+    dir_set_next(e, dir_next(head));
+    dir_set_next(head, dir_to_offset(e, seg));
+  }
+  uint16_t next = dir_next(e);
+  dir_assign(e, src);
+  dir_set_next(e, next);
+  dir_set_prev(e, 0);
+  dir_set_offset(e, offset);
+  dir_set_tag(e, dir_key_tag(key));
+  return true;
+}
+
+Errata
+Stripe::convertDir()
+{
+  Errata zret;
+  if (!OPEN_RW_FLAG) {
+    zret.push(0, 1, "Writing Not Enabled.. Please use --write to enable writing to disk");
+    return zret;
+  }
+  zret = this->loadMeta();
+  if (!zret) {
+    return zret;
+  }
+  if (!_legacy_dir) {
+    std::cout << "Stripe @" << hashText << " already has directory version " << static_cast<int>(_meta[A][HEAD].version._major)
+              << std::endl;
+    return zret;
+  }
+  this->loadDir();
+
+  // The full tag of an entry is only known from the key of the fragment it points at. The larger
+  // directory moves the start of content, so fragments now under the directory are lost and the
+  // offsets of the others, which are relative to the start of content, shrink.
+  CacheDirEntry *old_dir = const_cast<CacheDirEntry *>(dir);
+  int64_t old_entries    = _segments * _buckets * DIR_DEPTH;
+  Bytes old_content      = _content;
+  StripeMeta const live  = _meta[A][HEAD]; // loadDir reads the A copy.
+
+  _legacy_dir = false;
+  this->vol_init_data();
+  int64_t shift          = (_content - old_content).count() / CACHE_BLOCK_SIZE;
+  size_t dir_bytes       = _segments * _buckets * DIR_DEPTH * SIZEOF_DIR;
+  CacheDirEntry *new_dir = static_cast<CacheDirEntry *>(ats_memalign(ats_pagesize(), dir_bytes));
+  memset(static_cast<void *>(new_dir), 0, dir_bytes);
+  dir      = new_dir;
+  freelist = static_cast<uint16_t *>(realloc(freelist, _segments * sizeof(uint16_t)));
+  this->init_dir();
+
+  int64_t kept = 0, lost = 0;
+  char *doc_buf = static_cast<char *>(ats_memalign(ats_pagesize(), CACHE_BLOCK_SIZE));
+  for (int64_t i = 0; i < old_entries; ++i) {
+    CacheDirEntry const *e = old_dir + i;
+    int64_t offset         = dir_offset(e);
+    if (!offset) {
+      continue;
+    }
+    Doc *doc  = reinterpret_cast<Doc *>(doc_buf);
+    Bytes pos = old_content + Bytes((offset - 1) * CACHE_BLOCK_SIZE);
+    if (offset <= shift || pread(_span->_fd, doc_buf, CACHE_BLOCK_SIZE, pos) < CACHE_BLOCK_SIZE) {
+      ++lost;
+    } else if (doc->magic != DOC_MAGIC || dir_tag(e) != (dir_key_tag(&doc->key) & ((1 << LEGACY_DIR_TAG_WIDTH) - 1))) {
+      ++lost; // stale entry, the fragment was overwritten
+    } else if (this->dir_insert(&doc->key, e, offset - shift)) {
+      ++kept;
+    } else {
+      ++lost;
+    }
+  }
+  ats_free(doc_buf);
+  ats_free(old_dir);
+
+  for (auto &copy : _meta) {
+    for (auto &m : copy) {
+      m                = live;
+      m.version._major = ts::CACHE_STRIPE_MAJOR_VERSION;
+      m.version._minor = ts::CACHE_STRIPE_MINOR_VERSION;
+      m.write_pos      = std::max<off_t>(m.write_pos, _content.count());
+      m.last_write_pos = std::max<off_t>(m.last_write_pos, _content.count());
+      m.agg_pos        = std::max<off_t>(m.agg_pos, _content.count());
+      m.dirty          = 0;
+    }
+  }
+
+  // Both copies are identical, header and freelist, directory, then the footer at the end.
+  int64_t dir_len  = this->vol_dirlen();
+  int64_t foot_len = ROUND_TO_STORE_BLOCK(sizeof(StripeMeta));
+  char *raw_dir    = static_cast<char *>(ats_memalign(ats_pagesize(), dir_len));
+  memset(raw_dir, 0, dir_len);
+  memcpy(raw_dir, &_meta[A][HEAD], sizeof(StripeMeta));
+  memcpy(raw_dir + sizeof(StripeMeta) - sizeof(uint16_t), freelist, _segments * sizeof(uint16_t));
+  memcpy(raw_dir + this->vol_headerlen(), dir, dir_bytes);
+  memcpy(raw_dir + dir_len - foot_len, &_meta[A][FOOT], sizeof(StripeMeta));
+  for (auto c : {B, A}) {
+    Bytes pos = _start + Bytes(c * dir_len);
+    if (pwrite(_span->_fd, raw_dir, dir_len, pos) < dir_len) {
+      zret = Errata::Message(0, errno, "Failed to write stripe directory ", hashText, ": ", strerror(errno));
+      break;
+    }
+    _meta_pos[c][HEAD] = round_down(pos);
+    _meta_pos[c][FOOT] = round_down(pos + Bytes(dir_len - foot_len));
+  }
+  ats_free(raw_dir);
+
+  std::cout << "Converted stripe @" << hashText << ": " << kept << " entries kept, " << lost << " lost" << std::endl;
   return zret;
 }
 //
@@ -709,9 +855,11 @@ Stripe::check_loop(int s)
 }
 
 int
-compare_ushort(void const *a, void const *b)
+compare_tag(void const *a, void const *b)
 {
-  return *static_cast<unsigned short const *>(a) - *static_cast<unsigned short const *>(b);
+  uint32_t x = *static_cast<uint32_t const *>(a);
+  uint32_t y = *static_cast<uint32_t const *>(b);
+  return x < y ? -1 : (x > y ? 1 : 0);
 }
 
 void
@@ -719,7 +867,7 @@ Stripe::dir_check()
 {
   static int const SEGMENT_HISTOGRAM_WIDTH = 16;
   int hist[SEGMENT_HISTOGRAM_WIDTH + 1]    = {0};
-  unsigned short chain_tag[MAX_ENTRIES_PER_SEGMENT];
+  uint32_t chain_tag[MAX_ENTRIES_PER_SEGMENT];
   int32_t chain_mark[MAX_ENTRIES_PER_SEGMENT];
 
   this->loadMeta();
@@ -796,8 +944,8 @@ Stripe::dir_check()
 
       // Check for duplicates (identical tags in the same bucket).
       if (h > 1) {
-        unsigned short last;
-        qsort(chain_tag, h, sizeof(chain_tag[0]), &compare_ushort);
+        uint32_t last;
+        qsort(chain_tag, h, sizeof(chain_tag[0]), &compare_tag);
         last = chain_tag[0];
         for (int k = 1; k < h; ++k) {
           if (last == chain_tag[k]) {
@@ -913,6 +1061,11 @@ Stripe::loadMeta()
     delta               = Bytes(data.rebind<char>().data() - stripe_buff2);
     _meta[A][HEAD]      = *meta;
     _meta_pos[A][HEAD]  = round_down(pos + Bytes(delta));
+    if (meta->version._major < ts::CACHE_STRIPE_MAJOR_VERSION_COMPATIBLE && !_legacy_dir) {
+      // The directory geometry depends on the entry size, redo it for the smaller legacy entries.
+      _legacy_dir = true;
+      this->vol_init_data();
+    }
     pos                += round_up(SBSIZE);
     _directory._skip    = Bytes(SBSIZE); // first guess, updated in @c updateLiveData when the header length is computed.
     // Search for Footer A. Nothing for it except to grub through the disk.
@@ -60,6 +60,9 @@ namespace ts
     (_e)->w[2] = 0;   \
     (_e)->w[3] = 0;   \
     (_e)->w[4] = 0;   \
+    (_e)->w[5] = 0;   \
+    (_e)->w[6] = 0;   \
+    (_e)->w[7] = 0;   \
   } while (0)
 
 #define dir_assign(_e, _x)   \
@@ -69,10 +72,18 @@ namespace ts
     (_e)->w[2] = (_x)->w[2]; \
     (_e)->w[3] = (_x)->w[3]; \
     (_e)->w[4] = (_x)->w[4]; \
+    (_e)->w[5] = (_x)->w[5]; \
+    (_e)->w[6] = (_x)->w[6]; \
+    (_e)->w[7] = (_x)->w[7]; \
   } while (0)
 
 constexpr static uint8_t CACHE_DB_MAJOR_VERSION = 24;
 constexpr static uint8_t CACHE_DB_MINOR_VERSION = 1;
+/// Version of the stripe meta data and directory layout, see I_CacheDefs.h.
+constexpr static uint8_t CACHE_STRIPE_MAJOR_VERSION = 25;
+constexpr static uint8_t CACHE_STRIPE_MINOR_VERSION = 0;
+/// Stripes older than this have the 10 byte directory entry of @c LegacyDirEntry.
+constexpr static uint8_t CACHE_STRIPE_MAJOR_VERSION_COMPATIBLE = 25;
 /// Maximum allowed volume index.
 constexpr static int MAX_VOLUME_IDX          = 255;
 constexpr static int ENTRIES_PER_BUCKET      = 4;
@@ -198,12 +209,36 @@ struct Doc {
 
 /*
  @internal struct Dir in P_CacheDir.h
- * size: 10bytes
+ * size: 16bytes
  */
 
 class CacheDirEntry
 {
 public:
+#if 0
+  uint64_t offset : 48;
+  unsigned int size : 6;
+  unsigned int big : 2;
+  unsigned int phase : 1;
+  unsigned int head : 1;
+  unsigned int pinned : 1;
+  unsigned int token : 1;
+  unsigned int unused : 4;
+  unsigned int tag : 32;
+  unsigned int next : 16;
+  unsigned int prev : 16;
+#else
+  uint16_t w[8];
+#endif
+};
+
+/*
+ @internal struct Dir of stripes before CACHE_STRIPE_MAJOR_VERSION_COMPATIBLE
+ * size: 10bytes
+ */
+class LegacyDirEntry
+{
+public:
 #if 0
   unsigned int offset : 24;
   unsigned int big : 2;
@@ -359,40 +394,85 @@ constexpr int ESTIMATED_OBJECT_SIZE     = 8000;
 constexpr int DEFAULT_HW_SECTOR_SIZE    = 512;
 constexpr int VOL_HASH_TABLE_SIZE       = 32707;
 constexpr unsigned short VOL_HASH_EMPTY = 65535;
-constexpr int DIR_TAG_WIDTH             = 12;
+constexpr int DIR_TAG_WIDTH             = 32;
+constexpr int DIR_TAG_KEY2_WIDTH        = 12; // tag bits from key slice 2, the stripe hash uses the upper bits
+constexpr int LEGACY_DIR_TAG_WIDTH      = 12;
 constexpr int DIR_DEPTH                 = 4;
-constexpr int SIZEOF_DIR                = 10;
+constexpr int SIZEOF_DIR                = 16;
+constexpr int LEGACY_SIZEOF_DIR         = 10;
 constexpr int MAX_ENTRIES_PER_SEGMENT   = (1 << 16);
 constexpr int DIR_SIZE_WIDTH            = 6;
 constexpr int DIR_BLOCK_SIZES           = 4;
 constexpr int CACHE_BLOCK_SHIFT         = 9;
 constexpr int CACHE_BLOCK_SIZE          = (1 << CACHE_BLOCK_SHIFT); // 512, smallest sector size
+constexpr uint32_t DOC_MAGIC            = 0x5F129B13;
+
+static_assert(sizeof(CacheDirEntry) == SIZEOF_DIR, "directory entries are indexed in units of SIZEOF_DIR");
+static_assert(sizeof(ts::LegacyDirEntry) == LEGACY_SIZEOF_DIR, "legacy directory entries are 10 bytes");
 
 namespace ct
 {
-#define dir_big(_e)         ((uint32_t)((((_e)->w[1]) >> 8) & 0x3))
-#define dir_bit(_e, _w, _b) ((uint32_t)(((_e)->w[_w] >> (_b)) & 1))
-#define dir_size(_e)        ((uint32_t)(((_e)->w[1]) >> 10))
-#define dir_approx_size(_e) ((dir_size(_e) + 1) * DIR_BLOCK_SIZE(dir_big(_e)))
-#define dir_head(_e)        dir_bit(_e, 2, 13)
-#define DIR_MASK_TAG(_t)    ((_t) & ((1 << DIR_TAG_WIDTH) - 1))
-#define dir_tag(_e)         ((uint32_t)((_e)->w[2] & ((1 << DIR_TAG_WIDTH) - 1)))
-#define dir_offset(_e) \
-  ((int64_t)(((uint64_t)(_e)->w[0]) | (((uint64_t)((_e)->w[1] & 0xFF)) << 16) | (((uint64_t)(_e)->w[4]) << 24)))
-
-#define dir_set_offset(_e, _o)                                              \
-  do {                                                                      \
-    (_e)->w[0] = (uint16_t)_o;                                              \
-    (_e)->w[1] = (uint16_t)((((_o) >> 16) & 0xFF) | ((_e)->w[1] & 0xFF00)); \
-    (_e)->w[4] = (uint16_t)((_o) >> 24);                                    \
+#define dir_bit(_e, _w, _b)         ((uint32_t)(((_e)->w[_w] >> (_b)) & 1))
+#define dir_set_bit(_e, _w, _b, _v) (_e)->w[_w] = (uint16_t)(((_e)->w[_w] & ~(1 << (_b))) | (((_v) ? 1 : 0) << (_b)))
+#define dir_big(_e)                 ((uint32_t)((((_e)->w[3]) >> 6) & 0x3))
+#define dir_size(_e)                ((uint32_t)(((_e)->w[3]) & 0x3F))
+#define dir_approx_size(_e)         ((dir_size(_e) + 1) * DIR_BLOCK_SIZE(dir_big(_e)))
+#define dir_head(_e)                dir_bit(_e, 3, 9)
+#define dir_tag(_e)                 ((uint32_t)(((uint32_t)(_e)->w[4]) | (((uint32_t)(_e)->w[5]) << 16)))
+#define dir_set_tag(_e, _t)                          \
+  do {                                               \
+    (_e)->w[4] = (uint16_t)(_t);                     \
+    (_e)->w[5] = (uint16_t)(((uint32_t)(_t)) >> 16); \
+  } while (0)
+#define dir_offset(_e) ((int64_t)(((uint64_t)(_e)->w[0]) | (((uint64_t)(_e)->w[1]) << 16) | (((uint64_t)(_e)->w[2]) << 32)))
+#define dir_set_offset(_e, _o)                       \
+  do {                                               \
+    (_e)->w[0] = (uint16_t)(_o);                     \
+    (_e)->w[1] = (uint16_t)(((uint64_t)(_o)) >> 16); \
+    (_e)->w[2] = (uint16_t)(((uint64_t)(_o)) >> 32); \
   } while (0)
 
-#define dir_next(_e)         (_e)->w[3]
-#define dir_phase(_e)        dir_bit(_e, 2, 12)
+#define dir_next(_e)         (_e)->w[6]
+#define dir_phase(_e)        dir_bit(_e, 3, 8)
 #define DIR_BLOCK_SHIFT(_i)  (3 * (_i))
 #define DIR_BLOCK_SIZE(_i)   (CACHE_BLOCK_SIZE << DIR_BLOCK_SHIFT(_i))
-#define dir_set_prev(_e, _o) (_e)->w[2] = (uint16_t)(_o)
-#define dir_set_next(_e, _o) (_e)->w[3] = (uint16_t)(_o)
+#define dir_set_prev(_e, _o) (_e)->w[7] = (uint16_t)(_o)
+#define dir_set_next(_e, _o) (_e)->w[6] = (uint16_t)(_o)
+
+// Accessors for the 10 byte entries of stripes before CACHE_STRIPE_MAJOR_VERSION_COMPATIBLE.
+#define legacy_dir_offset(_e) \
+  ((int64_t)(((uint64_t)(_e)->w[0]) | (((uint64_t)((_e)->w[1] & 0xFF)) << 16) | (((uint64_t)(_e)->w[4]) << 24)))
+#define legacy_dir_big(_e)    ((uint32_t)((((_e)->w[1]) >> 8) & 0x3))
+#define legacy_dir_size(_e)   ((uint32_t)(((_e)->w[1]) >> 10))
+#define legacy_dir_tag(_e)    ((uint32_t)((_e)->w[2] & ((1 << LEGACY_DIR_TAG_WIDTH) - 1)))
+#define legacy_dir_prev(_e)   (_e)->w[2] // free list entries only, shares the word with the tag
+#define legacy_dir_phase(_e)  dir_bit(_e, 2, 12)
+#define legacy_dir_head(_e)   dir_bit(_e, 2, 13)
+#define legacy_dir_pinned(_e) dir_bit(_e, 2, 14)
+#define legacy_dir_next(_e)   (_e)->w[3]
+
+/// The directory tag of @a key, see @c dir_key_tag in P_CacheDir.h.
+inline uint32_t
+dir_key_tag(const CryptoHash *key)
+{
+  return (key->slice32(2) & ((1 << DIR_TAG_KEY2_WIDTH) - 1)) | (key->slice32(3) << DIR_TAG_KEY2_WIDTH);
+}
+
+/// Convert a legacy entry @a src to the current layout in @a dst. Legacy tags are the low bits of the current tag.
+inline void
+dir_from_legacy(CacheDirEntry *dst, const ts::LegacyDirEntry *src)
+{
+  dir_clear(dst);
+  dir_set_next(dst, legacy_dir_next(src));
+  if (!legacy_dir_offset(src)) {
+    dir_set_prev(dst, legacy_dir_prev(src));
+    return;
+  }
+  dir_set_offset(dst, legacy_dir_offset(src));
+  dst->w[3] = (uint16_t)(legacy_dir_size(src) | (legacy_dir_big(src) << 6) | (legacy_dir_phase(src) << 8) |
+                         (legacy_dir_head(src) << 9) | (legacy_dir_pinned(src) << 10));
+  dir_set_tag(dst, legacy_dir_tag(src));
+}
 
 #define dir_in_seg(_s, _i) ((CacheDirEntry *)(((char *)(_s)) + (SIZEOF_DIR * (_i))))
 
@@ -517,6 +597,8 @@ struct Stripe {
   /// Load metadata for this stripe.
   Errata loadMeta();
   Errata loadDir();
+  /// Rewrite a legacy stripe with the current directory layout, keeping the objects that remain reachable.
+  Errata convertDir();
   int check_loop(int s);
   void dir_check();
   bool walk_bucket_chain(int s); // returns true if there is a loop
@@ -537,6 +619,8 @@ struct Stripe {
 
   int64_t _buckets  = 0; ///< Number of buckets per segment.
   int64_t _segments = 0; ///< Number of segments.
+  /// The on disk directory has @c LegacyDirEntry entries, they are converted to @c CacheDirEntry when loaded.
+  bool _legacy_dir = false;
 
   std::string hashText;
 
@@ -576,6 +660,8 @@ struct Stripe {
   CacheDirEntry *dir_delete_entry(CacheDirEntry *e, CacheDirEntry *p, int s);
   //  int dir_bucket_length(CacheDirEntry *b, int s);
   int dir_probe(CryptoHash *key, CacheDirEntry *result, CacheDirEntry **last_collision);
+  bool dir_insert(const CryptoHash *key, const CacheDirEntry *src, int64_t offset);
+  bool dir_compare_tag(const CacheDirEntry *e, const CryptoHash *key) const;
   bool dir_valid(CacheDirEntry *e);
   bool validate_sync_serial();
   Errata updateHeaderFooter();
@@ -1022,7 +1022,7 @@ Cache::build_stripe_hash_table()
 Stripe *
 Cache::key_to_stripe(CryptoHash *key, const char *hostname, int host_len)
 {
-  uint32_t h = (key->slice32(2) >> DIR_TAG_WIDTH) % VOL_HASH_TABLE_SIZE;
+  uint32_t h = (key->slice32(2) >> DIR_TAG_KEY2_WIDTH) % VOL_HASH_TABLE_SIZE;
   return globalVec_stripe[stripes_hash_table[h]];
 }
 
@@ -1276,6 +1276,29 @@ Check_Freelist(const std::string &devicePath)
   }
 }
 
+void
+Convert_Dir(const std::string &devicePath)
+{
+  Cache cache;
+  if ((err = cache.loadSpan(SpanFile))) {
+    cache.dumpSpans(Cache::SpanDumpDepth::SPAN);
+    for (auto sp : cache._spans) {
+      if (devicePath.size() > 0 && sp->_path.view() != devicePath) {
+        continue;
+      }
+      for (auto strp : sp->_stripes) {
+        if (strp->isFree()) {
+          continue;
+        }
+        Errata r = strp->convertDir();
+        if (!r) {
+          std::cout << r;
+        }
+      }
+    }
+  }
+}
+
 void
 Init_disk(swoc::file::path const &input_file_path)
 {
@@ -1387,6 +1410,8 @@ main(int argc, const char *argv[])
   c.add_command("full", "Full report of the cache storage", &dir_check);
   c.add_command("freelist", "check the freelist for loop", [&]() { Check_Freelist(inputFile); });
   c.add_command("bucket_chain", "walk bucket chains for loops", [&]() { walk_bucket_chain(inputFile); });
+  parser.add_command("dir_convert", "Convert stripes with a legacy directory to the current layout",
+                     [&]() { Convert_Dir(inputFile); });
   parser.add_command("volumes", "Volumes", &Simulate_Span_Allocation);
   parser.add_command("alloc", "Storage allocation")
     .require_commands()
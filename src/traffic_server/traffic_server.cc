@@ -1734,18 +1734,32 @@ configure_io_uring()
   RecInt aio_io_uring_attach_wq     = cfg.attach_wq;
   RecInt aio_io_uring_wq_bounded    = cfg.wq_bounded;
   RecInt aio_io_uring_wq_unbounded  = cfg.wq_unbounded;
+  RecInt aio_io_uring_fixed         = cfg.fixed;
+  RecInt net_io_uring_buffers       = cfg.net_buffers;
+  RecInt net_io_uring_buffer_size   = cfg.net_buffer_size;
 
   REC_ReadConfigInteger(aio_io_uring_queue_entries, "proxy.config.io_uring.entries");
   REC_ReadConfigInteger(aio_io_uring_sq_poll_ms, "proxy.config.io_uring.sq_poll_ms");
   REC_ReadConfigInteger(aio_io_uring_attach_wq, "proxy.config.io_uring.attach_wq");
   REC_ReadConfigInteger(aio_io_uring_wq_bounded, "proxy.config.io_uring.wq_workers_bounded");
   REC_ReadConfigInteger(aio_io_uring_wq_unbounded, "proxy.config.io_uring.wq_workers_unbounded");
+  REC_ReadConfigInteger(aio_io_uring_fixed, "proxy.config.io_uring.fixed");
+  REC_ReadConfigInteger(net_io_uring_buffers, "proxy.config.io_uring.net_buffers");
+  REC_ReadConfigInteger(net_io_uring_buffer_size, "proxy.config.io_uring.net_buffer_size");
 
   cfg.queue_entries = aio_io_uring_queue_entries;
   cfg.sq_poll_ms    = aio_io_uring_sq_poll_ms;
   cfg.attach_wq     = aio_io_uring_attach_wq;
   cfg.wq_bounded    = aio_io_uring_wq_bounded;
   cfg.wq_unbounded  = aio_io_uring_wq_unbounded;
+  cfg.fixed         = aio_io_uring_fixed;
+
+  // The kernel requires a power of 2 for the size of a provided buffer ring.
+  cfg.net_buffers = 1;
+  while (cfg.net_buffers < net_io_uring_buffers && cfg.net_buffers < 32768) {
+    cfg.net_buffers <<= 1;
+  }
+  cfg.net_buffer_size = net_io_uring_buffer_size;
 
   IOUringContext::set_config(cfg);
 }
@@ -2035,6 +2049,8 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   }
 
   REC_ReadConfigInteger(thread_max_heartbeat_mseconds, "proxy.config.thread.max_heartbeat_mseconds");
+  thread_slow_handler_threshold = HRTIME_MSECONDS(REC_ConfigReadInteger("proxy.config.thread.slow_handler_mseconds"));
+  REC_ReadConfigInteger(thread_slow_handler_sample, "proxy.config.thread.slow_handler_sample");
 
 #if TS_USE_LINUX_IO_URING
   configure_io_uring();
@@ -2125,7 +2141,9 @@ main(int /* argc ATS_UNUSED */, const char **argv)
     // "Task" processor, possibly with its own set of task threads.
     // We don't need task threads in the "command_flag" case.
     tasksProcessor.register_event_type();
-    eventProcessor.thread_group[ET_TASK]._afterStartCallback = task_threads_started_callback;
+    auto &task_group               = eventProcessor.thread_group[ET_TASK];
+    task_group._afterStartCallback = task_threads_started_callback;
+    task_group._work_stealing      = REC_ConfigReadInteger("proxy.config.task_threads.work_stealing") != 0;
     tasksProcessor.start(num_task_threads, stacksize);
 
     RecProcessStart();
@@ -0,0 +1,289 @@
+/** @file
+
+  Slow paths of the magazine allocator.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+#include "tscore/Allocator.h"
+#include "tscore/hugepages.h"
+#include "tscore/ink_align.h"
+#include "tscore/ink_atomic.h"
+#include "tscore/ink_hw.h"
+#include "tscore/ink_memory.h"
+
+thread_local MagazineAllocator::Cache MagazineAllocator::_caches[MagazineAllocator::MAX_ALLOCATORS + 1];
+
+namespace
+{
+std::atomic<int> allocator_count{0};
+std::atomic<MagazineAllocator *> allocators[MagazineAllocator::MAX_ALLOCATORS];
+std::atomic<int64_t> node_bytes[MagazineAllocator::MAX_NODES];
+
+// Hands the magazines of a thread back when it exits, armed when the thread sets up its first cache.
+struct ThreadFlush {
+  bool armed = false;
+  ~ThreadFlush()
+  {
+    if (armed) {
+      MagazineAllocator::flush_thread();
+    }
+  }
+};
+thread_local ThreadFlush thread_flush;
+
+// The id of @a a, MAX_ALLOCATORS if there are too many.
+int
+register_allocator(MagazineAllocator *a)
+{
+  int id = allocator_count++;
+  if (id >= MagazineAllocator::MAX_ALLOCATORS) {
+    return MagazineAllocator::MAX_ALLOCATORS;
+  }
+  allocators[id] = a;
+  return id;
+}
+
+inline void
+add_used(InkFreeList *fl, int n)
+{
+  ink_atomic_increment(reinterpret_cast<int *>(&fl->used), n);
+}
+} // namespace
+
+// Looked up once, event threads are bound to their CPUs so the node does not change.
+int
+MagazineAllocator::local_node()
+{
+  static thread_local int node = -1;
+
+  if (node < 0) {
+    node = 0;
+#if TS_USE_HWLOC
+    hwloc_bitmap_t cpus = hwloc_bitmap_alloc();
+    if (hwloc_get_last_cpu_location(ink_get_topology(), cpus, HWLOC_CPUBIND_THREAD) == 0) {
+      node = ink_numa_node_of(cpus) % MAX_NODES;
+    }
+    hwloc_bitmap_free(cpus);
+#endif
+  }
+  return node;
+}
+
+int64_t
+MagazineAllocator::node_allocated(int node)
+{
+  return node_bytes[node % MAX_NODES].load(std::memory_order_relaxed);
+}
+
+void
+MagazineAllocator::init_depot(const char *name)
+{
+  for (auto &d : _depot) {
+    ink_atomiclist_init(&d.full, name, offsetof(Magazine, next));
+    ink_atomiclist_init(&d.empty, name, offsetof(Magazine, next));
+  }
+  if (fl) {
+    _capacity = std::clamp(static_cast<int>(MAGAZINE_BYTES / fl->type_size), 1, static_cast<int>(MAGAZINE_SIZE));
+  }
+}
+
+MagazineAllocator::MagazineAllocator() : _id(register_allocator(this))
+{
+  init_depot(nullptr);
+}
+
+MagazineAllocator::MagazineAllocator(const char *name, unsigned int element_size, unsigned int chunk_size, unsigned int alignment,
+                                     bool use_hugepages)
+  : FreelistAllocator(name, element_size, chunk_size, alignment, use_hugepages), _id(register_allocator(this))
+{
+  init_depot(name);
+}
+
+void
+MagazineAllocator::re_init(const char *name, unsigned int element_size, unsigned int chunk_size, unsigned int alignment,
+                           bool use_hugepages, int advice)
+{
+  FreelistAllocator::re_init(name, element_size, chunk_size, alignment, use_hugepages, advice);
+  init_depot(name);
+}
+
+// Ids are not reused, the magazines a thread still has for this allocator are left behind.
+MagazineAllocator::~MagazineAllocator()
+{
+  if (_id < MAX_ALLOCATORS) {
+    allocators[_id] = nullptr;
+  }
+}
+
+MagazineAllocator::Magazine *
+MagazineAllocator::get_full(int node)
+{
+  // Prefer blocks freed on this node, but take them from another node before carving new ones or
+  // blocks that are allocated on one node and freed on another would pile up.
+  for (int i = 0; i < MAX_NODES; ++i) {
+    InkAtomicList &l = _depot[(node + i) % MAX_NODES].full;
+    if (!INK_ATOMICLIST_EMPTY(l)) {
+      if (auto m = static_cast<Magazine *>(ink_atomiclist_pop(&l))) {
+        add_used(fl, m->count);
+        return m;
+      }
+    }
+  }
+  return nullptr;
+}
+
+MagazineAllocator::Magazine *
+MagazineAllocator::get_empty(int node)
+{
+  if (auto m = static_cast<Magazine *>(ink_atomiclist_pop(&_depot[node].empty))) {
+    return m;
+  }
+  return new (ats_malloc(sizeof(Magazine))) Magazine;
+}
+
+void
+MagazineAllocator::put(Magazine *m, int node)
+{
+  if (m->count > 0) {
+    add_used(fl, -m->count);
+    ink_atomiclist_push(&_depot[node].full, m);
+  } else {
+    ink_atomiclist_push(&_depot[node].empty, m);
+  }
+}
+
+void
+MagazineAllocator::setup(Cache &c, int node)
+{
+  c.loaded           = get_empty(node);
+  c.previous         = get_empty(node);
+  thread_flush.armed = true;
+}
+
+// Allocate a chunk on this thread and load its blocks.
+void
+MagazineAllocator::carve(Cache &c)
+{
+  int node         = local_node();
+  size_t size      = static_cast<size_t>(fl->chunk_size) * fl->type_size;
+  size_t alignment = 0;
+  char *chunk      = nullptr;
+
+  if (fl->use_hugepages) {
+    alignment = ats_hugepage_size();
+    chunk     = static_cast<char *>(ats_alloc_hugepage(size));
+    if (chunk == nullptr) {
+      fl->hugepages_failure++;
+    }
+  }
+  if (chunk == nullptr) {
+    alignment = ats_pagesize();
+    chunk     = static_cast<char *>(ats_memalign(alignment, INK_ALIGN(size, alignment)));
+  }
+  if (fl->advice) {
+    ats_madvise(chunk, INK_ALIGN(size, alignment), fl->advice);
+  }
+  // First touch, the pages are placed on the node of this thread.
+  for (size_t off = 0; off < size; off += ats_pagesize()) {
+    static_cast<volatile char *>(chunk)[off] = 0;
+  }
+  ink_atomic_increment(reinterpret_cast<int *>(&fl->allocated), fl->chunk_size);
+  add_used(fl, fl->chunk_size);
+  node_bytes[node] += size;
+
+  // The full magazines go to the depot, the last, possibly partial, one stays loaded.
+  for (uint32_t i = 0; i < fl->chunk_size; ++i) {
+    if (c.loaded->count == _capacity) {
+      put(c.loaded, node);
+      c.loaded = get_empty(node);
+    }
+    c.loaded->rounds[c.loaded->count++] = chunk + static_cast<size_t>(i) * fl->type_size;
+  }
+}
+
+void *
+MagazineAllocator::alloc_slow()
+{
+  if (_id == MAX_ALLOCATORS || ink_freelist_uses_malloc()) {
+    return ink_freelist_new(fl);
+  }
+
+  Cache &c = _caches[_id];
+  int node = local_node();
+  if (c.loaded == nullptr) {
+    setup(c, node);
+  }
+
+  if (c.previous->count > 0) {
+    std::swap(c.loaded, c.previous);
+  } else if (Magazine *m = get_full(node)) {
+    put(c.previous, node);
+    c.previous = c.loaded;
+    c.loaded   = m;
+  } else {
+    carve(c);
+  }
+  return c.loaded->rounds[--c.loaded->count];
+}
+
+void
+MagazineAllocator::free_slow(void *ptr)
+{
+  Cache &c = _caches[_id];
+
+  if (_id == MAX_ALLOCATORS || (c.loaded == nullptr && ink_freelist_uses_malloc())) {
+    ink_freelist_free(fl, ptr);
+    return;
+  }
+
+  int node = local_node();
+  if (c.loaded == nullptr) {
+    setup(c, node);
+  } else if (c.previous->count == 0) {
+    std::swap(c.loaded, c.previous);
+  } else {
+    put(c.previous, node);
+    c.previous = c.loaded;
+    c.loaded   = get_empty(node);
+  }
+  c.loaded->rounds[c.loaded->count++] = ptr;
+}
+
+void
+MagazineAllocator::flush_thread()
+{
+  int node = local_node();
+  int n    = std::min(allocator_count.load(), static_cast<int>(MAX_ALLOCATORS));
+
+  for (int i = 0; i < n; ++i) {
+    Cache &c             = _caches[i];
+    MagazineAllocator *a = allocators[i].load();
+    if (a && c.loaded) {
+      a->put(c.loaded, node);
+      a->put(c.previous, node);
+    }
+    c.loaded   = nullptr;
+    c.previous = nullptr;
+  }
+}
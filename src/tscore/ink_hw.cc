@@ -19,6 +19,8 @@
   limitations under the License.
  */
 
+#include <algorithm>
+
 #include "tscore/ink_hw.h"
 #include "tscore/ink_platform.h"
 
@@ -45,8 +47,33 @@ ink_get_topology()
   static hwloc_topology_t topology = setup_hwloc();
   return topology;
 }
+
+int
+ink_numa_node_of(hwloc_const_cpuset_t cpus)
+{
+  hwloc_topology_t topology = ink_get_topology();
+  int n                     = hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_NODE);
+
+  for (int i = 0; i < n; ++i) {
+    hwloc_obj_t node = hwloc_get_obj_by_type(topology, HWLOC_OBJ_NODE, i);
+    if (node->cpuset && hwloc_bitmap_isincluded(cpus, node->cpuset)) {
+      return i;
+    }
+  }
+  return 0;
+}
 #endif
 
+int
+ink_number_of_numa_nodes()
+{
+#if TS_USE_HWLOC
+  return std::max(hwloc_get_nbobjs_by_type(ink_get_topology(), HWLOC_OBJ_NODE), 1);
+#else
+  return 1;
+#endif
+}
+
 int
 ink_number_of_processors()
 {